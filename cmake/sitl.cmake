@@ -17,6 +17,8 @@ main_sources(SITL_SRC
     drivers/serial_tcp.h
     target/SITL/sim/realFlight.c
     target/SITL/sim/realFlight.h
+    target/SITL/sim/replay.c
+    target/SITL/sim/replay.h
     target/SITL/sim/simHelper.c
     target/SITL/sim/simHelper.h
     target/SITL/sim/soap_client.c
@@ -27,6 +27,8 @@ set(CMSIS_DSP_SRC
     TransformFunctions/arm_bitreversal2.S
     CommonTables/arm_common_tables.c
     ComplexMathFunctions/arm_cmplx_mag_f32.c
+    FastMathFunctions/arm_sin_f32.c
+    FastMathFunctions/arm_cos_f32.c
     StatisticsFunctions/arm_max_f32.c
     StatisticsFunctions/arm_rms_f32.c
     StatisticsFunctions/arm_std_f32.c
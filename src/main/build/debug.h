@@ -79,6 +79,8 @@ typedef enum {
     DEBUG_GPS,
     DEBUG_LULU,
     DEBUG_SBUS2,
+    DEBUG_RC_SMOOTHING,
+    DEBUG_MAG_CALIBRATION,
     DEBUG_COUNT // also update debugModeNames in cli.c
 } debugType_e;
 
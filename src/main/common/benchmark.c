@@ -0,0 +1,483 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_BENCHMARK
+
+#include "common/benchmark.h"
+#include "common/filter.h"
+#include "common/maths.h"
+#include "common/matrix.h"
+#include "common/utils.h"
+
+#ifdef USE_ARM_MATH
+#include "arm_math.h"
+#endif
+
+#define BENCHMARK_INPUT_COUNT       64      // Power of 2, inputs are cycled through during the timed loop
+#define BENCHMARK_ERROR_SAMPLES     1024
+
+#define BENCHMARK_FILTER_DT         0.001f  // 1kHz loop
+#define BENCHMARK_FILTER_DT_US      1000
+
+typedef struct benchmark_s {
+    const char *name;
+    float min;                                  // Input range, both arguments
+    float max;
+    void (*reset)(void);                        // Optional, clears kernel and reference state
+    float (*kernel)(float a, float b);
+    double (*reference)(double a, double b);
+} benchmark_t;
+
+typedef struct benchmarkInput_s {
+    float a;
+    float b;
+} benchmarkInput_t;
+
+static volatile float benchmarkSink;
+
+/*
+ * Inputs are a low discrepancy sequence: the range is covered evenly for the
+ * stateless functions and the sequence looks like noise to the filters.
+ */
+static void benchmarkInput(const benchmark_t *benchmark, uint32_t index, benchmarkInput_t *input)
+{
+    const double span = (double)benchmark->max - (double)benchmark->min;
+    const double a = index * 0.6180339887498949;
+    const double b = index * 0.4142135623730950;
+
+    input->a = (float)((double)benchmark->min + span * (a - floor(a)));
+    input->b = (float)((double)benchmark->min + span * (b - floor(b)));
+}
+
+static float benchmarkNull(float a, float b)
+{
+    UNUSED(b);
+    return a;
+}
+
+// Maths
+
+static float benchmarkSinApprox(float a, float b) { UNUSED(b); return sin_approx(a); }
+static float benchmarkSinApproxPoly(float a, float b) { UNUSED(b); return sin_approx_poly(a); }
+static float benchmarkSinApproxLut(float a, float b) { UNUSED(b); return sin_approx_lut(a); }
+static float benchmarkSinf(float a, float b) { UNUSED(b); return sinf(a); }
+static double benchmarkSinRef(double a, double b) { UNUSED(b); return sin(a); }
+
+static float benchmarkCosApprox(float a, float b) { UNUSED(b); return cos_approx(a); }
+static double benchmarkCosRef(double a, double b) { UNUSED(b); return cos(a); }
+
+#ifdef USE_ARM_MATH
+static float benchmarkArmSin(float a, float b) { UNUSED(b); return arm_sin_f32(a); }
+static float benchmarkArmCos(float a, float b) { UNUSED(b); return arm_cos_f32(a); }
+#endif
+
+static float benchmarkAtan2Approx(float a, float b) { return atan2_approx(a, b); }
+static float benchmarkAtan2ApproxRational(float a, float b) { return atan2_approx_rational(a, b); }
+static float benchmarkAtan2ApproxMinimax(float a, float b) { return atan2_approx_minimax(a, b); }
+static float benchmarkAtan2f(float a, float b) { return atan2f(a, b); }
+static double benchmarkAtan2Ref(double a, double b) { return atan2(a, b); }
+
+static float benchmarkAcosApprox(float a, float b) { UNUSED(b); return acos_approx(a); }
+static float benchmarkAcosf(float a, float b) { UNUSED(b); return acosf(a); }
+static double benchmarkAcosRef(double a, double b) { UNUSED(b); return acos(a); }
+
+static float benchmarkFastFsqrtf(float a, float b) { UNUSED(b); return fast_fsqrtf(a); }
+static float benchmarkSqrtf(float a, float b) { UNUSED(b); return sqrtf(a); }
+static double benchmarkSqrtRef(double a, double b) { UNUSED(b); return sqrt(a); }
+
+// Median filters, fed through a ring buffer
+
+static int32_t medianWindow[9];
+static double medianRefWindow[9];
+static uint8_t medianIndex;
+static uint8_t medianRefIndex;
+
+static void benchmarkMedianReset(void)
+{
+    for (unsigned i = 0; i < ARRAYLEN(medianWindow); i++) {
+        medianWindow[i] = 0;
+        medianRefWindow[i] = 0.0;
+    }
+    medianIndex = 0;
+    medianRefIndex = 0;
+}
+
+static int32_t *benchmarkMedianPush(float input, uint8_t size)
+{
+    medianWindow[medianIndex] = (int32_t)input;
+    medianIndex = (medianIndex + 1) % size;
+    return medianWindow;
+}
+
+static double benchmarkMedianRef(double input, uint8_t size)
+{
+    double sorted[9];
+
+    medianRefWindow[medianRefIndex] = (int32_t)input;
+    medianRefIndex = (medianRefIndex + 1) % size;
+
+    // Insertion sort of a copy
+    for (int i = 0; i < size; i++) {
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > medianRefWindow[i]; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = medianRefWindow[i];
+    }
+
+    return sorted[size / 2];
+}
+
+static float benchmarkMedian3(float a, float b) { UNUSED(b); return quickMedianFilter3(benchmarkMedianPush(a, 3)); }
+static float benchmarkMedian5(float a, float b) { UNUSED(b); return quickMedianFilter5(benchmarkMedianPush(a, 5)); }
+static float benchmarkMedian7(float a, float b) { UNUSED(b); return quickMedianFilter7(benchmarkMedianPush(a, 7)); }
+static float benchmarkMedian9(float a, float b) { UNUSED(b); return quickMedianFilter9(benchmarkMedianPush(a, 9)); }
+static double benchmarkMedian3Ref(double a, double b) { UNUSED(b); return benchmarkMedianRef(a, 3); }
+static double benchmarkMedian5Ref(double a, double b) { UNUSED(b); return benchmarkMedianRef(a, 5); }
+static double benchmarkMedian7Ref(double a, double b) { UNUSED(b); return benchmarkMedianRef(a, 7); }
+static double benchmarkMedian9Ref(double a, double b) { UNUSED(b); return benchmarkMedianRef(a, 9); }
+
+// Filters. Reference runs the same recurrence with the same coefficients in double precision
+
+static pt1Filter_t pt1Filter;
+static pt2Filter_t pt2Filter;
+static pt3Filter_t pt3Filter;
+static biquadFilter_t biquadFilter;
+static double refState[3];
+
+static void benchmarkPt1Reset(void)
+{
+    pt1FilterInit(&pt1Filter, 100.0f, BENCHMARK_FILTER_DT);
+    refState[0] = 0.0;
+}
+
+static float benchmarkPt1(float a, float b) { UNUSED(b); return pt1FilterApply(&pt1Filter, a); }
+
+static double benchmarkPt1Ref(double a, double b)
+{
+    UNUSED(b);
+    refState[0] += (double)pt1Filter.alpha * (a - refState[0]);
+    return refState[0];
+}
+
+static void benchmarkPt2Reset(void)
+{
+    pt2FilterInit(&pt2Filter, pt2FilterGain(100.0f, BENCHMARK_FILTER_DT));
+    refState[0] = refState[1] = 0.0;
+}
+
+static float benchmarkPt2(float a, float b) { UNUSED(b); return pt2FilterApply(&pt2Filter, a); }
+
+static double benchmarkPt2Ref(double a, double b)
+{
+    UNUSED(b);
+    const double k = (double)pt2Filter.k;
+    refState[1] += k * (a - refState[1]);
+    refState[0] += k * (refState[1] - refState[0]);
+    return refState[0];
+}
+
+static void benchmarkPt3Reset(void)
+{
+    pt3FilterInit(&pt3Filter, pt3FilterGain(100.0f, BENCHMARK_FILTER_DT));
+    refState[0] = refState[1] = refState[2] = 0.0;
+}
+
+static float benchmarkPt3(float a, float b) { UNUSED(b); return pt3FilterApply(&pt3Filter, a); }
+
+static double benchmarkPt3Ref(double a, double b)
+{
+    UNUSED(b);
+    const double k = (double)pt3Filter.k;
+    refState[1] += k * (a - refState[1]);
+    refState[2] += k * (refState[1] - refState[2]);
+    refState[0] += k * (refState[2] - refState[0]);
+    return refState[0];
+}
+
+static void benchmarkBiquadLpfReset(void)
+{
+    biquadFilterInitLPF(&biquadFilter, 100, BENCHMARK_FILTER_DT_US);
+    refState[0] = refState[1] = 0.0;
+}
+
+static void benchmarkBiquadNotchReset(void)
+{
+    biquadFilterInitNotch(&biquadFilter, BENCHMARK_FILTER_DT_US, 200, 150);
+    refState[0] = refState[1] = 0.0;
+}
+
+static float benchmarkBiquad(float a, float b) { UNUSED(b); return biquadFilterApply(&biquadFilter, a); }
+
+static double benchmarkBiquadRef(double a, double b)
+{
+    UNUSED(b);
+    const double result = (double)biquadFilter.b0 * a + refState[0];
+    refState[0] = (double)biquadFilter.b1 * a - (double)biquadFilter.a1 * result + refState[1];
+    refState[1] = (double)biquadFilter.b2 * a - (double)biquadFilter.a2 * result;
+    return result;
+}
+
+// Linear algebra. Kernels copy a fixed positive definite system, perturb it with
+// the inputs and solve it; the reference solves the same system in double precision
+
+#define BENCHMARK_MATRIX_N      6   // Position estimator sized
+#define BENCHMARK_RANK_ONE_N    9   // Ellipsoid fit sized
+
+static float matrixBase[BENCHMARK_MATRIX_N][BENCHMARK_MATRIX_N];
+static float rankOneMatrix[BENCHMARK_RANK_ONE_N][BENCHMARK_RANK_ONE_N];
+static double rankOneRef[BENCHMARK_RANK_ONE_N][BENCHMARK_RANK_ONE_N];
+
+static void benchmarkMatrixReset(void)
+{
+    float B[BENCHMARK_MATRIX_N][BENCHMARK_MATRIX_N];
+    for (int i = 0; i < BENCHMARK_MATRIX_N; i++) {
+        for (int j = 0; j < BENCHMARK_MATRIX_N; j++) {
+            B[i][j] = sinf(1.0f + i * 7 + j * 3);
+        }
+    }
+
+    // B * B' + I
+    for (int i = 0; i < BENCHMARK_MATRIX_N; i++) {
+        for (int j = 0; j < BENCHMARK_MATRIX_N; j++) {
+            matrixBase[i][j] = i == j ? 1.0f : 0.0f;
+            for (int k = 0; k < BENCHMARK_MATRIX_N; k++) {
+                matrixBase[i][j] += B[i][k] * B[j][k];
+            }
+        }
+    }
+
+    for (int i = 0; i < BENCHMARK_RANK_ONE_N; i++) {
+        for (int j = 0; j < BENCHMARK_RANK_ONE_N; j++) {
+            rankOneMatrix[i][j] = i == j ? 1000.0f : 0.0f;
+            rankOneRef[i][j] = rankOneMatrix[i][j];
+        }
+    }
+}
+
+static void benchmarkMatrixSystem(float A[BENCHMARK_MATRIX_N][BENCHMARK_MATRIX_N], float rhs[BENCHMARK_MATRIX_N], float a, float b)
+{
+    memcpy(A, matrixBase, sizeof(matrixBase));
+    A[0][0] += fabsf(a);
+    for (int i = 0; i < BENCHMARK_MATRIX_N; i++) {
+        rhs[i] = b * (i + 1);
+    }
+}
+
+static float benchmarkCholesky(float a, float b)
+{
+    float A[BENCHMARK_MATRIX_N][BENCHMARK_MATRIX_N];
+    float x[BENCHMARK_MATRIX_N];
+    benchmarkMatrixSystem(A, x, a, b);
+    if (!matrixCholeskyDecompose(&A[0][0], BENCHMARK_MATRIX_N)) {
+        return 0.0f;
+    }
+    matrixCholeskySolve(&A[0][0], BENCHMARK_MATRIX_N, x, x);
+    return x[0];
+}
+
+static float benchmarkLdlt(float a, float b)
+{
+    float A[BENCHMARK_MATRIX_N][BENCHMARK_MATRIX_N];
+    float x[BENCHMARK_MATRIX_N];
+    benchmarkMatrixSystem(A, x, a, b);
+    if (!matrixLdltDecompose(&A[0][0], BENCHMARK_MATRIX_N)) {
+        return 0.0f;
+    }
+    matrixLdltSolve(&A[0][0], BENCHMARK_MATRIX_N, x, x);
+    return x[0];
+}
+
+static float benchmarkLu(float a, float b)
+{
+    float A[BENCHMARK_MATRIX_N][BENCHMARK_MATRIX_N];
+    float x[BENCHMARK_MATRIX_N];
+    benchmarkMatrixSystem(A, x, a, b);
+    if (!matrixLuDecompose(&A[0][0], BENCHMARK_MATRIX_N)) {
+        return 0.0f;
+    }
+    matrixLuSolve(&A[0][0], BENCHMARK_MATRIX_N, x, x);
+    return x[0];
+}
+
+// Gauss-Jordan elimination with partial pivoting
+static double benchmarkMatrixSolveRef(double a, double b)
+{
+    double A[BENCHMARK_MATRIX_N][BENCHMARK_MATRIX_N + 1];
+    for (int i = 0; i < BENCHMARK_MATRIX_N; i++) {
+        for (int j = 0; j < BENCHMARK_MATRIX_N; j++) {
+            A[i][j] = matrixBase[i][j];
+        }
+        A[i][BENCHMARK_MATRIX_N] = b * (i + 1);
+    }
+    A[0][0] += fabs(a);
+
+    for (int col = 0; col < BENCHMARK_MATRIX_N; col++) {
+        int pivot = col;
+        for (int i = col + 1; i < BENCHMARK_MATRIX_N; i++) {
+            if (fabs(A[i][col]) > fabs(A[pivot][col])) {
+                pivot = i;
+            }
+        }
+        for (int j = 0; j <= BENCHMARK_MATRIX_N; j++) {
+            const double tmp = A[col][j];
+            A[col][j] = A[pivot][j];
+            A[pivot][j] = tmp;
+        }
+        for (int i = 0; i < BENCHMARK_MATRIX_N; i++) {
+            if (i != col) {
+                const double factor = A[i][col] / A[col][col];
+                for (int j = col; j <= BENCHMARK_MATRIX_N; j++) {
+                    A[i][j] -= factor * A[col][j];
+                }
+            }
+        }
+    }
+
+    return A[0][BENCHMARK_MATRIX_N] / A[0][0];
+}
+
+// Kalman covariance update P -= x * x' / S, inputs keep it positive definite
+static float benchmarkRankOne(float a, float b)
+{
+    float x[BENCHMARK_RANK_ONE_N];
+    for (int i = 0; i < BENCHMARK_RANK_ONE_N; i++) {
+        x[i] = b * (i + 1) * 0.01f;
+    }
+    matrixSymmetricRankOneUpdate(&rankOneMatrix[0][0], BENCHMARK_RANK_ONE_N, -1.0f / (100.0f + fabsf(a)), x);
+    return rankOneMatrix[BENCHMARK_RANK_ONE_N - 1][0];
+}
+
+static double benchmarkRankOneRef(double a, double b)
+{
+    double x[BENCHMARK_RANK_ONE_N];
+    for (int i = 0; i < BENCHMARK_RANK_ONE_N; i++) {
+        x[i] = b * (i + 1) * (double)0.01f;
+    }
+    const double alpha = -1 / (100 + fabs(a));
+    for (int i = 0; i < BENCHMARK_RANK_ONE_N; i++) {
+        for (int j = 0; j < BENCHMARK_RANK_ONE_N; j++) {
+            rankOneRef[i][j] += alpha * x[i] * x[j];
+        }
+    }
+    return rankOneRef[BENCHMARK_RANK_ONE_N - 1][0];
+}
+
+static const benchmark_t benchmarks[] = {
+    { "sin_approx",             -2 * M_PIf,  2 * M_PIf, NULL, benchmarkSinApprox,           benchmarkSinRef },
+    { "sin_approx_poly",        -2 * M_PIf,  2 * M_PIf, NULL, benchmarkSinApproxPoly,       benchmarkSinRef },
+    { "sin_approx_lut",         -2 * M_PIf,  2 * M_PIf, NULL, benchmarkSinApproxLut,        benchmarkSinRef },
+#ifdef USE_ARM_MATH
+    { "arm_sin_f32",            -2 * M_PIf,  2 * M_PIf, NULL, benchmarkArmSin,              benchmarkSinRef },
+#endif
+    { "sinf",                   -2 * M_PIf,  2 * M_PIf, NULL, benchmarkSinf,                benchmarkSinRef },
+    { "cos_approx",             -2 * M_PIf,  2 * M_PIf, NULL, benchmarkCosApprox,           benchmarkCosRef },
+#ifdef USE_ARM_MATH
+    { "arm_cos_f32",            -2 * M_PIf,  2 * M_PIf, NULL, benchmarkArmCos,              benchmarkCosRef },
+#endif
+    { "atan2_approx",           -1.0f,       1.0f,      NULL, benchmarkAtan2Approx,         benchmarkAtan2Ref },
+    { "atan2_approx_rational",  -1.0f,       1.0f,      NULL, benchmarkAtan2ApproxRational, benchmarkAtan2Ref },
+    { "atan2_approx_minimax",   -1.0f,       1.0f,      NULL, benchmarkAtan2ApproxMinimax,  benchmarkAtan2Ref },
+    { "atan2f",                 -1.0f,       1.0f,      NULL, benchmarkAtan2f,              benchmarkAtan2Ref },
+    { "acos_approx",            -1.0f,       1.0f,      NULL, benchmarkAcosApprox,          benchmarkAcosRef },
+    { "acosf",                  -1.0f,       1.0f,      NULL, benchmarkAcosf,               benchmarkAcosRef },
+    { "fast_fsqrtf",            0.0f,        10000.0f,  NULL, benchmarkFastFsqrtf,          benchmarkSqrtRef },
+    { "sqrtf",                  0.0f,        10000.0f,  NULL, benchmarkSqrtf,               benchmarkSqrtRef },
+    { "quickMedianFilter3",     -1000.0f,    1000.0f,   benchmarkMedianReset, benchmarkMedian3, benchmarkMedian3Ref },
+    { "quickMedianFilter5",     -1000.0f,    1000.0f,   benchmarkMedianReset, benchmarkMedian5, benchmarkMedian5Ref },
+    { "quickMedianFilter7",     -1000.0f,    1000.0f,   benchmarkMedianReset, benchmarkMedian7, benchmarkMedian7Ref },
+    { "quickMedianFilter9",     -1000.0f,    1000.0f,   benchmarkMedianReset, benchmarkMedian9, benchmarkMedian9Ref },
+    { "pt1FilterApply",         -1000.0f,    1000.0f,   benchmarkPt1Reset,          benchmarkPt1,       benchmarkPt1Ref },
+    { "pt2FilterApply",         -1000.0f,    1000.0f,   benchmarkPt2Reset,          benchmarkPt2,       benchmarkPt2Ref },
+    { "pt3FilterApply",         -1000.0f,    1000.0f,   benchmarkPt3Reset,          benchmarkPt3,       benchmarkPt3Ref },
+    { "biquadFilterApply lpf",  -1000.0f,    1000.0f,   benchmarkBiquadLpfReset,    benchmarkBiquad,    benchmarkBiquadRef },
+    { "biquadFilterApply notch", -1000.0f,   1000.0f,   benchmarkBiquadNotchReset,  benchmarkBiquad,    benchmarkBiquadRef },
+    { "matrixCholesky 6x6",     -10.0f,      10.0f,     benchmarkMatrixReset,       benchmarkCholesky,  benchmarkMatrixSolveRef },
+    { "matrixLdlt 6x6",         -10.0f,      10.0f,     benchmarkMatrixReset,       benchmarkLdlt,      benchmarkMatrixSolveRef },
+    { "matrixLu 6x6",           -10.0f,      10.0f,     benchmarkMatrixReset,       benchmarkLu,        benchmarkMatrixSolveRef },
+    { "matrixRankOne 9x9",      -10.0f,      10.0f,     benchmarkMatrixReset,       benchmarkRankOne,   benchmarkRankOneRef },
+};
+
+uint8_t benchmarkCount(void)
+{
+    return ARRAYLEN(benchmarks);
+}
+
+static uint32_t benchmarkTime(float (*kernel)(float a, float b), const benchmarkInput_t *inputs, benchmarkClockFnPtr clockFn, uint32_t calls)
+{
+    float sum = 0.0f;
+
+    const uint32_t start = clockFn();
+    for (uint32_t i = 0; i < calls; i++) {
+        const benchmarkInput_t *input = &inputs[i & (BENCHMARK_INPUT_COUNT - 1)];
+        sum += kernel(input->a, input->b);
+    }
+    const uint32_t elapsed = clockFn() - start;
+
+    benchmarkSink = sum;
+    return elapsed;
+}
+
+bool benchmarkRun(uint8_t index, benchmarkClockFnPtr clockFn, uint32_t calls, benchmarkResult_t *result)
+{
+    if (index >= ARRAYLEN(benchmarks) || calls == 0) {
+        return false;
+    }
+
+    const benchmark_t *benchmark = &benchmarks[index];
+    benchmarkInput_t inputs[BENCHMARK_INPUT_COUNT];
+
+    result->name = benchmark->name;
+
+    // Accuracy over the whole input range
+    if (benchmark->reset) {
+        benchmark->reset();
+    }
+
+    double maxError = 0.0;
+    for (uint32_t i = 0; i < BENCHMARK_ERROR_SAMPLES; i++) {
+        benchmarkInput(benchmark, i, &inputs[0]);
+        const double error = fabs((double)benchmark->kernel(inputs[0].a, inputs[0].b) - benchmark->reference((double)inputs[0].a, (double)inputs[0].b));
+        maxError = MAX(maxError, error);
+    }
+    result->maxError = (float)maxError;
+
+    // Speed, loop overhead is measured with a kernel that does nothing
+    for (uint32_t i = 0; i < BENCHMARK_INPUT_COUNT; i++) {
+        benchmarkInput(benchmark, i, &inputs[i]);
+    }
+
+    if (benchmark->reset) {
+        benchmark->reset();
+    }
+
+    const uint32_t overhead = benchmarkTime(benchmarkNull, inputs, clockFn, calls);
+    const uint32_t elapsed = benchmarkTime(benchmark->kernel, inputs, clockFn, calls);
+
+    result->ticksPerCall = elapsed > overhead ? (float)(elapsed - overhead) / calls : 0.0f;
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Speed and accuracy benchmark of the maths approximations and filter kernels.
+ * The same table runs on target (CLI 'bench', cycle counter) and on host (unit test).
+ * Error is the max absolute difference to a double precision reference.
+ */
+
+typedef uint32_t (*benchmarkClockFnPtr)(void);
+
+typedef struct benchmarkResult_s {
+    const char *name;
+    float ticksPerCall;     // Clock ticks per call, loop overhead removed
+    float maxError;         // Max absolute error against the reference
+} benchmarkResult_t;
+
+uint8_t benchmarkCount(void);
+bool benchmarkRun(uint8_t index, benchmarkClockFnPtr clockFn, uint32_t calls, benchmarkResult_t *result);
@@ -20,6 +20,23 @@
 #include "color.h"
 #include "colorconversion.h"
 
+/*
+ * k / 60 in Q16, rounded up. For x <= 255 (x * hueRampLut[k]) >> 16 equals x * k / 60 exactly,
+ * so the conversion below needs no divisions and gives the same result as the original code.
+ */
+static const uint32_t hueRampLut[61] = {
+    0, 1093, 2185, 3277, 4370, 5462, 6554, 7646, 8739, 9831,
+    10923, 12015, 13108, 14200, 15292, 16384, 17477, 18569, 19661, 20754,
+    21846, 22938, 24030, 25123, 26215, 27307, 28399, 29492, 30584, 31676,
+    32768, 33861, 34953, 36045, 37138, 38230, 39322, 40414, 41507, 42599,
+    43691, 44783, 45876, 46968, 48060, 49152, 50245, 51337, 52429, 53522,
+    54614, 55706, 56798, 57891, 58983, 60075, 61167, 62260, 63352, 64444,
+    65536
+};
+
+// (val - base) * k / 60 + base
+#define HUE_RAMP(val, base, k) (((((val) - (base)) * hueRampLut[k]) >> 16) + (base))
+
 /*
  * Source below found here: http://www.kasperkamperman.com/blog/arduino/arduino-programming-hsb-to-rgb/
  */
@@ -41,14 +58,18 @@ rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
 
         base = ((255 - sat) * val) >> 8;
 
-        switch (hue / 60) {
+        // hue / 60 and hue % 60, exact for 0..359
+        const uint16_t sector = ((uint32_t)hue * 1093) >> 16;
+        const uint16_t offset = hue - sector * 60;
+
+        switch (sector) {
             case 0:
             r.rgb.r = val;
-            r.rgb.g = (((val - base) * hue) / 60) + base;
+            r.rgb.g = HUE_RAMP(val, base, offset);
             r.rgb.b = base;
             break;
             case 1:
-            r.rgb.r = (((val - base) * (60 - (hue % 60))) / 60) + base;
+            r.rgb.r = HUE_RAMP(val, base, 60 - offset);
             r.rgb.g = val;
             r.rgb.b = base;
             break;
@@ -56,17 +77,17 @@ rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
             case 2:
             r.rgb.r = base;
             r.rgb.g = val;
-            r.rgb.b = (((val - base) * (hue % 60)) / 60) + base;
+            r.rgb.b = HUE_RAMP(val, base, offset);
             break;
 
             case 3:
             r.rgb.r = base;
-            r.rgb.g = (((val - base) * (60 - (hue % 60))) / 60) + base;
+            r.rgb.g = HUE_RAMP(val, base, 60 - offset);
             r.rgb.b = val;
             break;
 
             case 4:
-            r.rgb.r = (((val - base) * (hue % 60)) / 60) + base;
+            r.rgb.r = HUE_RAMP(val, base, offset);
             r.rgb.g = base;
             r.rgb.b = val;
             break;
@@ -74,11 +95,10 @@ rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
             case 5:
             r.rgb.r = val;
             r.rgb.g = base;
-            r.rgb.b = (((val - base) * (60 - (hue % 60))) / 60) + base;
+            r.rgb.b = HUE_RAMP(val, base, 60 - offset);
             break;
 
         }
     }
     return &r;
 }
-
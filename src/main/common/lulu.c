@@ -17,102 +17,71 @@
 #include <fenv.h>
 
 void luluFilterInit(luluFilter_t *filter, int N) {
-    filter->N = constrain(N, 1, 15);
-    filter->windowSize = filter->N * 2 + 1;
+    filter->N = constrain(N, 1, LULU_MAX_N);
     filter->windowBufIndex = 0;
 
-    memset(filter->luluInterim, 0, sizeof(float) * (filter->windowSize));
-    memset(filter->luluInterimB, 0, sizeof(float) * (filter->windowSize));
+    memset(filter->luluInterim, 0, sizeof(filter->luluInterim));
+    memset(filter->luluInterimB, 0, sizeof(filter->luluInterimB));
 }
 
-FAST_CODE float fixRoad(float *series, float *seriesB, int index, int filterN, int windowSize) {
-    float curVal = 0;
-    float curValB = 0;
-    for (int N = 1; N <= filterN; N++) {
-        int indexNeg = (index + windowSize - 2 * N) % windowSize;
-        int curIndex = (indexNeg + 1) % windowSize;
-        float prevVal = series[indexNeg];
-        float prevValB = seriesB[indexNeg];
-        int indexPos = (curIndex + N) % windowSize;
-        for (int i = windowSize - 2 * N; i < windowSize - N; i++) {
-            if (indexPos >= windowSize) {
-                indexPos = 0;
-            }
-            if (curIndex >= windowSize) {
-                curIndex = 0;
-            }
-
-            curVal = series[curIndex];
-            curValB = seriesB[curIndex];
-            float nextVal = series[indexPos];
-            float nextValB = seriesB[indexPos];
-
-            if (prevVal < curVal && curVal > nextVal) {
-                float maxValue = MAX(prevVal, nextVal);
-                series[curIndex] = maxValue;
-            }
-
-            if (prevValB < curValB && curValB > nextValB) {
-                float maxValue = MAX(prevValB, nextValB);
-                seriesB[curIndex] = maxValue;
-            }
-            prevVal = curVal;
-            prevValB = curValB;
-            curIndex++;
-            indexPos++;
+/*
+ * Samples are addressed by age, age 0 being the newest. The filter only
+ * looks at ages 0..2N, so a power of two ring of 32 samples holds the same
+ * window as the 2N + 1 sample buffer and wraps with a mask.
+ *
+ * Pass N flattens one sided peaks (then pits) of width N at ages 2N-1..N,
+ * comparing with the unmodified previous sample and the sample N newer.
+ */
+static FAST_CODE void luluRemovePeaks(float *series, unsigned head, int n)
+{
+    float prevVal = series[(head - 2 * n) & LULU_BUFFER_MASK];
+
+    for (int age = 2 * n - 1; age >= n; age--) {
+        const unsigned curIndex = (head - age) & LULU_BUFFER_MASK;
+        const float curVal = series[curIndex];
+        const float nextVal = series[(head - age + n) & LULU_BUFFER_MASK];
+
+        if (prevVal < curVal && curVal > nextVal) {
+            series[curIndex] = MAX(prevVal, nextVal);
         }
+        prevVal = curVal;
+    }
+}
+
+static FAST_CODE void luluRemovePits(float *series, unsigned head, int n)
+{
+    float prevVal = series[(head - 2 * n) & LULU_BUFFER_MASK];
+
+    for (int age = 2 * n - 1; age >= n; age--) {
+        const unsigned curIndex = (head - age) & LULU_BUFFER_MASK;
+        const float curVal = series[curIndex];
+        const float nextVal = series[(head - age + n) & LULU_BUFFER_MASK];
 
-        curIndex = (indexNeg + 1) % windowSize;
-        prevVal = series[indexNeg];
-        prevValB = seriesB[indexNeg];
-        indexPos = (curIndex + N) % windowSize;
-        for (int i = windowSize - 2 * N; i < windowSize - N; i++) {
-            if (indexPos >= windowSize) {
-                indexPos = 0;
-            }
-            if (curIndex >= windowSize) {
-                curIndex = 0;
-            }
-
-            curVal = series[curIndex];
-            curValB = seriesB[curIndex];
-            float nextVal = series[indexPos];
-            float nextValB = seriesB[indexPos];
-
-            if (prevVal > curVal && curVal < nextVal) {
-                float minValue = MIN(prevVal, nextVal);
-                series[curIndex] = minValue;
-            }
-
-            if (prevValB > curValB && curValB < nextValB) {
-                float minValue = MIN(prevValB, nextValB);
-                seriesB[curIndex] = minValue;
-            }
-            prevVal = curVal;
-            prevValB = curValB; 
-            curIndex++;
-            indexPos++;
+        if (prevVal > curVal && curVal < nextVal) {
+            series[curIndex] = MIN(prevVal, nextVal);
         }
+        prevVal = curVal;
     }
-    int finalIndex = (index + windowSize - filterN) % windowSize;
-    curVal = series[finalIndex];
-    curValB = seriesB[finalIndex];
-    return (curVal - curValB) / 2;
 }
 
 FAST_CODE float luluFilterPartialApply(luluFilter_t *filter, float input) {
-    // This is the value N of the LULU filter.
-    int filterN = filter->N;
-    // This is the total window size for the rolling buffer
-    int filterWindow = filter->windowSize;
-
-    int windowIndex = filter->windowBufIndex;
-    float inputVal = input;
-    int newIndex = (windowIndex + 1) % filterWindow;
-    filter->windowBufIndex = newIndex;
-    filter->luluInterim[windowIndex] = inputVal;
-    filter->luluInterimB[windowIndex] = -inputVal;
-    return fixRoad(filter->luluInterim, filter->luluInterimB, windowIndex, filterN, filterWindow);
+    const unsigned head = filter->windowBufIndex;
+    const int filterN = filter->N;
+
+    filter->windowBufIndex = (head + 1) & LULU_BUFFER_MASK;
+    filter->luluInterim[head] = input;
+    filter->luluInterimB[head] = -input;
+
+    // The negated series gets the same treatment, both are independent
+    for (int n = 1; n <= filterN; n++) {
+        luluRemovePeaks(filter->luluInterim, head, n);
+        luluRemovePits(filter->luluInterim, head, n);
+        luluRemovePeaks(filter->luluInterimB, head, n);
+        luluRemovePits(filter->luluInterimB, head, n);
+    }
+
+    const unsigned finalIndex = (head - filterN) & LULU_BUFFER_MASK;
+    return (filter->luluInterim[finalIndex] - filter->luluInterimB[finalIndex]) / 2;
 }
 
 FAST_CODE float luluFilterApply(luluFilter_t *filter, float input) {
@@ -120,4 +89,4 @@ FAST_CODE float luluFilterApply(luluFilter_t *filter, float input) {
     float resultA = luluFilterPartialApply(filter, input);
     // We use the median interpretation of this filter to remove bias in the output
     return resultA;
-}
\ No newline at end of file
+}
@@ -1,12 +1,14 @@
 #pragma once
 
-// Max N = 15
+#define LULU_MAX_N          15
+#define LULU_BUFFER_SIZE    32      // Power of two holding the 2 * LULU_MAX_N + 1 sample window
+#define LULU_BUFFER_MASK    (LULU_BUFFER_SIZE - 1)
+
 typedef struct {
-    int windowSize;
     int windowBufIndex;
     int N;
-    float luluInterim[32] __attribute__((aligned(128)));
-    float luluInterimB[32];
+    float luluInterim[LULU_BUFFER_SIZE] __attribute__((aligned(128)));
+    float luluInterimB[LULU_BUFFER_SIZE];
 } luluFilter_t;
 
 void luluFilterInit(luluFilter_t *filter, int N);
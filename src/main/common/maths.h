@@ -28,6 +28,10 @@
 #define FAST_MATH       // order 9 approximation
 //#define VERY_FAST_MATH  // order 7 approximation
 
+// Alternative implementations, may be selected per target. Compare them with the 'bench' CLI command
+//#define SIN_APPROX_LUT        // table with linear interpolation instead of the polynomial
+//#define ATAN2_APPROX_MINIMAX  // minimax polynomial instead of the rational approximation
+
 // Use floating point M_PI instead explicitly.
 #define M_PIf   3.14159265358979323846f
 #define M_LN2f  0.69314718055994530942f
@@ -185,8 +189,12 @@ int16_t quickMedianFilter5_16(int16_t * v);
 
 #if defined(FAST_MATH) || defined(VERY_FAST_MATH)
 float sin_approx(float x);
+float sin_approx_poly(float x);
+float sin_approx_lut(float x);
 float cos_approx(float x);
 float atan2_approx(float y, float x);
+float atan2_approx_rational(float y, float x);
+float atan2_approx_minimax(float y, float x);
 float acos_approx(float x);
 #define tan_approx(x)       (sin_approx(x) / cos_approx(x))
 #define asin_approx(x)      (M_PIf / 2 - acos_approx(x))
@@ -0,0 +1,257 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * Small dense matrix routines for estimators and calibration solvers.
+ *
+ * Matrices are row major float arrays, a float P[N][N] member is passed as
+ * &P[0][0]. Dimensions are plain arguments: callers pass compile time
+ * constants, so after inlining the loop bounds are known and the compiler
+ * can unroll and keep rows in FPU registers. Decompositions work in place
+ * and do not pivot, they are meant for the symmetric positive definite
+ * systems (normal equations, covariances) the callers build.
+ */
+
+#define MATRIX_MIN_PIVOT    1e-30f
+
+#define MATRIX_AT(m, cols, i, j)    ((m)[(i) * (cols) + (j)])
+
+static inline void matrixZero(float *m, const int rows, const int cols)
+{
+    for (int i = 0; i < rows * cols; i++) {
+        m[i] = 0.0f;
+    }
+}
+
+static inline void matrixScale(float *m, const int rows, const int cols, const float scale)
+{
+    for (int i = 0; i < rows * cols; i++) {
+        m[i] *= scale;
+    }
+}
+
+static inline float matrixTrace(const float *m, const int n)
+{
+    float trace = 0.0f;
+    for (int i = 0; i < n; i++) {
+        trace += MATRIX_AT(m, n, i, i);
+    }
+    return trace;
+}
+
+// y = A * x, y must not alias x
+static inline void matrixMultiplyVector(float *y, const float *A, const int rows, const int cols, const float *x)
+{
+    for (int i = 0; i < rows; i++) {
+        float sum = 0.0f;
+        for (int j = 0; j < cols; j++) {
+            sum += MATRIX_AT(A, cols, i, j) * x[j];
+        }
+        y[i] = sum;
+    }
+}
+
+static inline float matrixVectorDotProduct(const float *a, const float *b, const int n)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/*
+ * P += alpha * x * x' on a symmetric matrix. The upper triangle is computed
+ * and mirrored, so P stays exactly symmetric. With alpha = -1 / S and
+ * x = P * h' this is the covariance update of a scalar Kalman measurement.
+ */
+static inline void matrixSymmetricRankOneUpdate(float *P, const int n, const float alpha, const float *x)
+{
+    for (int i = 0; i < n; i++) {
+        const float ax = alpha * x[i];
+        for (int j = i; j < n; j++) {
+            const float value = MATRIX_AT(P, n, i, j) + ax * x[j];
+            MATRIX_AT(P, n, i, j) = value;
+            MATRIX_AT(P, n, j, i) = value;
+        }
+    }
+}
+
+/*
+ * A = L * L'. The lower triangle of A is replaced by L, the strict upper
+ * triangle is left alone. Fails if A is not positive definite.
+ */
+static inline bool matrixCholeskyDecompose(float *A, const int n)
+{
+    for (int j = 0; j < n; j++) {
+        float diagonal = MATRIX_AT(A, n, j, j);
+        for (int k = 0; k < j; k++) {
+            diagonal -= MATRIX_AT(A, n, j, k) * MATRIX_AT(A, n, j, k);
+        }
+        if (!(diagonal > MATRIX_MIN_PIVOT)) {
+            return false;
+        }
+
+        const float ljj = sqrtf(diagonal);
+        const float invLjj = 1.0f / ljj;
+        MATRIX_AT(A, n, j, j) = ljj;
+
+        for (int i = j + 1; i < n; i++) {
+            float value = MATRIX_AT(A, n, i, j);
+            for (int k = 0; k < j; k++) {
+                value -= MATRIX_AT(A, n, i, k) * MATRIX_AT(A, n, j, k);
+            }
+            MATRIX_AT(A, n, i, j) = value * invLjj;
+        }
+    }
+
+    return true;
+}
+
+// Solves L * L' * x = b, x may alias b
+static inline void matrixCholeskySolve(const float *L, const int n, const float *b, float *x)
+{
+    for (int i = 0; i < n; i++) {
+        float value = b[i];
+        for (int k = 0; k < i; k++) {
+            value -= MATRIX_AT(L, n, i, k) * x[k];
+        }
+        x[i] = value / MATRIX_AT(L, n, i, i);
+    }
+
+    for (int i = n - 1; i >= 0; i--) {
+        float value = x[i];
+        for (int k = i + 1; k < n; k++) {
+            value -= MATRIX_AT(L, n, k, i) * x[k];
+        }
+        x[i] = value / MATRIX_AT(L, n, i, i);
+    }
+}
+
+/*
+ * A = L * D * L' without square roots. D replaces the diagonal of A and the
+ * unit lower triangular L the strict lower triangle. Only the lower triangle
+ * of A is read. Fails on a zero or negative pivot.
+ */
+static inline bool matrixLdltDecompose(float *A, const int n)
+{
+    for (int j = 0; j < n; j++) {
+        float d = MATRIX_AT(A, n, j, j);
+        for (int k = 0; k < j; k++) {
+            d -= MATRIX_AT(A, n, j, k) * MATRIX_AT(A, n, j, k) * MATRIX_AT(A, n, k, k);
+        }
+        if (!(d > MATRIX_MIN_PIVOT)) {
+            return false;
+        }
+        MATRIX_AT(A, n, j, j) = d;
+
+        const float invD = 1.0f / d;
+        for (int i = j + 1; i < n; i++) {
+            float value = MATRIX_AT(A, n, i, j);
+            for (int k = 0; k < j; k++) {
+                value -= MATRIX_AT(A, n, i, k) * MATRIX_AT(A, n, j, k) * MATRIX_AT(A, n, k, k);
+            }
+            MATRIX_AT(A, n, i, j) = value * invD;
+        }
+    }
+
+    return true;
+}
+
+// Solves L * D * L' * x = b, x may alias b
+static inline void matrixLdltSolve(const float *LD, const int n, const float *b, float *x)
+{
+    for (int i = 0; i < n; i++) {
+        float value = b[i];
+        for (int k = 0; k < i; k++) {
+            value -= MATRIX_AT(LD, n, i, k) * x[k];
+        }
+        x[i] = value;
+    }
+
+    for (int i = 0; i < n; i++) {
+        x[i] /= MATRIX_AT(LD, n, i, i);
+    }
+
+    for (int i = n - 1; i >= 0; i--) {
+        float value = x[i];
+        for (int k = i + 1; k < n; k++) {
+            value -= MATRIX_AT(LD, n, k, i) * x[k];
+        }
+        x[i] = value;
+    }
+}
+
+/*
+ * Doolittle A = L * U for general square systems. U replaces the upper
+ * triangle with the diagonal, the unit lower triangular L the strict lower
+ * triangle. Fails on a zero pivot.
+ */
+static inline bool matrixLuDecompose(float *A, const int n)
+{
+    for (int i = 0; i < n; i++) {
+        for (int j = i; j < n; j++) {
+            float value = MATRIX_AT(A, n, i, j);
+            for (int k = 0; k < i; k++) {
+                value -= MATRIX_AT(A, n, i, k) * MATRIX_AT(A, n, k, j);
+            }
+            MATRIX_AT(A, n, i, j) = value;
+        }
+
+        const float pivot = MATRIX_AT(A, n, i, i);
+        if (!(fabsf(pivot) > MATRIX_MIN_PIVOT)) {
+            return false;
+        }
+
+        const float invPivot = 1.0f / pivot;
+        for (int j = i + 1; j < n; j++) {
+            float value = MATRIX_AT(A, n, j, i);
+            for (int k = 0; k < i; k++) {
+                value -= MATRIX_AT(A, n, j, k) * MATRIX_AT(A, n, k, i);
+            }
+            MATRIX_AT(A, n, j, i) = value * invPivot;
+        }
+    }
+
+    return true;
+}
+
+// Solves L * U * x = b, x may alias b
+static inline void matrixLuSolve(const float *LU, const int n, const float *b, float *x)
+{
+    for (int i = 0; i < n; i++) {
+        float value = b[i];
+        for (int k = 0; k < i; k++) {
+            value -= MATRIX_AT(LU, n, i, k) * x[k];
+        }
+        x[i] = value;
+    }
+
+    for (int i = n - 1; i >= 0; i--) {
+        float value = x[i];
+        for (int k = i + 1; k < n; k++) {
+            value -= MATRIX_AT(LU, n, i, k) * x[k];
+        }
+        x[i] = value / MATRIX_AT(LU, n, i, i);
+    }
+}
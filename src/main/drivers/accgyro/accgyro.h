@@ -30,6 +30,8 @@
 #define GYRO_LPF_5HZ        6
 #define GYRO_LPF_NONE       7
 
+#define GYRO_FIFO_MAX_SAMPLES   8
+
 typedef struct {
     uint8_t gyroLpf;
     uint16_t gyroRateHz;
@@ -40,12 +42,15 @@ typedef struct gyroDev_s {
     busDevice_t * busDev;
     sensorGyroInitFuncPtr initFn;                       // initialize function
     sensorGyroReadFuncPtr readFn;                       // read 3 axis data function
+    sensorGyroReadFuncPtr readFifoFn;                   // burst read all queued samples into gyroFifo, NULL if the driver has no FIFO
     sensorGyroReadDataFuncPtr temperatureFn;            // read temperature if available
     sensorGyroInterruptStatusFuncPtr intStatusFn;
     sensorGyroUpdateFuncPtr updateFn;
     float scale;                                        // scalefactor
     float gyroADCRaw[XYZ_AXIS_COUNT];
     float gyroZero[XYZ_AXIS_COUNT];
+    float gyroFifo[GYRO_FIFO_MAX_SAMPLES][XYZ_AXIS_COUNT];
+    uint8_t gyroFifoCount;                              // samples in gyroFifo after the last readFifoFn
     uint8_t imuSensorToUse;
     uint8_t lpf;                                        // Configuration value: Hardware LPF setting
     uint32_t requestedSampleIntervalUs;                 // Requested sample interval
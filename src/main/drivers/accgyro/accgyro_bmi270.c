@@ -93,6 +93,7 @@ typedef enum {
 #define BMI270_CHIP_ID 0x24
 
 #define BMI270_CMD_SOFTRESET 0xB6
+#define BMI270_CMD_FIFO_FLUSH 0xB0
 
 #define BMI270_PWR_CONF_HP 0x00
 #define BMI270_PWR_CTRL_GYR_EN 0x02
@@ -120,6 +121,11 @@ typedef enum {
 #define BMI270_BWP_OSR2 0x10
 #define BMI270_BWP_NORM 0x20
 
+#define BMI270_FIFO_DOWNS_GYR_FILT_DATA 0x08
+#define BMI270_FIFO_CONFIG_1_GYR_EN 0x80    // headerless, gyro frames only
+#define BMI270_FIFO_FRAME_SIZE 6
+#define BMI270_FIFO_LENGTH_MSB_MASK 0x3F
+
 typedef struct __attribute__ ((__packed__)) bmi270ContextData_s {
     uint16_t    chipMagicNumber;
     uint8_t     lastReadStatus;
@@ -130,6 +136,11 @@ typedef struct __attribute__ ((__packed__)) bmi270ContextData_s {
 
 STATIC_ASSERT(sizeof(bmi270ContextData_t) < BUS_SCRATCHPAD_MEMORY_SIZE, busDevice_scratchpad_memory_too_small);
 
+#ifdef USE_GYRO_FIFO
+// Dummy byte + gyro frames, too big for the scratchpad
+static uint8_t bmi270FifoBuffer[1 + GYRO_FIFO_MAX_SAMPLES * BMI270_FIFO_FRAME_SIZE];
+#endif
+
 static const gyroFilterAndRateConfig_t gyroConfigs[] = {
     { GYRO_LPF_256HZ,   3200,   { BMI270_BWP_OSR4 | BMI270_ODR_3200} },
     { GYRO_LPF_256HZ,   1600,   { BMI270_BWP_OSR2 | BMI270_ODR_1600} },
@@ -236,6 +247,21 @@ static void bmi270AccAndGyroInit(gyroDev_t *gyro)
     // Enable the gyro and accelerometer
     busWrite(busDev, BMI270_REG_PWR_CTRL, BMI270_PWR_CTRL_GYR_EN | BMI270_PWR_CTRL_ACC_EN);
     delay(1);
+
+#ifdef USE_GYRO_FIFO
+    // Queue filtered gyro samples at the full ODR
+    busWrite(busDev, BMI270_REG_FIFO_DOWNS, BMI270_FIFO_DOWNS_GYR_FILT_DATA);
+    delay(1);
+
+    busWrite(busDev, BMI270_REG_FIFO_CONFIG_0, 0);
+    delay(1);
+
+    busWrite(busDev, BMI270_REG_FIFO_CONFIG_1, BMI270_FIFO_CONFIG_1_GYR_EN);
+    delay(1);
+
+    busWrite(busDev, BMI270_REG_CMD, BMI270_CMD_FIFO_FLUSH);
+    delay(1);
+#endif
 }
 
 
@@ -255,6 +281,43 @@ static bool bmi270yroReadScratchpad(gyroDev_t *gyro)
     return false;
 }
 
+#ifdef USE_GYRO_FIFO
+static bool bmi270GyroReadFifo(gyroDev_t *gyro)
+{
+    // Data registers are still read for the accelerometer
+    if (!bmi270yroReadScratchpad(gyro)) {
+        return false;
+    }
+
+    uint8_t length[3];
+    if (!busReadBuf(gyro->busDev, BMI270_REG_FIFO_LENGTH_LSB, &length[0], sizeof(length))) {
+        return false;
+    }
+
+    const uint16_t fifoBytes = ((length[2] & BMI270_FIFO_LENGTH_MSB_MASK) << 8) | length[1];
+    const uint8_t frameCount = MIN(fifoBytes / BMI270_FIFO_FRAME_SIZE, GYRO_FIFO_MAX_SAMPLES);
+
+    // Frames left over are read with the next batch
+    if (frameCount == 0) {
+        return true;
+    }
+
+    if (!busReadBuf(gyro->busDev, BMI270_REG_FIFO_DATA, &bmi270FifoBuffer[0], 1 + frameCount * BMI270_FIFO_FRAME_SIZE)) {
+        return false;
+    }
+
+    for (int i = 0; i < frameCount; i++) {
+        const uint8_t *frame = &bmi270FifoBuffer[1 + i * BMI270_FIFO_FRAME_SIZE];
+        gyro->gyroFifo[i][X] = (float) int16_val_little_endian(frame, 0);
+        gyro->gyroFifo[i][Y] = (float) int16_val_little_endian(frame, 1);
+        gyro->gyroFifo[i][Z] = (float) int16_val_little_endian(frame, 2);
+    }
+    gyro->gyroFifoCount = frameCount;
+
+    return true;
+}
+#endif
+
 static bool bmi270AccReadScratchpad(accDev_t *acc)
 {
     bmi270ContextData_t * ctx = busDeviceGetScratchpadMemory(acc->busDev);
@@ -333,6 +396,9 @@ bool bmi270GyroDetect(gyroDev_t *gyro)
 
     gyro->initFn = bmi270GyroInit;
     gyro->readFn = bmi270yroReadScratchpad;
+#ifdef USE_GYRO_FIFO
+    gyro->readFifoFn = bmi270GyroReadFifo;
+#endif
     gyro->temperatureFn = bmi270TemperatureRead;
     gyro->intStatusFn = gyroCheckDataReady;
     gyro->scale = 1.0f / 16.4f; // 2000 dps
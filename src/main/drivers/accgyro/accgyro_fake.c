@@ -54,6 +54,44 @@ static bool fakeGyroRead(gyroDev_t *gyro)
     return true;
 }
 
+static float fakeGyroFifo[GYRO_FIFO_MAX_SAMPLES][XYZ_AXIS_COUNT];
+static uint8_t fakeGyroFifoCount;
+
+// Queues a sample for the next FIFO read, samples beyond the FIFO size are dropped
+bool fakeGyroQueueSample(int16_t x, int16_t y, int16_t z)
+{
+    if (fakeGyroFifoCount >= GYRO_FIFO_MAX_SAMPLES) {
+        return false;
+    }
+
+    fakeGyroFifo[fakeGyroFifoCount][X] = x;
+    fakeGyroFifo[fakeGyroFifoCount][Y] = y;
+    fakeGyroFifo[fakeGyroFifoCount][Z] = z;
+    fakeGyroFifoCount++;
+    return true;
+}
+
+static bool fakeGyroReadFifo(gyroDev_t *gyro)
+{
+    // Without a queued batch behave like a sensor sampling at the gyro task rate
+    if (fakeGyroFifoCount == 0) {
+        gyro->gyroFifo[0][X] = fakeGyroADC[X];
+        gyro->gyroFifo[0][Y] = fakeGyroADC[Y];
+        gyro->gyroFifo[0][Z] = fakeGyroADC[Z];
+        gyro->gyroFifoCount = 1;
+        return true;
+    }
+
+    for (int i = 0; i < fakeGyroFifoCount; i++) {
+        gyro->gyroFifo[i][X] = fakeGyroFifo[i][X];
+        gyro->gyroFifo[i][Y] = fakeGyroFifo[i][Y];
+        gyro->gyroFifo[i][Z] = fakeGyroFifo[i][Z];
+    }
+    gyro->gyroFifoCount = fakeGyroFifoCount;
+    fakeGyroFifoCount = 0;
+    return true;
+}
+
 static bool fakeGyroReadTemperature(gyroDev_t *gyro, int16_t *temperatureData)
 {
     UNUSED(gyro);
@@ -72,6 +110,7 @@ bool fakeGyroDetect(gyroDev_t *gyro)
     gyro->initFn = fakeGyroInit;
     gyro->intStatusFn = fakeGyroInitStatus;
     gyro->readFn = fakeGyroRead;
+    gyro->readFifoFn = fakeGyroReadFifo;
     gyro->temperatureFn = fakeGyroReadTemperature;
     gyro->scale = 0.0625f;
     gyro->gyroAlign = 0;
@@ -95,6 +95,23 @@
 #define ICM42605_INTF_CONFIG1_AFSR_MASK             0xC0
 #define ICM42605_INTF_CONFIG1_AFSR_DISABLE          0x40
 
+#define ICM42605_RA_SIGNAL_PATH_RESET               0x4B
+#define ICM42605_FIFO_FLUSH                         (1 << 1)
+
+#define ICM42605_RA_FIFO_CONFIG                     0x16
+#define ICM42605_FIFO_MODE_STREAM                   (1 << 6)
+
+#define ICM42605_RA_FIFO_CONFIG1                    0x5F
+#define ICM42605_FIFO_GYRO_EN                       (1 << 1)
+
+#define ICM42605_RA_FIFO_COUNTH                     0x2E
+#define ICM42605_RA_FIFO_DATA                       0x30
+
+// Gyro only packet: header, big endian X/Y/Z, temperature
+#define ICM42605_FIFO_PACKET_SIZE                   8
+#define ICM42605_FIFO_HEADER_EMPTY                  (1 << 7)
+#define ICM42605_FIFO_HEADER_GYRO                   (1 << 5)
+
 // --- Registers for gyro and acc Anti-Alias Filter ---------
 #define ICM426XX_RA_GYRO_CONFIG_STATIC3             0x0C  // User Bank 1
 #define ICM426XX_RA_GYRO_CONFIG_STATIC4             0x0D  // User Bank 1
@@ -111,6 +128,10 @@ typedef enum {
 
 static icm42605Variant_e icm42605DetectedVariant = ICM42605_VARIANT_42605;
 
+#ifdef USE_GYRO_FIFO
+static uint8_t icm42605FifoBuffer[GYRO_FIFO_MAX_SAMPLES * ICM42605_FIFO_PACKET_SIZE];
+#endif
+
 typedef struct aafConfig_s {
     uint16_t freq;
     uint8_t delt;
@@ -282,6 +303,14 @@ static void icm42605AccAndGyroInit(gyroDev_t *gyro)
 
     delay(15);
 
+#ifdef USE_GYRO_FIFO
+    // Queue every gyro sample, the gyro task reads them in batches
+    busWrite(dev, ICM42605_RA_FIFO_CONFIG1, ICM42605_FIFO_GYRO_EN);
+    busWrite(dev, ICM42605_RA_FIFO_CONFIG, ICM42605_FIFO_MODE_STREAM);
+    busWrite(dev, ICM42605_RA_SIGNAL_PATH_RESET, ICM42605_FIFO_FLUSH);
+    delay(1);
+#endif
+
     busSetSpeed(dev, BUS_SPEED_FAST);
 }
 
@@ -336,6 +365,45 @@ static bool icm42605GyroRead(gyroDev_t *gyro)
     return true;
 }
 
+#ifdef USE_GYRO_FIFO
+static bool icm42605GyroReadFifo(gyroDev_t *gyro)
+{
+    uint8_t count[2];
+
+    if (!busReadBuf(gyro->busDev, ICM42605_RA_FIFO_COUNTH, count, 2)) {
+        return false;
+    }
+
+    // Packets left over are read with the next batch
+    const uint8_t packetCount = MIN(((count[0] << 8) | count[1]) / ICM42605_FIFO_PACKET_SIZE, GYRO_FIFO_MAX_SAMPLES);
+    if (packetCount == 0) {
+        return true;
+    }
+
+    if (!busReadBuf(gyro->busDev, ICM42605_RA_FIFO_DATA, icm42605FifoBuffer, packetCount * ICM42605_FIFO_PACKET_SIZE)) {
+        return false;
+    }
+
+    uint8_t sampleCount = 0;
+    for (int i = 0; i < packetCount; i++) {
+        const uint8_t *packet = &icm42605FifoBuffer[i * ICM42605_FIFO_PACKET_SIZE];
+
+        if ((packet[0] & (ICM42605_FIFO_HEADER_EMPTY | ICM42605_FIFO_HEADER_GYRO)) != ICM42605_FIFO_HEADER_GYRO) {
+            continue;
+        }
+
+        const uint8_t *data = packet + 1;
+        gyro->gyroFifo[sampleCount][X] = (float) int16_val_big_endian(data, 0);
+        gyro->gyroFifo[sampleCount][Y] = (float) int16_val_big_endian(data, 1);
+        gyro->gyroFifo[sampleCount][Z] = (float) int16_val_big_endian(data, 2);
+        sampleCount++;
+    }
+    gyro->gyroFifoCount = sampleCount;
+
+    return true;
+}
+#endif
+
 static bool icm42605ReadTemperature(gyroDev_t *gyro, int16_t * temp)
 {
     uint8_t data[2];
@@ -368,6 +436,9 @@ bool icm42605GyroDetect(gyroDev_t *gyro)
 
     gyro->initFn = icm42605AccAndGyroInit;
     gyro->readFn = icm42605GyroRead;
+#ifdef USE_GYRO_FIFO
+    gyro->readFifoFn = icm42605GyroReadFifo;
+#endif
     gyro->intStatusFn = gyroCheckDataReady;
     gyro->temperatureFn = icm42605ReadTemperature;
     gyro->scale = 1.0f / 16.4f;     // 16.4 dps/lsb scalefactor
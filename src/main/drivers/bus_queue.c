@@ -0,0 +1,206 @@
+/*
+ * This file is part of INAV.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "platform.h"
+
+#include "build/atomic.h"
+
+#include "common/utils.h"
+
+#include "drivers/bus.h"
+#include "drivers/bus_queue.h"
+#include "drivers/nvic.h"
+
+void busQueueInit(busQueue_t * queue, busQueueStartFnPtr startFn)
+{
+    for (int i = 0; i < BUS_JOB_PRIORITY_COUNT; i++) {
+        queue->head[i] = NULL;
+        queue->tail[i] = NULL;
+    }
+
+    queue->startFn = startFn;
+    queue->active = NULL;
+    queue->dispatching = false;
+    queue->completedCount = 0;
+    queue->failedCount = 0;
+}
+
+static busJob_t * busQueuePop(busQueue_t * queue)
+{
+    for (int i = 0; i < BUS_JOB_PRIORITY_COUNT; i++) {
+        busJob_t * job = queue->head[i];
+        if (job) {
+            queue->head[i] = job->next;
+            if (queue->head[i] == NULL) {
+                queue->tail[i] = NULL;
+            }
+            job->next = NULL;
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Starts queued jobs while the bus is free. Only the queue manipulation is
+ * atomic, the backend is started with interrupts enabled. A backend may
+ * complete the job from inside startFn (blocking transfer), the loop then
+ * carries on with the next one instead of recursing.
+ */
+static void busQueueDispatch(busQueue_t * queue)
+{
+    for (;;) {
+        busJob_t * job = NULL;
+
+        ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+            if (!queue->dispatching && queue->active == NULL) {
+                job = busQueuePop(queue);
+                if (job) {
+                    job->state = BUS_JOB_RUNNING;
+                    queue->active = job;
+                    queue->dispatching = true;
+                }
+            }
+        }
+
+        if (job == NULL) {
+            return;
+        }
+
+        queue->startFn(queue, job);
+
+        ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+            queue->dispatching = false;
+        }
+    }
+}
+
+bool busQueueSubmit(busQueue_t * queue, busJob_t * job)
+{
+    if (job->priority >= BUS_JOB_PRIORITY_COUNT || job->segmentCount == 0) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        if (busJobIsPending(job)) {
+            return false;
+        }
+
+        job->state = BUS_JOB_QUEUED;
+        job->next = NULL;
+
+        if (queue->tail[job->priority]) {
+            queue->tail[job->priority]->next = job;
+        } else {
+            queue->head[job->priority] = job;
+        }
+        queue->tail[job->priority] = job;
+    }
+
+    busQueueDispatch(queue);
+    return true;
+}
+
+// Called by the backend when the active job has finished, the callback may submit the job again
+void busQueueJobComplete(busQueue_t * queue, bool success)
+{
+    busJob_t * job = NULL;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        job = queue->active;
+        queue->active = NULL;
+
+        if (job) {
+            job->state = success ? BUS_JOB_DONE : BUS_JOB_FAILED;
+            if (success) {
+                queue->completedCount++;
+            } else {
+                queue->failedCount++;
+            }
+        }
+    }
+
+    if (job && job->callback) {
+        job->callback(job);
+    }
+
+    busQueueDispatch(queue);
+}
+
+bool busQueueIsIdle(const busQueue_t * queue)
+{
+    if (queue->active) {
+        return false;
+    }
+
+    for (int i = 0; i < BUS_JOB_PRIORITY_COUNT; i++) {
+        if (queue->head[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool busJobIsPending(const busJob_t * job)
+{
+    return job->state == BUS_JOB_QUEUED || job->state == BUS_JOB_RUNNING;
+}
+
+#if defined(USE_SPI) && !defined(SITL_BUILD)
+static busQueue_t spiBusQueue[SPIDEV_COUNT];
+static bool spiBusQueueInitialized[SPIDEV_COUNT];
+
+// Runs the job with the blocking transfer until a DMA backend is registered for the bus
+static void spiBusQueueStartBlocking(busQueue_t * queue, busJob_t * job)
+{
+    const bool success = spiBusTransferMultiple(job->dev, job->segments, job->segmentCount);
+    busQueueJobComplete(queue, success);
+}
+#endif
+
+busQueue_t * busDeviceGetQueue(const busDevice_t * dev)
+{
+#if defined(USE_SPI) && !defined(SITL_BUILD)
+    if (dev->busType == BUSTYPE_SPI && dev->busdev.spi.spiBus < SPIDEV_COUNT) {
+        const SPIDevice bus = dev->busdev.spi.spiBus;
+
+        if (!spiBusQueueInitialized[bus]) {
+            busQueueInit(&spiBusQueue[bus], spiBusQueueStartBlocking);
+            spiBusQueueInitialized[bus] = true;
+        }
+
+        return &spiBusQueue[bus];
+    }
+#else
+    UNUSED(dev);
+#endif
+
+    return NULL;
+}
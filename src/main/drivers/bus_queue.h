@@ -0,0 +1,89 @@
+/*
+ * This file is part of INAV.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "drivers/bus.h"
+
+/*
+ * Asynchronous bus job queue, one per bus. A job is a list of transfer
+ * segments done with the device selected. Jobs are started in priority order
+ * whenever the bus becomes free, a job that is already on the bus is never
+ * interrupted. The backend starts a job and reports its end through
+ * busQueueJobComplete(), normally from the DMA completion interrupt, which
+ * chains the next job without involving the main loop.
+ */
+
+typedef enum {
+    BUS_JOB_PRIORITY_GYRO = 0,      // Always the next job on the bus
+    BUS_JOB_PRIORITY_SENSOR,        // Baro, mag and other periodic sensor reads
+    BUS_JOB_PRIORITY_BULK,          // OSD, flash and other long transfers
+    BUS_JOB_PRIORITY_COUNT
+} busJobPriority_e;
+
+typedef enum {
+    BUS_JOB_IDLE = 0,
+    BUS_JOB_QUEUED,
+    BUS_JOB_RUNNING,
+    BUS_JOB_DONE,
+    BUS_JOB_FAILED,
+} busJobState_e;
+
+struct busJob_s;
+struct busQueue_s;
+
+typedef void (*busJobCallbackPtr)(struct busJob_s * job);
+typedef void (*busQueueStartFnPtr)(struct busQueue_s * queue, struct busJob_s * job);
+
+typedef struct busJob_s {
+    const busDevice_t * dev;
+    busTransferDescriptor_t * segments;
+    uint8_t segmentCount;
+    busJobPriority_e priority;
+    volatile busJobState_e state;
+    busJobCallbackPtr callback;     // Called in the context that completes the job, possibly an interrupt
+    void * param;                   // For use by the callback
+    struct busJob_s * next;
+} busJob_t;
+
+typedef struct busQueue_s {
+    busQueueStartFnPtr startFn;
+    busJob_t * head[BUS_JOB_PRIORITY_COUNT];
+    busJob_t * tail[BUS_JOB_PRIORITY_COUNT];
+    busJob_t * volatile active;
+    volatile bool dispatching;
+    uint32_t completedCount;
+    uint32_t failedCount;
+} busQueue_t;
+
+void busQueueInit(busQueue_t * queue, busQueueStartFnPtr startFn);
+bool busQueueSubmit(busQueue_t * queue, busJob_t * job);
+void busQueueJobComplete(busQueue_t * queue, bool success);
+bool busQueueIsIdle(const busQueue_t * queue);
+bool busJobIsPending(const busJob_t * job);
+
+busQueue_t * busDeviceGetQueue(const busDevice_t * dev);
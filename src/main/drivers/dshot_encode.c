@@ -0,0 +1,94 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_DSHOT
+
+#include "drivers/dshot_encode.h"
+
+// Timer compare values of a packet nibble, MSB first
+#define DSHOT_BIT(nibble, bit)  ((((nibble) >> (bit)) & 1) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0)
+#define DSHOT_NIBBLE(nibble)    { DSHOT_BIT(nibble, 3), DSHOT_BIT(nibble, 2), DSHOT_BIT(nibble, 1), DSHOT_BIT(nibble, 0) }
+
+static const timerDMASafeType_t dshotNibbleBits[16][4] = {
+    DSHOT_NIBBLE(0x0), DSHOT_NIBBLE(0x1), DSHOT_NIBBLE(0x2), DSHOT_NIBBLE(0x3),
+    DSHOT_NIBBLE(0x4), DSHOT_NIBBLE(0x5), DSHOT_NIBBLE(0x6), DSHOT_NIBBLE(0x7),
+    DSHOT_NIBBLE(0x8), DSHOT_NIBBLE(0x9), DSHOT_NIBBLE(0xA), DSHOT_NIBBLE(0xB),
+    DSHOT_NIBBLE(0xC), DSHOT_NIBBLE(0xD), DSHOT_NIBBLE(0xE), DSHOT_NIBBLE(0xF),
+};
+
+uint16_t dshotEncodePacket(uint16_t value, bool requestTelemetry, bool bidirectional)
+{
+    const uint16_t packet = (value << 1) | (requestTelemetry ? 1 : 0);
+
+    // checksum is the xor of the three data nibbles, inverted for bidirectional DShot
+    uint16_t csum = (packet ^ (packet >> 4) ^ (packet >> 8)) & 0xf;
+    if (bidirectional) {
+        csum ^= 0xf;
+    }
+
+    return (packet << 4) | csum;
+}
+
+// Per channel DMA buffer, the frame reset slots stay zero from the timer setup
+void dshotLoadDmaBuffer(timerDMASafeType_t *dmaBuffer, uint16_t packet)
+{
+    for (int shift = DSHOT_PACKET_BITS - 4; shift >= 0; shift -= 4) {
+        const timerDMASafeType_t *bits = dshotNibbleBits[(packet >> shift) & 0xf];
+        dmaBuffer[0] = bits[0];
+        dmaBuffer[1] = bits[1];
+        dmaBuffer[2] = bits[2];
+        dmaBuffer[3] = bits[3];
+        dmaBuffer += 4;
+    }
+}
+
+/*
+ * Burst DMA buffer of one timer: each row holds CCR1..CCR4 for one bit slot.
+ * All channels in channelMask are written in one pass, packets are indexed by
+ * timer channel. Channels not in the mask are left untouched.
+ */
+void dshotLoadBurstDmaBuffer(timerDMASafeType_t *dmaBurstBuffer, const uint16_t *packets, uint8_t channelMask)
+{
+    for (int shift = DSHOT_PACKET_BITS - 4; shift >= 0; shift -= 4) {
+        for (int channel = 0; channel < DSHOT_BURST_CHANNELS; channel++) {
+            if (channelMask & (1 << channel)) {
+                const timerDMASafeType_t *bits = dshotNibbleBits[(packets[channel] >> shift) & 0xf];
+                timerDMASafeType_t *slot = &dmaBurstBuffer[channel];
+                slot[0 * DSHOT_BURST_CHANNELS] = bits[0];
+                slot[1 * DSHOT_BURST_CHANNELS] = bits[1];
+                slot[2 * DSHOT_BURST_CHANNELS] = bits[2];
+                slot[3 * DSHOT_BURST_CHANNELS] = bits[3];
+            }
+        }
+        dmaBurstBuffer += 4 * DSHOT_BURST_CHANNELS;
+    }
+
+    // Frame reset
+    for (int channel = 0; channel < DSHOT_BURST_CHANNELS; channel++) {
+        if (channelMask & (1 << channel)) {
+            dmaBurstBuffer[channel] = 0;
+            dmaBurstBuffer[DSHOT_BURST_CHANNELS + channel] = 0;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,35 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "drivers/timer.h"
+
+#define DSHOT_MOTOR_BIT_0       7
+#define DSHOT_MOTOR_BIT_1       14
+#define DSHOT_MOTOR_BITLENGTH   20
+
+#define DSHOT_PACKET_BITS       16
+#define DSHOT_DMA_BUFFER_SIZE   18 /* resolution + frame reset (2us) */
+#define DSHOT_BURST_CHANNELS    4  /* CCR1..CCR4 interleaved in the burst DMA buffer */
+
+uint16_t dshotEncodePacket(uint16_t value, bool requestTelemetry, bool bidirectional);
+void dshotLoadDmaBuffer(timerDMASafeType_t *dmaBuffer, uint16_t packet);
+void dshotLoadBurstDmaBuffer(timerDMASafeType_t *dmaBurstBuffer, const uint16_t *packets, uint8_t channelMask);
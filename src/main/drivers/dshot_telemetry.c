@@ -0,0 +1,158 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_DSHOT_TELEMETRY
+
+#include "common/utils.h"
+
+#include "drivers/dshot_telemetry.h"
+#include "drivers/pwm_mapping.h"
+
+#define GCR_INVALID 0xFF
+
+// 5 bit GCR symbol to data nibble
+static const uint8_t gcrDecodeTable[32] = {
+    GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID,
+    GCR_INVALID, 0x9,         0xA,         0xB,         GCR_INVALID, 0xD,         0xE,         0xF,
+    GCR_INVALID, GCR_INVALID, 0x2,         0x3,         GCR_INVALID, 0x5,         0x6,         0x7,
+    GCR_INVALID, 0x0,         0x8,         0x1,         GCR_INVALID, 0x4,         0xC,         GCR_INVALID,
+};
+
+static uint8_t dshotTelemetryMotorCount;
+static uint32_t dshotTelemetryErpm[MAX_MOTORS];
+static uint32_t dshotTelemetryErrors;
+
+/*
+ * Every edge is a GCR "1" followed by as many "0" as bit periods pass until
+ * the next edge. The line stays idle after the last edge, so the length of
+ * the last run is whatever is left of the 21 bits.
+ */
+bool dshotTelemetryDecodeEdges(const uint32_t *edges, uint8_t edgeCount, uint16_t bitTicks, uint16_t *value)
+{
+    if (edgeCount < 2 || edgeCount > DSHOT_TELEMETRY_MAX_EDGES || bitTicks == 0) {
+        return false;
+    }
+
+    uint32_t gcr = 0;
+    int bits = 0;
+
+    for (int i = 1; i <= edgeCount; i++) {
+        int len;
+
+        if (i < edgeCount) {
+            // 16 bit difference handles the counter wrapping on both 16 and 32 bit timers
+            const uint16_t ticks = edges[i] - edges[i - 1];
+            len = (ticks + bitTicks / 2) / bitTicks;
+        } else {
+            len = DSHOT_TELEMETRY_GCR_BITS - bits;
+        }
+
+        if (len <= 0 || bits + len > DSHOT_TELEMETRY_GCR_BITS) {
+            return false;
+        }
+
+        gcr = (gcr << len) | (1 << (len - 1));
+        bits += len;
+    }
+
+    uint16_t packet = 0;
+    for (int shift = 15; shift >= 0; shift -= 5) {
+        const uint8_t nibble = gcrDecodeTable[(gcr >> shift) & 0x1f];
+        if (nibble == GCR_INVALID) {
+            return false;
+        }
+        packet = (packet << 4) | nibble;
+    }
+
+    // All four nibbles xor to 0xF
+    uint16_t csum = packet ^ (packet >> 8);
+    csum ^= csum >> 4;
+    if ((csum & 0xf) != 0xf) {
+        return false;
+    }
+
+    *value = packet >> 4;
+    return true;
+}
+
+/*
+ * The 12 bit value is the electrical period in us as a 9 bit mantissa and a
+ * 3 bit left shift. Returns eRPM / 100, the unit of ESC serial telemetry.
+ */
+uint32_t dshotTelemetryValueToErpm(uint16_t value)
+{
+    if (value == DSHOT_TELEMETRY_MOTOR_STOPPED) {
+        return 0;
+    }
+
+    const uint32_t periodUs = (value & 0x1ff) << (value >> 9);
+    if (periodUs == 0) {
+        return 0;
+    }
+
+    return (60 * 1000000 / 100 + periodUs / 2) / periodUs;
+}
+
+void dshotTelemetryInit(uint8_t motorCount)
+{
+    dshotTelemetryMotorCount = MIN(motorCount, MAX_MOTORS);
+    dshotTelemetryErrors = 0;
+
+    for (int i = 0; i < MAX_MOTORS; i++) {
+        dshotTelemetryErpm[i] = 0;
+    }
+}
+
+bool dshotTelemetryIsActive(void)
+{
+    return dshotTelemetryMotorCount > 0;
+}
+
+// Called by the capture driver once the reply of a motor is complete, a failed frame keeps the last value
+bool dshotTelemetryProcessCapture(uint8_t motor, const uint32_t *edges, uint8_t edgeCount, uint16_t bitTicks)
+{
+    uint16_t value;
+
+    if (motor >= dshotTelemetryMotorCount) {
+        return false;
+    }
+
+    if (!dshotTelemetryDecodeEdges(edges, edgeCount, bitTicks, &value)) {
+        dshotTelemetryErrors++;
+        return false;
+    }
+
+    dshotTelemetryErpm[motor] = dshotTelemetryValueToErpm(value);
+    return true;
+}
+
+uint32_t getDshotTelemetry(uint8_t motor)
+{
+    return motor < dshotTelemetryMotorCount ? dshotTelemetryErpm[motor] : 0;
+}
+
+uint32_t getDshotTelemetryErrorCount(void)
+{
+    return dshotTelemetryErrors;
+}
+
+#endif
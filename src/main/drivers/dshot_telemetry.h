@@ -0,0 +1,40 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DSHOT_TELEMETRY_GCR_BITS        21  /* start transition + 4 x 5 bit GCR symbols */
+#define DSHOT_TELEMETRY_MAX_EDGES       DSHOT_TELEMETRY_GCR_BITS
+#define DSHOT_TELEMETRY_MOTOR_STOPPED   0x0FFF
+
+/*
+ * Bidirectional DShot eRPM reply decoding. The capture driver records the
+ * timer count of every edge of the reply, starting with the falling edge of
+ * the start bit, and hands them over after the frame.
+ */
+
+bool dshotTelemetryDecodeEdges(const uint32_t *edges, uint8_t edgeCount, uint16_t bitTicks, uint16_t *value);
+uint32_t dshotTelemetryValueToErpm(uint16_t value);
+
+void dshotTelemetryInit(uint8_t motorCount);
+bool dshotTelemetryIsActive(void);
+bool dshotTelemetryProcessCapture(uint8_t motor, const uint32_t *edges, uint8_t edgeCount, uint16_t bitTicks);
+uint32_t getDshotTelemetry(uint8_t motor);
+uint32_t getDshotTelemetryErrorCount(void);
@@ -66,6 +66,10 @@ static bool pwmMode = false;
 
 static hsvColor_t ledColorBuffer[WS2811_LED_STRIP_LENGTH];
 
+// Colors currently encoded in the DMA buffer. Only LEDs whose color differs are converted and encoded again
+static hsvColor_t ledEncodedColorBuffer[WS2811_LED_STRIP_LENGTH];
+static bool ledEncodedColorValid = false;
+
 void setLedHsv(uint16_t index, const hsvColor_t *color)
 {
     ledColorBuffer[index] = *color;
@@ -159,6 +163,7 @@ void ws2811LedStripInit(void)
         if ( ledPinConfig()->led_pin_pwm_mode == LED_PIN_PWM_MODE_SHARED_HIGH ) {
            ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE-1] = 255;
         }
+        ledEncodedColorValid = false;
         ws2811Initialised = true;
 
         ws2811UpdateStrip();
@@ -182,32 +187,51 @@ STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color)
     }
 }
 
+static bool hsvColorEqual(const hsvColor_t *a, const hsvColor_t *b)
+{
+    return a->h == b->h && a->s == b->s && a->v == b->v;
+}
+
+/*
+ * Encode LEDs whose color changed since the last update into the DMA buffer.
+ * Returns the number of LEDs encoded.
+ */
+STATIC_UNIT_TESTED uint16_t ws2811UpdateDMABuffer(void)
+{
+    uint16_t updatedCount = 0;
+
+    for (ledIndex = 0; ledIndex < WS2811_LED_STRIP_LENGTH; ledIndex++) {
+        if (ledEncodedColorValid && hsvColorEqual(&ledColorBuffer[ledIndex], &ledEncodedColorBuffer[ledIndex])) {
+            continue;
+        }
+
+        dmaBufferOffset = ledIndex * WS2811_BITS_PER_LED;
+        fastUpdateLEDDMABuffer(hsvToRgb24(&ledColorBuffer[ledIndex]));
+        ledEncodedColorBuffer[ledIndex] = ledColorBuffer[ledIndex];
+        updatedCount++;
+    }
+
+    ledEncodedColorValid = true;
+
+    return updatedCount;
+}
+
 /*
  * This method is non-blocking unless an existing LED update is in progress.
  * it does not wait until all the LEDs have been updated, that happens in the background.
  */
 void ws2811UpdateStrip(void)
 {
-    static rgbColor24bpp_t *rgb24;
-
     // don't wait - risk of infinite block, just get an update next time round
     if (pwmMode || timerPWMDMAInProgress(ws2811TCH)) {
         return;
     }
 
-    dmaBufferOffset = 0;                // reset buffer memory index
-    ledIndex = 0;                       // reset led index
-
     // fill transmit buffer with correct compare values to achieve
     // correct pulse widths according to color values
-    while (ledIndex < WS2811_LED_STRIP_LENGTH)
-    {
-        rgb24 = hsvToRgb24(&ledColorBuffer[ledIndex]);
-        fastUpdateLEDDMABuffer(rgb24);
-        ledIndex++;
-    }
+    ws2811UpdateDMABuffer();
 
-    // Initiate hardware transfer
+    // Initiate hardware transfer. The whole strip is always sent, LEDs may have been powered up since the last update
     if (!ws2811Initialised || !ws2811TCH) {
         return;
     }
@@ -38,6 +38,7 @@
 #include "common/utils.h"
 
 #include "drivers/bus.h"
+#include "drivers/bus_queue.h"
 #include "drivers/dma.h"
 #include "drivers/io.h"
 #include "drivers/light_led.h"
@@ -209,6 +210,12 @@ typedef struct max7456State_s {
 
 static max7456State_t state;
 
+// Screen updates are queued as bulk jobs on buses that have a job queue,
+// so they never hold the bus while a gyro read is waiting
+static busJob_t drawJob;
+static busTransferDescriptor_t drawJobSegment;
+static uint8_t drawBuffer[MAX_CHARS2UPDATE * BYTES_PER_CHAR2UPDATE];
+
 static bool max7456ReadVM0(uint8_t *vm0)
 {
     return busRead(state.dev, MAX7456ADD_VM0 | MAX7456ADD_READ, vm0);
@@ -260,9 +267,15 @@ static bool max7456OSDIsEnabled(void)
     return state.registers.vm0 & OSD_ENABLE;
 }
 
+static bool max7456DrawIsPending(void)
+{
+    return busJobIsPending(&drawJob);
+}
+
+// The lock is only granted once the last screen update has left the bus
 static void max7456Lock(void)
 {
-    while(state.mutex);
+    while(state.mutex || max7456DrawIsPending());
 
     state.mutex = true;
 }
@@ -274,7 +287,7 @@ static void max7456Unlock(void)
 
 static bool max7456TryLock(void)
 {
-    if (!state.mutex) {
+    if (!state.mutex && !max7456DrawIsPending()) {
         state.mutex = true;
         return true;
     }
@@ -494,17 +507,42 @@ void max7456Write(uint8_t x, uint8_t y, const char *buff, uint8_t mode)
     }
 }
 
+static void max7456SendDrawBuffer(int length)
+{
+    busQueue_t * queue = busDeviceGetQueue(state.dev);
+
+    if (queue) {
+        drawJobSegment.rxBuf = NULL;
+        drawJobSegment.txBuf = drawBuffer;
+        drawJobSegment.length = length;
+
+        drawJob.dev = state.dev;
+        drawJob.segments = &drawJobSegment;
+        drawJob.segmentCount = 1;
+        drawJob.priority = BUS_JOB_PRIORITY_BULK;
+        drawJob.callback = NULL;
+
+        if (busQueueSubmit(queue, &drawJob)) {
+            return;
+        }
+    }
+
+    busTransfer(state.dev, NULL, drawBuffer, length);
+}
+
 // Must be called with the lock held. Returns whether any new characters
 // were drawn.
 static bool max7456DrawScreenPartial(void)
 {
-    uint8_t spiBuff[MAX_CHARS2UPDATE * BYTES_PER_CHAR2UPDATE];
     int bufPtr = 0;
     size_t pos;
     uint_fast16_t updatedCharCount;
     uint8_t charMode;
     int next;
 
+    // Full redraws call this back to back, the previous update may still be using the buffer
+    while (max7456DrawIsPending());
+
     for (pos = 0, updatedCharCount = 0; pos < ARRAYLEN(osdCharacterGridBuffer);) {
         next = BITARRAY_FIND_FIRST_SET(screenIsDirty, pos);
         if (next < 0) {
@@ -525,21 +563,21 @@ static bool max7456DrawScreenPartial(void)
         if (CHAR_MODE_IS_EXT(charMode)) {
             if (!DMM_IS_8BIT_MODE(state.registers.dmm)) {
                 state.registers.dmm |= DMM_8BIT_MODE;
-                bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMM, state.registers.dmm);
+                bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMM, state.registers.dmm);
             }
 
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAH, ph | DMAH_8_BIT_DMDI_IS_CHAR_ATTR);
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAL, pl);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMAH, ph | DMAH_8_BIT_DMDI_IS_CHAR_ATTR);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMAL, pl);
             // Attribute bit positions on DMDI are 2 bits up relative to DMM.
             // DMM uses [5:3] while DMDI uses [7:4] - one bit more for referencing
             // characters in the [256, 511] range (which is not possible via DMM).
             // Since we write mostly to DMM, the internal representation uses
             // the format of the former and we shift it up here.
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, charMode << 2);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMDI, charMode << 2);
 
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAH, ph);
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAL, pl);
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, chr);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMAH, ph);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMAL, pl);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMDI, chr);
 
         } else {
             if (DMM_IS_8BIT_MODE(state.registers.dmm) || (DMM_CHAR_MODE_MASK & state.registers.dmm) != charMode) {
@@ -548,12 +586,12 @@ static bool max7456DrawScreenPartial(void)
                 // Send the attributes for the character run. They
                 // will be applied to all characters until we change
                 // the DMM register.
-                bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMM, state.registers.dmm);
+                bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMM, state.registers.dmm);
             }
 
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAH, ph);
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAL, pl);
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, chr);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMAH, ph);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMAL, pl);
+            bufPtr = max7456PrepareBuffer(drawBuffer, sizeof(drawBuffer), bufPtr, MAX7456ADD_DMDI, chr);
         }
 
         bitArrayClr(screenIsDirty, pos);
@@ -565,7 +603,7 @@ static bool max7456DrawScreenPartial(void)
     }
 
     if (bufPtr) {
-        busTransfer(state.dev, NULL, spiBuff, bufPtr);
+        max7456SendDrawBuffer(bufPtr);
         return true;
     }
     return false;
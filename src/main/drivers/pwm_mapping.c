@@ -31,6 +31,7 @@
 
 #include "fc/config.h"
 
+#include "drivers/dshot_telemetry.h"
 #include "drivers/io.h"
 #include "drivers/io_impl.h"
 #include "drivers/timer.h"
@@ -415,6 +416,12 @@ static void pwmInitMotors(timMotorServoHardware_t * timOutputs)
             return;
         }
     }
+
+#ifdef USE_DSHOT_TELEMETRY
+    if (isMotorProtocolDshotBidirectional()) {
+        dshotTelemetryInit(motorCount);
+    }
+#endif
 }
 
 static void pwmInitServos(timMotorServoHardware_t * timOutputs)
@@ -30,6 +30,8 @@
 #include "common/maths.h"
 #include "common/circular_queue.h"
 
+#include "drivers/dshot_encode.h"
+#include "drivers/dshot_telemetry.h"
 #include "drivers/io.h"
 #include "drivers/timer.h"
 #include "drivers/pwm_mapping.h"
@@ -53,12 +55,6 @@
 #define MOTOR_DSHOT300_HZ     6000000
 #define MOTOR_DSHOT150_HZ     3000000
 
-
-#define DSHOT_MOTOR_BIT_0       7
-#define DSHOT_MOTOR_BIT_1       14
-#define DSHOT_MOTOR_BITLENGTH   20
-
-#define DSHOT_DMA_BUFFER_SIZE   18 /* resolution + frame reset (2us) */
 #define MAX_DMA_TIMERS          8
 
 #define DSHOT_COMMAND_DELAY_US 1000
@@ -70,7 +66,7 @@
 typedef void (*pwmWriteFuncPtr)(uint8_t index, uint16_t value);  // function pointer used to write motors
 
 #ifdef USE_DSHOT_DMAR
-    timerDMASafeType_t dmaBurstBuffer[MAX_DMA_TIMERS][DSHOT_DMA_BUFFER_SIZE * 4];
+    timerDMASafeType_t dmaBurstBuffer[MAX_DMA_TIMERS][DSHOT_DMA_BUFFER_SIZE * DSHOT_BURST_CHANNELS];
 #endif
 
 typedef struct {
@@ -88,6 +84,10 @@ typedef struct {
     timerDMASafeType_t dmaBuffer[DSHOT_DMA_BUFFER_SIZE];
 #ifdef USE_DSHOT_DMAR
     timerDMASafeType_t *dmaBurstBuffer;
+    uint8_t burstDmaTimerIndex;
+#endif
+#ifdef USE_DSHOT_TELEMETRY
+    timerDMASafeType_t captureBuffer[DSHOT_TELEMETRY_MAX_EDGES];
 #endif
 #endif
 } pwmOutputPort_t;
@@ -125,12 +125,9 @@ static circularBuffer_t commandsCircularBuffer;
 static uint8_t commandsBuff[DHSOT_COMMAND_QUEUE_SIZE];
 static currentExecutingCommand_t currentExecutingCommand;
 
-static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry);
-#ifndef USE_DSHOT_DMAR
-static void loadDmaBufferDshot(timerDMASafeType_t *dmaBuffer, uint16_t packet);
-#else
-static void loadDmaBufferDshotStride(timerDMASafeType_t *dmaBuffer, int stride, uint16_t packet);
-#endif
+static bool dshotBidirectional = false;   // Inverted frames with an eRPM reply, see USE_DSHOT_TELEMETRY
+
+static void loadDmaBuffersDshot(int motorCount, bool zeroThrottle);
 
 #ifdef USE_DSHOT_DMAR
 burstDmaTimer_t burstDmaTimers[MAX_DMA_TIMERS];
@@ -250,16 +247,7 @@ void pwmSetMotorDMACircular(bool circular)
     if (circular) {
         // Load zero-throttle packets directly into DMA buffers,
         // bypassing the rate limiter in pwmCompleteMotorUpdate()
-        uint16_t packet = prepareDshotPacket(0, false);
-        for (int i = 0; i < motorCount; i++) {
-            if (motors[i].pwmPort && motors[i].pwmPort->configured) {
-#ifdef USE_DSHOT_DMAR
-                loadDmaBufferDshotStride(&motors[i].pwmPort->dmaBurstBuffer[motors[i].pwmPort->tch->timHw->channelIndex], 4, packet);
-#else
-                loadDmaBufferDshot(motors[i].pwmPort->dmaBuffer, packet);
-#endif
-            }
-        }
+        loadDmaBuffersDshot(motorCount, true);
     }
 
 #ifdef USE_DSHOT_DMAR
@@ -270,7 +258,7 @@ void pwmSetMotorDMACircular(bool circular)
         for (int m = 0; m < motorCount; m++) {
             if (motors[m].pwmPort && motors[m].pwmPort->configured && motors[m].pwmPort->tch
                 && motors[m].pwmPort->tch->timHw->tim == burstDmaTimer->timer) {
-                impl_pwmBurstDMASetCircular(burstDmaTimer, motors[m].pwmPort->tch, circular, DSHOT_DMA_BUFFER_SIZE * 4);
+                impl_pwmBurstDMASetCircular(burstDmaTimer, motors[m].pwmPort->tch, circular, DSHOT_DMA_BUFFER_SIZE * DSHOT_BURST_CHANNELS);
                 break;
             }
         }
@@ -356,6 +344,7 @@ static pwmOutputPort_t * motorConfigDshot(const timerHardware_t * timerHardware,
     }
 
     port->dmaBurstBuffer = &dmaBurstBuffer[burstDmaTimerIndex][0];
+    port->burstDmaTimerIndex = burstDmaTimerIndex;
     burstDmaTimer_t *burstDmaTimer = &burstDmaTimers[burstDmaTimerIndex];
     burstDmaTimer->dmaBurstBuffer = port->dmaBurstBuffer;
 
@@ -368,49 +357,63 @@ static pwmOutputPort_t * motorConfigDshot(const timerHardware_t * timerHardware,
         ZERO_FARRAY(port->dmaBuffer);
         port->configured = true;
     }
+
+#ifdef USE_DSHOT_TELEMETRY
+    if (port->configured && dshotBidirectional) {
+        // An ESC in bidirectional mode only accepts inverted frames, so a channel that can't capture stays off
+        port->configured = timerPWMConfigDMACapture(port->tch, port->captureBuffer, DSHOT_TELEMETRY_MAX_EDGES);
+
+        if (port->configured && enableOutput) {
+            // Pull the line up while the ESC is not driving it
+            IOConfigGPIOAF(IOGetByTag(timerHardware->tag), IOCFG_AF_PP_UP, timerHardware->alternateFunction);
+        }
+    }
+#endif
 #endif
 
     return port;
 }
 
-#ifdef USE_DSHOT_DMAR
-static void loadDmaBufferDshotStride(timerDMASafeType_t *dmaBuffer, int stride, uint16_t packet)
-{
-    int i;
-    for (i = 0; i < 16; i++) {
-        dmaBuffer[i * stride] = (packet & 0x8000) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0;  // MSB first
-        packet <<= 1;
-    }
-    dmaBuffer[i++ * stride] = 0;
-    dmaBuffer[i++ * stride] = 0;
-}
-#else
-static void loadDmaBufferDshot(timerDMASafeType_t *dmaBuffer, uint16_t packet)
+/*
+ * Encodes the motor packets into the DMA buffers. With burst DMA all motors of
+ * a timer are gathered first, so each timer buffer is written in one pass.
+ */
+static void loadDmaBuffersDshot(int motorCount, bool zeroThrottle)
 {
-    for (int i = 0; i < 16; i++) {
-        dmaBuffer[i] = (packet & 0x8000) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0;  // MSB first
-        packet <<= 1;
-    }
-}
+#ifdef USE_DSHOT_DMAR
+    uint16_t packets[MAX_DMA_TIMERS][DSHOT_BURST_CHANNELS];
+    uint8_t channelMask[MAX_DMA_TIMERS] = { 0 };
 #endif
 
-static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry)
-{
-    uint16_t packet = (value << 1) | (requestTelemetry ? 1 : 0);
+    for (int index = 0; index < motorCount; index++) {
+        pwmOutputPort_t *port = motors[index].pwmPort;
 
-    // compute checksum
-    int csum = 0;
-    int csum_data = packet;
-    for (int i = 0; i < 3; i++) {
-        csum ^=  csum_data;   // xor data by nibbles
-        csum_data >>= 4;
-    }
-    csum &= 0xf;
+        if (!port || !port->configured) {
+            continue;
+        }
+
+        uint16_t packet;
+        if (zeroThrottle) {
+            packet = dshotEncodePacket(0, false, dshotBidirectional);
+        } else {
+            packet = dshotEncodePacket(motors[index].value, motors[index].requestTelemetry, dshotBidirectional);
+            motors[index].requestTelemetry = false;
+        }
 
-    // append checksum
-    packet = (packet << 4) | csum;
+#ifdef USE_DSHOT_DMAR
+        const uint8_t channel = port->tch->timHw->channelIndex;
+        packets[port->burstDmaTimerIndex][channel] = packet;
+        channelMask[port->burstDmaTimerIndex] |= 1 << channel;
+#else
+        dshotLoadDmaBuffer(port->dmaBuffer, packet);
+#endif
+    }
 
-    return packet;
+#ifdef USE_DSHOT_DMAR
+    for (int burstDmaTimerIndex = 0; burstDmaTimerIndex < burstDmaTimersCount; burstDmaTimerIndex++) {
+        dshotLoadBurstDmaBuffer(dmaBurstBuffer[burstDmaTimerIndex], packets[burstDmaTimerIndex], channelMask[burstDmaTimerIndex]);
+    }
+#endif
 }
 #endif
 
@@ -440,6 +443,27 @@ bool isMotorProtocolDigital(void)
     return isMotorProtocolDshot();
 }
 
+#ifdef USE_DSHOT_TELEMETRY
+bool isMotorProtocolDshotBidirectional(void)
+{
+    return isMotorProtocolDshot() && dshotBidirectional;
+}
+
+// The reply of the previous frame is complete by now, read it out before the channels go back to output
+static void readDshotTelemetry(int motorCount)
+{
+    for (int index = 0; index < motorCount; index++) {
+        pwmOutputPort_t *port = motors[index].pwmPort;
+
+        if (port && port->configured) {
+            const uint16_t edgeCount = timerPWMStopDMACapture(port->tch);
+            // Reply bits are 4/5 of a frame bit
+            dshotTelemetryProcessCapture(index, port->captureBuffer, edgeCount, DSHOT_MOTOR_BITLENGTH * 4 / 5);
+        }
+    }
+}
+#endif
+
 void pwmRequestMotorTelemetry(int motorIndex)
 {
     if (!isMotorProtocolDigital()) {
@@ -541,27 +565,24 @@ void pwmCompleteMotorUpdate(void) {
             return;
         }
 
-#ifdef USE_DSHOT_DMAR
-        for (int index = 0; index < motorCount; index++) {
-            if (motors[index].pwmPort && motors[index].pwmPort->configured) {
-                uint16_t packet = prepareDshotPacket(motors[index].value, motors[index].requestTelemetry);
-                loadDmaBufferDshotStride(&motors[index].pwmPort->dmaBurstBuffer[motors[index].pwmPort->tch->timHw->channelIndex], 4, packet);
-                motors[index].requestTelemetry = false;
-            }
+#ifdef USE_DSHOT_TELEMETRY
+        if (dshotBidirectional) {
+            readDshotTelemetry(motorCount);
         }
+#endif
+
+        // Generate DMA buffers
+        loadDmaBuffersDshot(motorCount, false);
 
+#ifdef USE_DSHOT_DMAR
         for (int burstDmaTimerIndex = 0; burstDmaTimerIndex < burstDmaTimersCount; burstDmaTimerIndex++) {
             burstDmaTimer_t *burstDmaTimer = &burstDmaTimers[burstDmaTimerIndex];
-            pwmBurstDMAStart(burstDmaTimer, DSHOT_DMA_BUFFER_SIZE * 4);
+            pwmBurstDMAStart(burstDmaTimer, DSHOT_DMA_BUFFER_SIZE * DSHOT_BURST_CHANNELS);
         }
 #else
-        // Generate DMA buffers
         for (int index = 0; index < motorCount; index++) {
             if (motors[index].pwmPort && motors[index].pwmPort->configured) {
-                uint16_t packet = prepareDshotPacket(motors[index].value, motors[index].requestTelemetry);
-                loadDmaBufferDshot(motors[index].pwmPort->dmaBuffer, packet);
                 timerPWMPrepareDMA(motors[index].pwmPort->tch, DSHOT_DMA_BUFFER_SIZE);
-                motors[index].requestTelemetry = false;
             }
         }
 
@@ -612,7 +633,13 @@ void pwmMotorPreconfigure(void)
         case PWM_TYPE_DSHOT600:
         case PWM_TYPE_DSHOT300:
         case PWM_TYPE_DSHOT150:
+#ifdef USE_DSHOT_TELEMETRY
+            dshotBidirectional = motorConfig()->dshotBidirectional;
+            // Leave room for the frame, the ~30us turnaround and the reply
+            motorConfigDigitalUpdateInterval(getEscUpdateFrequency() / (dshotBidirectional ? 2 : 1));
+#else
             motorConfigDigitalUpdateInterval(getEscUpdateFrequency());
+#endif
             motorWritePtr = pwmWriteDigital;
             break;
 #endif
@@ -45,6 +45,9 @@ void pwmShutdownPulsesForAllMotors(uint8_t motorCount);
 void pwmCompleteMotorUpdate(void);
 bool isMotorProtocolDigital(void);
 bool isMotorProtocolDshot(void);
+#ifdef USE_DSHOT_TELEMETRY
+bool isMotorProtocolDshotBidirectional(void);
+#endif
 
 void pwmWriteServo(uint8_t index, uint16_t value);
 
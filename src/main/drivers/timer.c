@@ -298,6 +298,18 @@ bool timerPWMDMAInProgress(TCH_t * tch)
     return tch->dmaState != TCH_DMA_IDLE;
 }
 
+#ifdef USE_DSHOT_TELEMETRY
+bool timerPWMConfigDMACapture(TCH_t * tch, void * captureBuffer, uint16_t captureBufferElementCount)
+{
+    return impl_timerPWMConfigDMACapture(tch, captureBuffer, captureBufferElementCount);
+}
+
+uint16_t timerPWMStopDMACapture(TCH_t * tch)
+{
+    return impl_timerPWMStopDMACapture(tch);
+}
+#endif
+
 #ifdef USE_DSHOT_DMAR
 bool timerPWMConfigDMABurst(burstDmaTimer_t *burstDmaTimer, TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
 {
@@ -139,6 +139,7 @@ typedef enum {
     TCH_DMA_READY,
     TCH_DMA_ACTIVE,
     TCH_DMA_CIRCULAR,
+    TCH_DMA_CAPTURE,
 } tchDmaState_e;
 
 // Some forward declarations for types
@@ -162,6 +163,11 @@ typedef struct TCH_s {
     DMA_t                           dma;            // Timer channel DMA handle
     volatile tchDmaState_e          dmaState;
     void *                          dmaBuffer;
+#ifdef USE_DSHOT_TELEMETRY
+    void *                          dmaCaptureBuffer;   // Bidirectional DShot reply edges, NULL if the channel is output only
+    uint16_t                        dmaCaptureCount;
+    uint16_t                        dmaCapturePeriod;   // Output period restored once the reply is read out
+#endif
 } TCH_t;
 
 // Run-time timer context (dynamically allocated), includes 4x TCH
@@ -259,6 +265,14 @@ void timerPWMStartDMA(TCH_t * tch);
 void timerPWMStopDMA(TCH_t * tch);
 bool timerPWMDMAInProgress(TCH_t * tch);
 
+#ifdef USE_DSHOT_TELEMETRY
+// Bidirectional DShot: after every DMA frame the channel captures the edges of
+// the reply into captureBuffer, elements are the size of the DMA buffer ones.
+// Stopping the capture returns the edge count and restores the output.
+bool timerPWMConfigDMACapture(TCH_t * tch, void * captureBuffer, uint16_t captureBufferElementCount);
+uint16_t timerPWMStopDMACapture(TCH_t * tch);
+#endif
+
 volatile timCCR_t *timerCCR(TCH_t * tch);
 
 uint8_t timer2id(const HAL_Timer_t *tim);
@@ -86,6 +86,11 @@ void impl_timerPWMStartDMA(TCH_t * tch);
 void impl_timerPWMStopDMA(TCH_t * tch);
 void impl_timerPWMSetDMACircular(TCH_t * tch, bool circular, uint32_t dmaBufferSize);
 
+#ifdef USE_DSHOT_TELEMETRY
+bool impl_timerPWMConfigDMACapture(TCH_t * tch, void * captureBuffer, uint16_t captureBufferElementCount);
+uint16_t impl_timerPWMStopDMACapture(TCH_t * tch);
+#endif
+
 #ifdef USE_DSHOT_DMAR
 bool impl_timerPWMConfigDMABurst(burstDmaTimer_t *burstDmaTimer, TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount);
 void impl_pwmBurstDMAStart(burstDmaTimer_t * burstDmaTimer, uint32_t BurstLength);
@@ -202,7 +202,14 @@ void impl_timerCaptureCompareHandler(TIM_TypeDef *tim, timHardwareContext_t *tim
 
 void impl_timerPWMConfigChannel(TCH_t * tch, uint16_t value)
 {
-    const bool inverted = tch->timHw->output & TIMER_OUTPUT_INVERTED;
+    bool inverted = tch->timHw->output & TIMER_OUTPUT_INVERTED;
+
+#ifdef USE_DSHOT_TELEMETRY
+    // Bidirectional DShot sends the frame inverted
+    if (tch->dmaCaptureBuffer) {
+        inverted = !inverted;
+    }
+#endif
 
     TIM_OCInitTypeDef  TIM_OCInitStructure;
 
@@ -266,6 +273,75 @@ void impl_timerChCaptureCompareEnable(TCH_t * tch, bool enable)
     TIM_CCxCmd(tch->timHw->tim, lookupTIMChannelTable[tch->timHw->channelIndex], (enable ? TIM_CCx_Enable : TIM_CCx_Disable));
 }
 
+#ifdef USE_DSHOT_TELEMETRY
+// Called from the DMA IRQ once the frame is out, the line idles high and the ESC replies after ~30us
+static void impl_timerDMAStartCapture(TCH_t * tch)
+{
+    TIM_TypeDef * tim = tch->timHw->tim;
+    DMA_Stream_TypeDef * stream = tch->dma->ref;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+
+    // Counter runs freely until the next frame, the decoder works on 16 bit edge differences
+    TIM_SetAutoreload(tim, 0xFFFF);
+
+    TIM_ICStructInit(&TIM_ICInitStructure);
+    TIM_ICInitStructure.TIM_Channel = lookupTIMChannelTable[tch->timHw->channelIndex];
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = getFilter(8);
+    TIM_ICInit(tim, &TIM_ICInitStructure);
+
+    stream->CR &= ~DMA_SxCR_DIR;    // Peripheral to memory
+    stream->M0AR = (uint32_t)tch->dmaCaptureBuffer;
+    DMA_SetCurrDataCounter(stream, tch->dmaCaptureCount);
+
+    tch->dmaState = TCH_DMA_CAPTURE;
+
+    DMA_Cmd(stream, ENABLE);
+    TIM_DMACmd(tim, lookupDMASourceTable[tch->timHw->channelIndex], ENABLE);
+}
+
+// Must run with the DMA IRQ masked. Returns the number of edges captured.
+static uint16_t impl_timerDMAStopCapture(TCH_t * tch)
+{
+    TIM_TypeDef * tim = tch->timHw->tim;
+    DMA_Stream_TypeDef * stream = tch->dma->ref;
+
+    TIM_DMACmd(tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
+    DMA_Cmd(stream, DISABLE);
+
+    uint32_t timeout = 10000;
+    while ((stream->CR & DMA_SxCR_EN) && timeout--) {
+        __NOP();
+    }
+
+    const uint16_t edgeCount = tch->dmaCaptureCount - DMA_GetCurrDataCounter(stream);
+
+    DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF);
+    stream->CR = (stream->CR & ~DMA_SxCR_DIR) | DMA_DIR_MemoryToPeripheral;
+    stream->M0AR = (uint32_t)tch->dmaBuffer;
+
+    // CCxNP is left set by the both edges capture and must be cleared in output mode
+    tim->CCER &= ~(TIM_CCER_CC1NP << (tch->timHw->channelIndex * 4));
+    impl_timerPWMConfigChannel(tch, 0);
+
+    tch->dmaState = TCH_DMA_IDLE;
+
+    // The last channel of the timer to stop capturing restores the bit period
+    for (int i = 0; i < CC_CHANNELS_PER_TIMER; i++) {
+        if (tch->timCtx->ch[i].dmaState == TCH_DMA_CAPTURE) {
+            return edgeCount;
+        }
+    }
+
+    TIM_SetAutoreload(tim, tch->dmaCapturePeriod);
+    TIM_GenerateEvent(tim, TIM_EventSource_Update);
+
+    return edgeCount;
+}
+#endif
+
 static void impl_timerDMA_IRQHandler(DMA_t descriptor)
 {
     if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
@@ -277,12 +353,27 @@ static void impl_timerDMA_IRQHandler(DMA_t descriptor)
             return;
         }
 
+#ifdef USE_DSHOT_TELEMETRY
+        // Capture buffer is full, edges are read out before the next frame
+        if (tch->dmaState == TCH_DMA_CAPTURE) {
+            TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
+            DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+            return;
+        }
+#endif
+
         tch->dmaState = TCH_DMA_IDLE;
 
         TIM_DMACmd(tch->timHw->tim, lookupDMASourceTable[tch->timHw->channelIndex], DISABLE);
         DMA_Cmd(tch->dma->ref, DISABLE);
 
         DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+
+#ifdef USE_DSHOT_TELEMETRY
+        if (tch->dmaCaptureBuffer) {
+            impl_timerDMAStartCapture(tch);
+        }
+#endif
     }
 }
 
@@ -366,9 +457,43 @@ bool impl_timerPWMConfigChannelDMA(TCH_t * tch, void * dmaBuffer, uint8_t dmaBuf
     DMA_Init(tch->dma->ref, &DMA_InitStructure);
     DMA_ITConfig(tch->dma->ref, DMA_IT_TC, ENABLE);
 
+    tch->dmaBuffer = dmaBuffer;
+
     return true;
 }
 
+#ifdef USE_DSHOT_TELEMETRY
+bool impl_timerPWMConfigDMACapture(TCH_t * tch, void * captureBuffer, uint16_t captureBufferElementCount)
+{
+    // The reply is read back on the output pin, a complementary output can't do that
+    if (tch->dma == NULL || (tch->timHw->output & TIMER_OUTPUT_N_CHANNEL)) {
+        return false;
+    }
+
+    tch->dmaCaptureBuffer = captureBuffer;
+    tch->dmaCaptureCount = captureBufferElementCount;
+    tch->dmaCapturePeriod = tch->timHw->tim->ARR;
+
+    // Reconfigure the output, it idles high in bidirectional mode
+    impl_timerPWMConfigChannel(tch, 0);
+
+    return true;
+}
+
+uint16_t impl_timerPWMStopDMACapture(TCH_t * tch)
+{
+    uint16_t edgeCount = 0;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        if (tch->dmaState == TCH_DMA_CAPTURE) {
+            edgeCount = impl_timerDMAStopCapture(tch);
+        }
+    }
+
+    return edgeCount;
+}
+#endif
+
 #ifdef USE_DSHOT_DMAR
 bool impl_timerPWMConfigDMABurst(burstDmaTimer_t *burstDmaTimer, TCH_t * tch, void * dmaBuffer, uint8_t dmaBufferElementSize, uint32_t dmaBufferElementCount)
 {
@@ -493,6 +618,13 @@ void impl_pwmBurstDMASetCircular(burstDmaTimer_t * burstDmaTimer, TCH_t * tch, b
 
         DMA_CLEAR_FLAG(tch->dma, DMA_IT_TCIF);
 
+#ifdef USE_DSHOT_TELEMETRY
+        // Loop the frame buffer, not the reply capture
+        if (tch->dmaState == TCH_DMA_CAPTURE) {
+            impl_timerDMAStopCapture(tch);
+        }
+#endif
+
         if (circular) {
             burstDmaTimer->dmaBurstStream->CR |= DMA_SxCR_CIRC;
             DMA_SetCurrDataCounter(burstDmaTimer->dmaBurstStream, dmaBufferSize);
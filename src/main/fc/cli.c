@@ -34,6 +34,7 @@ bool cliMode = false;
 #include "build/version.h"
 
 #include "common/axis.h"
+#include "common/benchmark.h"
 #include "common/color.h"
 #include "common/maths.h"
 #include "common/printf.h"
@@ -85,6 +86,7 @@ bool cliMode = false;
 #include "flight/mixer_profile.h"
 #include "flight/pid.h"
 #include "flight/servos.h"
+#include "flight/sysid.h"
 
 #include "io/asyncfatfs/asyncfatfs.h"
 #include "io/beeper.h"
@@ -222,7 +224,9 @@ static const char *debugModeNames[DEBUG_COUNT] = {
     "HEADTRACKER",
     "GPS",
     "LULU",
-    "SBUS2"
+    "SBUS2",
+    "RC_SMOOTHING",
+    "MAG_CALIBRATION"
 };
 
 /* Sensor names (used in lookup tables for *_hardware settings and in status
@@ -345,6 +349,65 @@ typedef enum {
     HIDE_UNUSED = (1 << 7)
 } dumpFlags_e;
 
+// dump/diff is generated in steps over several cliProcess() calls, in this order
+typedef enum {
+    CLI_DUMP_STAGE_IDLE = 0,
+    CLI_DUMP_STAGE_BEGIN,
+    CLI_DUMP_STAGE_TIMER_OUTPUTS,
+    CLI_DUMP_STAGE_SERVO,
+    CLI_DUMP_STAGE_SAFEHOME,
+    CLI_DUMP_STAGE_FW_APPROACH,
+    CLI_DUMP_STAGE_GEOZONES,
+    CLI_DUMP_STAGE_GEOZONE_VERTICES,
+    CLI_DUMP_STAGE_FEATURES,
+    CLI_DUMP_STAGE_BEEPER,
+    CLI_DUMP_STAGE_BLACKBOX,
+    CLI_DUMP_STAGE_RX_MAP,
+    CLI_DUMP_STAGE_SERIAL,
+    CLI_DUMP_STAGE_LED,
+    CLI_DUMP_STAGE_LED_COLOR,
+    CLI_DUMP_STAGE_LED_MODE_COLOR,
+    CLI_DUMP_STAGE_AUX,
+    CLI_DUMP_STAGE_ADJRANGE,
+    CLI_DUMP_STAGE_RXRANGE,
+    CLI_DUMP_STAGE_TEMP_SENSOR,
+    CLI_DUMP_STAGE_WAYPOINTS,
+    CLI_DUMP_STAGE_OSD_LAYOUT,
+    CLI_DUMP_STAGE_LOGIC,
+    CLI_DUMP_STAGE_GVAR,
+    CLI_DUMP_STAGE_PID,
+    CLI_DUMP_STAGE_OSD_CUSTOM_ELEMENTS,
+    CLI_DUMP_STAGE_MASTER_VALUES,
+    CLI_DUMP_STAGE_CONTROL_PROFILE,
+    CLI_DUMP_STAGE_CONTROL_PROFILE_PID,
+    CLI_DUMP_STAGE_CONTROL_PROFILE_RATES,
+    CLI_DUMP_STAGE_CONTROL_PROFILE_EZ_TUNE,
+    CLI_DUMP_STAGE_MIXER_PROFILE,
+    CLI_DUMP_STAGE_MIXER_PROFILE_VALUES,
+    CLI_DUMP_STAGE_MIXER_PROFILE_MOTOR_MIX,
+    CLI_DUMP_STAGE_MIXER_PROFILE_SERVO_MIX,
+    CLI_DUMP_STAGE_BATTERY_PROFILE,
+    CLI_DUMP_STAGE_BATTERY_PROFILE_VALUES,
+    CLI_DUMP_STAGE_END,
+} cliDumpStage_e;
+
+#define CLI_DUMP_SETTINGS_PER_STEP  8       // settings table entries walked per step
+#define CLI_DUMP_TX_RESERVE         128     // min free TX space to start a step, one cliWriteBuffer
+#define CLI_DUMP_SLICE_US           500     // max time spent dumping per cliProcess() call
+
+typedef struct cliDumpState_s {
+    cliDumpStage_e stage;
+    uint16_t item;                  // cursor within the stage (setting, waypoint, logic condition...)
+    uint8_t dumpMask;
+    uint8_t profileIndex;           // profile dumped by the current profile stage
+    uint8_t controlProfileIndex;    // profiles active when the dump was started
+    uint8_t mixerProfileIndex;
+    uint8_t batteryProfileIndex;
+    bool batchModeEnabled;
+} cliDumpState_t;
+
+static cliDumpState_t cliDumpState;
+
 static void cliPrintfva(const char *format, va_list va)
 {
     tfp_format(cliWriter, cliPutp, format, va);
@@ -537,13 +600,13 @@ static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
     char name[SETTING_MAX_NAME_LENGTH];
     const char *format = "set %s = ";
     const char *defaultFormat = "#set %s = ";
-    // During a dump, the PGs have been backed up to their "copy"
-    // regions and the actual values have been reset to its
-    // defaults. This means that settingGetValuePointer() will
-    // return the default value while settingGetCopyValuePointer()
-    // will return the actual value.
-    const void *valuePointer = settingGetCopyValuePointer(value);
-    const void *defaultValuePointer = settingGetValuePointer(value);
+    // During a dump, the PG "copy" regions hold the defaults while
+    // the actual values stay in place, so the flight code keeps
+    // running on them between dump steps. This means that
+    // settingGetValuePointer() will return the actual value while
+    // settingGetCopyValuePointer() will return the default value.
+    const void *valuePointer = settingGetValuePointer(value);
+    const void *defaultValuePointer = settingGetCopyValuePointer(value);
     const bool equalsDefault = valuePtrEqualsDefault(value, valuePointer, defaultValuePointer);
     if (((dumpMask & DO_DIFF) == 0) || !equalsDefault) {
         settingGetName(value, name);
@@ -563,15 +626,17 @@ static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
     }
 }
 
-static void dumpAllValues(uint16_t valueSection, uint8_t dumpMask)
+// Dumps the next chunk of the settings table, returns true once the whole table has been walked
+static bool dumpValues(uint16_t valueSection, uint8_t dumpMask)
 {
-    for (unsigned i = 0; i < SETTINGS_TABLE_COUNT; i++) {
-        const setting_t *value = settingGet(i);
-        bufWriterFlush(cliWriter);
+    const uint16_t end = MIN(cliDumpState.item + CLI_DUMP_SETTINGS_PER_STEP, SETTINGS_TABLE_COUNT);
+    for (; cliDumpState.item < end; cliDumpState.item++) {
+        const setting_t *value = settingGet(cliDumpState.item);
         if (SETTING_SECTION(value) == valueSection) {
             dumpPgValue(value, dumpMask);
         }
     }
+    return cliDumpState.item >= SETTINGS_TABLE_COUNT;
 }
 
 static void cliPrintVar(const setting_t *var, uint32_t full)
@@ -1571,10 +1636,13 @@ static void cliSafeHomes(char *cmdline)
 #endif
 
 #if defined(USE_GEOZONE)
-static void printGeozones(uint8_t dumpMask, const geoZoneConfig_t *geoZone, const geoZoneConfig_t *defaultGeoZone)
+static void printGeozones(uint8_t dumpMask, const geoZoneConfig_t *geoZone, const geoZoneConfig_t *defaultGeoZone, int16_t showZone)
 {
     const char *format = "geozone %u %u %u %d %d %u %u %u";
     for (uint8_t i = 0; i < MAX_GEOZONES_IN_CONFIG; i++) {
+        if (showZone >= 0 && showZone != i) {
+            continue;
+        }
         bool equalsDefault = false;
         if (defaultGeoZone) {
             equalsDefault = geoZone[i].fenceAction == defaultGeoZone->fenceAction
@@ -1592,10 +1660,13 @@ static void printGeozones(uint8_t dumpMask, const geoZoneConfig_t *geoZone, cons
     }
 }
 
-static void printGeozoneVertices(uint8_t dumpMask, const vertexConfig_t *vertices, const vertexConfig_t *defaultVertices)
+static void printGeozoneVertices(uint8_t dumpMask, const vertexConfig_t *vertices, const vertexConfig_t *defaultVertices, int16_t showVertex)
 {
     const char *format = "geozone vertex %d %u %d %d";
     for (uint8_t i = 0; i < MAX_VERTICES_IN_CONFIG; i++) {
+        if (showVertex >= 0 && showVertex != i) {
+            continue;
+        }
         bool equalsDefault = false;
         if (defaultVertices) {
             equalsDefault = vertices[i].idx == defaultVertices->idx
@@ -1609,7 +1680,7 @@ static void printGeozoneVertices(uint8_t dumpMask, const vertexConfig_t *vertice
         cliDumpPrintLinef(dumpMask, equalsDefault, format, vertices[i].zoneId, vertices[i].idx, vertices[i].lat, vertices[i].lon);
     }
 
-    if (!defaultVertices) {
+    if (!defaultVertices && showVertex < 0) {
         uint8_t totalVertices = geozoneGetUsedVerticesCount();
         cliPrintLinef("# %u vertices free (Used %u of %u)", MAX_VERTICES_IN_CONFIG - totalVertices, totalVertices, MAX_VERTICES_IN_CONFIG);
     }
@@ -1618,9 +1689,9 @@ static void printGeozoneVertices(uint8_t dumpMask, const vertexConfig_t *vertice
 static void cliGeozone(char* cmdLine)
 {
     if (isEmpty(cmdLine)) {
-        printGeozones(DUMP_MASTER, geoZonesConfig(0), NULL);
+        printGeozones(DUMP_MASTER, geoZonesConfig(0), NULL, -1);
     } else if (sl_strcasecmp(cmdLine, "vertex") == 0) {
-        printGeozoneVertices(DUMP_MASTER, geoZoneVertices(0), NULL);
+        printGeozoneVertices(DUMP_MASTER, geoZoneVertices(0), NULL, -1);
     } else if (sl_strncasecmp(cmdLine, "vertex reset", 12) == 0) {
          const char* ptr = &cmdLine[12];
          uint8_t zoneId = 0, idx = 0;
@@ -1849,31 +1920,39 @@ static void cliGeozone(char* cmdLine)
 #endif
 
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE) && defined(NAV_NON_VOLATILE_WAYPOINT_CLI)
-static void printWaypoints(uint8_t dumpMask, const navWaypoint_t *navWaypoint, const navWaypoint_t *defaultNavWaypoint)
+// The packed mission storage defaults to an empty mission
+static const navWaypoint_t emptyNavWaypoint;
+
+static void printWaypoints(uint8_t dumpMask, const navWaypoint_t *navWaypoint, const navWaypoint_t *defaultNavWaypoint, int16_t showWp)
 {
-    cliPrintLinef("#wp %d %svalid", posControl.waypointCount, posControl.waypointListValid ? "" : "in"); //int8_t bool
+    if (showWp <= 0) {
+        cliPrintLinef("#wp %d %svalid", posControl.waypointCount, posControl.waypointListValid ? "" : "in"); //int8_t bool
+    }
     const char *format = "wp %u %u %d %d %d %d %d %d %u"; //uint8_t action; int32_t lat; int32_t lon; int32_t alt; int16_t p1 int16_t p2 int16_t p3; uint8_t flag
-    for (uint8_t i = 0; i < NAV_MAX_WAYPOINTS; i++) {
+    for (int i = 0; i < NAV_MAX_WAYPOINTS; i++) {
+        if (showWp >= 0 && showWp != i) {
+            continue;
+        }
         bool equalsDefault = false;
         if (defaultNavWaypoint) {
-            equalsDefault = navWaypoint[i].action == defaultNavWaypoint[i].action
-                && navWaypoint[i].lat == defaultNavWaypoint[i].lat
-                && navWaypoint[i].lon == defaultNavWaypoint[i].lon
-                && navWaypoint[i].alt == defaultNavWaypoint[i].alt
-                && navWaypoint[i].p1 == defaultNavWaypoint[i].p1
-                && navWaypoint[i].p2 == defaultNavWaypoint[i].p2
-                && navWaypoint[i].p3 == defaultNavWaypoint[i].p3
-                && navWaypoint[i].flag == defaultNavWaypoint[i].flag;
+            equalsDefault = navWaypoint[i].action == defaultNavWaypoint->action
+                && navWaypoint[i].lat == defaultNavWaypoint->lat
+                && navWaypoint[i].lon == defaultNavWaypoint->lon
+                && navWaypoint[i].alt == defaultNavWaypoint->alt
+                && navWaypoint[i].p1 == defaultNavWaypoint->p1
+                && navWaypoint[i].p2 == defaultNavWaypoint->p2
+                && navWaypoint[i].p3 == defaultNavWaypoint->p3
+                && navWaypoint[i].flag == defaultNavWaypoint->flag;
             cliDefaultPrintLinef(dumpMask, equalsDefault, format,
                 i,
-                defaultNavWaypoint[i].action,
-                defaultNavWaypoint[i].lat,
-                defaultNavWaypoint[i].lon,
-                defaultNavWaypoint[i].alt,
-                defaultNavWaypoint[i].p1,
-                defaultNavWaypoint[i].p2,
-                defaultNavWaypoint[i].p3,
-                defaultNavWaypoint[i].flag
+                defaultNavWaypoint->action,
+                defaultNavWaypoint->lat,
+                defaultNavWaypoint->lon,
+                defaultNavWaypoint->alt,
+                defaultNavWaypoint->p1,
+                defaultNavWaypoint->p2,
+                defaultNavWaypoint->p3,
+                defaultNavWaypoint->flag
             );
         }
         cliDumpPrintLinef(dumpMask, equalsDefault, format,
@@ -1893,10 +1972,10 @@ static void printWaypoints(uint8_t dumpMask, const navWaypoint_t *navWaypoint, c
 static void cliWaypoints(char *cmdline)
 {
 #ifdef USE_MULTI_MISSION
-    static int8_t multiMissionWPCounter = 0;
+    static int16_t multiMissionWPCounter = 0;
 #endif
     if (isEmpty(cmdline)) {
-        printWaypoints(DUMP_MASTER, posControl.waypointList, NULL);
+        printWaypoints(DUMP_MASTER, posControl.waypointList, NULL, -1);
     } else if (sl_strcasecmp(cmdline, "reset") == 0) {
         resetWaypointList();
     } else if (sl_strcasecmp(cmdline, "load") == 0) {
@@ -3761,20 +3840,6 @@ static void cliControlProfile(char *cmdline)
     }
 }
 
-static void cliDumpControlProfile(uint8_t profileIndex, uint8_t dumpMask)
-{
-    if (profileIndex >= MAX_PROFILE_COUNT) {
-        // Faulty values
-        return;
-    }
-    setConfigProfile(profileIndex);
-    cliPrintHashLine("control_profile");
-    cliPrintLinef("control_profile %d\r\n", getConfigProfile() + 1);
-    dumpAllValues(PROFILE_VALUE, dumpMask);
-    dumpAllValues(CONTROL_VALUE, dumpMask);
-    dumpAllValues(EZ_TUNE_VALUE, dumpMask);
-}
-
 static void cliBatteryProfile(char *cmdline)
 {
     // CLI profile index is 1-based
@@ -3790,18 +3855,6 @@ static void cliBatteryProfile(char *cmdline)
     }
 }
 
-static void cliDumpBatteryProfile(uint8_t profileIndex, uint8_t dumpMask)
-{
-    if (profileIndex >= MAX_BATTERY_PROFILE_COUNT) {
-        // Faulty values
-        return;
-    }
-    setConfigBatteryProfile(profileIndex);
-    cliPrintHashLine("battery_profile");
-    cliPrintLinef("battery_profile %d\r\n", getConfigBatteryProfile() + 1);
-    dumpAllValues(BATTERY_CONFIG_VALUE, dumpMask);
-}
-
 static void cliMixerProfile(char *cmdline)
 {
     // CLI profile index is 1-based
@@ -3817,24 +3870,6 @@ static void cliMixerProfile(char *cmdline)
     }
 }
 
-static void cliDumpMixerProfile(uint8_t profileIndex, uint8_t dumpMask)
-{
-    if (profileIndex >= MAX_MIXER_PROFILE_COUNT) {
-        // Faulty values
-        return;
-    }
-    setConfigMixerProfile(profileIndex);
-    cliPrintHashLine("mixer_profile");
-    cliPrintLinef("mixer_profile %d\r\n", getConfigMixerProfile() + 1);
-    dumpAllValues(MIXER_CONFIG_VALUE, dumpMask);
-    cliPrintHashLine("Mixer: motor mixer");
-    cliDumpPrintLinef(dumpMask, primaryMotorMixer_CopyArray()[0].throttle == 0.0f, "\r\nmmix reset\r\n");
-    printMotorMix(dumpMask, primaryMotorMixer_CopyArray(), primaryMotorMixer(0));
-    cliPrintHashLine("Mixer: servo mixer");
-    cliDumpPrintLinef(dumpMask, customServoMixers_CopyArray()[0].rate == 0, "smix reset\r\n");
-    printServoMix(dumpMask, customServoMixers_CopyArray(), customServoMixers(0));
-}
-
 #ifdef USE_CLI_BATCH
 static void cliPrintCommandBatchWarning(const char *warning)
 {
@@ -3876,6 +3911,76 @@ static void cliBatch(char *cmdline)
 }
 #endif
 
+#ifdef USE_BENCHMARK
+static void cliBench(char *cmdline)
+{
+    int calls = 10000;
+
+    if (!isEmpty(cmdline)) {
+        calls = fastA2I(cmdline);
+        if (calls <= 0) {
+            cliShowParseError();
+            return;
+        }
+    }
+
+    cliPrintLinef("Clock %d ticks/us, %d calls", (int)usTicks, calls);
+    cliPrintLine("Kernel                     ticks/call  max error (1e-6)");
+
+    for (uint8_t i = 0; i < benchmarkCount(); i++) {
+        benchmarkResult_t result;
+        if (benchmarkRun(i, ticks, calls, &result)) {
+            const int ticksPerCall = lrintf(result.ticksPerCall * 10);
+            cliPrintLinef("%-24s %8d.%1d  %16d", result.name, ticksPerCall / 10, ticksPerCall % 10, (int)lrintf(result.maxError * 1e6f));
+        }
+    }
+}
+#endif
+
+#ifdef USE_SYSID
+// Prints a value with one decimal, tfp_printf has no float support
+static void cliPrintTenths(const char *label, float value, const char *unit)
+{
+    const int tenths = lrintf(value * 10);
+    cliPrintLinef("%s: %s%d.%d %s", label, tenths < 0 ? "-" : "", ABS(tenths) / 10, ABS(tenths) % 10, unit);
+}
+
+static void cliSysid(char *cmdline)
+{
+    static const char * const stateNames[] = { "IDLE", "RUNNING", "ANALYSING", "DONE", "FAILED" };
+    static const char * const axisNames[] = { "ROLL", "PITCH", "YAW" };
+    const sysidResult_t *result = sysidGetResult();
+    const sysidState_e state = sysidGetState();
+
+    cliPrintLinef("State: %s", stateNames[state]);
+    if (state != SYSID_STATE_DONE) {
+        return;
+    }
+
+    if (sl_strcasecmp(cmdline, "response") == 0) {
+        cliPrintLine("Hz       gain dB   phase  coherence");
+        for (int bin = 0; bin < SYSID_BIN_COUNT; bin++) {
+            sysidResponse_t response;
+            if (sysidGetResponse(bin, &response)) {
+                const int frequency = lrintf(response.frequencyHz * 10);
+                const int gain = lrintf(response.gainDb * 10);
+                cliPrintLinef("%3d.%1d  %5s%d.%1d  %6d  %9d", frequency / 10, frequency % 10,
+                    gain < 0 ? "-" : "", ABS(gain) / 10, ABS(gain) % 10, (int)lrintf(response.phase), (int)lrintf(response.coherence * 100));
+            }
+        }
+        return;
+    }
+
+    cliPrintLinef("Axis: %s, %d segments, %d coherent bins", axisNames[result->axis], result->segments, result->coherentBins);
+    cliPrintTenths("Bandwidth", result->bandwidthHz, "Hz");
+    cliPrintTenths("Crossover", result->crossoverHz, "Hz");
+    cliPrintTenths("Phase margin", result->phaseMargin, "deg");
+    cliPrintLinef("D: %d, suggested %d", result->d, result->suggestedD);
+    cliPrintTenths("Phase margin with suggested D", result->suggestedPhaseMargin, "deg");
+    cliPrintLinef("FF: %d, suggested %d", result->ff, result->suggestedFF);
+}
+#endif
+
 static void cliSave(char *cmdline)
 {
     UNUSED(cmdline);
@@ -4167,6 +4272,16 @@ static void cliStatus(char *cmdline)
     }
 #endif
 
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    if (sensors(SENSOR_MAG) && compassConfig()->magOnlineCalibration) {
+        const magEllipsoidFit_t *fit = compassGetOnlineCalibration();
+        const int fieldError = lrintf(magEllipsoidFitGetQuality(fit) * 1000);
+        cliPrintLinef("Mag online calibration: %s, field error %d.%d%%, samples %u, rejected %u",
+            compassOnlineCalibrationIsActive() ? "ACTIVE" : "LEARNING", fieldError / 10, fieldError % 10,
+            (unsigned)fit->sampleCount, (unsigned)fit->rejectedCount);
+    }
+#endif
+
 #ifdef USE_SDCARD
     cliSdInfo(NULL);
 #endif
@@ -4408,78 +4523,89 @@ static void cliResource(char *cmdline)
     }
 }
 
-static void backupConfigs(void)
+static uint16_t pgStorageSize(const pgRegistry_t *pg)
+{
+    return pgIsProfile(pg) ? pgSize(pg) * MAX_PROFILE_COUNT : pgSize(pg);
+}
+
+static void swapConfigs(void)
 {
-    // make copies of configs to do differencing
     PG_FOREACH(pg) {
-        if (pgIsProfile(pg)) {
-            memcpy(pg->copy, pg->address, pgSize(pg) * MAX_PROFILE_COUNT);
-        } else {
-            memcpy(pg->copy, pg->address, pgSize(pg));
+        const uint16_t size = pgStorageSize(pg);
+        for (uint16_t i = 0; i < size; i++) {
+            const uint8_t tmp = pg->address[i];
+            pg->address[i] = pg->copy[i];
+            pg->copy[i] = tmp;
         }
     }
 }
 
-static void restoreConfigs(void)
+// Build the default image of every PG once per dump into the PG copy regions.
+// The actual configuration is left in place, so it stays in use between dump steps.
+static void cacheDefaultConfigs(void)
 {
     PG_FOREACH(pg) {
-        if (pgIsProfile(pg)) {
-            memcpy(pg->address, pg->copy, pgSize(pg) * MAX_PROFILE_COUNT);
-        } else {
-            memcpy(pg->address, pg->copy, pgSize(pg));
-        }
+        memcpy(pg->copy, pg->address, pgStorageSize(pg));
     }
+
+    resetConfigs();
+    // restore the profile indices, since they should not be reset for proper comparison
+    setConfigProfile(cliDumpState.controlProfileIndex);
+    setConfigMixerProfile(cliDumpState.mixerProfileIndex);
+    setConfigBatteryProfile(cliDumpState.batteryProfileIndex);
+
+    swapConfigs();
+#ifdef USE_LED_STRIP
+    reevaluateLedConfig();
+#endif
 }
 
-static void printConfig(const char *cmdline, bool doDiff)
+static void cliDumpNextStage(void)
 {
-    uint8_t dumpMask = DUMP_MASTER;
-    const char *options;
-    if ((options = checkCommand(cmdline, "master"))) {
-        dumpMask = DUMP_MASTER; // only
-    } else if ((options = checkCommand(cmdline, "control_profile"))) {
-        dumpMask = DUMP_CONTROL_PROFILE; // only
-    } else if ((options = checkCommand(cmdline, "mixer_profile"))) {
-        dumpMask = DUMP_MIXER_PROFILE; // only
-    } else if ((options = checkCommand(cmdline, "battery_profile"))) {
-        dumpMask = DUMP_BATTERY_PROFILE; // only
-    } else if ((options = checkCommand(cmdline, "all"))) {
-        dumpMask = DUMP_ALL;   // all profiles and rates
-    } else {
-        options = cmdline;
-    }
+    cliDumpState.stage++;
+    cliDumpState.item = 0;
+}
 
-    if (doDiff) {
-        dumpMask = dumpMask | DO_DIFF;
+static void cliDumpNextItem(uint16_t itemCount)
+{
+    if (++cliDumpState.item >= itemCount) {
+        cliDumpNextStage();
     }
+}
 
-    const int currentControlProfileIndexSave = getConfigProfile();
-    const int currentMixerProfileIndexSave = getConfigMixerProfile();
-    const int currentBatteryProfileIndexSave = getConfigBatteryProfile();
-    backupConfigs();
-    // reset all configs to defaults to do differencing
-    resetConfigs();
-    // restore the profile indices, since they should not be reset for proper comparison
-    setConfigProfile(currentControlProfileIndexSave);
-    setConfigMixerProfile(currentMixerProfileIndexSave);
-    setConfigBatteryProfile(currentBatteryProfileIndexSave);
+static void cliDumpStartProfiles(cliDumpStage_e stage, uint8_t activeProfileIndex)
+{
+    cliDumpState.stage = stage;
+    cliDumpState.item = 0;
+    cliDumpState.profileIndex = (cliDumpState.dumpMask & DUMP_ALL) ? 0 : activeProfileIndex;
+}
 
-    if (checkCommand(options, "showdefaults")) {
-        dumpMask = dumpMask | SHOW_DEFAULTS;   // add default values as comments for changed values
+static bool cliDumpProfileDone(uint8_t profileDumpFlag, uint8_t activeProfileIndex)
+{
+    if (!(cliDumpState.dumpMask & (DUMP_MASTER | DUMP_ALL | profileDumpFlag))) {
+        return true;
     }
+    return (cliDumpState.dumpMask & DUMP_ALL) ? false : cliDumpState.profileIndex != activeProfileIndex;
+}
 
-#ifdef USE_CLI_BATCH
-    bool batchModeEnabled = false;
-#endif
+static void cliDumpStep(void)
+{
+    const uint8_t dumpMask = cliDumpState.dumpMask;
+
+    switch (cliDumpState.stage) {
+    case CLI_DUMP_STAGE_BEGIN:
+        if (!(dumpMask & (DUMP_MASTER | DUMP_ALL))) {
+            cliDumpStartProfiles(CLI_DUMP_STAGE_CONTROL_PROFILE, cliDumpState.controlProfileIndex);
+            break;
+        }
 
-    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
         cliPrintHashLine("version");
         cliVersion(NULL);
 
 #ifdef USE_CLI_BATCH
         cliPrintHashLine("start the command batch");
         cliPrintLine("batch start");
-        batchModeEnabled = true;
+        cliDumpState.batchModeEnabled = true;
 #endif
 
         if ((dumpMask & (DUMP_ALL | DO_DIFF)) == (DUMP_ALL | DO_DIFF)) {
@@ -4492,163 +4618,380 @@ static void printConfig(const char *cmdline, bool doDiff)
 
         cliPrintHashLine("resources");
         //printResource(dumpMask, &defaultConfig);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_TIMER_OUTPUTS:
         cliPrintHashLine("Timer overrides");
-        printTimerOutputModes(dumpMask, timerOverrides_CopyArray, timerOverrides(0), -1);
+        printTimerOutputModes(dumpMask, timerOverrides(0), timerOverrides_CopyArray, -1);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_SERVO:
         // print servo parameters
         cliPrintHashLine("Outputs [servo]");
-        printServo(dumpMask, servoParams_CopyArray, servoParams(0));
+        printServo(dumpMask, servoParams(0), servoParams_CopyArray);
+        cliDumpNextStage();
+        break;
 
 #if defined(USE_SAFE_HOME)
+    case CLI_DUMP_STAGE_SAFEHOME:
         cliPrintHashLine("safehome");
-        printSafeHomes(dumpMask, safeHomeConfig_CopyArray, safeHomeConfig(0));
+        printSafeHomes(dumpMask, safeHomeConfig(0), safeHomeConfig_CopyArray);
+        cliDumpNextStage();
+        break;
 #endif
 
 #ifdef USE_FW_AUTOLAND
+    case CLI_DUMP_STAGE_FW_APPROACH:
         cliPrintHashLine("Fixed Wing Approach");
-        printFwAutolandApproach(dumpMask, fwAutolandApproachConfig_CopyArray, fwAutolandApproachConfig(0));
+        printFwAutolandApproach(dumpMask, fwAutolandApproachConfig(0), fwAutolandApproachConfig_CopyArray);
+        cliDumpNextStage();
+        break;
 #endif
 
 #if defined(USE_GEOZONE)
-        cliPrintHashLine("geozone");
-        printGeozones(dumpMask, geoZonesConfig_CopyArray, geoZonesConfig(0));
+    case CLI_DUMP_STAGE_GEOZONES:
+        if (cliDumpState.item == 0) {
+            cliPrintHashLine("geozone");
+        }
+        printGeozones(dumpMask, geoZonesConfig(0), geoZonesConfig_CopyArray, cliDumpState.item);
+        cliDumpNextItem(MAX_GEOZONES_IN_CONFIG);
+        break;
 
-        cliPrintHashLine("geozone vertices");
-        printGeozoneVertices(dumpMask, geoZoneVertices_CopyArray, geoZoneVertices(0));
+    case CLI_DUMP_STAGE_GEOZONE_VERTICES:
+        if (cliDumpState.item == 0) {
+            cliPrintHashLine("geozone vertices");
+        }
+        printGeozoneVertices(dumpMask, geoZoneVertices(0), geoZoneVertices_CopyArray, cliDumpState.item);
+        cliDumpNextItem(MAX_VERTICES_IN_CONFIG);
+        break;
 #endif
 
+    case CLI_DUMP_STAGE_FEATURES:
         cliPrintHashLine("features");
-        printFeature(dumpMask, &featureConfig_Copy, featureConfig());
+        printFeature(dumpMask, featureConfig(), &featureConfig_Copy);
+        cliDumpNextStage();
+        break;
 
 #if defined(BEEPER) || defined(USE_DSHOT)
+    case CLI_DUMP_STAGE_BEEPER:
         cliPrintHashLine("beeper");
-        printBeeper(dumpMask, &beeperConfig_Copy, beeperConfig());
+        printBeeper(dumpMask, beeperConfig(), &beeperConfig_Copy);
+        cliDumpNextStage();
+        break;
 #endif
 
 #ifdef USE_BLACKBOX
+    case CLI_DUMP_STAGE_BLACKBOX:
         cliPrintHashLine("blackbox");
-        printBlackbox(dumpMask, &blackboxConfig_Copy, blackboxConfig());
+        printBlackbox(dumpMask, blackboxConfig(), &blackboxConfig_Copy);
+        cliDumpNextStage();
+        break;
 #endif
 
+    case CLI_DUMP_STAGE_RX_MAP:
         cliPrintHashLine("Receiver: Channel map");
-        printMap(dumpMask, &rxConfig_Copy, rxConfig());
+        printMap(dumpMask, rxConfig(), &rxConfig_Copy);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_SERIAL:
         cliPrintHashLine("Ports");
-        printSerial(dumpMask, &serialConfig_Copy, serialConfig());
+        printSerial(dumpMask, serialConfig(), &serialConfig_Copy);
+        cliDumpNextStage();
+        break;
 
 #ifdef USE_LED_STRIP
+    case CLI_DUMP_STAGE_LED:
         cliPrintHashLine("LEDs");
-        printLed(dumpMask, ledStripConfig_Copy.ledConfigs, ledStripConfig()->ledConfigs);
+        printLed(dumpMask, ledStripConfig()->ledConfigs, ledStripConfig_Copy.ledConfigs);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_LED_COLOR:
         cliPrintHashLine("LED color");
-        printColor(dumpMask, ledStripConfig_Copy.colors, ledStripConfig()->colors);
+        printColor(dumpMask, ledStripConfig()->colors, ledStripConfig_Copy.colors);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_LED_MODE_COLOR:
         cliPrintHashLine("LED mode_color");
-        printModeColor(dumpMask, &ledStripConfig_Copy, ledStripConfig());
+        printModeColor(dumpMask, ledStripConfig(), &ledStripConfig_Copy);
+        cliDumpNextStage();
+        break;
 #endif
 
+    case CLI_DUMP_STAGE_AUX:
         cliPrintHashLine("Modes [aux]");
-        printAux(dumpMask, modeActivationConditions_CopyArray, modeActivationConditions(0));
+        printAux(dumpMask, modeActivationConditions(0), modeActivationConditions_CopyArray);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_ADJRANGE:
         cliPrintHashLine("Adjustments [adjrange]");
-        printAdjustmentRange(dumpMask, adjustmentRanges_CopyArray, adjustmentRanges(0));
+        printAdjustmentRange(dumpMask, adjustmentRanges(0), adjustmentRanges_CopyArray);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_RXRANGE:
         cliPrintHashLine("Receiver rxrange");
-        printRxRange(dumpMask, rxChannelRangeConfigs_CopyArray, rxChannelRangeConfigs(0));
+        printRxRange(dumpMask, rxChannelRangeConfigs(0), rxChannelRangeConfigs_CopyArray);
+        cliDumpNextStage();
+        break;
 
 #ifdef USE_TEMPERATURE_SENSOR
+    case CLI_DUMP_STAGE_TEMP_SENSOR:
         cliPrintHashLine("temp_sensor");
-        printTempSensor(dumpMask, tempSensorConfig_CopyArray, tempSensorConfig(0));
+        printTempSensor(dumpMask, tempSensorConfig(0), tempSensorConfig_CopyArray);
+        cliDumpNextStage();
+        break;
 #endif
 
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE) && defined(NAV_NON_VOLATILE_WAYPOINT_CLI)
-        cliPrintHashLine("Mission Control Waypoints [wp]");
-        printWaypoints(dumpMask, posControl.waypointList, nonVolatileWaypointList(0));
+    case CLI_DUMP_STAGE_WAYPOINTS:
+        if (cliDumpState.item == 0) {
+            cliPrintHashLine("Mission Control Waypoints [wp]");
+        }
+        printWaypoints(dumpMask, posControl.waypointList, &emptyNavWaypoint, cliDumpState.item);
+        cliDumpNextItem(NAV_MAX_WAYPOINTS);
+        break;
 #endif
 
 #ifdef USE_OSD
-        cliPrintHashLine("OSD [osd_layout]");
-        printOsdLayout(dumpMask, &osdLayoutsConfig_Copy, osdLayoutsConfig(), -1, -1);
+    case CLI_DUMP_STAGE_OSD_LAYOUT:
+        if (cliDumpState.item == 0) {
+            cliPrintHashLine("OSD [osd_layout]");
+        }
+        printOsdLayout(dumpMask, osdLayoutsConfig(), &osdLayoutsConfig_Copy, cliDumpState.item / OSD_ITEM_COUNT, cliDumpState.item % OSD_ITEM_COUNT);
+        cliDumpNextItem(OSD_LAYOUT_COUNT * OSD_ITEM_COUNT);
+        break;
 #endif
 
 #ifdef USE_PROGRAMMING_FRAMEWORK
-        cliPrintHashLine("Programming: logic");
-        printLogic(dumpMask, logicConditions_CopyArray, logicConditions(0), -1);
+    case CLI_DUMP_STAGE_LOGIC:
+        if (cliDumpState.item == 0) {
+            cliPrintHashLine("Programming: logic");
+        }
+        printLogic(dumpMask, logicConditions(0), logicConditions_CopyArray, cliDumpState.item);
+        cliDumpNextItem(MAX_LOGIC_CONDITIONS);
+        break;
 
+    case CLI_DUMP_STAGE_GVAR:
         cliPrintHashLine("Programming: global variables");
-        printGvar(dumpMask, globalVariableConfigs_CopyArray, globalVariableConfigs(0));
+        printGvar(dumpMask, globalVariableConfigs(0), globalVariableConfigs_CopyArray);
+        cliDumpNextStage();
+        break;
 
+    case CLI_DUMP_STAGE_PID:
         cliPrintHashLine("Programming: PID controllers");
-        printPid(dumpMask, programmingPids_CopyArray, programmingPids(0));
-#endif
-#ifdef USE_PROGRAMMING_FRAMEWORK
+        printPid(dumpMask, programmingPids(0), programmingPids_CopyArray);
+        cliDumpNextStage();
+        break;
+
+    case CLI_DUMP_STAGE_OSD_CUSTOM_ELEMENTS:
         cliPrintHashLine("OSD: custom elements");
-        printOsdCustomElements(dumpMask, osdCustomElements_CopyArray, osdCustomElements(0));
+        printOsdCustomElements(dumpMask, osdCustomElements(0), osdCustomElements_CopyArray);
+        cliDumpNextStage();
+        break;
 #endif
 
-        cliPrintHashLine("master");
-        dumpAllValues(MASTER_VALUE, dumpMask);
+    case CLI_DUMP_STAGE_MASTER_VALUES:
+        if (cliDumpState.item == 0) {
+            cliPrintHashLine("master");
+        }
+        if (dumpValues(MASTER_VALUE, dumpMask)) {
+            cliDumpStartProfiles(CLI_DUMP_STAGE_CONTROL_PROFILE, cliDumpState.controlProfileIndex);
+        }
+        break;
 
-        if (dumpMask & DUMP_ALL) {
-            // dump all profiles
-            const int currentControlProfileIndexSave = getConfigProfile();
-            const int currentMixerProfileIndexSave = getConfigMixerProfile();
-            const int currentBatteryProfileIndexSave = getConfigBatteryProfile();
-            for (int ii = 0; ii < MAX_PROFILE_COUNT; ++ii) {
-                cliDumpControlProfile(ii, dumpMask);
-            }
-            for (int ii = 0; ii < MAX_MIXER_PROFILE_COUNT; ++ii) {
-                cliDumpMixerProfile(ii, dumpMask);
-            }
-            for (int ii = 0; ii < MAX_BATTERY_PROFILE_COUNT; ++ii) {
-                cliDumpBatteryProfile(ii, dumpMask);
-            }
-            setConfigProfile(currentControlProfileIndexSave);
-            setConfigMixerProfile(currentMixerProfileIndexSave);
-            setConfigBatteryProfile(currentBatteryProfileIndexSave);
+    case CLI_DUMP_STAGE_CONTROL_PROFILE:
+        if (cliDumpState.profileIndex >= MAX_PROFILE_COUNT || cliDumpProfileDone(DUMP_CONTROL_PROFILE, cliDumpState.controlProfileIndex)) {
+            cliDumpStartProfiles(CLI_DUMP_STAGE_MIXER_PROFILE, cliDumpState.mixerProfileIndex);
+            break;
+        }
+        cliPrintHashLine("control_profile");
+        cliPrintLinef("control_profile %d\r\n", cliDumpState.profileIndex + 1);
+        cliDumpNextStage();
+        break;
+
+    case CLI_DUMP_STAGE_CONTROL_PROFILE_PID:
+        if (dumpValues(PROFILE_VALUE, dumpMask)) {
+            cliDumpNextStage();
+        }
+        break;
 
+    case CLI_DUMP_STAGE_CONTROL_PROFILE_RATES:
+        if (dumpValues(CONTROL_VALUE, dumpMask)) {
+            cliDumpNextStage();
+        }
+        break;
+
+    case CLI_DUMP_STAGE_CONTROL_PROFILE_EZ_TUNE:
+        if (dumpValues(EZ_TUNE_VALUE, dumpMask)) {
+            cliDumpState.stage = CLI_DUMP_STAGE_CONTROL_PROFILE;
+            cliDumpState.item = 0;
+            cliDumpState.profileIndex++;
+        }
+        break;
+
+    case CLI_DUMP_STAGE_MIXER_PROFILE:
+        if (cliDumpState.profileIndex >= MAX_MIXER_PROFILE_COUNT || cliDumpProfileDone(DUMP_MIXER_PROFILE, cliDumpState.mixerProfileIndex)) {
+            cliDumpStartProfiles(CLI_DUMP_STAGE_BATTERY_PROFILE, cliDumpState.batteryProfileIndex);
+            break;
+        }
+        cliPrintHashLine("mixer_profile");
+        cliPrintLinef("mixer_profile %d\r\n", cliDumpState.profileIndex + 1);
+        cliDumpNextStage();
+        break;
+
+    case CLI_DUMP_STAGE_MIXER_PROFILE_VALUES:
+        if (dumpValues(MIXER_CONFIG_VALUE, dumpMask)) {
+            cliDumpNextStage();
+        }
+        break;
+
+    case CLI_DUMP_STAGE_MIXER_PROFILE_MOTOR_MIX:
+        cliPrintHashLine("Mixer: motor mixer");
+        cliDumpPrintLinef(dumpMask, primaryMotorMixer(0)->throttle == 0.0f, "\r\nmmix reset\r\n");
+        printMotorMix(dumpMask, primaryMotorMixer(0), primaryMotorMixer_CopyArray());
+        cliDumpNextStage();
+        break;
+
+    case CLI_DUMP_STAGE_MIXER_PROFILE_SERVO_MIX:
+        cliPrintHashLine("Mixer: servo mixer");
+        cliDumpPrintLinef(dumpMask, customServoMixers(0)->rate == 0, "smix reset\r\n");
+        printServoMix(dumpMask, customServoMixers(0), customServoMixers_CopyArray());
+        cliDumpState.stage = CLI_DUMP_STAGE_MIXER_PROFILE;
+        cliDumpState.item = 0;
+        cliDumpState.profileIndex++;
+        break;
+
+    case CLI_DUMP_STAGE_BATTERY_PROFILE:
+        if (cliDumpState.profileIndex >= MAX_BATTERY_PROFILE_COUNT || cliDumpProfileDone(DUMP_BATTERY_PROFILE, cliDumpState.batteryProfileIndex)) {
+            cliDumpState.stage = CLI_DUMP_STAGE_END;
+            break;
+        }
+        cliPrintHashLine("battery_profile");
+        cliPrintLinef("battery_profile %d\r\n", cliDumpState.profileIndex + 1);
+        cliDumpNextStage();
+        break;
+
+    case CLI_DUMP_STAGE_BATTERY_PROFILE_VALUES:
+        if (dumpValues(BATTERY_CONFIG_VALUE, dumpMask)) {
+            cliDumpState.stage = CLI_DUMP_STAGE_BATTERY_PROFILE;
+            cliDumpState.item = 0;
+            cliDumpState.profileIndex++;
+        }
+        break;
+
+    case CLI_DUMP_STAGE_END:
+        if (dumpMask & DUMP_ALL) {
             cliPrintHashLine("restore original profile selection");
-            cliPrintLinef("control_profile %d", currentControlProfileIndexSave + 1);
-            cliPrintLinef("mixer_profile %d", currentMixerProfileIndexSave + 1);
-            cliPrintLinef("battery_profile %d", currentBatteryProfileIndexSave + 1);
+            cliPrintLinef("control_profile %d", cliDumpState.controlProfileIndex + 1);
+            cliPrintLinef("mixer_profile %d", cliDumpState.mixerProfileIndex + 1);
+            cliPrintLinef("battery_profile %d", cliDumpState.batteryProfileIndex + 1);
+
+            cliDumpState.batchModeEnabled = false;
+        }
+
+        if (dumpMask & (DUMP_MASTER | DUMP_ALL)) {
+            cliPrintHashLine("save configuration\r\nsave");
+        }
 
 #ifdef USE_CLI_BATCH
-            batchModeEnabled = false;
-#endif
-        } else {
-            // dump just the current profiles
-            cliDumpControlProfile(getConfigProfile(), dumpMask);
-            cliDumpMixerProfile(getConfigMixerProfile(), dumpMask);
-            cliDumpBatteryProfile(getConfigBatteryProfile(), dumpMask);
+        if (cliDumpState.batchModeEnabled) {
+            cliPrintHashLine("end the command batch");
+            cliPrintLine("batch end");
         }
-    }
+#endif
+        cliDumpState.stage = CLI_DUMP_STAGE_IDLE;
+        break;
 
-    if (dumpMask & DUMP_CONTROL_PROFILE) {
-        cliDumpControlProfile(getConfigProfile(), dumpMask);
+    default:
+        // stage not compiled in
+        cliDumpNextStage();
+        break;
     }
+}
 
-    if (dumpMask & DUMP_MIXER_PROFILE) {
-        cliDumpMixerProfile(getConfigMixerProfile(), dumpMask);
+// Runs dump steps while the TX buffer has room and the slice has time left.
+// Returns true once the dump has finished.
+static bool cliDumpResume(void)
+{
+    const timeUs_t startTime = micros();
+
+    while (cliDumpState.stage != CLI_DUMP_STAGE_IDLE) {
+        if (!isSerialTransmitBufferEmpty(cliPort) && serialTxBytesFree(cliPort) < CLI_DUMP_TX_RESERVE) {
+            break;
+        }
+
+        // Profile settings are addressed through the selected profile indices. Point them at the
+        // dumped profile for this step only, without activating it, the flight code keeps its profile.
+        systemConfig_t *config = systemConfigMutable();
+        const uint8_t controlProfileIndex = config->current_profile_index;
+        const uint8_t mixerProfileIndex = config->current_mixer_profile_index;
+        const uint8_t batteryProfileIndex = config->current_battery_profile_index;
+
+        if (cliDumpState.stage >= CLI_DUMP_STAGE_CONTROL_PROFILE && cliDumpState.stage <= CLI_DUMP_STAGE_CONTROL_PROFILE_EZ_TUNE) {
+            config->current_profile_index = cliDumpState.profileIndex;
+        } else if (cliDumpState.stage >= CLI_DUMP_STAGE_MIXER_PROFILE && cliDumpState.stage <= CLI_DUMP_STAGE_MIXER_PROFILE_SERVO_MIX) {
+            config->current_mixer_profile_index = cliDumpState.profileIndex;
+        } else if (cliDumpState.stage >= CLI_DUMP_STAGE_BATTERY_PROFILE && cliDumpState.stage <= CLI_DUMP_STAGE_BATTERY_PROFILE_VALUES) {
+            config->current_battery_profile_index = cliDumpState.profileIndex;
+        }
+
+        cliDumpStep();
+
+        config->current_profile_index = controlProfileIndex;
+        config->current_mixer_profile_index = mixerProfileIndex;
+        config->current_battery_profile_index = batteryProfileIndex;
+
+        bufWriterFlush(cliWriter);
+
+        if (cmpTimeUs(micros(), startTime) >= CLI_DUMP_SLICE_US) {
+            break;
+        }
     }
 
-    if (dumpMask & DUMP_BATTERY_PROFILE) {
-        cliDumpBatteryProfile(getConfigBatteryProfile(), dumpMask);
+    return cliDumpState.stage == CLI_DUMP_STAGE_IDLE;
+}
+
+// Starts a dump, the output is generated by cliProcess() over the following calls
+static void printConfig(const char *cmdline, bool doDiff)
+{
+    uint8_t dumpMask = DUMP_MASTER;
+    const char *options;
+    if ((options = checkCommand(cmdline, "master"))) {
+        dumpMask = DUMP_MASTER; // only
+    } else if ((options = checkCommand(cmdline, "control_profile"))) {
+        dumpMask = DUMP_CONTROL_PROFILE; // only
+    } else if ((options = checkCommand(cmdline, "mixer_profile"))) {
+        dumpMask = DUMP_MIXER_PROFILE; // only
+    } else if ((options = checkCommand(cmdline, "battery_profile"))) {
+        dumpMask = DUMP_BATTERY_PROFILE; // only
+    } else if ((options = checkCommand(cmdline, "all"))) {
+        dumpMask = DUMP_ALL;   // all profiles and rates
+    } else {
+        options = cmdline;
     }
 
-    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
-        cliPrintHashLine("save configuration\r\nsave");
+    if (doDiff) {
+        dumpMask = dumpMask | DO_DIFF;
     }
 
-#ifdef USE_CLI_BATCH
-    if (batchModeEnabled) {
-        cliPrintHashLine("end the command batch");
-        cliPrintLine("batch end");
+    if (checkCommand(options, "showdefaults")) {
+        dumpMask = dumpMask | SHOW_DEFAULTS;   // add default values as comments for changed values
     }
-#endif
 
-    // restore configs from copies
-    restoreConfigs();
+    memset(&cliDumpState, 0, sizeof(cliDumpState));
+    cliDumpState.dumpMask = dumpMask;
+    cliDumpState.controlProfileIndex = getConfigProfile();
+    cliDumpState.mixerProfileIndex = getConfigMixerProfile();
+    cliDumpState.batteryProfileIndex = getConfigBatteryProfile();
+    cliDumpState.stage = CLI_DUMP_STAGE_BEGIN;
+
+    cacheDefaultConfigs();
 }
 
 static void cliDump(char *cmdline)
@@ -4866,6 +5209,9 @@ const clicmd_t cmdTable[] = {
 #ifdef USE_CLI_BATCH
     CLI_COMMAND_DEF("batch", "start or end a batch of commands", "start | end", cliBatch),
 #endif
+#ifdef USE_BENCHMARK
+    CLI_COMMAND_DEF("bench", "benchmark maths and filter kernels", "[<calls>]", cliBench),
+#endif
 #if defined(BEEPER) || defined(USE_DSHOT)
     CLI_COMMAND_DEF("beeper", "turn on/off beeper", "list\r\n"
             "\t<+|->[name]", cliBeeper),
@@ -4972,6 +5318,9 @@ const clicmd_t cmdTable[] = {
 #endif
     CLI_COMMAND_DEF("showdebug", "Show debug fields.", NULL, cliCmdDebug),
     CLI_COMMAND_DEF("status", "show status", NULL, cliStatus),
+#ifdef USE_SYSID
+    CLI_COMMAND_DEF("sysid", "show system identification results", "[response]", cliSysid),
+#endif
     CLI_COMMAND_DEF("tasks", "show task stats", NULL, cliTasks),
 #ifdef USE_TEMPERATURE_SENSOR
     CLI_COMMAND_DEF("temp_sensor", "change temp sensor settings", NULL, cliTempSensor),
@@ -5013,6 +5362,14 @@ void cliProcess(void)
     // Be a little bit tricky.  Flush the last inputs buffer, if any.
     bufWriterFlush(cliWriter);
 
+    // Input waits in the RX buffer until a running dump/diff has finished
+    if (cliDumpState.stage != CLI_DUMP_STAGE_IDLE) {
+        if (!cliDumpResume()) {
+            return;
+        }
+        cliPrompt();
+    }
+
     while (serialRxBytesWaiting(cliPort)) {
         uint8_t c = serialRead(cliPort);
         if (c == '\t' || c == '?') {
@@ -5097,6 +5454,10 @@ void cliProcess(void)
             if (!cliMode)
                 return;
 
+            // dump/diff prints the prompt once it has finished
+            if (cliDumpState.stage != CLI_DUMP_STAGE_IDLE)
+                return;
+
             cliPrompt();
         } else if (c == 127) {
             // backspace
@@ -91,11 +91,21 @@
 
 #include "flight/failsafe.h"
 #include "flight/power_limits.h"
+#include "flight/rpm_filter.h"
 
 #include "config/feature.h"
 #include "common/vector.h"
 #include "programming/pid.h"
 
+#if defined(SITL_BUILD)
+#include "target/SITL/sim/replay.h"
+#define REPLAY_PROFILE_BEGIN(section)   simReplayProfileBegin(section)
+#define REPLAY_PROFILE_END(section)     simReplayProfileEnd(section)
+#else
+#define REPLAY_PROFILE_BEGIN(section)
+#define REPLAY_PROFILE_END(section)
+#endif
+
 // June 2013     V2.2-dev
 
 enum {
@@ -856,7 +866,7 @@ void FAST_CODE taskGyro(timeUs_t currentTimeUs) {
 
 #ifdef USE_OPFLOW
     if (sensors(SENSOR_OPFLOW)) {
-        opflowGyroUpdateCallback(currentDeltaTime);
+        opflowGyroUpdateCallback(currentTimeUs, currentDeltaTime);
     }
 #endif
 }
@@ -952,10 +962,18 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
     if (ARMING_FLAG(SIMULATOR_MODE_HITL) || lockMainPID()) {
 #endif
 
+#if defined(USE_RPM_FILTER) && defined(USE_DSHOT_TELEMETRY)
+    rpmFilterDshotTelemetryUpdate();
+#endif
+
+    REPLAY_PROFILE_BEGIN(REPLAY_PROFILE_GYRO_FILTER);
     gyroFilter();
+    REPLAY_PROFILE_END(REPLAY_PROFILE_GYRO_FILTER);
 
+    REPLAY_PROFILE_BEGIN(REPLAY_PROFILE_IMU);
     imuUpdateAccelerometer();
     imuUpdateAttitude(currentTimeUs);
+    REPLAY_PROFILE_END(REPLAY_PROFILE_IMU);
 
 #if defined(SITL_BUILD)
     }
@@ -979,7 +997,10 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
     }
     isRXDataNew = false;
 
+    REPLAY_PROFILE_BEGIN(REPLAY_PROFILE_POS_ESTIMATOR);
     updatePositionEstimator();
+    REPLAY_PROFILE_END(REPLAY_PROFILE_POS_ESTIMATOR);
+
     applyWaypointNavigationAndAltitudeHold();
 
     // Apply throttle tilt compensation
@@ -990,7 +1011,9 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
 #endif
 
     // Calculate stabilisation
+    REPLAY_PROFILE_BEGIN(REPLAY_PROFILE_PID);
     pidController(dT);
+    REPLAY_PROFILE_END(REPLAY_PROFILE_PID);
 
     mixTable();
 
@@ -50,6 +50,7 @@
 #include "drivers/compass/compass.h"
 #include "drivers/bus.h"
 #include "drivers/dma.h"
+#include "drivers/dshot_telemetry.h"
 #include "drivers/exti.h"
 #include "drivers/io.h"
 #include "drivers/flash.h"
@@ -728,6 +729,12 @@ void init(void)
 
 #ifdef USE_RPM_FILTER
     disableRpmFilters();
+#ifdef USE_DSHOT_TELEMETRY
+    if (dshotTelemetryIsActive() && (rpmFilterConfig()->gyro_filter_enabled || rpmFilterConfig()->dterm_filter_enabled)) {
+        // Updated from the PID loop
+        rpmFiltersInit();
+    } else
+#endif
     if (STATE(ESC_SENSOR_ENABLED) && (rpmFilterConfig()->gyro_filter_enabled || rpmFilterConfig()->dterm_filter_enabled)) {
         rpmFiltersInit();
         setTaskEnabled(TASK_RPM_FILTER, true);
@@ -80,6 +80,7 @@
 #include "flight/mixer.h"
 #include "flight/pid.h"
 #include "flight/servos.h"
+#include "flight/sysid.h"
 #include "flight/ez_tune.h"
 
 #include "config/config_eeprom.h"
@@ -111,6 +112,7 @@
 #include "navigation/navigation.h"
 #include "navigation/navigation_private.h" //for MSP_SIMULATOR
 #include "navigation/navigation_pos_estimator_private.h" //for MSP_SIMULATOR
+#include "navigation/navigation_terrain.h"
 
 #include "rx/rx.h"
 #include "rx/msp.h"
@@ -1503,9 +1505,9 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
 
     case MSP_WP_GETINFO:
         sbufWriteU8(dst, 0);                        // Reserved for waypoint capabilities
-        sbufWriteU8(dst, NAV_MAX_WAYPOINTS);        // Maximum number of waypoints supported
-        sbufWriteU8(dst, isWaypointListValid());    // Is current mission valid
-        sbufWriteU8(dst, getWaypointCount());       // Number of waypoints in current mission
+        sbufWriteU8(dst, MIN(NAV_MAX_WAYPOINTS, 253));      // Maximum number of waypoints addressable by MSP_WP, MSP2_INAV_WP_BULK reports the full range
+        sbufWriteU8(dst, isWaypointListValid());            // Is current mission valid
+        sbufWriteU8(dst, MIN(getWaypointCount(), 255));     // Number of waypoints in current mission
         break;
 
     case MSP_TX_INFO:
@@ -1621,6 +1623,26 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
 #endif
         break;
 
+#ifdef USE_SYSID
+    case MSP2_INAV_SYSID:
+        {
+            const sysidResult_t *result = sysidGetResult();
+            sbufWriteU8(dst, sysidGetState());
+            sbufWriteU8(dst, result->axis);
+            sbufWriteU16(dst, result->segments);
+            sbufWriteU16(dst, result->coherentBins);
+            sbufWriteU16(dst, lrintf(result->bandwidthHz * 10));
+            sbufWriteU16(dst, lrintf(result->crossoverHz * 10));
+            sbufWriteU16(dst, (int16_t)lrintf(result->phaseMargin * 10));
+            sbufWriteU16(dst, result->d);
+            sbufWriteU16(dst, result->suggestedD);
+            sbufWriteU16(dst, (int16_t)lrintf(result->suggestedPhaseMargin * 10));
+            sbufWriteU16(dst, result->ff);
+            sbufWriteU16(dst, result->suggestedFF);
+        }
+        break;
+#endif
+
     case MSP2_INAV_MIXER:
         sbufWriteU8(dst, mixerConfig()->motorDirectionInverted);
         sbufWriteU8(dst, 0);
@@ -1945,20 +1967,133 @@ static mspResult_e mspFcLogicConditionCommand(sbuf_t *dst, sbuf_t *src) {
     }
 }
 
+#define MSP_WAYPOINT_SIZE   20  // waypoint record without the wp number
+
+// MSP_WP and MSP_SET_WP address the special waypoints as #254 and #255
+static uint16_t mspWaypointNumber(uint8_t msp_wp_no)
+{
+    switch (msp_wp_no) {
+        case 254:
+            return NAV_WP_NUMBER_GCS_TARGET;
+        case 255:
+            return NAV_WP_NUMBER_GCS_POSITION;
+        default:
+            return msp_wp_no;
+    }
+}
+
+static void mspWriteWaypoint(sbuf_t *dst, const navWaypoint_t *msp_wp)
+{
+    sbufWriteU8(dst, msp_wp->action);  // action (WAYPOINT)
+    sbufWriteU32(dst, msp_wp->lat);    // lat
+    sbufWriteU32(dst, msp_wp->lon);    // lon
+    sbufWriteU32(dst, msp_wp->alt);    // altitude (cm)
+    sbufWriteU16(dst, msp_wp->p1);     // P1
+    sbufWriteU16(dst, msp_wp->p2);     // P2
+    sbufWriteU16(dst, msp_wp->p3);     // P3
+    sbufWriteU8(dst, msp_wp->flag);    // flags
+}
+
+static void mspReadWaypoint(sbuf_t *src, navWaypoint_t *msp_wp)
+{
+    msp_wp->action = sbufReadU8(src);    // action
+    msp_wp->lat = sbufReadU32(src);      // lat
+    msp_wp->lon = sbufReadU32(src);      // lon
+    msp_wp->alt = sbufReadU32(src);      // to set altitude (cm)
+    msp_wp->p1 = sbufReadU16(src);       // P1
+    msp_wp->p2 = sbufReadU16(src);       // P2
+    msp_wp->p3 = sbufReadU16(src);       // P3
+    msp_wp->flag = sbufReadU8(src);      // future: to set nav flag
+}
+
 static void mspFcWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
 {
     const uint8_t msp_wp_no = sbufReadU8(src);    // get the wp number
     navWaypoint_t msp_wp;
-    getWaypoint(msp_wp_no, &msp_wp);
+    getWaypoint(mspWaypointNumber(msp_wp_no), &msp_wp);
     sbufWriteU8(dst, msp_wp_no);      // wp_no
-    sbufWriteU8(dst, msp_wp.action);  // action (WAYPOINT)
-    sbufWriteU32(dst, msp_wp.lat);    // lat
-    sbufWriteU32(dst, msp_wp.lon);    // lon
-    sbufWriteU32(dst, msp_wp.alt);    // altitude (cm)
-    sbufWriteU16(dst, msp_wp.p1);     // P1
-    sbufWriteU16(dst, msp_wp.p2);     // P2
-    sbufWriteU16(dst, msp_wp.p3);     // P3
-    sbufWriteU8(dst, msp_wp.flag);    // flags
+    mspWriteWaypoint(dst, &msp_wp);
+}
+
+/*
+ * Reads up to count mission waypoints starting at wp number first, as many as fit in the reply.
+ * Reply: U16 max waypoints, U16 mission waypoint count, U8 mission valid, U16 first, U8 n, n waypoint records
+ */
+static mspResult_e mspFcWaypointBulkOutCommand(sbuf_t *dst, sbuf_t *src)
+{
+    uint16_t first;
+    uint8_t count;
+
+    if (!sbufReadU16Safe(&first, src) || !sbufReadU8Safe(&count, src) || first < 1 || first > NAV_MAX_WAYPOINTS) {
+        return MSP_RESULT_ERROR;
+    }
+
+    sbufWriteU16(dst, NAV_MAX_WAYPOINTS);
+    sbufWriteU16(dst, getWaypointCount());
+    sbufWriteU8(dst, isWaypointListValid());
+    sbufWriteU16(dst, first);
+
+    const int available = MIN(getWaypointCount() - first + 1, ((int)sbufBytesRemaining(dst) - 1) / MSP_WAYPOINT_SIZE);
+    const uint8_t n = constrain(available, 0, count);
+    sbufWriteU8(dst, n);
+
+    for (uint8_t i = 0; i < n; i++) {
+        navWaypoint_t msp_wp;
+        getWaypoint(first + i, &msp_wp);
+        mspWriteWaypoint(dst, &msp_wp);
+    }
+
+    return MSP_RESULT_ACK;
+}
+
+#ifdef USE_SYSID
+// Bins outside the analysed band are skipped, the reply carries the bins that follow
+static mspResult_e mspFcSysidResponseCommand(sbuf_t *dst, sbuf_t *src)
+{
+    uint8_t first;
+    uint8_t count;
+
+    if (!sbufReadU8Safe(&first, src) || !sbufReadU8Safe(&count, src)) {
+        return MSP_RESULT_ERROR;
+    }
+
+    uint8_t *countPtr = sbufPtr(dst);
+    uint8_t n = 0;
+    sbufWriteU8(dst, 0);
+
+    for (int bin = first; bin < SYSID_BIN_COUNT && n < count && sbufBytesRemaining(dst) >= 8; bin++) {
+        sysidResponse_t response;
+        if (sysidGetResponse(bin, &response)) {
+            sbufWriteU8(dst, bin);
+            sbufWriteU16(dst, lrintf(response.frequencyHz * 10));
+            sbufWriteU16(dst, (int16_t)lrintf(response.gainDb * 100));
+            sbufWriteU16(dst, (int16_t)lrintf(response.phase * 10));
+            sbufWriteU8(dst, lrintf(response.coherence * 100));
+            n++;
+        }
+    }
+    *countPtr = n;
+
+    return MSP_RESULT_ACK;
+}
+#endif
+
+static void mspFcSetWaypoint(uint16_t wpNumber, const navWaypoint_t *msp_wp)
+{
+    setWaypoint(wpNumber, msp_wp);
+
+#ifdef USE_FW_AUTOLAND
+    static uint8_t mmIdx = 0, fwAppraochStartIdx = 8;
+#ifdef USE_SAFE_HOME
+    fwAppraochStartIdx = MAX_SAFE_HOMES;
+#endif
+    if (wpNumber == 0) {
+        mmIdx = 0;
+    } else if (msp_wp->flag == NAV_WP_FLAG_LAST) {
+        mmIdx++;
+    }
+    resetFwAutolandApproach(fwAppraochStartIdx + mmIdx);
+#endif
 }
 
 #ifdef USE_FLASHFS
@@ -3108,33 +3243,64 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
 
             const uint8_t msp_wp_no = sbufReadU8(src);     // get the waypoint number
             navWaypoint_t msp_wp;
-            msp_wp.action = sbufReadU8(src);    // action
-            msp_wp.lat = sbufReadU32(src);      // lat
-            msp_wp.lon = sbufReadU32(src);      // lon
-            msp_wp.alt = sbufReadU32(src);      // to set altitude (cm)
-            msp_wp.p1 = sbufReadU16(src);       // P1
-            msp_wp.p2 = sbufReadU16(src);       // P2
-            msp_wp.p3 = sbufReadU16(src);       // P3
-            msp_wp.flag = sbufReadU8(src);      // future: to set nav flag
-            setWaypoint(msp_wp_no, &msp_wp);
+            mspReadWaypoint(src, &msp_wp);
+            mspFcSetWaypoint(mspWaypointNumber(msp_wp_no), &msp_wp);
+        } else {
+            return MSP_RESULT_ERROR;
+        }
 
-#ifdef USE_FW_AUTOLAND
-            static uint8_t mmIdx = 0, fwAppraochStartIdx = 8;
-#ifdef USE_SAFE_HOME
-            fwAppraochStartIdx = MAX_SAFE_HOMES;
-#endif
-            if (msp_wp_no == 0) {
-                mmIdx = 0;
-            } else if (msp_wp.flag == NAV_WP_FLAG_LAST) {
-                mmIdx++;
+        break;
+
+    case MSP2_INAV_SET_WP_BULK:
+        // Payload: U16 first wp number, then consecutive waypoint records
+        if (dataSize > 2 && (dataSize - 2) % MSP_WAYPOINT_SIZE == 0) {
+            const uint16_t first = sbufReadU16(src);
+            const uint8_t count = (dataSize - 2) / MSP_WAYPOINT_SIZE;
+
+            if (first < 1 || first + count - 1 > NAV_MAX_WAYPOINTS) {
+                return MSP_RESULT_ERROR;
+            }
+
+            for (uint8_t i = 0; i < count; i++) {
+                navWaypoint_t msp_wp;
+                mspReadWaypoint(src, &msp_wp);
+                mspFcSetWaypoint(first + i, &msp_wp);
             }
-            resetFwAutolandApproach(fwAppraochStartIdx + mmIdx);
-#endif
         } else {
             return MSP_RESULT_ERROR;
         }
 
         break;
+
+#ifdef USE_TERRAIN_GRID
+    case MSP2_INAV_SET_TERRAIN:
+        // Payload: I32 lat, I32 lon of the first post, U16 spacing (m), U8 rows, U8 columns, then rows x columns I16 altitudes (m AMSL)
+        if (dataSize >= 12 && posControl.gpsOrigin.valid) {
+            gpsLocation_t llh;
+            llh.lat = sbufReadU32(src);
+            llh.lon = sbufReadU32(src);
+            llh.alt = 0;
+            const uint16_t spacing = sbufReadU16(src);
+            const uint8_t rows = sbufReadU8(src);
+            const uint8_t columns = sbufReadU8(src);
+
+            fpVector3_t first;
+            if (dataSize != 12u + rows * columns * 2u || !geoConvertGeodeticToLocal(&first, &posControl.gpsOrigin, &llh, GEO_ALT_ABSOLUTE)) {
+                return MSP_RESULT_ERROR;
+            }
+
+            for (int row = 0; row < rows; row++) {
+                for (int column = 0; column < columns; column++) {
+                    const int16_t altitude = sbufReadU16(src);
+                    terrainGridSeed(&posControl.gpsOrigin, first.x + row * spacing * 100.0f, first.y + column * spacing * 100.0f, altitude * 100);
+                }
+            }
+        } else {
+            return MSP_RESULT_ERROR;
+        }
+
+        break;
+#endif
     case MSP2_COMMON_SET_RADAR_POS:
         if (dataSize == 19) {
             const uint8_t msp_radar_no = MIN(sbufReadU8(src), RADAR_MAX_POIS - 1); // Radar poi number, 0 to 3
@@ -4473,6 +4639,16 @@ bool mspFCProcessInOutCommand(uint16_t cmdMSP, sbuf_t *dst, sbuf_t *src, mspResu
         *ret = MSP_RESULT_ACK;
         break;
 
+    case MSP2_INAV_WP_BULK:
+        *ret = mspFcWaypointBulkOutCommand(dst, src);
+        break;
+
+#ifdef USE_SYSID
+    case MSP2_INAV_SYSID_RESPONSE:
+        *ret = mspFcSysidResponseCommand(dst, src);
+        break;
+#endif
+
 #if defined(USE_FLASHFS)
     case MSP_DATAFLASH_READ:
         mspFcDataFlashReadCommand(dst, src);
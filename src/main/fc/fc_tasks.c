@@ -52,6 +52,7 @@
 #include "flight/power_limits.h"
 #include "flight/rpm_filter.h"
 #include "flight/servos.h"
+#include "flight/sysid.h"
 #include "flight/wind_estimator.h"
 #include "flight/adaptive_filter.h"
 
@@ -207,7 +208,9 @@ void taskUpdateBaro(timeUs_t currentTimeUs)
         rescheduleTask(TASK_SELF, newDeadline);
     }
 
-    updatePositionEstimator_BaroTopic(currentTimeUs);
+    if (baroProcess()) {
+        updatePositionEstimator_BaroTopic(currentTimeUs);
+    }
 }
 #endif
 
@@ -372,6 +375,9 @@ void fcTasksInit(void)
 #endif
 #ifdef USE_MAG
     setTaskEnabled(TASK_COMPASS, sensors(SENSOR_MAG));
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    setTaskEnabled(TASK_COMPASS_CALIBRATION, sensors(SENSOR_MAG) && compassConfig()->magOnlineCalibration);
+#endif
 #if defined(USE_MAG_MPU9250)
     // fixme temporary solution for AK6983 via slave I2C on MPU9250
     rescheduleTask(TASK_COMPASS, TASK_PERIOD_HZ(40));
@@ -464,6 +470,10 @@ void fcTasksInit(void)
     setTaskEnabled(TASK_GEOZONE, feature(FEATURE_GEOZONE));
 #endif
 
+#ifdef USE_SYSID
+    setTaskEnabled(TASK_SYSID, true);
+#endif
+
 }
 
 cfTask_t cfTasks[TASK_COUNT] = {
@@ -760,4 +770,22 @@ cfTask_t cfTasks[TASK_COUNT] = {
     },
 #endif
 
+#ifdef USE_SYSID
+    [TASK_SYSID] = {
+        .taskName = "SYSID",
+        .taskFunc = sysidTask,
+        .desiredPeriod = TASK_PERIOD_HZ(SYSID_TASK_RATE_HZ),
+        .staticPriority = TASK_PRIORITY_LOW,
+    },
+#endif
+
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    [TASK_COMPASS_CALIBRATION] = {
+        .taskName = "COMPASS_CAL",
+        .taskFunc = compassOnlineCalibrationUpdate,
+        .desiredPeriod = TASK_PERIOD_HZ(10),      // Same as the compass
+        .staticPriority = TASK_PRIORITY_LOW,
+    },
+#endif
+
 };
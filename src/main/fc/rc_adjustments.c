@@ -617,7 +617,7 @@ static void applyStepAdjustment(controlConfig_t *controlConfig, uint8_t adjustme
 #ifdef USE_MULTI_MISSION
         case ADJUSTMENT_NAV_WP_MULTI_MISSION_INDEX:
             if (posControl.multiMissionCount && !FLIGHT_MODE(NAV_WP_MODE)) {
-                applyAdjustmentU8(ADJUSTMENT_NAV_WP_MULTI_MISSION_INDEX, &navConfigMutable()->general.waypoint_multi_mission_index, delta, SETTING_NAV_WP_MULTI_MISSION_INDEX_MIN, posControl.multiMissionCount);
+                applyAdjustmentU8(ADJUSTMENT_NAV_WP_MULTI_MISSION_INDEX, &navConfigMutable()->general.waypoint_multi_mission_index, delta, SETTING_NAV_WP_MULTI_MISSION_INDEX_MIN, MIN(posControl.multiMissionCount, NAV_MAX_MULTI_MISSIONS));
             }
             break;
 #endif
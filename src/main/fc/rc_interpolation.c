@@ -0,0 +1,167 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+
+#include "fc/rc_interpolation.h"
+
+/*
+ * Second order loop: the phase gain pulls the frame time towards the
+ * measured one, the period gain integrates the error into the period.
+ * With these gains the poles sit at |z| = 0.89, settling in about 30
+ * frames while averaging out most of the per frame jitter.
+ */
+#define RC_FRAME_PLL_PHASE_GAIN     0.2f
+#define RC_FRAME_PLL_PERIOD_GAIN    0.02f
+
+// Consecutive gaps of several periods mean the link rate went down
+#define RC_FRAME_PLL_MAX_GAPS       4
+
+void rcFramePllReset(rcFramePll_t *pll)
+{
+    pll->frameTimeUs = 0;
+    pll->periodUs = 0;
+    pll->jitterUs = 0;
+    pll->gapCount = 0;
+    pll->hasFrame = false;
+    pll->locked = false;
+}
+
+static void rcFramePllRestart(rcFramePll_t *pll, timeUs_t frameTimeUs)
+{
+    pll->frameTimeUs = frameTimeUs;
+    pll->jitterUs = 0;
+    pll->gapCount = 0;
+    pll->locked = false;
+}
+
+void rcFramePllUpdate(rcFramePll_t *pll, timeUs_t frameTimeUs)
+{
+    const timeDelta_t elapsedUs = cmpTimeUs(frameTimeUs, pll->frameTimeUs);
+
+    if (!pll->hasFrame) {
+        pll->hasFrame = true;
+        rcFramePllRestart(pll, frameTimeUs);
+        return;
+    }
+
+    if (!pll->locked) {
+        // Initial period straight from two frames
+        if (elapsedUs >= RC_FRAME_PLL_MIN_PERIOD_US && elapsedUs <= RC_FRAME_PLL_MAX_PERIOD_US) {
+            pll->periodUs = elapsedUs;
+            pll->locked = true;
+        }
+        pll->frameTimeUs = frameTimeUs;
+        return;
+    }
+
+    // Whole periods since the last frame, more than one when frames were lost
+    const int frames = lrintf(elapsedUs / pll->periodUs);
+
+    if (frames > 1) {
+        pll->gapCount++;
+    } else {
+        pll->gapCount = 0;
+    }
+
+    if (frames < 1 || frames > RC_FRAME_PLL_MAX_LOST_FRAMES || pll->gapCount >= RC_FRAME_PLL_MAX_GAPS) {
+        rcFramePllRestart(pll, frameTimeUs);
+        return;
+    }
+
+    const float predictedUs = frames * pll->periodUs;
+    const float errorUs = elapsedUs - predictedUs;
+
+    pll->frameTimeUs += lrintf(predictedUs + RC_FRAME_PLL_PHASE_GAIN * errorUs);
+    pll->periodUs = constrainf(pll->periodUs + RC_FRAME_PLL_PERIOD_GAIN * errorUs / frames, RC_FRAME_PLL_MIN_PERIOD_US, RC_FRAME_PLL_MAX_PERIOD_US);
+    pll->jitterUs = errorUs;
+}
+
+// Position between the last estimated frame time and the next one, held at 1 when a frame is late
+float rcFramePllGetFraction(const rcFramePll_t *pll, timeUs_t currentTimeUs)
+{
+    if (!pll->locked) {
+        return 1.0f;
+    }
+
+    return constrainf(cmpTimeUs(currentTimeUs, pll->frameTimeUs) / pll->periodUs, 0.0f, 1.0f);
+}
+
+void rcInterpolatorReset(rcInterpolator_t *interpolator, float value)
+{
+    interpolator->sample[0] = value;
+    interpolator->sample[1] = value;
+    interpolator->sample[2] = value;
+}
+
+void rcInterpolatorPush(rcInterpolator_t *interpolator, float value)
+{
+    interpolator->sample[2] = interpolator->sample[1];
+    interpolator->sample[1] = interpolator->sample[0];
+    interpolator->sample[0] = value;
+}
+
+// Data processed without a new frame (failsafe, 10 Hz refresh) updates the newest sample only
+void rcInterpolatorReplace(rcInterpolator_t *interpolator, float value)
+{
+    interpolator->sample[0] = value;
+}
+
+// Runs from the previous frame to the newest one in one period, one frame of latency
+float rcInterpolatorApplyLinear(const rcInterpolator_t *interpolator, float fraction)
+{
+    const float *s = interpolator->sample;
+
+    return s[1] + fraction * (s[0] - s[1]);
+}
+
+// Fritsch-Carlson limit keeping the curve within the samples it connects
+static float rcInterpolatorLimitTangent(float tangent, float slope)
+{
+    if (tangent * slope <= 0.0f) {
+        return 0.0f;
+    }
+
+    return fabsf(tangent) > 3.0f * fabsf(slope) ? 3.0f * slope : tangent;
+}
+
+/*
+ * Hermite segment over the same span as the linear one. Both tangents are
+ * backward differences, the start tangent being the end tangent of the
+ * previous segment, so the setpoint derivative has no steps at frame
+ * boundaries unless the limit cuts in. Ramps come out exactly linear, steps
+ * do not overshoot.
+ */
+float rcInterpolatorApplyCubic(const rcInterpolator_t *interpolator, float fraction)
+{
+    const float *s = interpolator->sample;
+    const float slope = s[0] - s[1];
+    const float startTangent = rcInterpolatorLimitTangent(s[1] - s[2], slope);
+    const float endTangent = slope;
+
+    const float t = fraction;
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+
+    return (2 * t3 - 3 * t2 + 1) * s[1] + (t3 - 2 * t2 + t) * startTangent + (-2 * t3 + 3 * t2) * s[0] + (t3 - t2) * endTangent;
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+#define RC_FRAME_PLL_MIN_PERIOD_US      500     // 2 kHz
+#define RC_FRAME_PLL_MAX_PERIOD_US      100000  // 10 Hz
+#define RC_FRAME_PLL_MAX_LOST_FRAMES    8
+
+/*
+ * Tracks period and phase of the RX frames from the driver timestamps. The
+ * estimated frame times follow the transmitter clock instead of the jitter
+ * of the link and the UART.
+ */
+typedef struct rcFramePll_s {
+    timeUs_t frameTimeUs;   // Estimated time of the last frame
+    float periodUs;         // Estimated frame period
+    float jitterUs;         // Last frame time minus the prediction
+    uint8_t gapCount;       // Consecutive updates spanning several periods
+    bool hasFrame;
+    bool locked;
+} rcFramePll_t;
+
+// Last three frames of one channel, newest first
+typedef struct rcInterpolator_s {
+    float sample[3];
+} rcInterpolator_t;
+
+void rcFramePllReset(rcFramePll_t *pll);
+void rcFramePllUpdate(rcFramePll_t *pll, timeUs_t frameTimeUs);
+float rcFramePllGetFraction(const rcFramePll_t *pll, timeUs_t currentTimeUs);
+
+void rcInterpolatorReset(rcInterpolator_t *interpolator, float value);
+void rcInterpolatorPush(rcInterpolator_t *interpolator, float value);
+void rcInterpolatorReplace(rcInterpolator_t *interpolator, float value);
+float rcInterpolatorApplyLinear(const rcInterpolator_t *interpolator, float fraction);
+float rcInterpolatorApplyCubic(const rcInterpolator_t *interpolator, float fraction);
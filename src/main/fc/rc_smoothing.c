@@ -25,6 +25,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <math.h>
 
 #include "platform.h"
 
@@ -42,6 +43,7 @@
 #include "fc/config.h"
 #include "fc/fc_core.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_interpolation.h"
 #include "fc/rc_smoothing.h"
 #include "fc/runtime_config.h"
 
@@ -54,6 +56,9 @@ static pt3Filter_t rcSmoothFilter[4];
 static float rcStickUnfiltered[4];
 static uint16_t rcUpdateFrequency;
 
+static rcFramePll_t rcFramePll;
+static rcInterpolator_t rcInterpolator[4];
+
 uint16_t getRcUpdateFrequency(void) {
     return rcUpdateFrequency;
 }
@@ -75,8 +80,78 @@ static int32_t applyRcUpdateFrequencyMedianFilter(int32_t newReading)
     return medianFilterReady ? quickMedianFilter9(filterSamples) : newReading;
 }
 
+/*
+ * Frame timed interpolation: the PLL follows the transmitter frame clock
+ * through the driver timestamps, the sticks are interpolated between the
+ * last two frames along the estimated frame times at PID loop rate.
+ */
+static void rcInterpolationApplyFrameTimed(bool isRXDataNew, timeUs_t currentTimeUs)
+{
+    static timeUs_t previousFrameTimeUs;
+    static bool initDone = false;
+
+    if (isRXDataNew) {
+        const timeUs_t frameTimeUs = rxGetFrameTimeUs();
+
+        if (!initDone) {
+            rcFramePllReset(&rcFramePll);
+            for (int stick = 0; stick < 4; stick++) {
+                rcInterpolatorReset(&rcInterpolator[stick], rcCommand[stick]);
+            }
+            initDone = true;
+        }
+
+        if (frameTimeUs != previousFrameTimeUs) {
+            previousFrameTimeUs = frameTimeUs;
+            rcFramePllUpdate(&rcFramePll, frameTimeUs);
+
+            for (int stick = 0; stick < 4; stick++) {
+                rcInterpolatorPush(&rcInterpolator[stick], rcCommand[stick]);
+            }
+
+            if (rcFramePll.locked) {
+                rcUpdateFrequency = lrintf(1e6f / rcFramePll.periodUs);
+            }
+
+            DEBUG_SET(DEBUG_RC_SMOOTHING, 0, lrintf(rcFramePll.jitterUs));
+            DEBUG_SET(DEBUG_RC_SMOOTHING, 1, lrintf(rcFramePll.periodUs));
+            // Frame received to first use in the PID loop
+            DEBUG_SET(DEBUG_RC_SMOOTHING, 2, cmpTimeUs(currentTimeUs, frameTimeUs));
+        } else {
+            // Processed without a new frame, failsafe or the 10 Hz refresh
+            for (int stick = 0; stick < 4; stick++) {
+                rcInterpolatorReplace(&rcInterpolator[stick], rcCommand[stick]);
+            }
+        }
+    }
+
+    if (!initDone) {
+        return;
+    }
+
+    const float fraction = rcFramePllGetFraction(&rcFramePll, currentTimeUs);
+
+    for (int stick = 0; stick < 4; stick++) {
+        if (rxConfig()->rcFilterMode == RC_FILTER_MODE_CUBIC) {
+            rcCommand[stick] = rcInterpolatorApplyCubic(&rcInterpolator[stick], fraction);
+        } else {
+            rcCommand[stick] = rcInterpolatorApplyLinear(&rcInterpolator[stick], fraction);
+        }
+    }
+
+    // Total stick latency is the frame period plus the frame to PID loop delay
+    DEBUG_SET(DEBUG_RC_SMOOTHING, 3, lrintf(fraction * 1000));
+    DEBUG_SET(DEBUG_RC_SMOOTHING, 4, rcInterpolator[ROLL].sample[0]);
+    DEBUG_SET(DEBUG_RC_SMOOTHING, 5, rcCommand[ROLL]);
+}
+
 void rcInterpolationApply(bool isRXDataNew, timeUs_t currentTimeUs)
 {
+    if (rxConfig()->rcFilterMode != RC_FILTER_MODE_PT3) {
+        rcInterpolationApplyFrameTimed(isRXDataNew, currentTimeUs);
+        return;
+    }
+
     // Compute the RC update frequency
     static timeUs_t previousRcData;
     static int filterFrequency;
@@ -137,18 +137,18 @@ PG_RESET_TEMPLATE(imuConfig_t, imuConfig,
     .gps_yaw_weight = SETTING_AHRS_GPS_YAW_WEIGHT_DEFAULT
 );
 
-STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
+static inline void imuQuaternionToRotationMatrix(const fpQuaternion_t * q)
 {
-    float q1q1 = orientation.q1 * orientation.q1;
-    float q2q2 = orientation.q2 * orientation.q2;
-    float q3q3 = orientation.q3 * orientation.q3;
+    float q1q1 = q->q1 * q->q1;
+    float q2q2 = q->q2 * q->q2;
+    float q3q3 = q->q3 * q->q3;
 
-    float q0q1 = orientation.q0 * orientation.q1;
-    float q0q2 = orientation.q0 * orientation.q2;
-    float q0q3 = orientation.q0 * orientation.q3;
-    float q1q2 = orientation.q1 * orientation.q2;
-    float q1q3 = orientation.q1 * orientation.q3;
-    float q2q3 = orientation.q2 * orientation.q3;
+    float q0q1 = q->q0 * q->q1;
+    float q0q2 = q->q0 * q->q2;
+    float q0q3 = q->q0 * q->q3;
+    float q1q2 = q->q1 * q->q2;
+    float q1q3 = q->q1 * q->q3;
+    float q2q3 = q->q2 * q->q3;
 
     rMat[0][0] = 1.0f - 2.0f * q2q2 - 2.0f * q3q3;
     rMat[0][1] = 2.0f * (q1q2 + -q0q3);
@@ -163,6 +163,33 @@ STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
     rMat[2][2] = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
 }
 
+STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
+{
+    imuQuaternionToRotationMatrix(&orientation);
+}
+
+/*
+ * rMat is kept in sync with orientation, so rotating by rMat (9 multiplies) gives the same
+ * result as quaternionRotateVector()/quaternionRotateVectorInv() (two quaternion products)
+ */
+static inline void imuRotateVectorBodyToEarth(fpVector3_t * result, const fpVector3_t * v)
+{
+    const float x = v->x, y = v->y, z = v->z;
+
+    result->x = rMat[0][0] * x + rMat[0][1] * y + rMat[0][2] * z;
+    result->y = rMat[1][0] * x + rMat[1][1] * y + rMat[1][2] * z;
+    result->z = rMat[2][0] * x + rMat[2][1] * y + rMat[2][2] * z;
+}
+
+static inline void imuRotateVectorEarthToBody(fpVector3_t * result, const fpVector3_t * v)
+{
+    const float x = v->x, y = v->y, z = v->z;
+
+    result->x = rMat[0][0] * x + rMat[1][0] * y + rMat[2][0] * z;
+    result->y = rMat[0][1] * x + rMat[1][1] * y + rMat[2][1] * z;
+    result->z = rMat[0][2] * x + rMat[1][2] * y + rMat[2][2] * z;
+}
+
 void imuConfigure(void)
 {
     imuRuntimeConfig.dcm_kp_acc = imuConfig()->dcm_kp_acc / 10000.0f;
@@ -367,6 +394,71 @@ static float imuCalculateMcCogAccWeight(void)
     return wCoGAcc;
 }
 
+/*
+ * Fused attitude update: integrate body rate into the orientation quaternion, renormalize
+ * and rebuild rMat in one pass. The quaternion stays in local variables from the delta
+ * rotation to the rotation matrix, orientation and rMat are written once.
+ * Returns false if the result is not a valid quaternion.
+ */
+static bool imuIntegrateOrientation(const fpVector3_t * vRotation, float dt)
+{
+    const float thetaX = vRotation->x * 0.5f * dt;
+    const float thetaY = vRotation->y * 0.5f * dt;
+    const float thetaZ = vRotation->z * 0.5f * dt;
+    const float thetaMagnitudeSq = sq(thetaX) + sq(thetaY) + sq(thetaZ);
+
+    // If calculated rotation is zero - don't update quaternion, rMat is already in sync
+    if (thetaMagnitudeSq < 1e-20f) {
+        return true;
+    }
+
+    // Calculate quaternion delta:
+    // Theta is a axis/angle rotation. Direction of a vector is axis, magnitude is angle/2.
+    // Proper quaternion from axis/angle involves computing sin/cos, but the formula becomes numerically unstable as Theta approaches zero.
+    // For near-zero cases we use the first 3 terms of the Taylor series expansion for sin/cos. We check if fourth term is less than machine precision -
+    // then we can safely use the "low angle" approximated version without loss of accuracy.
+    // Original condition was "thetaMagnitudeSq < sqrt(24e-6)", squared to avoid the sqrt() call.
+    float dq0, thetaScale;
+    if (thetaMagnitudeSq * thetaMagnitudeSq < 24.0e-6f) {
+        thetaScale = 1.0f - thetaMagnitudeSq / 6.0f;
+        dq0 = 1.0f - thetaMagnitudeSq / 2.0f;
+    }
+    else {
+        const float thetaMagnitude = fast_fsqrtf(thetaMagnitudeSq);
+        thetaScale = sin_approx(thetaMagnitude) / thetaMagnitude;
+        dq0 = cos_approx(thetaMagnitude);
+    }
+
+    const float dq1 = thetaX * thetaScale;
+    const float dq2 = thetaY * thetaScale;
+    const float dq3 = thetaZ * thetaScale;
+
+    // orientation * deltaQ
+    fpQuaternion_t q;
+    q.q0 = orientation.q0 * dq0 - orientation.q1 * dq1 - orientation.q2 * dq2 - orientation.q3 * dq3;
+    q.q1 = orientation.q0 * dq1 + orientation.q1 * dq0 + orientation.q2 * dq3 - orientation.q3 * dq2;
+    q.q2 = orientation.q0 * dq2 - orientation.q1 * dq3 + orientation.q2 * dq0 + orientation.q3 * dq1;
+    q.q3 = orientation.q0 * dq3 + orientation.q1 * dq2 - orientation.q2 * dq1 + orientation.q3 * dq0;
+
+    // First-order Newton renormalization, 1/sqrt(x) ~ (3 - x) / 2 for x close to 1.
+    // At 1 kHz the quaternion norm drifts by < 1e-6 per step, the error is O(1e-12).
+    // imuCheckAndResetOrientationQuaternion() catches any catastrophic norm deviation.
+    const float normScale = (3.0f - (sq(q.q0) + sq(q.q1) + sq(q.q2) + sq(q.q3))) * 0.5f;
+    q.q0 *= normScale;
+    q.q1 *= normScale;
+    q.q2 *= normScale;
+    q.q3 *= normScale;
+
+    orientation = q;
+
+    if (!imuValidateQuaternion(&q)) {
+        return false;
+    }
+
+    imuQuaternionToRotationMatrix(&q);
+    return true;
+}
+
 static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVector3_t * accBF, const fpVector3_t * magBF, const fpVector3_t * vCOG, const fpVector3_t * vCOGAcc, float accWScaler, float magWScaler)
 {
     STATIC_FASTRAM fpVector3_t vGyroDriftEstimate = { 0 };
@@ -407,7 +499,7 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
 
             // (hx; hy; 0) - measured mag field vector in EF (assuming Z-component is zero)
             // This should yield direction to magnetic North (1; 0; 0)
-            quaternionRotateVectorInv(&vMag, magBF, &orientation);    // BF -> EF
+            imuRotateVectorBodyToEarth(&vMag, magBF);
 
             // Ignore magnetic inclination
             vMag.z = 0.0f;
@@ -428,7 +520,7 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
                 vectorCrossProduct(&vMagErr, &vMag, &vCorrectedMagNorth);
 
                 // Rotate error back into body frame
-                quaternionRotateVector(&vMagErr, &vMagErr, &orientation);
+                imuRotateVectorEarthToBody(&vMagErr, &vMagErr);
             }
         }
         if (vCOG || vCOGAcc) {
@@ -442,7 +534,7 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
             }
             fpVector3_t vHeadingEF;
             // Rotate Forward vector from BF to EF - will yield Heading vector in Earth frame
-            quaternionRotateVectorInv(&vHeadingEF, &vForward, &orientation);
+            imuRotateVectorBodyToEarth(&vHeadingEF, &vForward);
             if (vCOG) {
                 vCoGlocal = *vCOG;
                 float airSpeed = gpsSol.groundSpeed;
@@ -487,7 +579,7 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
                 vectorCrossProduct(&vCoGErr, &vCoGlocal, &vHeadingEF);
 
                 // Rotate error back into body frame
-                quaternionRotateVector(&vCoGErr, &vCoGErr, &orientation);
+                imuRotateVectorEarthToBody(&vCoGErr, &vCoGErr);
             }
         }
         fpVector3_t vErr = { .v = { 0.0f, 0.0f, 0.0f } };
@@ -557,57 +649,12 @@ static void imuMahonyAHRSupdate(float dt, const fpVector3_t * gyroBF, const fpVe
     // Apply gyro drift correction
     vectorAdd(&vRotation, &vRotation, &vGyroDriftEstimate);
 
-    // Integrate rate of change of quaternion
-    fpVector3_t vTheta;
-    fpQuaternion_t deltaQ;
-
-    vectorScale(&vTheta, &vRotation, 0.5f * dt);
-    quaternionInitFromVector(&deltaQ, &vTheta);
-    const float thetaMagnitudeSq = vectorNormSquared(&vTheta);
-
-    // If calculated rotation is zero - don't update quaternion
-    if (thetaMagnitudeSq >= 1e-20f) {
-        // Calculate quaternion delta:
-        // Theta is a axis/angle rotation. Direction of a vector is axis, magnitude is angle/2.
-        // Proper quaternion from axis/angle involves computing sin/cos, but the formula becomes numerically unstable as Theta approaches zero.
-        // For near-zero cases we use the first 3 terms of the Taylor series expansion for sin/cos. We check if fourth term is less than machine precision -
-        // then we can safely use the "low angle" approximated version without loss of accuracy.
-        /* Opt 2: original condition was "thetaMagnitudeSq < sqrt(24e-6)".
-         * Squaring both sides (both are non-negative) gives an equivalent
-         * condition without a sqrt() call: thetaMagnitudeSq² < 24e-6. */
-        if (thetaMagnitudeSq * thetaMagnitudeSq < 24.0e-6f) {
-            quaternionScale(&deltaQ, &deltaQ, 1.0f - thetaMagnitudeSq / 6.0f);
-            deltaQ.q0 = 1.0f - thetaMagnitudeSq / 2.0f;
-        }
-        else {
-            const float thetaMagnitude = fast_fsqrtf(thetaMagnitudeSq);
-            quaternionScale(&deltaQ, &deltaQ, sin_approx(thetaMagnitude) / thetaMagnitude);
-            deltaQ.q0 = cos_approx(thetaMagnitude);
-        }
-
-        // Calculate final orientation and renormalize
-        quaternionMultiply(&orientation, &orientation, &deltaQ);
-        /* Opt 3: first-order Newton renormalization avoids sqrt() and 4 divides.
-         * At 1 kHz the quaternion norm drifts by < 1e-6 per step, so normSq = 1 + ε
-         * with |ε| ≪ 1.  The identity 1/sqrt(x) ≈ (3-x)/2 is accurate to O(ε²) ≈ 1e-12
-         * — well within float precision.  imuCheckAndResetOrientationQuaternion() below
-         * catches any catastrophic norm deviation that this approximation cannot correct. */
-        {
-            const float normSq = orientation.q0 * orientation.q0 + orientation.q1 * orientation.q1
-                               + orientation.q2 * orientation.q2 + orientation.q3 * orientation.q3;
-            const float scale = (3.0f - normSq) * 0.5f;
-            orientation.q0 *= scale;
-            orientation.q1 *= scale;
-            orientation.q2 *= scale;
-            orientation.q3 *= scale;
-        }
+    // Integrate rate of change of quaternion, renormalize and update rMat
+    if (!imuIntegrateOrientation(&vRotation, dt)) {
+        // Invalid quaternion, reset to previous known good one
+        imuCheckAndResetOrientationQuaternion(&prevOrientation, accBF);
+        imuComputeRotationMatrix();
     }
-
-    // Check for invalid quaternion and reset to previous known good one
-    imuCheckAndResetOrientationQuaternion(&prevOrientation, accBF);
-
-    // Pre-compute rotation matrix from quaternion
-    imuComputeRotationMatrix();
 }
 
 STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
@@ -716,7 +763,7 @@ static void imuCalculateGPSacceleration(fpVector3_t *vEstAccelEF,fpVector3_t *vE
         vEstAccelEF->y = (currentGPSvel.y - lastGPSvel.y) / (MS2S(time_delta_ms));
         vEstAccelEF->z = (currentGPSvel.z - lastGPSvel.z) / (MS2S(time_delta_ms));
         // Calculate estimated centrifugal accleration vector in body frame
-        quaternionRotateVector(vEstcentrifugalAccelBF, vEstAccelEF, &orientation); // EF -> BF
+        imuRotateVectorEarthToBody(vEstcentrifugalAccelBF, vEstAccelEF);
         lastGPSNewDataTime = currenttime;
         lastGPSvel = currentGPSvel;
     }
@@ -787,6 +834,7 @@ void imuUpdateTailSitter(void)
     if (((bool)STATE(TAILSITTER)) != lastTailSitter) {
         fpQuaternion_t* rotation_for_tailsitter= getTailSitterQuaternion(STATE(TAILSITTER));
         quaternionMultiply(&orientation, &orientation, rotation_for_tailsitter);
+        imuComputeRotationMatrix();
     }
     lastTailSitter = STATE(TAILSITTER);
 }
@@ -48,6 +48,7 @@
 #include "flight/failsafe.h"
 #include "flight/imu.h"
 #include "flight/mixer.h"
+#include "flight/motor_mix.h"
 #include "flight/pid.h"
 #include "flight/servos.h"
 
@@ -65,6 +66,7 @@ FASTRAM int16_t motor_disarmed[MAX_SUPPORTED_MOTORS];
 static float motorMixRange;
 static float mixerScale = 1.0f;
 static EXTENDED_FASTRAM motorMixer_t currentMixer[MAX_SUPPORTED_MOTORS];
+static EXTENDED_FASTRAM motorMix_t motorMix;
 static EXTENDED_FASTRAM uint8_t motorCount = 0;
 EXTENDED_FASTRAM int mixerThrottleCommand;
 static EXTENDED_FASTRAM int throttleIdleValue = 0;
@@ -93,6 +95,9 @@ PG_RESET_TEMPLATE(motorConfig_t, motorConfig,
     .motorPwmRate = SETTING_MOTOR_PWM_RATE_DEFAULT,
     .mincommand = SETTING_MIN_COMMAND_DEFAULT,
     .motorPoleCount = SETTING_MOTOR_POLES_DEFAULT,            // Most brushless motors that we use are 14 poles
+#ifdef USE_DSHOT_TELEMETRY
+    .dshotBidirectional = SETTING_DSHOT_BIDIR_DEFAULT,
+#endif
 );
 PG_REGISTER_ARRAY_WITH_RESET_FN(timerOverride_t, HARDWARE_TIMER_DEFINITION_COUNT, timerOverrides, PG_TIMER_OVERRIDE_CONFIG, 0);
 
@@ -219,22 +224,24 @@ void nullMotorRateLimiting(const float dT)
 void mixerInit(void)
 {
     computeMotorCount();
-    loadPrimaryMotorMixer();
     // in 3D mode, mixer gain has to be halved
     if (feature(FEATURE_REVERSIBLE_MOTORS)) {
         mixerScale = 0.5f;
     }
 
-    throttleDeadbandLow = PWM_RANGE_MIDDLE - rcControlsConfig()->mid_throttle_deadband;
-    throttleDeadbandHigh = PWM_RANGE_MIDDLE + rcControlsConfig()->mid_throttle_deadband;
-
-    mixerResetDisarmedMotors();
-
     if (currentMixerConfig.motorDirectionInverted) {
         motorYawMultiplier = -1;
     } else {
         motorYawMultiplier = 1;
     }
+
+    // Scale and yaw direction are folded into the precomputed mix
+    loadPrimaryMotorMixer();
+
+    throttleDeadbandLow = PWM_RANGE_MIDDLE - rcControlsConfig()->mid_throttle_deadband;
+    throttleDeadbandHigh = PWM_RANGE_MIDDLE + rcControlsConfig()->mid_throttle_deadband;
+
+    mixerResetDisarmedMotors();
 }
 
 void mixerResetDisarmedMotors(void)
@@ -529,21 +536,7 @@ void FAST_CODE mixTable(void)
 
     // Initial mixer concept by bdoiron74 reused and optimized for Air Mode
     int16_t rpyMix[MAX_SUPPORTED_MOTORS];
-    int16_t rpyMixMax = 0; // assumption: symetrical about zero.
-    int16_t rpyMixMin = 0;
-
-    // motors for non-servo mixes
-    for (int i = 0; i < motorCount; i++) {
-        rpyMix[i] =
-            (input[PITCH] * currentMixer[i].pitch +
-            input[ROLL] * currentMixer[i].roll +
-            -motorYawMultiplier * input[YAW] * currentMixer[i].yaw) * mixerScale;
-
-        if (rpyMix[i] > rpyMixMax) rpyMixMax = rpyMix[i];
-        if (rpyMix[i] < rpyMixMin) rpyMixMin = rpyMix[i];
-    }
-
-    int16_t rpyMixRange = rpyMixMax - rpyMixMin;
+    const int16_t rpyMixRange = motorMixRpy(&motorMix, input, rpyMix);
     int16_t throttleRange;
     int16_t throttleMin, throttleMax;
 
@@ -610,10 +603,6 @@ void FAST_CODE mixTable(void)
     #define THROTTLE_CLIPPING_FACTOR    0.33f
     motorMixRange = (float)rpyMixRange / (float)throttleRange;
     if (motorMixRange > 1.0f) {
-        for (int i = 0; i < motorCount; i++) {
-            rpyMix[i] /= motorMixRange;
-        }
-
         // Allow some clipping on edges to soften correction response
         throttleMin = throttleMin + (throttleRange / 2) - (throttleRange * THROTTLE_CLIPPING_FACTOR / 2);
         throttleMax = throttleMin + (throttleRange / 2) + (throttleRange * THROTTLE_CLIPPING_FACTOR / 2);
@@ -624,25 +613,20 @@ void FAST_CODE mixTable(void)
 
     // Now add in the desired throttle, but keep in a range that doesn't clip adjusted
     // roll/pitch/yaw. This could move throttle down, but also up for those low throttle flips.
-    for (int i = 0; i < motorCount; i++) {
-        motor[i] = rpyMix[i] + constrain(mixerThrottleCommand * currentMixer[i].throttle, throttleMin, throttleMax);
-
-        if (failsafeIsActive()) {
-            motor[i] = constrain(motor[i], motorConfig()->mincommand, getMaxThrottle());
-        } else {
-            motor[i] = constrain(motor[i], throttleRangeMin, throttleRangeMax);
-        }
-
-        //stop motors
-        if (currentMixer[i].throttle <= 0.0f) {
-            motor[i] = motorZeroCommand;
-        }
+    const bool isFailsafeActive = failsafeIsActive();
+    const motorMixLimits_t limits = {
+        .throttleMin = throttleMin,
+        .throttleMax = throttleMax,
+        .outputMin = isFailsafeActive ? motorConfig()->mincommand : throttleRangeMin,
+        .outputMax = isFailsafeActive ? getMaxThrottle() : throttleRangeMax,
+        .transitionMin = throttleRangeMin,
+        .transitionMax = throttleRangeMax,
+        .stopValue = motorZeroCommand,
         //spin stopped motors only in mixer transition mode
-        if (isMixerTransitionMixing && currentMixer[i].throttle <= -1.05f && currentMixer[i].throttle >= -2.0f && !feature(FEATURE_REVERSIBLE_MOTORS)) {
-            motor[i] = -currentMixer[i].throttle * 1000;
-            motor[i] = constrain(motor[i], throttleRangeMin, throttleRangeMax);
-        }
-    }
+        .transitionSpin = isMixerTransitionMixing && !feature(FEATURE_REVERSIBLE_MOTORS),
+    };
+
+    motorMixOutput(&motorMix, rpyMix, motorMixRange, mixerThrottleCommand, &limits, motor);
 }
 
 int16_t getThrottlePercent(bool useScaled)
@@ -707,6 +691,7 @@ void loadPrimaryMotorMixer(void) {
     for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
         currentMixer[i] = *primaryMotorMixer(i);
     }
+    motorMixInit(&motorMix, currentMixer, motorCount, mixerScale, motorYawMultiplier);
 }
 
 bool areMotorsRunning(void)
@@ -86,6 +86,9 @@ typedef struct motorConfig_s {
     uint8_t  motorPwmProtocol;
     uint16_t digitalIdleOffsetValue;
     uint8_t motorPoleCount;                 // Magnetic poles in the motors for calculating actual RPM from eRPM provided by ESC telemetry
+#ifdef USE_DSHOT_TELEMETRY
+    bool dshotBidirectional;                // ESCs reply with eRPM on the signal wire after every DShot frame
+#endif
 } motorConfig_t;
 
 PG_DECLARE(motorConfig_t, motorConfig);
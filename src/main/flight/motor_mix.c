@@ -0,0 +1,84 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "flight/motor_mix.h"
+
+void motorMixInit(motorMix_t *mix, const motorMixer_t *mixers, uint8_t count, float scale, int8_t yawMultiplier)
+{
+    memset(mix, 0, sizeof(*mix));
+    mix->count = MIN(count, MAX_SUPPORTED_MOTORS);
+
+    // The scale is 1 or 0.5 and the yaw multiplier +-1, folding them in does not change rounding
+    for (int i = 0; i < mix->count; i++) {
+        mix->roll[i] = mixers[i].roll * scale;
+        mix->pitch[i] = mixers[i].pitch * scale;
+        mix->yaw[i] = -yawMultiplier * mixers[i].yaw * scale;
+        mix->throttle[i] = mixers[i].throttle;
+        mix->stopped[i] = mixers[i].throttle <= 0.0f;
+        if (mixers[i].throttle <= -1.05f && mixers[i].throttle >= -2.0f) {
+            mix->transitionOutput[i] = -mixers[i].throttle * 1000;
+        }
+    }
+}
+
+// Mixes the RPY inputs into rpyMix, returns the spread of the mix (assumed symmetrical about zero)
+int16_t FAST_CODE motorMixRpy(const motorMix_t *mix, const int16_t input[3], int16_t *rpyMix)
+{
+    const float inputRoll = input[FD_ROLL];
+    const float inputPitch = input[FD_PITCH];
+    const float inputYaw = input[FD_YAW];
+    int16_t rpyMixMax = 0;
+    int16_t rpyMixMin = 0;
+
+    for (int i = 0; i < mix->count; i++) {
+        rpyMix[i] = inputPitch * mix->pitch[i] + inputRoll * mix->roll[i] + inputYaw * mix->yaw[i];
+        rpyMixMax = MAX(rpyMixMax, rpyMix[i]);
+        rpyMixMin = MIN(rpyMixMin, rpyMix[i]);
+    }
+
+    return rpyMixMax - rpyMixMin;
+}
+
+// Scales the RPY mix down when it does not fit in the throttle range, adds throttle and limits the outputs
+void FAST_CODE motorMixOutput(const motorMix_t *mix, const int16_t *rpyMix, float mixRange, int throttleCommand, const motorMixLimits_t *limits, int16_t *output)
+{
+    // Dividing by 1 is exact, so the loop does not branch on the mix range
+    const float rpyDivisor = mixRange > 1.0f ? mixRange : 1.0f;
+
+    for (int i = 0; i < mix->count; i++) {
+        const int16_t rpy = rpyMix[i] / rpyDivisor;
+        int16_t value = rpy + constrain(throttleCommand * mix->throttle[i], limits->throttleMin, limits->throttleMax);
+
+        value = constrain(value, limits->outputMin, limits->outputMax);
+        value = mix->stopped[i] ? limits->stopValue : value;
+        if (limits->transitionSpin && mix->transitionOutput[i]) {
+            value = constrain(mix->transitionOutput[i], limits->transitionMin, limits->transitionMax);
+        }
+
+        output[i] = value;
+    }
+}
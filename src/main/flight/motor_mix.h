@@ -0,0 +1,53 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "flight/mixer.h"
+
+/*
+ * Motor mixer matrix in struct-of-arrays layout, built when the mixer is
+ * loaded. The mixer scale and yaw direction are folded into the coefficients
+ * so the per-loop mix is a plain multiply-add over contiguous arrays.
+ */
+typedef struct motorMix_s {
+    float roll[MAX_SUPPORTED_MOTORS];
+    float pitch[MAX_SUPPORTED_MOTORS];
+    float yaw[MAX_SUPPORTED_MOTORS];
+    float throttle[MAX_SUPPORTED_MOTORS];
+    int16_t transitionOutput[MAX_SUPPORTED_MOTORS];    // Output while spinning up for a mixer transition, 0 if the motor does not spin
+    bool stopped[MAX_SUPPORTED_MOTORS];                 // Motor has no throttle and always outputs the stop value
+    uint8_t count;
+} motorMix_t;
+
+typedef struct motorMixLimits_s {
+    int16_t throttleMin;        // Throttle range left after the RPY correction
+    int16_t throttleMax;
+    int16_t outputMin;          // Motor output range
+    int16_t outputMax;
+    int16_t transitionMin;      // Range of the transition spin output
+    int16_t transitionMax;
+    int16_t stopValue;
+    bool transitionSpin;        // Spin the motors flagged for mixer transition
+} motorMixLimits_t;
+
+void motorMixInit(motorMix_t *mix, const motorMixer_t *mixers, uint8_t count, float scale, int8_t yawMultiplier);
+int16_t motorMixRpy(const motorMix_t *mix, const int16_t input[3], int16_t *rpyMix);
+void motorMixOutput(const motorMix_t *mix, const int16_t *rpyMix, float mixRange, int throttleCommand, const motorMixLimits_t *limits, int16_t *output);
@@ -48,6 +48,7 @@
 #include "flight/kalman.h"
 #include "flight/smith_predictor.h"
 #include "flight/adaptive_filter.h"
+#include "flight/sysid.h"
 
 #include "io/gps.h"
 
@@ -171,6 +172,9 @@ static EXTENDED_FASTRAM pidControllerFnPtr pidControllerApplyFn;
 static EXTENDED_FASTRAM filterApplyFnPtr dTermLpfFilterApplyFn;
 static EXTENDED_FASTRAM bool restartAngleHoldMode = true;
 static EXTENDED_FASTRAM bool angleHoldIsLevel = false;
+#ifdef USE_SYSID
+static EXTENDED_FASTRAM bool sysidRequested = false;
+#endif
 
 #define FIXED_WING_LEVEL_TRIM_MAX_ANGLE 10.0f // Max angle auto trimming can demand
 #define FIXED_WING_LEVEL_TRIM_DIVIDER 50.0f
@@ -1220,6 +1224,53 @@ void updateAngleHold(float *angleTarget, uint8_t axis)
     }
 }
 
+#ifdef USE_SYSID
+/*
+ * The rate controller of the excited axis is handed over at the start, the
+ * analysis needs it to separate the plant from the closed loop response
+ */
+static void pidSysidStart(flight_dynamics_index_t axis, float dT)
+{
+    const pidState_t *state = &pidState[axis];
+    const pid8_t *gains = &pidBank()->pid[axis];
+    sysidController_t controller = {
+        .kP = state->kP,
+        .kI = state->kI,
+        .d = gains->D,
+        .ff = gains->FF,
+        .ffIsDerivative = usedPidControllerType != PID_TYPE_PIFF,
+        .dtermLpfType = pidProfile()->dterm_lpf_type,
+        .dtermLpfHz = pidProfile()->dterm_lpf_hz,
+        .ffLpfHz = pidProfile()->controlDerivativeLpfHz,
+    };
+
+    // Gain of one configured unit, TPA included
+    controller.kDPerUnit = gains->D ? state->kD / gains->D : 1.0f / FP_PID_RATE_D_MULTIPLIER;
+    if (controller.ffIsDerivative) {
+        controller.kFFPerUnit = gains->FF ? state->kCD * US2S(getLooptime()) / gains->FF : 1.0f / FP_PID_RATE_D_FF_MULTIPLIER;
+    } else {
+        controller.kFFPerUnit = gains->FF ? state->kFF / gains->FF : 1.0f / FP_PID_RATE_FF_MULTIPLIER;
+    }
+
+    sysidStart(&controller, 1.0f / dT);
+}
+
+// Starts on the rising edge of SYSTEM ID, returns true while the excitation runs
+static bool pidUpdateSysid(float dT)
+{
+    const bool requested = ARMING_FLAG(ARMED) && IS_RC_MODE_ACTIVE(BOXSYSID) && !FLIGHT_MODE(FAILSAFE_MODE) && !FLIGHT_MODE(MANUAL_MODE);
+
+    if (requested && !sysidRequested) {
+        pidSysidStart(sysidConfig()->axis, dT);
+    } else if (!requested) {
+        sysidStop();
+    }
+    sysidRequested = requested;
+
+    return sysidIsRunning();
+}
+#endif
+
 void FAST_CODE pidController(float dT)
 {
     const float dT_inv = 1.0f / dT;
@@ -1315,16 +1366,34 @@ void FAST_CODE pidController(float dT)
     // Prevent strong Iterm accumulation during stick inputs
     antiWindupScaler = constrainf((1.0f - getMotorMixRange()) * motorItermWindupPoint, 0.0f, 1.0f);
 
+#ifdef USE_SYSID
+    const bool sysidActive = pidUpdateSysid(dT);
+    const int sysidAxis = sysidConfig()->axis;
+#endif
+
     for (int axis = 0; axis < 3; axis++) {
         // Apply setpoint rate of change limits
         pidApplySetpointRateLimiting(&pidState[axis], axis, dT);
 
+#ifdef USE_SYSID
+        // Excitation goes in after the rate limits so it reaches the controller unchanged
+        if (sysidActive && axis == sysidAxis) {
+            pidState[axis].rateTarget += sysidGetExcitation();
+        }
+#endif
+
         // Step 4: Run gyro-driven control
         checkItermLimitingActive(&pidState[axis]);
         checkItermFreezingActive(&pidState[axis], axis);
 
         pidControllerApplyFn(&pidState[axis], dT, dT_inv);
     }
+
+#ifdef USE_SYSID
+    if (sysidActive) {
+        sysidPushSample(pidState[sysidAxis].rateTarget, pidState[sysidAxis].gyroRate);
+    }
+#endif
 }
 
 pidType_e pidIndexGetType(pidIndex_e pidIndex)
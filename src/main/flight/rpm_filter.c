@@ -35,6 +35,7 @@
 #include "common/utils.h"
 #include "common/maths.h"
 #include "common/filter.h"
+#include "drivers/dshot_telemetry.h"
 #include "flight/mixer.h"
 #include "sensors/esc_sensor.h"
 #include "fc/config.h"
@@ -70,6 +71,10 @@ static EXTENDED_FASTRAM pt1Filter_t motorFrequencyFilter[MAX_SUPPORTED_MOTORS];
 static EXTENDED_FASTRAM rpmFilterBank_t gyroRpmFilters;
 static EXTENDED_FASTRAM rpmFilterApplyFnPtr rpmGyroApplyFn;
 static EXTENDED_FASTRAM rpmFilterUpdateFnPtr rpmGyroUpdateFn;
+#ifdef USE_DSHOT_TELEMETRY
+static EXTENDED_FASTRAM bool rpmFilterUseDshotTelemetry;
+static EXTENDED_FASTRAM float dshotErpmToHz;
+#endif
 
 float nullRpmFilterApply(rpmFilterBank_t *filter, uint8_t axis, float input)
 {
@@ -140,28 +145,55 @@ void disableRpmFilters(void) {
 
 void rpmFilterUpdate(rpmFilterBank_t *filterBank, uint8_t motor, float baseFrequency)
 {
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++)
+    for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++)
     {
-        for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++)
+        float harmonicFrequency = baseFrequency * (harmonicIndex + 1);
+        harmonicFrequency = constrainf(harmonicFrequency, filterBank->minHz, filterBank->maxHz);
+
+        biquadFilter_t *notch = &filterBank->filters[FD_ROLL][motor][harmonicIndex];
+        biquadFilterUpdate(
+            notch,
+            harmonicFrequency,
+            getLooptime(),
+            filterBank->q,
+            FILTER_NOTCH);
+
+        /*
+         * Notch of a motor harmonic is the same on all axes, compute the
+         * coefficients once and only keep the per axis filter state
+         */
+        for (int axis = FD_PITCH; axis < XYZ_AXIS_COUNT; axis++)
         {
-            float harmonicFrequency = baseFrequency * (harmonicIndex + 1);
-            harmonicFrequency = constrainf(harmonicFrequency, filterBank->minHz, filterBank->maxHz);
-
-            biquadFilterUpdate(
-                &filterBank->filters[axis][motor][harmonicIndex],
-                harmonicFrequency,
-                getLooptime(),
-                filterBank->q,
-                FILTER_NOTCH);
+            biquadFilter_t *filter = &filterBank->filters[axis][motor][harmonicIndex];
+            filter->b0 = notch->b0;
+            filter->b1 = notch->b1;
+            filter->b2 = notch->b2;
+            filter->a1 = notch->a1;
+            filter->a2 = notch->a2;
         }
     }
 }
 
 void rpmFiltersInit(void)
 {
+    float updateIntervalUs = RPM_FILTER_UPDATE_RATE_US;
+
+#ifdef USE_DSHOT_TELEMETRY
+    /*
+     * Bidirectional DShot delivers eRPM with every motor update, the notches
+     * are then moved from the PID loop instead of the RPM task
+     */
+    rpmFilterUseDshotTelemetry = dshotTelemetryIsActive();
+    if (rpmFilterUseDshotTelemetry)
+    {
+        updateIntervalUs = getLooptime();
+        dshotErpmToHz = ERPM_PER_LSB / 60.0f / MAX(motorConfig()->motorPoleCount / 2, 1);
+    }
+#endif
+
     for (uint8_t i = 0; i < MAX_SUPPORTED_MOTORS; i++)
     {
-        pt1FilterInit(&motorFrequencyFilter[i], RPM_FILTER_RPM_LPF_HZ, US2S(RPM_FILTER_UPDATE_RATE_US));
+        pt1FilterInit(&motorFrequencyFilter[i], RPM_FILTER_RPM_LPF_HZ, US2S(updateIntervalUs));
     }
 
     rpmGyroUpdateFn = (rpmFilterUpdateFnPtr)nullRpmFilterUpdate;
@@ -195,6 +227,24 @@ void rpmFilterUpdateTask(timeUs_t currentTimeUs)
     }
 }
 
+#ifdef USE_DSHOT_TELEMETRY
+void rpmFilterDshotTelemetryUpdate(void)
+{
+    if (!rpmFilterUseDshotTelemetry)
+    {
+        return;
+    }
+
+    const uint8_t motorCount = getMotorCount();
+    for (uint8_t i = 0; i < motorCount; i++)
+    {
+        const float baseFrequency = pt1FilterApply(&motorFrequencyFilter[i], getDshotTelemetry(i) * dshotErpmToHz);
+
+        rpmGyroUpdateFn(&gyroRpmFilters, i, baseFrequency);
+    }
+}
+#endif
+
 float rpmFilterGyroApply(uint8_t axis, float input)
 {
     return rpmGyroApplyFn(&gyroRpmFilters, axis, input);
@@ -49,4 +49,5 @@ PG_DECLARE(rpmFilterConfig_t, rpmFilterConfig);
 void disableRpmFilters(void);
 void rpmFiltersInit(void);
 void rpmFilterUpdateTask(timeUs_t currentTimeUs);
+void rpmFilterDshotTelemetryUpdate(void);
 float rpmFilterGyroApply(uint8_t axis, float input);
\ No newline at end of file
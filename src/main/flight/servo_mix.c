@@ -0,0 +1,109 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/filter.h"
+#include "common/utils.h"
+
+#include "flight/servo_mix.h"
+
+// Rules with an out of range target or input are dropped instead of indexing past the arrays
+void servoMixCompile(servoMix_t *mix, const servoMixer_t *mixers, uint8_t count, const int16_t *input, rateLimitFilter_t *speedLimitFilters)
+{
+    memset(mix, 0, sizeof(*mix));
+
+    for (int i = 0; i < count; i++) {
+        const servoMixer_t *mixer = &mixers[i];
+
+        if (mixer->targetChannel >= MAX_SUPPORTED_SERVOS || mixer->inputSource >= INPUT_SOURCE_COUNT) {
+            continue;
+        }
+
+        servoMixRule_t rule = {
+            .input = &input[mixer->inputSource],
+            .speedLimitFilter = mixer->speed ? &speedLimitFilters[i] : NULL,
+            .speedLimit = mixer->speed * 10,
+            .rate = mixer->rate,
+            .target = mixer->targetChannel,
+            .condition = SERVO_MIX_CONDITION_NONE,
+        };
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+        if (mixer->conditionId >= 0) {
+            rule.condition = 0;
+            while (rule.condition < mix->conditionCount && mix->conditionIds[rule.condition] != mixer->conditionId) {
+                rule.condition++;
+            }
+            if (rule.condition == mix->conditionCount) {
+                mix->conditionIds[mix->conditionCount++] = mixer->conditionId;
+            }
+        }
+#endif
+
+        // Insertion sort by target, rules of the same servo keep their order
+        int j = mix->ruleCount++;
+        while (j > 0 && mix->rules[j - 1].target > rule.target) {
+            mix->rules[j] = mix->rules[j - 1];
+            j--;
+        }
+        mix->rules[j] = rule;
+    }
+}
+
+// conditionActive holds the state of mix->conditionIds, it is not used without the programming framework
+void FAST_CODE servoMixApply(const servoMix_t *mix, const bool *conditionActive, float dT, int16_t *output)
+{
+#ifndef USE_PROGRAMMING_FRAMEWORK
+    UNUSED(conditionActive);
+#endif
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        output[i] = 0;
+    }
+
+    for (int i = 0; i < mix->ruleCount; i++) {
+        const servoMixRule_t *rule = &mix->rules[i];
+
+        int16_t inputLimited = *rule->input;
+
+        /*
+         * Check if conditions for a rule are met, not all conditions apply all the time
+         */
+#ifdef USE_PROGRAMMING_FRAMEWORK
+        if (rule->condition != SERVO_MIX_CONDITION_NONE && !conditionActive[rule->condition]) {
+            inputLimited = 0;
+        }
+#endif
+        /*
+         * Apply mixer speed limit. 1 [one] speed unit is defined as 10us/s:
+         * 0 = no limiting
+         * 1 = 10us/s -> full servo sweep (from 1000 to 2000) is performed in 100s
+         * 10 = 100us/s -> full sweep (from 1000 to 2000)  is performed in 10s
+         * 100 = 1000us/s -> full sweep in 1s
+         */
+        if (rule->speedLimitFilter) {
+            inputLimited = (int16_t) rateLimitFilterApply4(rule->speedLimitFilter, inputLimited, rule->speedLimit, dT);
+        }
+
+        output[rule->target] += ((int32_t)inputLimited * rule->rate) / 100;
+    }
+}
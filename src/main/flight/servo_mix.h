@@ -0,0 +1,53 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/filter.h"
+
+#include "flight/servos.h"
+
+#define SERVO_MIX_CONDITION_NONE    0xFF
+
+/*
+ * Servo rules compiled when the mixer is loaded: input sources are resolved
+ * to pointers, rules are sorted by target servo and each distinct logic
+ * condition gets one slot, so it is evaluated once per loop.
+ */
+typedef struct servoMixRule_s {
+    const int16_t *input;
+    rateLimitFilter_t *speedLimitFilter;    // NULL when the speed is not limited
+    float speedLimit;                       // us/s
+    int16_t rate;
+    uint8_t target;
+    uint8_t condition;                      // index into conditionIds
+} servoMixRule_t;
+
+typedef struct servoMix_s {
+    servoMixRule_t rules[MAX_SERVO_RULES];
+    uint8_t ruleCount;
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    int8_t conditionIds[MAX_SERVO_RULES];
+    uint8_t conditionCount;
+#endif
+} servoMix_t;
+
+void servoMixCompile(servoMix_t *mix, const servoMixer_t *mixers, uint8_t count, const int16_t *input, rateLimitFilter_t *speedLimitFilters);
+void servoMixApply(const servoMix_t *mix, const bool *conditionActive, float dT, int16_t *output);
@@ -52,6 +52,7 @@
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
+#include "flight/servo_mix.h"
 #include "flight/servos.h"
 
 #include "io/gps.h"
@@ -124,6 +125,9 @@ static bool servoFilterIsSet;
 static servoMetadata_t servoMetadata[MAX_SUPPORTED_SERVOS];
 static rateLimitFilter_t servoSpeedLimitFilter[MAX_SERVO_RULES];
 
+static int16_t servoMixInput[INPUT_SOURCE_COUNT]; // Range [-500:+500]
+static servoMix_t servoMix;
+
 STATIC_FASTRAM pt1Filter_t rotRateFilter;
 STATIC_FASTRAM pt1Filter_t targetRateFilter;
 
@@ -251,6 +255,8 @@ void loadCustomServoMixer(void)
         servoSpeedLimitFilter[servoRuleCount].state = servoMixerSwitchHelper[i].speedLimitFilterState;
         servoRuleCount++;
     }
+
+    servoMixCompile(&servoMix, currentServoMixer, servoRuleCount, servoMixInput, servoSpeedLimitFilter);
 }
 
 static void filterServos(void)
@@ -303,7 +309,7 @@ void writeServos(void)
 
 void servoMixer(float dT)
 {
-    int16_t input[INPUT_SOURCE_COUNT]; // Range [-500:+500]
+    int16_t *input = servoMixInput;
 
     if (FLIGHT_MODE(MANUAL_MODE)) {
         input[INPUT_STABILIZED_ROLL] = rcCommand[ROLL];
@@ -435,36 +441,15 @@ void servoMixer(float dT)
         input[INPUT_RC_THROTTLE] = -500;
     }
 
-    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
-        servo[i] = 0;
+    bool conditionActive[MAX_SERVO_RULES];
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    for (int i = 0; i < servoMix.conditionCount; i++) {
+        conditionActive[i] = logicConditionGetValue(servoMix.conditionIds[i]);
     }
+#endif
 
     // mix servos according to rules
-    for (int i = 0; i < servoRuleCount; i++) {
-        const uint8_t target = currentServoMixer[i].targetChannel;
-        const uint8_t from = currentServoMixer[i].inputSource;
-
-        int16_t inputRaw = input[from];
-
-        /*
-         * Check if conditions for a rule are met, not all conditions apply all the time
-         */
-    #ifdef USE_PROGRAMMING_FRAMEWORK
-        if (!logicConditionGetValue(currentServoMixer[i].conditionId)) {
-            inputRaw = 0;
-        }
-    #endif
-        /*
-         * Apply mixer speed limit. 1 [one] speed unit is defined as 10us/s:
-         * 0 = no limiting
-         * 1 = 10us/s -> full servo sweep (from 1000 to 2000) is performed in 100s
-         * 10 = 100us/s -> full sweep (from 1000 to 2000)  is performed in 10s
-         * 100 = 1000us/s -> full sweep in 1s
-         */
-        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&servoSpeedLimitFilter[i], inputRaw, currentServoMixer[i].speed * 10, dT);
-
-        servo[target] += ((int32_t)inputLimited * currentServoMixer[i].rate) / 100;
-    }
+    servoMixApply(&servoMix, conditionActive, dT, servo);
 
     for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
 
@@ -0,0 +1,688 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Rate loop system identification. An excitation signal is added to the rate
+ * setpoint of one axis while setpoint and gyro are recorded. The closed loop
+ * response T = gyro / setpoint is estimated with Welch averaged cross spectra,
+ * then the plant is recovered using the known controller:
+ *
+ *   T = Cref * G / (1 + Cfb * G)  =>  G = T / (Cref - T * Cfb)
+ *
+ * Cfb is P + I + D (D on gyro only), Cref is P + I + FF. Open loop Cfb * G
+ * gives crossover and phase margin, and since G is known the loop can be
+ * re-evaluated with other D and FF gains to suggest better ones.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_SYSID
+
+#ifdef USE_ARM_MATH
+#include "arm_math.h"
+#endif
+
+#include "common/axis.h"
+#include "common/filter.h"
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "config/parameter_group.h"
+#include "config/parameter_group_ids.h"
+
+#include "fc/settings.h"
+
+#include "flight/sysid.h"
+
+#define SYSID_SAMPLE_SCALE      16.0f   // int16 samples in 1/16 deg/s, +-2048 deg/s
+#define SYSID_SEGMENT_HOP       (SYSID_FFT_SIZE / 2)
+#define SYSID_MIN_SEGMENTS      4
+#define SYSID_MIN_COHERENCE     0.6f
+#define SYSID_BANDWIDTH_GAIN    0.7071f // -3 dB
+#define SYSID_MAX_HZ_RATIO      0.4f    // Highest excitation frequency relative to the sample rate
+#define SYSID_PRBS_CLOCK_RATIO  2.5f    // PRBS clock relative to sysid_max_hz, -3 dB at ~0.44 x clock
+#define SYSID_D_STEPS           40
+#define SYSID_D_MIN_RANGE       40
+#define SYSID_GAIN_MAX          255
+
+PG_REGISTER_WITH_RESET_TEMPLATE(sysidConfig_t, sysidConfig, PG_SYSID_CONFIG, 0);
+
+PG_RESET_TEMPLATE(sysidConfig_t, sysidConfig,
+    .axis = SETTING_SYSID_AXIS_DEFAULT,
+    .signal = SETTING_SYSID_SIGNAL_DEFAULT,
+    .amplitude = SETTING_SYSID_AMPLITUDE_DEFAULT,
+    .minHz = SETTING_SYSID_MIN_HZ_DEFAULT,
+    .maxHz = SETTING_SYSID_MAX_HZ_DEFAULT,
+);
+
+typedef struct {
+    float re;
+    float im;
+} sysidComplex_t;
+
+typedef struct {
+    int16_t setpoint;
+    int16_t gyroRate;
+} sysidSample_t;
+
+typedef struct {
+    uint8_t signal;
+    float amplitude;
+    float dT;
+    // Chirp
+    float phase;
+    float frequency;
+    float frequencyStep;
+    // PRBS
+    uint16_t lfsr;
+    uint16_t bitCycles;
+    uint16_t bitCounter;
+} sysidExcitation_t;
+
+static sysidState_e sysidState;
+static sysidController_t sysidController;
+static sysidResult_t sysidResult;
+static sysidExcitation_t sysidExcitation;
+
+static sysidSample_t sysidSamples[SYSID_SAMPLE_COUNT];
+static uint16_t sysidSampleCount;
+static uint8_t sysidDecimation;
+static uint8_t sysidDecimationCount;
+static float sysidSetpointSum;
+static float sysidGyroSum;
+static float sysidPidRateHz;
+static float sysidSampleRateHz;
+static uint16_t sysidMinBin;
+static uint16_t sysidMaxBin;
+
+// Welch averaged spectra, conj(X) * Y for the cross spectrum
+static uint16_t sysidNextSegment;
+static float sysidSxx[SYSID_BIN_COUNT];
+static float sysidSyy[SYSID_BIN_COUNT];
+static sysidComplex_t sysidSxy[SYSID_BIN_COUNT];
+static bool sysidBinValid[SYSID_BIN_COUNT];
+
+// FFT buffers are free once all segments are in, the loop model reuses them
+static union {
+    struct {
+        float input[SYSID_FFT_SIZE];
+        float setpoint[SYSID_FFT_SIZE];
+        float gyroRate[SYSID_FFT_SIZE];
+    } fft;
+    struct {
+        sysidComplex_t plant[SYSID_BIN_COUNT];
+        sysidComplex_t proportionalIntegral[SYSID_BIN_COUNT];
+        sysidComplex_t derivativePerUnit[SYSID_BIN_COUNT];
+    } model;
+} sysidWork;
+
+#ifdef USE_ARM_MATH
+static arm_rfft_fast_instance_f32 sysidFftInstance;
+#else
+static float sysidFftComplex[2 * SYSID_FFT_SIZE];
+#endif
+
+static sysidComplex_t complexMul(sysidComplex_t a, sysidComplex_t b)
+{
+    return (sysidComplex_t) { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+}
+
+static sysidComplex_t complexDiv(sysidComplex_t a, sysidComplex_t b)
+{
+    const float norm = sq(b.re) + sq(b.im);
+    return (sysidComplex_t) { (a.re * b.re + a.im * b.im) / norm, (a.im * b.re - a.re * b.im) / norm };
+}
+
+static sysidComplex_t complexAdd(sysidComplex_t a, sysidComplex_t b)
+{
+    return (sysidComplex_t) { a.re + b.re, a.im + b.im };
+}
+
+static sysidComplex_t complexScale(sysidComplex_t a, float k)
+{
+    return (sysidComplex_t) { a.re * k, a.im * k };
+}
+
+static float complexAbs(sysidComplex_t a)
+{
+    return sqrtf(sq(a.re) + sq(a.im));
+}
+
+static float complexArgDegrees(sysidComplex_t a)
+{
+    return RADIANS_TO_DEGREES(atan2_approx(a.im, a.re));
+}
+
+/*
+ * Real FFT with the CMSIS packed output: out[0] = DC, out[1] = Nyquist,
+ * then real and imaginary parts of bins 1..N/2-1. The input is destroyed.
+ */
+#ifdef USE_ARM_MATH
+static void sysidRfft(float *in, float *out)
+{
+    arm_rfft_fast_f32(&sysidFftInstance, in, out, 0);
+}
+#else
+// Radix-2 complex FFT of the real input, for targets without CMSIS DSP
+static void sysidRfft(float *in, float *out)
+{
+    float *data = sysidFftComplex;
+
+    for (int i = 0, j = 0; i < SYSID_FFT_SIZE; i++) {
+        data[2 * j] = in[i];
+        data[2 * j + 1] = 0;
+
+        // Bit reversed index for the next sample
+        int bit = SYSID_FFT_SIZE >> 1;
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+
+    for (int len = 2; len <= SYSID_FFT_SIZE; len <<= 1) {
+        const float angle = -2.0f * M_PIf / len;
+        for (int k = 0; k < len / 2; k++) {
+            const float wr = cosf(angle * k);
+            const float wi = sinf(angle * k);
+            for (int i = k; i < SYSID_FFT_SIZE; i += len) {
+                float *a = &data[2 * i];
+                float *b = &data[2 * (i + len / 2)];
+                const float tr = b[0] * wr - b[1] * wi;
+                const float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+
+    out[0] = data[0];
+    out[1] = data[SYSID_FFT_SIZE];
+    for (int k = 1; k < SYSID_BIN_COUNT; k++) {
+        out[2 * k] = data[2 * k];
+        out[2 * k + 1] = data[2 * k + 1];
+    }
+}
+#endif
+
+static int16_t sysidQuantize(float rate)
+{
+    return constrainf(rate * SYSID_SAMPLE_SCALE, INT16_MIN, INT16_MAX);
+}
+
+void sysidStart(const sysidController_t *controller, float pidRateHz)
+{
+    sysidController = *controller;
+    sysidPidRateHz = pidRateHz;
+    sysidDecimation = constrain(lrintf(pidRateHz / SYSID_SAMPLE_RATE_HZ), 1, UINT8_MAX);
+    sysidSampleRateHz = pidRateHz / sysidDecimation;
+
+    const float maxHz = MIN(sysidConfig()->maxHz, sysidSampleRateHz * SYSID_MAX_HZ_RATIO);
+    const float minHz = MIN(sysidConfig()->minHz, maxHz / 2);
+    const float binHz = sysidSampleRateHz / SYSID_FFT_SIZE;
+    sysidMinBin = MAX(1, lrintf(minHz / binHz));
+    sysidMaxBin = MIN(SYSID_BIN_COUNT - 1, lrintf(maxHz / binHz));
+
+    sysidExcitation.signal = sysidConfig()->signal;
+    sysidExcitation.amplitude = sysidConfig()->amplitude;
+    sysidExcitation.dT = 1.0f / pidRateHz;
+    sysidExcitation.phase = 0;
+    sysidExcitation.frequency = minHz;
+    sysidExcitation.frequencyStep = expf(logf(maxHz / minHz) / ((float)SYSID_SAMPLE_COUNT * sysidDecimation));
+    sysidExcitation.lfsr = 0x7FFF;
+    sysidExcitation.bitCycles = MAX(1, lrintf(pidRateHz / (SYSID_PRBS_CLOCK_RATIO * maxHz)));
+    sysidExcitation.bitCounter = 1;
+
+    sysidSampleCount = 0;
+    sysidDecimationCount = 0;
+    sysidSetpointSum = 0;
+    sysidGyroSum = 0;
+
+    sysidNextSegment = 0;
+    memset(sysidSxx, 0, sizeof(sysidSxx));
+    memset(sysidSyy, 0, sizeof(sysidSyy));
+    memset(sysidSxy, 0, sizeof(sysidSxy));
+    memset(sysidBinValid, 0, sizeof(sysidBinValid));
+
+    memset(&sysidResult, 0, sizeof(sysidResult));
+    sysidResult.axis = sysidConfig()->axis;
+    sysidResult.d = controller->d;
+    sysidResult.ff = controller->ff;
+    sysidResult.suggestedD = controller->d;
+    sysidResult.suggestedFF = controller->ff;
+
+#ifdef USE_ARM_MATH
+    arm_rfft_fast_init_f32(&sysidFftInstance, SYSID_FFT_SIZE);
+#endif
+
+    sysidState = SYSID_STATE_RUNNING;
+}
+
+// Excitation ends, whatever was recorded is analysed
+void sysidStop(void)
+{
+    if (sysidState == SYSID_STATE_RUNNING) {
+        sysidState = SYSID_STATE_ANALYSING;
+    }
+}
+
+bool sysidIsRunning(void)
+{
+    return sysidState == SYSID_STATE_RUNNING;
+}
+
+// Setpoint offset in deg/s, called once per PID cycle
+float sysidGetExcitation(void)
+{
+    if (sysidState != SYSID_STATE_RUNNING) {
+        return 0;
+    }
+
+    sysidExcitation_t *ex = &sysidExcitation;
+
+    if (ex->signal == SYSID_SIGNAL_PRBS) {
+        if (--ex->bitCounter == 0) {
+            // x^15 + x^14 + 1, maximum length
+            const uint16_t bit = ((ex->lfsr >> 14) ^ (ex->lfsr >> 13)) & 1;
+            ex->lfsr = ((ex->lfsr << 1) | bit) & 0x7FFF;
+            ex->bitCounter = ex->bitCycles;
+        }
+        return (ex->lfsr & 1) ? ex->amplitude : -ex->amplitude;
+    }
+
+    const float excitation = ex->amplitude * sin_approx(ex->phase);
+
+    ex->phase += 2.0f * M_PIf * ex->frequency * ex->dT;
+    if (ex->phase > M_PIf) {
+        ex->phase -= 2.0f * M_PIf;
+    }
+    ex->frequency *= ex->frequencyStep;
+
+    return excitation;
+}
+
+// Decimated by averaging, which filters both signals the same and leaves their ratio intact
+void sysidPushSample(float setpoint, float gyroRate)
+{
+    if (sysidState != SYSID_STATE_RUNNING) {
+        return;
+    }
+
+    sysidSetpointSum += setpoint;
+    sysidGyroSum += gyroRate;
+
+    if (++sysidDecimationCount < sysidDecimation) {
+        return;
+    }
+
+    sysidSamples[sysidSampleCount].setpoint = sysidQuantize(sysidSetpointSum / sysidDecimation);
+    sysidSamples[sysidSampleCount].gyroRate = sysidQuantize(sysidGyroSum / sysidDecimation);
+    sysidDecimationCount = 0;
+    sysidSetpointSum = 0;
+    sysidGyroSum = 0;
+
+    if (++sysidSampleCount >= SYSID_SAMPLE_COUNT) {
+        sysidState = SYSID_STATE_ANALYSING;
+    }
+}
+
+static void sysidProcessSegment(uint16_t start)
+{
+    const sysidSample_t *samples = &sysidSamples[start];
+    float setpointMean = 0;
+    float gyroMean = 0;
+
+    for (int i = 0; i < SYSID_FFT_SIZE; i++) {
+        setpointMean += samples[i].setpoint;
+        gyroMean += samples[i].gyroRate;
+    }
+    setpointMean /= SYSID_FFT_SIZE;
+    gyroMean /= SYSID_FFT_SIZE;
+
+    // Hann window, scaling cancels out in all ratios
+    for (int i = 0; i < SYSID_FFT_SIZE; i++) {
+        sysidWork.fft.input[i] = (samples[i].setpoint - setpointMean) * (0.5f - 0.5f * cos_approx(2.0f * M_PIf * i / SYSID_FFT_SIZE));
+    }
+    sysidRfft(sysidWork.fft.input, sysidWork.fft.setpoint);
+
+    for (int i = 0; i < SYSID_FFT_SIZE; i++) {
+        sysidWork.fft.input[i] = (samples[i].gyroRate - gyroMean) * (0.5f - 0.5f * cos_approx(2.0f * M_PIf * i / SYSID_FFT_SIZE));
+    }
+    sysidRfft(sysidWork.fft.input, sysidWork.fft.gyroRate);
+
+    for (int k = 1; k < SYSID_BIN_COUNT; k++) {
+        const float xr = sysidWork.fft.setpoint[2 * k];
+        const float xi = sysidWork.fft.setpoint[2 * k + 1];
+        const float yr = sysidWork.fft.gyroRate[2 * k];
+        const float yi = sysidWork.fft.gyroRate[2 * k + 1];
+
+        sysidSxx[k] += sq(xr) + sq(xi);
+        sysidSyy[k] += sq(yr) + sq(yi);
+        sysidSxy[k].re += xr * yr + xi * yi;
+        sysidSxy[k].im += xr * yi - xi * yr;
+    }
+
+    sysidResult.segments++;
+}
+
+static float sysidBinFrequency(int bin)
+{
+    return bin * sysidSampleRateHz / SYSID_FFT_SIZE;
+}
+
+static float sysidCoherence(int bin)
+{
+    const float power = sysidSxx[bin] * sysidSyy[bin];
+    return power > 0 ? (sq(sysidSxy[bin].re) + sq(sysidSxy[bin].im)) / power : 0;
+}
+
+// Closed loop response of a bin
+static sysidComplex_t sysidClosedLoop(int bin)
+{
+    return complexScale(sysidSxy[bin], 1.0f / sysidSxx[bin]);
+}
+
+static sysidComplex_t sysidLowpass(uint8_t type, float cutoffHz, float frequencyHz)
+{
+    if (cutoffHz <= 0) {
+        return (sysidComplex_t) { 1, 0 };
+    }
+
+    const sysidComplex_t one = { 1, 0 };
+    float order = 1;
+
+    switch (type) {
+    case FILTER_PT1:
+        break;
+    case FILTER_PT2:
+        order = 2;
+        break;
+    case FILTER_PT3:
+        order = 3;
+        break;
+    case FILTER_BIQUAD:
+        {
+            const float ratio = frequencyHz / cutoffHz;
+            return complexDiv(one, (sysidComplex_t) { 1 - sq(ratio), ratio / BIQUAD_Q });
+        }
+    default:
+        // LULU is not linear, treated as transparent
+        return one;
+    }
+
+    // Same per stage cutoff correction as pt2FilterGain() and pt3FilterGain()
+    const float stageCutoffHz = cutoffHz / sqrtf(powf(2, 1.0f / order) - 1);
+    const sysidComplex_t stage = complexDiv(one, (sysidComplex_t) { 1, frequencyHz / stageCutoffHz });
+    sysidComplex_t response = stage;
+    for (int i = 1; i < order; i++) {
+        response = complexMul(response, stage);
+    }
+    return response;
+}
+
+// Backward difference of the PID loop, (1 - z^-1) / dT
+static sysidComplex_t sysidDerivative(float frequencyHz)
+{
+    const float angle = 2.0f * M_PIf * frequencyHz / sysidPidRateHz;
+    return complexScale((sysidComplex_t) { 1 - cos_approx(angle), sin_approx(angle) }, sysidPidRateHz);
+}
+
+// Feed forward of one configured unit
+static sysidComplex_t sysidFeedForwardPerUnit(float frequencyHz)
+{
+    if (sysidController.ffIsDerivative) {
+        const sysidComplex_t response = complexMul(sysidDerivative(frequencyHz), sysidLowpass(FILTER_PT3, sysidController.ffLpfHz, frequencyHz));
+        return complexScale(response, sysidController.kFFPerUnit);
+    }
+    return (sysidComplex_t) { sysidController.kFFPerUnit, 0 };
+}
+
+static sysidComplex_t sysidOpenLoop(int bin, float d)
+{
+    const sysidComplex_t feedback = complexAdd(sysidWork.model.proportionalIntegral[bin], complexScale(sysidWork.model.derivativePerUnit[bin], d));
+    return complexMul(feedback, sysidWork.model.plant[bin]);
+}
+
+/*
+ * Phase margin at the first unity gain crossing of the open loop with the
+ * given D. False when the crossing is not inside the measured band.
+ */
+static bool sysidPhaseMargin(float d, float *crossoverHz, float *phaseMargin)
+{
+    int previousBin = -1;
+    sysidComplex_t previous = { 0, 0 };
+
+    for (int k = sysidMinBin; k <= sysidMaxBin; k++) {
+        if (!sysidBinValid[k]) {
+            continue;
+        }
+
+        const sysidComplex_t loop = sysidOpenLoop(k, d);
+        const float gain = complexAbs(loop);
+
+        if (previousBin < 0 && gain < 1) {
+            return false;
+        }
+
+        if (previousBin >= 0 && gain < 1) {
+            const float previousGain = complexAbs(previous);
+            const float t = (previousGain - 1) / (previousGain - gain);
+            const sysidComplex_t crossing = complexAdd(complexScale(previous, 1 - t), complexScale(loop, t));
+
+            *crossoverHz = sysidBinFrequency(previousBin) + t * (sysidBinFrequency(k) - sysidBinFrequency(previousBin));
+            *phaseMargin = 180.0f + complexArgDegrees(crossing);
+            if (*phaseMargin > 180.0f) {
+                *phaseMargin -= 360.0f;
+            }
+            return true;
+        }
+
+        previousBin = k;
+        previous = loop;
+    }
+
+    return false;
+}
+
+static float sysidBandwidth(void)
+{
+    int previousBin = -1;
+    float previousGain = 0;
+
+    for (int k = sysidMinBin; k <= sysidMaxBin; k++) {
+        if (!sysidBinValid[k]) {
+            continue;
+        }
+
+        const float gain = complexAbs(sysidClosedLoop(k));
+        if (gain < SYSID_BANDWIDTH_GAIN) {
+            if (previousBin < 0) {
+                return 0;
+            }
+            const float t = (previousGain - SYSID_BANDWIDTH_GAIN) / (previousGain - gain);
+            return sysidBinFrequency(previousBin) + t * (sysidBinFrequency(k) - sysidBinFrequency(previousBin));
+        }
+
+        previousBin = k;
+        previousGain = gain;
+    }
+
+    return 0;
+}
+
+/*
+ * Least squares FF change that brings the closed loop closest to 1 up to
+ * the crossover frequency, with D already at its new value:
+ *   T' = (Cref + dFF * B) * G / (1 + L')
+ */
+static float sysidFeedForwardChange(float d, float maxHz)
+{
+    float num = 0;
+    float den = 0;
+
+    for (int k = sysidMinBin; k <= sysidMaxBin && sysidBinFrequency(k) <= maxHz; k++) {
+        if (!sysidBinValid[k]) {
+            continue;
+        }
+
+        const float f = sysidBinFrequency(k);
+        const sysidComplex_t plant = sysidWork.model.plant[k];
+        const sysidComplex_t sensitivity = complexDiv((sysidComplex_t) { 1, 0 }, complexAdd((sysidComplex_t) { 1, 0 }, sysidOpenLoop(k, d)));
+        const sysidComplex_t perUnit = sysidFeedForwardPerUnit(f);
+        const sysidComplex_t reference = complexAdd(sysidWork.model.proportionalIntegral[k], complexScale(perUnit, sysidController.ff));
+
+        const sysidComplex_t a = complexMul(complexMul(perUnit, plant), sensitivity);
+        const sysidComplex_t tracking = complexMul(complexMul(reference, plant), sensitivity);
+        const sysidComplex_t error = { 1 - tracking.re, -tracking.im };
+
+        num += a.re * error.re + a.im * error.im;
+        den += sq(a.re) + sq(a.im);
+    }
+
+    return den > 0 ? num / den : 0;
+}
+
+static void sysidAnalyse(void)
+{
+    sysidResult_t *result = &sysidResult;
+
+    if (result->segments < SYSID_MIN_SEGMENTS) {
+        sysidState = SYSID_STATE_FAILED;
+        return;
+    }
+
+    // Plant from the closed loop and the controller
+    for (int k = sysidMinBin; k <= sysidMaxBin; k++) {
+        const float f = sysidBinFrequency(k);
+        const sysidComplex_t derivative = sysidDerivative(f);
+        const sysidComplex_t integral = complexDiv((sysidComplex_t) { 1, 0 }, derivative);
+        const sysidComplex_t proportionalIntegral = complexAdd((sysidComplex_t) { sysidController.kP, 0 }, complexScale(integral, sysidController.kI));
+        const sysidComplex_t derivativePerUnit = complexScale(complexMul(derivative, sysidLowpass(sysidController.dtermLpfType, sysidController.dtermLpfHz, f)), sysidController.kDPerUnit);
+        const sysidComplex_t feedback = complexAdd(proportionalIntegral, complexScale(derivativePerUnit, sysidController.d));
+        const sysidComplex_t reference = complexAdd(proportionalIntegral, complexScale(sysidFeedForwardPerUnit(f), sysidController.ff));
+
+        sysidBinValid[k] = false;
+        sysidWork.model.proportionalIntegral[k] = proportionalIntegral;
+        sysidWork.model.derivativePerUnit[k] = derivativePerUnit;
+
+        if (sysidSxx[k] <= 0 || sysidCoherence(k) < SYSID_MIN_COHERENCE) {
+            continue;
+        }
+
+        const sysidComplex_t closedLoop = sysidClosedLoop(k);
+        const sysidComplex_t denominator = { reference.re - (closedLoop.re * feedback.re - closedLoop.im * feedback.im), reference.im - (closedLoop.re * feedback.im + closedLoop.im * feedback.re) };
+        if (complexAbs(denominator) < 1e-6f) {
+            continue;
+        }
+
+        sysidWork.model.plant[k] = complexDiv(closedLoop, denominator);
+        sysidBinValid[k] = true;
+        result->coherentBins++;
+    }
+
+    if (result->coherentBins == 0) {
+        sysidState = SYSID_STATE_FAILED;
+        return;
+    }
+
+    result->bandwidthHz = sysidBandwidth();
+    if (!sysidPhaseMargin(sysidController.d, &result->crossoverHz, &result->phaseMargin)) {
+        result->crossoverHz = 0;
+        result->phaseMargin = 0;
+    }
+
+    // D with the best phase margin
+    float bestMargin = -INFINITY;
+    float bestCrossoverHz = result->crossoverHz;
+    if (sysidController.kDPerUnit > 0) {
+        const float maxD = MAX(2 * sysidController.d, SYSID_D_MIN_RANGE);
+        for (int i = 0; i <= SYSID_D_STEPS; i++) {
+            const float d = i * maxD / SYSID_D_STEPS;
+            float crossoverHz;
+            float margin;
+            if (sysidPhaseMargin(d, &crossoverHz, &margin) && margin > bestMargin) {
+                bestMargin = margin;
+                bestCrossoverHz = crossoverHz;
+                result->suggestedD = constrain(lrintf(d), 0, SYSID_GAIN_MAX);
+            }
+        }
+    }
+    result->suggestedPhaseMargin = bestMargin > -INFINITY ? bestMargin : result->phaseMargin;
+
+    // FF for the flattest response up to crossover, the whole band when it was not found
+    if (sysidController.kFFPerUnit > 0) {
+        const float maxHz = bestCrossoverHz > 0 ? bestCrossoverHz : sysidBinFrequency(sysidMaxBin);
+        const float ff = sysidController.ff + sysidFeedForwardChange(result->suggestedD, maxHz);
+        result->suggestedFF = constrain(lrintf(ff), 0, SYSID_GAIN_MAX);
+    }
+
+    sysidState = SYSID_STATE_DONE;
+}
+
+// One FFT segment per call, the recording is processed while it is being made
+void sysidTask(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    if (sysidState != SYSID_STATE_RUNNING && sysidState != SYSID_STATE_ANALYSING) {
+        return;
+    }
+
+    if (sysidNextSegment + SYSID_FFT_SIZE <= sysidSampleCount) {
+        sysidProcessSegment(sysidNextSegment);
+        sysidNextSegment += SYSID_SEGMENT_HOP;
+        return;
+    }
+
+    if (sysidState == SYSID_STATE_ANALYSING) {
+        sysidAnalyse();
+    }
+}
+
+sysidState_e sysidGetState(void)
+{
+    return sysidState;
+}
+
+const sysidResult_t *sysidGetResult(void)
+{
+    return &sysidResult;
+}
+
+bool sysidGetResponse(int bin, sysidResponse_t *response)
+{
+    if (sysidState != SYSID_STATE_DONE || bin < sysidMinBin || bin > sysidMaxBin || sysidSxx[bin] <= 0) {
+        return false;
+    }
+
+    const sysidComplex_t closedLoop = sysidClosedLoop(bin);
+    response->frequencyHz = sysidBinFrequency(bin);
+    response->gainDb = 20.0f * log10f(MAX(complexAbs(closedLoop), 1e-6f));
+    response->phase = complexArgDegrees(closedLoop);
+    response->coherence = sysidCoherence(bin);
+    return true;
+}
+
+#endif
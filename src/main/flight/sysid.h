@@ -0,0 +1,104 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+#include "config/parameter_group.h"
+
+#define SYSID_SAMPLE_COUNT          4096    // Recording length, 8 s at the nominal sample rate
+#define SYSID_SAMPLE_RATE_HZ        500     // Nominal recording rate, the PID rate is decimated to this
+#define SYSID_FFT_SIZE              256
+#define SYSID_BIN_COUNT             (SYSID_FFT_SIZE / 2)
+#define SYSID_TASK_RATE_HZ          10
+#define SYSID_TARGET_PHASE_MARGIN   45.0f   // deg
+
+typedef enum {
+    SYSID_SIGNAL_CHIRP = 0,         // Logarithmic sine sweep from sysid_min_hz to sysid_max_hz
+    SYSID_SIGNAL_PRBS,              // Pseudo random binary sequence clocked at 2.5 x sysid_max_hz
+} sysidSignal_e;
+
+typedef enum {
+    SYSID_STATE_IDLE = 0,
+    SYSID_STATE_RUNNING,            // Excitation injected, recording
+    SYSID_STATE_ANALYSING,          // Excitation stopped, processing the rest of the recording
+    SYSID_STATE_DONE,
+    SYSID_STATE_FAILED,             // Too short or no coherent response
+} sysidState_e;
+
+typedef struct sysidConfig_s {
+    uint8_t axis;
+    uint8_t signal;                 // sysidSignal_e
+    uint16_t amplitude;             // deg/s
+    uint8_t minHz;
+    uint16_t maxHz;
+} sysidConfig_t;
+
+PG_DECLARE(sysidConfig_t, sysidConfig);
+
+/*
+ * Rate controller of the excited axis as seen by the PID loop, all gains in
+ * PID output per deg/s. D acts on gyro only, feed forward on setpoint only.
+ */
+typedef struct sysidController_s {
+    float kP;
+    float kI;
+    float kDPerUnit;                // Derivative gain of one unit of configured D
+    float kFFPerUnit;               // Feed forward gain of one unit of configured FF
+    uint16_t d;                     // Configured D
+    uint16_t ff;                    // Configured FF / CD
+    bool ffIsDerivative;            // Multirotor control derivative, acts on setpoint rate of change
+    uint8_t dtermLpfType;           // filterType_e
+    uint16_t dtermLpfHz;
+    uint16_t ffLpfHz;               // PT3 on the setpoint derivative
+} sysidController_t;
+
+typedef struct sysidResult_s {
+    uint8_t axis;
+    uint16_t segments;              // FFT segments averaged
+    uint16_t coherentBins;          // Bins used for the estimates
+    float bandwidthHz;              // Closed loop -3 dB, 0 when above the measured range
+    float crossoverHz;              // Open loop unity gain, 0 when not found
+    float phaseMargin;              // deg
+    uint16_t d;                     // Configured D and FF during the run
+    uint16_t ff;
+    uint16_t suggestedD;            // D with the best phase margin
+    uint16_t suggestedFF;           // FF with the flattest closed loop response up to crossover
+    float suggestedPhaseMargin;     // deg, with suggestedD
+} sysidResult_t;
+
+typedef struct sysidResponse_s {
+    float frequencyHz;
+    float gainDb;                   // Closed loop, gyro / setpoint
+    float phase;                    // deg
+    float coherence;
+} sysidResponse_t;
+
+void sysidStart(const sysidController_t *controller, float pidRateHz);
+void sysidStop(void);
+bool sysidIsRunning(void);
+float sysidGetExcitation(void);
+void sysidPushSample(float setpoint, float gyroRate);
+void sysidTask(timeUs_t currentTimeUs);
+
+sysidState_e sysidGetState(void);
+const sysidResult_t *sysidGetResult(void);
+bool sysidGetResponse(int bin, sysidResponse_t *response);
@@ -37,20 +37,32 @@
 #include "fc/runtime_config.h"
 
 #include "flight/imu.h"
+#include "flight/wind_estimator.h"
+#include "flight/wind_estimator_kf.h"
 
 #include "navigation/navigation_pos_estimator_private.h"
 
 #include "io/gps.h"
 
+#include "sensors/pitotmeter.h"
+#include "sensors/sensors.h"
 
-#define WINDESTIMATOR_TIMEOUT       60*15 // 15min with out altitude change
-#define WINDESTIMATOR_ALTITUDE_SCALE WINDESTIMATOR_TIMEOUT/500.0f //or 500m altitude change
-// Based on WindEstimation.pdf paper
 
+// Wind is valid while the horizontal wind is known to this accuracy (cm/s)
+#define WINDESTIMATOR_VALID_STDDEV      300.0f
+
+static const windKfParams_t windKfParams = {
+    .windNoise = 5.0f,              // ~150 cm/s after 15 min without heading change
+    .windAltitudeNoise = 15.0f,     // ~340 cm/s after 500 m altitude change
+    .airspeedNoise = 50.0f,
+    .pitotScaleNoise = 0.002f,
+    .velocityNoise = 150.0f,        // GPS velocity, sideslip and angle of attack
+    .innovationGate = 5.0f,
+};
+
+static windKf_t windKf;
 static bool hasValidWindEstimate = false;
 static float estimatedWind[XYZ_AXIS_COUNT] = {0, 0, 0};    // wind velocity vectors in cm / sec in earth frame
-static float lastGroundVelocity[XYZ_AXIS_COUNT];
-static float lastFuselageDirection[XYZ_AXIS_COUNT];
 
 bool isEstimatedWindSpeedValid(void)
 {
@@ -66,6 +78,11 @@ float getEstimatedWindSpeed(int axis)
     return estimatedWind[axis];
 }
 
+float getEstimatedWindSpeedStdDev(int axis)
+{
+    return windKfGetStdDev(&windKf, WIND_KF_WIND(axis));
+}
+
 float getEstimatedHorizontalWindSpeed(uint16_t *angle)
 {
     float xWindSpeed = getEstimatedWindSpeed(X);
@@ -82,21 +99,48 @@ float getEstimatedHorizontalWindSpeed(uint16_t *angle)
     return calc_length_pythagorean_2D(xWindSpeed, yWindSpeed);
 }
 
+static bool windEstimatorUsePitot(void)
+{
+#ifdef USE_PITOT
+    // Virtual pitot derives airspeed from the wind estimate, it adds no information
+    return sensors(SENSOR_PITOT) && detectedSensors[SENSOR_INDEX_PITOT] != PITOT_VIRTUAL &&
+        pitotGetValidForAirspeed() && !pitotHasFailed();
+#else
+    return false;
+#endif
+}
+
+static bool windEstimatorIsConverged(void)
+{
+    return windKfGetStdDev(&windKf, WIND_KF_WIND_X) < WINDESTIMATOR_VALID_STDDEV &&
+        windKfGetStdDev(&windKf, WIND_KF_WIND_Y) < WINDESTIMATOR_VALID_STDDEV;
+}
+
+/*
+ * Called on every GPS update. Every velocity sample is fused, there is no need
+ * for a heading change between samples: the filter covariance tells how well
+ * the wind is known in each direction and decides validity.
+ */
 void updateWindEstimator(timeUs_t currentTimeUs)
 {
     static timeUs_t lastUpdateUs = 0;
-    static timeUs_t lastValidWindEstimate = 0;
-    static float lastValidEstimateAltitude = 0.0f;
-    float currentAltitude = gpsSol.llh.alt / 100.0f; // altitude in m
+    static float lastAltitude = 0.0f;
+    const float currentAltitude = gpsSol.llh.alt / 100.0f; // altitude in m
 
-    if ((US2S(currentTimeUs - lastValidWindEstimate) + WINDESTIMATOR_ALTITUDE_SCALE * fabsf(currentAltitude - lastValidEstimateAltitude)) > WINDESTIMATOR_TIMEOUT) {
-        hasValidWindEstimate = false;
+    if (lastUpdateUs == 0) {
+        windKfInit(&windKf, &windKfParams);
+    } else {
+        windKfPredict(&windKf, US2S(cmpTimeUs(currentTimeUs, lastUpdateUs)), currentAltitude - lastAltitude);
     }
 
+    lastUpdateUs = currentTimeUs;
+    lastAltitude = currentAltitude;
+    hasValidWindEstimate = windEstimatorIsConverged();
+
     if (!STATE(FIXED_WING_LEGACY) ||
         !isGPSHeadingValid() ||
         !gpsSol.flags.validVelNE ||
-        !gpsSol.flags.validVelD 
+        !gpsSol.flags.validVelD
 #ifdef USE_GPS_FIX_ESTIMATION
             || STATE(GPS_ESTIMATED_FIX)
 #endif
@@ -104,91 +148,26 @@ void updateWindEstimator(timeUs_t currentTimeUs)
         return;
     }
 
-    float groundVelocity[XYZ_AXIS_COUNT];
-    float groundVelocityDiff[XYZ_AXIS_COUNT];
-    float groundVelocitySum[XYZ_AXIS_COUNT];
-
-    float fuselageDirection[XYZ_AXIS_COUNT];
-    float fuselageDirectionDiff[XYZ_AXIS_COUNT];
-    float fuselageDirectionSum[XYZ_AXIS_COUNT];
-
-    // Get current 3D velocity from GPS in cm/s
-    // relative to earth frame
-    groundVelocity[X] = posEstimator.gps.vel.x;
-    groundVelocity[Y] = posEstimator.gps.vel.y;
-    groundVelocity[Z] = posEstimator.gps.vel.z;
+    // Current 3D velocity from GPS in cm/s relative to earth frame
+    const fpVector3_t groundVelocity = { .v = { posEstimator.gps.vel.x, posEstimator.gps.vel.y, posEstimator.gps.vel.z } };
 
     // Fuselage direction in earth frame
-    fuselageDirection[X] = HeadVecEFFiltered.x;
-    fuselageDirection[Y] = -HeadVecEFFiltered.y;
-    fuselageDirection[Z] = -HeadVecEFFiltered.z;
-
-    timeDelta_t timeDelta = cmpTimeUs(currentTimeUs, lastUpdateUs);
-    // scrap our data and start over if we're taking too long to get a direction change
-    if (lastUpdateUs == 0 || timeDelta > 10 * USECS_PER_SEC) {
-
-        lastUpdateUs = currentTimeUs;
-
-        memcpy(lastFuselageDirection, fuselageDirection, sizeof(lastFuselageDirection));
-        memcpy(lastGroundVelocity, groundVelocity, sizeof(lastGroundVelocity));
-        return;
+    fpVector3_t airspeedReference = { .v = { HeadVecEFFiltered.x, -HeadVecEFFiltered.y, -HeadVecEFFiltered.z } };
+
+    if (windEstimatorUsePitot()) {
+        windKfSetReference(&windKf, WIND_KF_REFERENCE_PITOT, 0.0f);
+        vectorScale(&airspeedReference, &airspeedReference, pitot.airSpeed);
+    } else {
+        // Restart airspeed from ground speed corrected by the wind known so far
+        const float airspeed = calc_length_pythagorean_3D(groundVelocity.x - estimatedWind[X], groundVelocity.y - estimatedWind[Y], groundVelocity.z - estimatedWind[Z]);
+        windKfSetReference(&windKf, WIND_KF_REFERENCE_HEADING, airspeed);
     }
 
-    fuselageDirectionDiff[X] = fuselageDirection[X] - lastFuselageDirection[X];
-    fuselageDirectionDiff[Y] = fuselageDirection[Y] - lastFuselageDirection[Y];
-    fuselageDirectionDiff[Z] = fuselageDirection[Z] - lastFuselageDirection[Z];
-
-    float diffLengthSq = sq(fuselageDirectionDiff[X]) + sq(fuselageDirectionDiff[Y]) + sq(fuselageDirectionDiff[Z]);
-    
-    // Very small changes in attitude will result in a denominator
-    // very close to zero which will introduce too much error in the
-    // estimation.
-    //
-    // TODO: Is 0.2f an adequate threshold?
-    if (diffLengthSq > sq(0.2f)) {
-        // when turning, use the attitude response to estimate wind speed
-        groundVelocityDiff[X] = groundVelocity[X] - lastGroundVelocity[X];
-        groundVelocityDiff[Y] = groundVelocity[Y] - lastGroundVelocity[Y];
-        groundVelocityDiff[Z] = groundVelocity[Z] - lastGroundVelocity[Z];
-
-        // estimate airspeed it using equation 6
-        float V = (calc_length_pythagorean_3D(groundVelocityDiff[X], groundVelocityDiff[Y], groundVelocityDiff[Z])) / fast_fsqrtf(diffLengthSq);
-
-        fuselageDirectionSum[X] = fuselageDirection[X] + lastFuselageDirection[X];
-        fuselageDirectionSum[Y] = fuselageDirection[Y] + lastFuselageDirection[Y];
-        fuselageDirectionSum[Z] = fuselageDirection[Z] + lastFuselageDirection[Z];
-
-        groundVelocitySum[X] = groundVelocity[X] + lastGroundVelocity[X];
-        groundVelocitySum[Y] = groundVelocity[Y] + lastGroundVelocity[Y];
-        groundVelocitySum[Z] = groundVelocity[Z] + lastGroundVelocity[Z];
-
-        memcpy(lastFuselageDirection, fuselageDirection, sizeof(lastFuselageDirection));
-        memcpy(lastGroundVelocity, groundVelocity, sizeof(lastGroundVelocity));
-
-        float theta = atan2f(groundVelocityDiff[Y], groundVelocityDiff[X]) - atan2f(fuselageDirectionDiff[Y], fuselageDirectionDiff[X]);// equation 9
-        float sintheta = sinf(theta);
-        float costheta = cosf(theta);
-
-        float wind[XYZ_AXIS_COUNT];
-        wind[X] = (groundVelocitySum[X] - V * (costheta * fuselageDirectionSum[X] - sintheta * fuselageDirectionSum[Y])) * 0.5f;// equation 10
-        wind[Y] = (groundVelocitySum[Y] - V * (sintheta * fuselageDirectionSum[X] + costheta * fuselageDirectionSum[Y])) * 0.5f;// equation 11
-        wind[Z] = (groundVelocitySum[Z] - V * fuselageDirectionSum[Z]) * 0.5f;// equation 12
-
-        float prevWindLength = calc_length_pythagorean_3D(estimatedWind[X], estimatedWind[Y], estimatedWind[Z]);
-        float windLength = calc_length_pythagorean_3D(wind[X], wind[Y], wind[Z]);
-
-        //is this really needed? The reason it is here might be above equation was wrong in early implementations
-        if (windLength < prevWindLength + 4000) {
-            // TODO: Better filtering
-            estimatedWind[X] = estimatedWind[X] * 0.98f + wind[X] * 0.02f;
-            estimatedWind[Y] = estimatedWind[Y] * 0.98f + wind[Y] * 0.02f;
-            estimatedWind[Z] = estimatedWind[Z] * 0.98f + wind[Z] * 0.02f;
+    if (windKfFuseGroundVelocity(&windKf, &groundVelocity, &airspeedReference)) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            estimatedWind[axis] = windKf.x[WIND_KF_WIND(axis)];
         }
-
-        lastUpdateUs = currentTimeUs;
-        lastValidWindEstimate = currentTimeUs;
-        hasValidWindEstimate = true;
-        lastValidEstimateAltitude = currentAltitude;
+        hasValidWindEstimate = windEstimatorIsConverged();
     }
 }
 
@@ -0,0 +1,199 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* --------------------------------------------------------------------------------
+ * == Wind Kalman filter ==
+ * Random walk model for wind and airspeed, the process noise plays the role of
+ * the forgetting factor of a recursive least squares fit: old samples lose
+ * weight as the covariance grows between updates. Unlike a single forgetting
+ * factor, wind is forgotten slowly while airspeed follows throttle changes.
+ *
+ * Flying straight without a pitot only the cross track wind is observable.
+ * The along track covariance then grows, capped at its initial value, and the
+ * estimate is held instead of being discarded.
+ * --------------------------------------------------------------------------------- */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_WIND_ESTIMATOR
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/matrix.h"
+
+#include "flight/wind_estimator_kf.h"
+
+#define WIND_KF_MIN_VARIANCE                1e-6f   // Keep diagonal positive despite rounding
+#define WIND_KF_INIT_WIND_VARIANCE          sq(1500.0f)
+#define WIND_KF_INIT_AIRSPEED_VARIANCE      sq(2000.0f)
+#define WIND_KF_INIT_PITOT_SCALE_VARIANCE   sq(0.3f)
+#define WIND_KF_MIN_PITOT_SCALE             0.5f
+#define WIND_KF_MAX_PITOT_SCALE             2.0f
+
+void windKfInit(windKf_t *kf, const windKfParams_t *params)
+{
+    memset(kf, 0, sizeof(windKf_t));
+    kf->params = *params;
+    kf->reference = WIND_KF_REFERENCE_HEADING;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        kf->P[WIND_KF_WIND(axis)][WIND_KF_WIND(axis)] = WIND_KF_INIT_WIND_VARIANCE;
+    }
+
+    kf->P[WIND_KF_AIRSPEED][WIND_KF_AIRSPEED] = WIND_KF_INIT_AIRSPEED_VARIANCE;
+}
+
+static void windKfResetState(windKf_t *kf, windKfState_e state, float value, float variance)
+{
+    kf->x[state] = value;
+
+    for (int i = 0; i < WIND_KF_STATE_COUNT; i++) {
+        kf->P[state][i] = 0.0f;
+        kf->P[i][state] = 0.0f;
+    }
+
+    kf->P[state][state] = variance;
+}
+
+/**
+ * Switch between estimated airspeed and pitot scale. The airspeed state changes
+ * meaning, so it restarts: from the given airspeed, or from a unity scale.
+ */
+void windKfSetReference(windKf_t *kf, windKfReference_e reference, float airspeed)
+{
+    if (reference == kf->reference) {
+        return;
+    }
+
+    kf->reference = reference;
+
+    if (reference == WIND_KF_REFERENCE_PITOT) {
+        windKfResetState(kf, WIND_KF_AIRSPEED, 1.0f, WIND_KF_INIT_PITOT_SCALE_VARIANCE);
+    } else {
+        windKfResetState(kf, WIND_KF_AIRSPEED, airspeed, WIND_KF_INIT_AIRSPEED_VARIANCE);
+    }
+}
+
+// Scaling row and column keeps P positive definite, unlike clipping the diagonal alone
+static void windKfLimitVariance(windKf_t *kf, windKfState_e state, float maxVariance)
+{
+    if (kf->P[state][state] <= maxVariance) {
+        return;
+    }
+
+    const float scale = fast_fsqrtf(maxVariance / kf->P[state][state]);
+
+    for (int i = 0; i < WIND_KF_STATE_COUNT; i++) {
+        kf->P[state][i] *= scale;
+        kf->P[i][state] *= scale;
+    }
+}
+
+/**
+ * Grow the covariance for the time since the last update. Wind also changes
+ * with altitude, altitudeChange is in m.
+ */
+void windKfPredict(windKf_t *kf, float dt, float altitudeChange)
+{
+    const float windVariance = sq(kf->params.windNoise) * dt + sq(kf->params.windAltitudeNoise) * fabsf(altitudeChange);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        kf->P[WIND_KF_WIND(axis)][WIND_KF_WIND(axis)] += windVariance;
+        windKfLimitVariance(kf, WIND_KF_WIND(axis), WIND_KF_INIT_WIND_VARIANCE);
+    }
+
+    if (kf->reference == WIND_KF_REFERENCE_PITOT) {
+        kf->P[WIND_KF_AIRSPEED][WIND_KF_AIRSPEED] += sq(kf->params.pitotScaleNoise) * dt;
+        windKfLimitVariance(kf, WIND_KF_AIRSPEED, WIND_KF_INIT_PITOT_SCALE_VARIANCE);
+    } else {
+        kf->P[WIND_KF_AIRSPEED][WIND_KF_AIRSPEED] += sq(kf->params.airspeedNoise) * dt;
+        windKfLimitVariance(kf, WIND_KF_AIRSPEED, WIND_KF_INIT_AIRSPEED_VARIANCE);
+    }
+}
+
+/**
+ * Scalar update of one ground velocity axis, H = [1 at the wind axis, a at the airspeed state]
+ */
+static bool windKfFuseAxis(windKf_t *kf, int axis, float velocity, float a)
+{
+    float (*P)[WIND_KF_STATE_COUNT] = kf->P;
+    const int w = WIND_KF_WIND(axis);
+    float PHt[WIND_KF_STATE_COUNT];
+
+    for (int i = 0; i < WIND_KF_STATE_COUNT; i++) {
+        PHt[i] = P[i][w] + P[i][WIND_KF_AIRSPEED] * a;
+    }
+
+    const float innovation = velocity - (kf->x[w] + kf->x[WIND_KF_AIRSPEED] * a);
+    const float innovationVariance = PHt[w] + PHt[WIND_KF_AIRSPEED] * a + sq(kf->params.velocityNoise);
+
+    if (innovationVariance <= 0.0f) {
+        return false;
+    }
+
+    if (kf->params.innovationGate > 0.0f && sq(innovation) > sq(kf->params.innovationGate) * innovationVariance) {
+        kf->rejectedCount++;
+        return false;
+    }
+
+    const float invS = 1.0f / innovationVariance;
+
+    for (int i = 0; i < WIND_KF_STATE_COUNT; i++) {
+        kf->x[i] += PHt[i] * invS * innovation;
+    }
+
+    // P = P - K * H * P, with K = PHt / S
+    matrixSymmetricRankOneUpdate(&P[0][0], WIND_KF_STATE_COUNT, -invS, PHt);
+    for (int i = 0; i < WIND_KF_STATE_COUNT; i++) {
+        P[i][i] = MAX(P[i][i], WIND_KF_MIN_VARIANCE);
+    }
+
+    return true;
+}
+
+/**
+ * Fuse one GPS velocity sample. airspeedReference is the fuselage direction,
+ * multiplied by the pitot airspeed when the reference is WIND_KF_REFERENCE_PITOT.
+ */
+bool windKfFuseGroundVelocity(windKf_t *kf, const fpVector3_t *groundVelocity, const fpVector3_t *airspeedReference)
+{
+    bool fused = false;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fused |= windKfFuseAxis(kf, axis, groundVelocity->v[axis], airspeedReference->v[axis]);
+    }
+
+    if (kf->reference == WIND_KF_REFERENCE_PITOT) {
+        kf->x[WIND_KF_AIRSPEED] = constrainf(kf->x[WIND_KF_AIRSPEED], WIND_KF_MIN_PITOT_SCALE, WIND_KF_MAX_PITOT_SCALE);
+    } else {
+        kf->x[WIND_KF_AIRSPEED] = MAX(kf->x[WIND_KF_AIRSPEED], 0.0f);
+    }
+
+    return fused;
+}
+
+float windKfGetStdDev(const windKf_t *kf, windKfState_e state)
+{
+    return fast_fsqrtf(kf->P[state][state]);
+}
+
+#endif
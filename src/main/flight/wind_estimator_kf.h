@@ -0,0 +1,74 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/vector.h"
+
+/*
+ * Wind Kalman filter (NEU frame, cm/s). Ground velocity is modelled as wind
+ * plus airspeed along the fuselage:
+ *
+ *   groundVelocity = wind + airspeedState * airspeedReference
+ *
+ * Without a pitot the reference is the fuselage direction and the airspeed
+ * state is the airspeed itself. With a pitot the reference is the fuselage
+ * direction scaled by the pitot airspeed and the state is the pitot scale
+ * factor, absorbing calibration and IAS to TAS errors. The model is linear in
+ * the states, every GPS velocity sample is fused as three exact scalar updates.
+ */
+
+typedef enum {
+    WIND_KF_WIND_X = 0,
+    WIND_KF_WIND_Y,
+    WIND_KF_WIND_Z,
+    WIND_KF_AIRSPEED,       // Airspeed (cm/s) or pitot scale, depending on the reference
+    WIND_KF_STATE_COUNT
+} windKfState_e;
+
+#define WIND_KF_WIND(axis)  (WIND_KF_WIND_X + (axis))
+
+typedef enum {
+    WIND_KF_REFERENCE_HEADING = 0,  // Fuselage direction only, airspeed is estimated
+    WIND_KF_REFERENCE_PITOT,        // Fuselage direction times measured airspeed
+} windKfReference_e;
+
+typedef struct {
+    float windNoise;            // Wind random walk (cm/s/sqrt(s))
+    float windAltitudeNoise;    // Wind change with altitude (cm/s/sqrt(m))
+    float airspeedNoise;        // Airspeed random walk (cm/s/sqrt(s))
+    float pitotScaleNoise;      // Pitot scale random walk (1/sqrt(s))
+    float velocityNoise;        // GPS velocity and model error (cm/s)
+    float innovationGate;       // Innovation gate (standard deviations), 0 to disable
+} windKfParams_t;
+
+typedef struct {
+    float x[WIND_KF_STATE_COUNT];
+    float P[WIND_KF_STATE_COUNT][WIND_KF_STATE_COUNT];  // Kept symmetric
+    windKfParams_t params;
+    windKfReference_e reference;
+    uint32_t rejectedCount;                             // Number of samples rejected by the innovation gate
+} windKf_t;
+
+void windKfInit(windKf_t *kf, const windKfParams_t *params);
+void windKfSetReference(windKf_t *kf, windKfReference_e reference, float airspeed);
+void windKfPredict(windKf_t *kf, float dt, float altitudeChange);
+bool windKfFuseGroundVelocity(windKf_t *kf, const fpVector3_t *groundVelocity, const fpVector3_t *airspeedReference);
+float windKfGetStdDev(const windKf_t *kf, windKfState_e state);
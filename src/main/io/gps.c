@@ -73,6 +73,10 @@
 
 #include "programming/logic_condition.h"
 
+#define GPS_UBX_PVT_FRAME_SIZE          100     // UBX-NAV-PVT payload + header and checksum (bytes)
+#define GPS_LATENCY_MAX_JITTER_MS       500     // Larger jumps mean the time reference was lost
+#define GPS_LATENCY_RELEASE_MS_PER_MS   1000    // Release zero-jitter reference by 1ms per second to follow clock drift
+
 typedef struct {
     bool                isDriverBased;
     portMode_t          portMode;           // Port mode RX/TX (only for serial based)
@@ -91,6 +95,8 @@ gpsStatistics_t   gpsStats;
 gpsSolutionData_t gpsSolDRV;  //filled by driver
 gpsSolutionData_t gpsSol;     //used in the rest of the code
 
+static uint16_t gpsSolutionLatencyMs = 0;
+
 // Map gpsBaudRate_e index to baudRate_e
 baudRate_e gpsToSerialBaudRate[GPS_BAUDRATE_COUNT] = { BAUD_115200, BAUD_57600, BAUD_38400, BAUD_19200, BAUD_9600, BAUD_230400, BAUD_460800, BAUD_921600 };
 
@@ -351,6 +357,87 @@ void gpsProcessNewDriverData(void)
 #endif
 }
 
+/*
+ * Nominal delay between the navigation epoch and the start of the solution output.
+ * Values are typical for the receiver generation, transmission time is accounted separately.
+ */
+static uint16_t gpsGetNominalLatencyMs(void)
+{
+    switch (gpsState.gpsConfig->provider) {
+        case GPS_UBLOX:
+            switch (gpsState.hwVersion) {
+                case UBX_HW_VERSION_UBLOX5:
+                case UBX_HW_VERSION_UBLOX6:
+                case UBX_HW_VERSION_UBLOX7:
+                    return 100;
+                case UBX_HW_VERSION_UBLOX8:
+                    return 60;
+                case UBX_HW_VERSION_UBLOX9:
+                case UBX_HW_VERSION_UBLOX10:
+                    return 40;
+                default:
+                    return 80;
+            }
+        case GPS_MSP:
+            return 80;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Solution latency is nominal receiver latency + serial transmission time + extra delay of this solution.
+ * Local clock and GPS time of week have an unknown constant offset, so the smallest observed
+ * offset (slowly released to follow clock drift) is taken as the zero-jitter reference.
+ */
+static void gpsUpdateLatencyEstimate(void)
+{
+    static bool offsetValid = false;
+    static int32_t minOffsetMs;
+    static timeMs_t lastUpdateMs;
+    static timeMs_t releaseElapsedMs;     // Time not yet released, carries the remainder between updates
+
+    const timeMs_t currentTimeMs = millis();
+    uint16_t latencyMs = gpsGetNominalLatencyMs();
+
+    if (gpsState.gpsConfig->provider == GPS_UBLOX) {
+        const int baudrate = getGpsBaudrate();
+        if (baudrate > 0) {
+            latencyMs += (GPS_UBX_PVT_FRAME_SIZE * 10 * 1000) / baudrate;
+        }
+    }
+
+    if (gpsSol.flags.validTimeOfWeek) {
+        const int32_t offsetMs = (int32_t)(currentTimeMs - gpsSol.timeOfWeekMs);
+
+        if (!offsetValid || ABS(offsetMs - minOffsetMs) > GPS_LATENCY_MAX_JITTER_MS) {
+            // First sample, week rollover or receiver restart
+            minOffsetMs = offsetMs;
+            offsetValid = true;
+            releaseElapsedMs = 0;
+        }
+        else {
+            releaseElapsedMs += currentTimeMs - lastUpdateMs;
+            const int32_t releaseMs = releaseElapsedMs / GPS_LATENCY_RELEASE_MS_PER_MS;
+            releaseElapsedMs -= releaseMs * GPS_LATENCY_RELEASE_MS_PER_MS;
+            minOffsetMs = MIN(offsetMs, minOffsetMs + releaseMs);
+        }
+
+        latencyMs += offsetMs - minOffsetMs;
+        lastUpdateMs = currentTimeMs;
+    }
+    else {
+        offsetValid = false;
+    }
+
+    gpsSolutionLatencyMs = latencyMs;
+}
+
+uint16_t gpsGetSolutionLatencyMs(void)
+{
+    return gpsSolutionLatencyMs;
+}
+
 //called after: 
 //1)driver copies gpsSolDRV to gpsSol
 //2)gpsSol is processed by "Disable GPS logical switch"
@@ -384,6 +471,7 @@ void gpsProcessNewSolutionData(bool timeout)
     if (!timeout) {
         // Data came from GPS sensor - set sensor as ready and available (it may still not have GPS fix)
         sensorsSet(SENSOR_GPS);
+        gpsUpdateLatencyEstimate();
     }
 
     // Pass on GPS update to NAV and IMU
@@ -418,6 +506,7 @@ static void gpsResetSolution(gpsSolutionData_t* gpsSol)
     gpsSol->flags.validVelD = false;
     gpsSol->flags.validEPE = false;
     gpsSol->flags.validTime = false;
+    gpsSol->flags.validTimeOfWeek = false;
 }
 
 void gpsTryEstimateOnTimeout(void)
@@ -129,6 +129,7 @@ typedef struct gpsSolutionData_s {
         bool validVelD;
         bool validEPE;      // EPH/EPV values are valid - actual accuracy
         bool validTime;
+        bool validTimeOfWeek;   // timeOfWeekMs is valid - solution epoch is known
     } flags;
 
     gpsFixType_e fixType;
@@ -146,6 +147,7 @@ typedef struct gpsSolutionData_s {
     uint16_t hdop;  // generic HDOP value (*HDOP_SCALE)
 
     dateTime_t time; // GPS time in UTC
+    uint32_t timeOfWeekMs;  // GPS time of week of the navigation epoch (ms)
 
 } gpsSolutionData_t;
 
@@ -178,6 +180,7 @@ uint8_t getGpsProtoMinorVersion(void);
 
 int getGpsBaudrate(void);
 int gpsBaudRateToInt(gpsBaudRate_e baudrate);
+uint16_t gpsGetSolutionLatencyMs(void);
 
 #if defined(USE_GPS_FAKE)
 void gpsFakeSet(
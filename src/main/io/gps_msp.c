@@ -107,6 +107,8 @@ void mspGPSReceiveNewData(const uint8_t * bufferPtr)
     gpsSolDRV.time.millis  = 0;
 
     gpsSolDRV.flags.validTime = (pkt->fixType >= 3);
+    gpsSolDRV.timeOfWeekMs = pkt->msTOW;
+    gpsSolDRV.flags.validTimeOfWeek = (pkt->fixType >= 3);
 
     gpsProcessNewDriverData();
     newDataReady = true;
@@ -601,6 +601,8 @@ static bool gpsParseFrameUBLOX(void)
         gpsSolDRV.eph = gpsConstrainEPE(_buffer.posllh.horizontal_accuracy / 10);
         gpsSolDRV.epv = gpsConstrainEPE(_buffer.posllh.vertical_accuracy / 10);
         gpsSolDRV.flags.validEPE = true;
+        gpsSolDRV.timeOfWeekMs = _buffer.posllh.time;
+        gpsSolDRV.flags.validTimeOfWeek = true;
         if (next_fix_type != GPS_NO_FIX)
             gpsSolDRV.fixType = next_fix_type;
         _new_position = true;
@@ -666,6 +668,8 @@ static bool gpsParseFrameUBLOX(void)
         gpsSolDRV.flags.validVelNE = true;
         gpsSolDRV.flags.validVelD = true;
         gpsSolDRV.flags.validEPE = true;
+        gpsSolDRV.timeOfWeekMs = _buffer.pvt.time;
+        gpsSolDRV.flags.validTimeOfWeek = true;
 
         if (UBX_VALID_GPS_DATE_TIME(_buffer.pvt.valid)) {
             gpsSolDRV.time.year = _buffer.pvt.year;
@@ -76,9 +76,17 @@ void mspOpflowReceiveNewData(uint8_t * bufferPtr)
     const timeUs_t currentTimeUs = micros();
     const mspSensorOpflowDataMessage_t * pkt = (const mspSensorOpflowDataMessage_t *)bufferPtr;
 
-    sensorData.deltaTime = currentTimeUs - updatedTimeUs;
-    sensorData.flowRateRaw[0] = pkt->motionX;
-    sensorData.flowRateRaw[1] = pkt->motionY;
+    // Sensor may report faster than the OPFLOW task polls, accumulate until read so no motion is lost
+    if (!hasNewData) {
+        sensorData.deltaTime = 0;
+        sensorData.flowRateRaw[0] = 0;
+        sensorData.flowRateRaw[1] = 0;
+    }
+
+    sensorData.timestamp = currentTimeUs;
+    sensorData.deltaTime += currentTimeUs - updatedTimeUs;
+    sensorData.flowRateRaw[0] += pkt->motionX;
+    sensorData.flowRateRaw[1] += pkt->motionY;
     sensorData.flowRateRaw[2] = 0;
     sensorData.quality = (int)pkt->quality * 100 / 255;
     hasNewData = true;
@@ -1761,14 +1761,14 @@ static void osdDisplayAdjustableDecimalValue(uint8_t elemPosX, uint8_t elemPosY,
     displayWriteWithAttr(osdDisplayPort, elemPosX + strlen(str) + 1 + valueOffset, elemPosY, buff, elemAttr);
 }
 
-int8_t getGeoWaypointNumber(int8_t waypointIndex)
+int16_t getGeoWaypointNumber(int16_t waypointIndex)
 {
-    static int8_t lastWaypointIndex = 1;
-    static int8_t geoWaypointIndex;
+    static int16_t lastWaypointIndex = 1;
+    static int16_t geoWaypointIndex;
 
     if (waypointIndex != lastWaypointIndex) {
         lastWaypointIndex = geoWaypointIndex = waypointIndex;
-        for (uint8_t i = posControl.startWpIndex; i <= waypointIndex; i++) {
+        for (int16_t i = posControl.startWpIndex; i <= waypointIndex; i++) {
             if (posControl.waypointList[i].action == NAV_WP_ACTION_SET_POI ||
                 posControl.waypointList[i].action == NAV_WP_ACTION_SET_HEAD ||
                 posControl.waypointList[i].action == NAV_WP_ACTION_JUMP) {
@@ -29,6 +29,7 @@
 
 #if defined(SITL_BUILD)
 #include "target/SITL/serial_proxy.h"
+#include "target/SITL/sim/replay.h"
 #endif
 
 
@@ -72,6 +73,7 @@ int main(void)
     while (true) {
 #if defined(SITL_BUILD)
         serialProxyProcess();
+        simReplayProcess();
 #endif
         scheduler();
         processLoopback();
@@ -135,3 +135,11 @@
 #define MSP2_INAV_SET_AUX_RC                    0x2230
 
 #define MSP2_INAV_WIND                          0x2231
+
+#define MSP2_INAV_WP_BULK                       0x2240  //in/out message  read mission waypoints; payload: U16 first wp number, U8 count
+#define MSP2_INAV_SET_WP_BULK                   0x2241  //in message  upload consecutive mission waypoints; payload: U16 first wp number, then MSP_SET_WP records without the wp number
+
+#define MSP2_INAV_SYSID                         0x2250  //out message  SYSTEM ID mode state and results
+#define MSP2_INAV_SYSID_RESPONSE                0x2251  //in/out message  measured closed loop response; payload: U8 first bin, U8 count
+
+#define MSP2_INAV_SET_TERRAIN                   0x2260  //in message  seed the terrain grid; payload: I32 lat, I32 lon of the first post, U16 post spacing (m), U8 rows, U8 columns, then rows x columns I16 altitudes (m AMSL), rows going north, columns east
@@ -56,6 +56,7 @@
 
 #include "navigation/navigation.h"
 #include "navigation/navigation_private.h"
+#include "navigation/navigation_wp_storage.h"
 #include "navigation/rth_trackback.h"
 
 #include "rx/rx.h"
@@ -112,12 +113,9 @@ PG_RESET_TEMPLATE(navFwAutolandConfig_t, navFwAutolandConfig,
 PG_REGISTER_ARRAY(navSafeHome_t, MAX_SAFE_HOMES, safeHomeConfig, PG_SAFE_HOME_CONFIG , 0);
 #endif
 
-// waypoint 254, 255 are special waypoints
-STATIC_ASSERT(NAV_MAX_WAYPOINTS < 254, NAV_MAX_WAYPOINTS_exceeded_allowable_range);
-
-#if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE)
-PG_REGISTER_ARRAY(navWaypoint_t, NAV_MAX_WAYPOINTS, nonVolatileWaypointList, PG_WAYPOINT_MISSION_STORAGE, 2);
-#endif
+// waypoint numbers above NAV_MAX_WAYPOINTS are special waypoints
+STATIC_ASSERT(NAV_MAX_WAYPOINTS < NAV_WP_NUMBER_GCS_TARGET, NAV_MAX_WAYPOINTS_exceeded_allowable_range);
+STATIC_ASSERT(NAV_MAX_WAYPOINTS <= INT16_MAX, NAV_MAX_WAYPOINTS_exceeds_waypoint_index_range);
 
 PG_REGISTER_WITH_RESET_TEMPLATE(navConfig_t, navConfig, PG_NAV_CONFIG, 7);
 
@@ -1537,7 +1535,7 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_RTH_INITIALIZE(navigati
         }
         else {
             // Switch to RTH trackback
-            if (rthTrackBackCanBeActivated() && rth_trackback.activePointIndex >= 0 && !isWaypointMissionRTHActive()) {
+            if (rthTrackBackCanBeActivated() && rth_trackback.pointCount > 0 && !isWaypointMissionRTHActive()) {
                 rthTrackBackUpdate(true);  // save final trackpoint for altitude and max trackback distance reference
                 posControl.flags.rthTrackbackActive = true;
                 calculateAndSetActiveWaypointToLocalPosition(getRthTrackBackPosition());
@@ -3017,7 +3015,7 @@ static bool getLocalPosNextWaypoint(fpVector3_t * nextWpPos)
         navWaypointActions_e nextWpAction = posControl.waypointList[posControl.activeWaypointIndex + 1].action;
 
         if (!(nextWpAction == NAV_WP_ACTION_SET_POI || nextWpAction == NAV_WP_ACTION_SET_HEAD)) {
-            uint8_t nextWpIndex = posControl.activeWaypointIndex + 1;
+            int16_t nextWpIndex = posControl.activeWaypointIndex + 1;
             if (nextWpAction == NAV_WP_ACTION_JUMP) {
                 if (posControl.waypointList[posControl.activeWaypointIndex + 1].p3 != 0 ||
                     posControl.waypointList[posControl.activeWaypointIndex + 1].p2 == -1) {
@@ -3729,7 +3727,7 @@ static bool adjustAltitudeFromRCInput(void)
  *-----------------------------------------------------------*/
 static void setupJumpCounters(void)
 {
-    for (uint8_t wp = posControl.startWpIndex; wp < posControl.waypointCount + posControl.startWpIndex; wp++) {
+    for (int16_t wp = posControl.startWpIndex; wp < posControl.waypointCount + posControl.startWpIndex; wp++) {
         if (posControl.waypointList[wp].action == NAV_WP_ACTION_JUMP){
             posControl.waypointList[wp].p3 = posControl.waypointList[wp].p2;
         }
@@ -3744,7 +3742,7 @@ static void resetJumpCounter(void)
 
 static void clearJumpCounters(void)
 {
-    for (uint8_t wp = posControl.startWpIndex; wp < posControl.waypointCount + posControl.startWpIndex; wp++) {
+    for (int16_t wp = posControl.startWpIndex; wp < posControl.waypointCount + posControl.startWpIndex; wp++) {
         if (posControl.waypointList[wp].action == NAV_WP_ACTION_JUMP) {
             posControl.waypointList[wp].p3 = 0;
         }
@@ -3817,7 +3815,7 @@ void resetGCSFlags(void)
     posControl.flags.isGCSAssistedNavigationEnabled = false;
 }
 
-void getWaypoint(uint8_t wpNumber, navWaypoint_t * wpData)
+void getWaypoint(uint16_t wpNumber, navWaypoint_t * wpData)
 {
     /* Default waypoint to send */
     wpData->action = NAV_WP_ACTION_RTH;
@@ -3838,7 +3836,7 @@ void getWaypoint(uint8_t wpNumber, navWaypoint_t * wpData)
         }
     }
     // WP #255 - special waypoint - directly get actualPosition
-    else if (wpNumber == 255) {
+    else if (wpNumber == NAV_WP_NUMBER_GCS_POSITION) {
         gpsLocation_t wpLLH;
 
         geoConvertLocalToGeodetic(&wpLLH, &posControl.gpsOrigin, &navGetCurrentActualPositionAndVelocity()->pos);
@@ -3848,7 +3846,7 @@ void getWaypoint(uint8_t wpNumber, navWaypoint_t * wpData)
         wpData->alt = wpLLH.alt;
     }
     // WP #254 - special waypoint - get desiredPosition that was set by ground control station if in 3D-guided mode
-    else if (wpNumber == 254) {
+    else if (wpNumber == NAV_WP_NUMBER_GCS_TARGET) {
         navigationFSMStateFlags_t navStateFlags = navGetStateFlags(posControl.navState);
 
         if ((posControl.gpsOrigin.valid) && (navStateFlags & NAV_CTL_ALT) && (navStateFlags & NAV_CTL_POS)) {
@@ -3861,7 +3859,7 @@ void getWaypoint(uint8_t wpNumber, navWaypoint_t * wpData)
             wpData->alt = wpLLH.alt;
         }
     }
-    // WP #1 - #60 - common waypoints - pre-programmed mission
+    // WP #1 - #NAV_MAX_WAYPOINTS - common waypoints - pre-programmed mission
     else if ((wpNumber >= 1) && (wpNumber <= NAV_MAX_WAYPOINTS)) {
         if (wpNumber <= getWaypointCount()) {
             *wpData = posControl.waypointList[wpNumber - 1 + (ARMING_FLAG(ARMED) ? posControl.startWpIndex : 0)];
@@ -3892,7 +3890,7 @@ int isGCSValid(void)
  * Returns true on success, false when the preconditions are not met (not armed,
  * not in WP mode, or index out of range).
  */
-bool navSetActiveWaypointIndex(uint8_t index)
+bool navSetActiveWaypointIndex(uint16_t index)
 {
     // Must be armed and actively executing a WP mission
     if (!ARMING_FLAG(ARMED) || !FLIGHT_MODE(NAV_WP_MODE)) {
@@ -3900,7 +3898,7 @@ bool navSetActiveWaypointIndex(uint8_t index)
     }
 
     // Translate user-visible 0-based index to the internal absolute index
-    int8_t absoluteIndex = (int8_t)index + posControl.startWpIndex;
+    int32_t absoluteIndex = (int32_t)index + posControl.startWpIndex;
     if (absoluteIndex < posControl.startWpIndex ||
         absoluteIndex >= posControl.startWpIndex + posControl.waypointCount) {
         return false;
@@ -3944,7 +3942,7 @@ bool navSetCruiseHeading(int32_t headingCd)
     return true;
 }
 
-void setWaypoint(uint8_t wpNumber, const navWaypoint_t * wpData)
+void setWaypoint(uint16_t wpNumber, const navWaypoint_t * wpData)
 {
     gpsLocation_t wpLLH;
     navWaypointPosition_t wpPos;
@@ -3962,7 +3960,7 @@ void setWaypoint(uint8_t wpNumber, const navWaypoint_t * wpData)
     }
     // WP #255 - special waypoint - directly set desiredPosition
     // Only valid when armed and in poshold mode
-    else if ((wpNumber == 255) && (wpData->action == NAV_WP_ACTION_WAYPOINT) && isGCSValid()) {
+    else if ((wpNumber == NAV_WP_NUMBER_GCS_POSITION) && (wpData->action == NAV_WP_ACTION_WAYPOINT) && isGCSValid()) {
         // Convert to local coordinates
         geoConvertGeodeticToLocal(&wpPos.pos, &posControl.gpsOrigin, &wpLLH, GEO_ALT_RELATIVE);
 
@@ -3984,7 +3982,7 @@ void setWaypoint(uint8_t wpNumber, const navWaypoint_t * wpData)
         // WP upload is not allowed why WP mode is active
         if (wpData->action == NAV_WP_ACTION_WAYPOINT || wpData->action == NAV_WP_ACTION_JUMP || wpData->action == NAV_WP_ACTION_RTH || wpData->action == NAV_WP_ACTION_HOLD_TIME || wpData->action == NAV_WP_ACTION_LAND || wpData->action == NAV_WP_ACTION_SET_POI || wpData->action == NAV_WP_ACTION_SET_HEAD ) {
             // Only allow upload next waypoint (continue upload mission) or first waypoint (new mission)
-            static int8_t nonGeoWaypointCount = 0;
+            static int16_t nonGeoWaypointCount = 0;
 
             if (wpNumber == (posControl.waypointCount + 1) || wpNumber == 1) {
                 if (wpNumber == 1) {
@@ -4033,7 +4031,7 @@ bool isWaypointListValid(void)
 
 int getWaypointCount(void)
 {
-    uint8_t waypointCount = posControl.waypointCount;
+    int waypointCount = posControl.waypointCount;
 #ifdef USE_MULTI_MISSION
     if (!ARMING_FLAG(ARMED) && posControl.totalMultiMissionWpCount) {
         waypointCount = posControl.totalMultiMissionWpCount;
@@ -4046,36 +4044,26 @@ int getWaypointCount(void)
 void selectMultiMissionIndex(int8_t increment)
 {
     if (posControl.multiMissionCount > 1) {     // stick selection only active when multi mission loaded
-        navConfigMutable()->general.waypoint_multi_mission_index = constrain(navConfigMutable()->general.waypoint_multi_mission_index + increment, 1, posControl.multiMissionCount);
+        navConfigMutable()->general.waypoint_multi_mission_index = constrain(navConfigMutable()->general.waypoint_multi_mission_index + increment, 1, MIN(posControl.multiMissionCount, NAV_MAX_MULTI_MISSIONS));
     }
 }
 
 void loadSelectedMultiMission(uint8_t missionIndex)
 {
-    uint8_t missionCount = 1;
     posControl.waypointCount = 0;
     posControl.geoWaypointCount = 0;
 
-    for (int i = 0; i < NAV_MAX_WAYPOINTS; i++) {
-        if (missionCount == missionIndex) {
-            /* store details of selected mission: start wp index, mission wp count, geo wp count */
+    /* mission boundaries from the index built on load */
+    if (posControl.totalMultiMissionWpCount && missionIndex >= 1 && missionIndex <= MIN(posControl.multiMissionCount, NAV_MAX_MULTI_MISSIONS)) {
+        posControl.startWpIndex = posControl.multiMissionStartWpIndex[missionIndex - 1];
+        posControl.waypointCount = posControl.multiMissionStartWpIndex[missionIndex] - posControl.startWpIndex;
+
+        for (int i = posControl.startWpIndex; i < posControl.startWpIndex + posControl.waypointCount; i++) {
             if (!(posControl.waypointList[i].action == NAV_WP_ACTION_SET_POI ||
                     posControl.waypointList[i].action == NAV_WP_ACTION_SET_HEAD ||
                         posControl.waypointList[i].action == NAV_WP_ACTION_JUMP)) {
                 posControl.geoWaypointCount++;
             }
-            // mission start WP
-            if (posControl.waypointCount == 0) {
-                posControl.waypointCount = 1;   // start marker only, value unimportant (but not 0)
-                posControl.startWpIndex = i;
-            }
-            // mission end WP
-            if (posControl.waypointList[i].flag == NAV_WP_FLAG_LAST) {
-                posControl.waypointCount = i - posControl.startWpIndex + 1;
-                break;
-            }
-        } else if (posControl.waypointList[i].flag == NAV_WP_FLAG_LAST) {
-            missionCount++;
         }
     }
 
@@ -4102,7 +4090,7 @@ bool updateWpMissionChange(void)
 
     static bool toggleFlag = false;
     if (IS_RC_MODE_ACTIVE(BOXNAVWP) && toggleFlag) {
-        if (setMissionIndex == posControl.multiMissionCount) {
+        if (setMissionIndex >= MIN(posControl.multiMissionCount, NAV_MAX_MULTI_MISSIONS)) {
             navConfigMutable()->general.waypoint_multi_mission_index = 1;
         } else {
             selectMultiMissionIndex(1);
@@ -4114,18 +4102,6 @@ bool updateWpMissionChange(void)
     return false;   // block WP mode while changing mission when armed
 }
 
-bool checkMissionCount(int8_t waypoint)
-{
-    if (nonVolatileWaypointList(waypoint)->flag == NAV_WP_FLAG_LAST) {
-        posControl.multiMissionCount += 1;  // count up no missions in multi mission WP file
-        if (waypoint != NAV_MAX_WAYPOINTS - 1) {
-            return (nonVolatileWaypointList(waypoint + 1)->flag == NAV_WP_FLAG_LAST &&
-                    nonVolatileWaypointList(waypoint + 1)->action ==NAV_WP_ACTION_RTH);
-            // end of multi mission file if successive NAV_WP_FLAG_LAST and default action (RTH)
-        }
-    }
-    return false;
-}
 #endif  // multi mission
 #ifdef NAV_NON_VOLATILE_WAYPOINT_STORAGE
 bool loadNonVolatileWaypointList(bool clearIfLoaded)
@@ -4146,14 +4122,23 @@ bool loadNonVolatileWaypointList(bool clearIfLoaded)
         navConfigMutable()->general.waypoint_multi_mission_index = 1;
     }
 #endif
-    for (int i = 0; i < NAV_MAX_WAYPOINTS; i++) {
-        setWaypoint(i + 1, nonVolatileWaypointList(i));
+    navWaypointStorageCursor_t cursor;
+    navWaypoint_t wp;
+
+    resetWaypointList();
+    navWpStorageRewind(&cursor);
+    for (int i = 0; i < NAV_MAX_WAYPOINTS && navWpStorageRead(nonVolatileWaypointStorage(), &cursor, &wp); i++) {
+        setWaypoint(i + 1, &wp);
 #ifdef USE_MULTI_MISSION
-        /* count up number of missions and exit after last multi mission */
-        if (checkMissionCount(i)) {
-            break;
+        /* index the start of the next mission, only the first NAV_MAX_MULTI_MISSIONS are selectable */
+        if (wp.flag == NAV_WP_FLAG_LAST) {
+            if (posControl.multiMissionCount < NAV_MAX_MULTI_MISSIONS) {
+                posControl.multiMissionStartWpIndex[posControl.multiMissionCount + 1] = i + 1;
+            }
+            posControl.multiMissionCount += 1;
         }
     }
+    posControl.multiMissionStartWpIndex[0] = 0;
     posControl.totalMultiMissionWpCount = posControl.waypointCount;
     loadSelectedMultiMission(navConfig()->general.waypoint_multi_mission_index);
 
@@ -4161,10 +4146,6 @@ bool loadNonVolatileWaypointList(bool clearIfLoaded)
      * Also reset if no selected mission loaded (shouldn't happen) */
     if (!posControl.waypointListValid || !posControl.waypointCount) {
 #else
-        // check this is the last waypoint
-        if (nonVolatileWaypointList(i)->flag == NAV_WP_FLAG_LAST) {
-            break;
-        }
     }
 
     // Mission sanity check failed - reset the list
@@ -4181,8 +4162,8 @@ bool saveNonVolatileWaypointList(void)
     if (ARMING_FLAG(ARMED) || !posControl.waypointListValid)
         return false;
 
-    for (int i = 0; i < NAV_MAX_WAYPOINTS; i++) {
-        getWaypoint(i + 1, nonVolatileWaypointListMutable(i));
+    if (!navWpStorageStore(nonVolatileWaypointStorageMutable(), getWaypointCount(), getWaypoint)) {
+        return false;
     }
 #ifdef USE_MULTI_MISSION
     navConfigMutable()->general.waypoint_multi_mission_index = 1;    // reset selected mission to 1 when new entries saved
@@ -4320,7 +4301,7 @@ bool isWaypointNavTrackingActive(void)
 
     return FLIGHT_MODE(NAV_WP_MODE)
     || posControl.navState == NAV_STATE_FW_LANDING_APPROACH
-    || (posControl.flags.rthTrackbackActive && rth_trackback.activePointIndex != rth_trackback.lastSavedIndex);
+    || (posControl.flags.rthTrackbackActive && rth_trackback.pointCount != rth_trackback.savedPointCount);
 }
 
 /*-----------------------------------------------------------
@@ -4802,7 +4783,7 @@ navArmingBlocker_e navigationIsBlockingArming(bool *usedBypass)
      * Only jump to geo-referenced WP types
      */
     if (posControl.waypointCount) {
-        for (uint8_t wp = posControl.startWpIndex; wp < posControl.waypointCount + posControl.startWpIndex; wp++){
+        for (int16_t wp = posControl.startWpIndex; wp < posControl.waypointCount + posControl.startWpIndex; wp++){
             if (posControl.waypointList[wp].action == NAV_WP_ACTION_JUMP){
                 if (wp == posControl.startWpIndex || posControl.waypointList[wp].p1 >= posControl.waypointCount ||
                 (posControl.waypointList[wp].p1 > (wp - posControl.startWpIndex - 2) && posControl.waypointList[wp].p1 < (wp - posControl.startWpIndex + 2)) || posControl.waypointList[wp].p2 < -1) {
@@ -5105,11 +5086,7 @@ void navigationInit(void)
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE)
     /* configure WP missions at boot */
 #ifdef USE_MULTI_MISSION
-    for (int8_t i = 0; i < NAV_MAX_WAYPOINTS; i++) {    // check number missions in NVM
-        if (checkMissionCount(i)) {
-            break;
-        }
-    }
+    posControl.multiMissionCount = nonVolatileWaypointStorage()->missionCount;    // number of missions in NVM
     /* set index to 1 if saved mission index > available missions */
     if (navConfig()->general.waypoint_multi_mission_index > posControl.multiMissionCount) {
         navConfigMutable()->general.waypoint_multi_mission_index = 1;
@@ -5357,7 +5334,7 @@ int8_t navCheckActiveAngleHoldAxis(void)
     return activeAxis;
 }
 
-uint8_t getActiveWpNumber(void)
+uint16_t getActiveWpNumber(void)
 {
     return NAV_Status.activeWpNumber;
 }
@@ -237,6 +237,10 @@ void abortForcedPosHold(void);
 #define NAV_MAX_WAYPOINTS 15
 #endif
 
+// Special waypoint numbers, MSP_WP and MSP_SET_WP address them as #254 and #255
+#define NAV_WP_NUMBER_GCS_TARGET    0xFFFE  // desired position set by the ground control station (read only)
+#define NAV_WP_NUMBER_GCS_POSITION  0xFFFF  // actual position on read, sets the desired position on write
+
 #define NAV_ACCEL_CUTOFF_FREQUENCY_HZ 2       // low-pass filter on XY-acceleration target
 
 enum {
@@ -346,6 +350,11 @@ typedef enum {
     MC_ALT_HOLD_HOVER,
 } navMcAltHoldThrottle_e;
 
+typedef enum {
+    POS_ESTIMATOR_COMPLEMENTARY = 0,
+    POS_ESTIMATOR_EKF,
+} navPositionEstimatorType_e;
+
 typedef struct positionEstimationConfig_s {
     uint8_t automatic_mag_declination;
     uint8_t reset_altitude_type;            // from nav_reset_type_e
@@ -379,9 +388,24 @@ typedef struct positionEstimationConfig_s {
     float baro_epv;             // Baro position error
 
     uint8_t default_alt_sensor; // default altitude sensor source
+    uint8_t gps_delay_ms;       // GPS measurement latency (ms), 0 = auto
+    uint8_t baro_delay_ms;      // Baro measurement latency (ms)
 #ifdef USE_GPS_FIX_ESTIMATION
     uint8_t allow_gps_fix_estimation;
 #endif
+#ifdef USE_POS_ESTIMATOR_EKF
+    uint8_t estimator_type;         // navPositionEstimatorType_e
+    uint8_t ekf_innovation_gate;    // Measurement rejection gate (standard deviations)
+    float ekf_acc_noise;            // Accelerometer noise density (cm/s/s/sqrt(Hz))
+    float ekf_acc_bias_noise;       // Accelerometer bias random walk (cm/s/s/sqrt(s))
+    float ekf_wind_noise;           // Wind random walk (cm/s/sqrt(s))
+    float ekf_gps_vel_noise;        // GPS velocity measurement noise (cm/s)
+    float ekf_airspeed_noise;       // Airspeed measurement noise (cm/s)
+    float ekf_flow_vel_noise;       // Optical flow velocity measurement noise (cm/s)
+#endif
+#ifdef USE_TERRAIN_GRID
+    uint8_t use_terrain_grid;       // Keep AGL from the learned terrain when the rangefinder is out of range
+#endif
 } positionEstimationConfig_t;
 
 PG_DECLARE(positionEstimationConfig_t, positionEstimationConfig);
@@ -653,8 +677,8 @@ typedef struct {
     navSystemStatus_State_e state;
     navSystemStatus_Error_e error;
     navSystemStatus_Flags_e flags;
-    uint8_t                 activeWpNumber;
-    uint8_t                 activeWpIndex;
+    uint16_t                activeWpNumber;
+    uint16_t                activeWpIndex;
     navWaypointActions_e    activeWpAction;
 } navSystemStatus_t;
 
@@ -705,10 +729,10 @@ void getEstimatedPositionAndVelocity(navPositionAndVelocity_t * pos);
 int getWaypointCount(void);
 bool isWaypointListValid(void);
 int isGCSValid(void);
-void getWaypoint(uint8_t wpNumber, navWaypoint_t * wpData);
-void setWaypoint(uint8_t wpNumber, const navWaypoint_t * wpData);
+void getWaypoint(uint16_t wpNumber, navWaypoint_t * wpData);
+void setWaypoint(uint16_t wpNumber, const navWaypoint_t * wpData);
 void resetWaypointList(void);
-bool navSetActiveWaypointIndex(uint8_t index);  // MSP2_INAV_SET_WP_INDEX: jump to WP during active mission
+bool navSetActiveWaypointIndex(uint16_t index);  // MSP2_INAV_SET_WP_INDEX: jump to WP during active mission
 bool navSetCruiseHeading(int32_t headingCd);    // MSP2_INAV_SET_CRUISE_HEADING: set cruise/course-hold heading (centidegrees)
 bool loadNonVolatileWaypointList(bool clearIfLoaded);
 bool saveNonVolatileWaypointList(void);
@@ -815,7 +839,7 @@ void updateBaroAltitudeRate(float newBaroAltRate);
 bool rthAltControlStickOverrideCheck(uint8_t axis);
 
 int8_t navCheckActiveAngleHoldAxis(void);
-uint8_t getActiveWpNumber(void);
+uint16_t getActiveWpNumber(void);
 uint16_t getFlownLoiterRadius(void);
 
 /* Returns the heading recorded when home position was acquired.
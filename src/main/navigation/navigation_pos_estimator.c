@@ -45,6 +45,8 @@
 #include "navigation/navigation.h"
 #include "navigation/navigation_private.h"
 #include "navigation/navigation_pos_estimator_private.h"
+#include "navigation/navigation_pos_estimator_ekf.h"
+#include "navigation/navigation_terrain.h"
 
 #include "sensors/acceleration.h"
 #include "sensors/barometer.h"
@@ -56,8 +58,14 @@
 
 navigationPosEstimator_t posEstimator;
 static float initialBaroAltitudeOffset = 0.0f;
+static timeMs_t lastXYSensorUpdateMs = 0;
+static timeMs_t lastZSensorUpdateMs = 0;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig, PG_POSITION_ESTIMATION_CONFIG, 8);
+#ifdef USE_POS_ESTIMATOR_EKF
+static posEkf_t posEkf;
+#endif
+
+PG_REGISTER_WITH_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig, PG_POSITION_ESTIMATION_CONFIG, 11);
 
 PG_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig,
         // Inertial position estimator parameters
@@ -93,8 +101,23 @@ PG_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig,
         .baro_epv = SETTING_INAV_BARO_EPV_DEFAULT,
 
         .default_alt_sensor = SETTING_INAV_DEFAULT_ALT_SENSOR_DEFAULT,
+        .gps_delay_ms = SETTING_INAV_GPS_DELAY_DEFAULT,
+        .baro_delay_ms = SETTING_INAV_BARO_DELAY_DEFAULT,
 #ifdef USE_GPS_FIX_ESTIMATION
-        .allow_gps_fix_estimation = SETTING_INAV_ALLOW_GPS_FIX_ESTIMATION_DEFAULT
+        .allow_gps_fix_estimation = SETTING_INAV_ALLOW_GPS_FIX_ESTIMATION_DEFAULT,
+#endif
+#ifdef USE_POS_ESTIMATOR_EKF
+        .estimator_type = SETTING_INAV_ESTIMATOR_TYPE_DEFAULT,
+        .ekf_innovation_gate = SETTING_INAV_EKF_INNOVATION_GATE_DEFAULT,
+        .ekf_acc_noise = SETTING_INAV_EKF_ACC_NOISE_DEFAULT,
+        .ekf_acc_bias_noise = SETTING_INAV_EKF_ACC_BIAS_NOISE_DEFAULT,
+        .ekf_wind_noise = SETTING_INAV_EKF_WIND_NOISE_DEFAULT,
+        .ekf_gps_vel_noise = SETTING_INAV_EKF_GPS_VEL_NOISE_DEFAULT,
+        .ekf_airspeed_noise = SETTING_INAV_EKF_AIRSPEED_NOISE_DEFAULT,
+        .ekf_flow_vel_noise = SETTING_INAV_EKF_FLOW_VEL_NOISE_DEFAULT,
+#endif
+#ifdef USE_TERRAIN_GRID
+        .use_terrain_grid = SETTING_INAV_USE_TERRAIN_GRID_DEFAULT,
 #endif
 );
 
@@ -240,6 +263,9 @@ void onNewGPSData(void)
                 float dT = US2S(getGPSDeltaTimeFilter(currentTimeUs - lastGPSNewDataTime));
                 posEstimator.gps.updateDt = dT;
 
+                const uint8_t gpsDelayMs = positionEstimationConfig()->gps_delay_ms;
+                posEstimator.gps.delayUs = MS2US(gpsDelayMs ? gpsDelayMs : gpsGetSolutionLatencyMs());
+
                 /* Use VELNED provided by GPS if available, calculate from coordinates otherwise */
                 float gpsScaleLonDown = constrainf(cos_approx((ABS(gpsSol.llh.lat) / 10000000.0f) * 0.0174532925f), 0.01f, 1.0f);
                 /* SITL (X-Plane DataRef) passes zero velNED — use coordinate-difference velocity instead.
@@ -310,6 +336,7 @@ void updatePositionEstimator_BaroTopic(timeUs_t currentTimeUs)
         posEstimator.baro.alt = newBaroAlt - initialBaroAltitudeOffset;
         posEstimator.baro.epv = positionEstimationConfig()->baro_epv;
         posEstimator.baro.lastUpdateTime = currentTimeUs;
+        posEstimator.baro.delayUs = MS2US(positionEstimationConfig()->baro_delay_ms);
 
         if (baroDtUs > 0 && baroDtUs <= MS2US(INAV_BARO_TIMEOUT_MS)) {
             const float baroDtSec = US2S(baroDtUs);
@@ -530,6 +557,60 @@ static uint32_t calculateCurrentValidityFlags(timeUs_t currentTimeUs)
     return newFlags;
 }
 
+/**
+ * Estimate history
+ *  Samples of the estimate are kept at a fixed interval so a measurement delayed by
+ *  a known latency can be compared to the estimate at the time it was taken
+ */
+static void estimationHistoryReset(void)
+{
+    posEstimator.history.head = 0;
+    posEstimator.history.count = 0;
+}
+
+static void estimationHistoryUpdate(timeUs_t currentTimeUs)
+{
+    navPositionEstimatorHistory_t * history = &posEstimator.history;
+
+    if (history->count && (currentTimeUs - history->lastSampleTime) < INAV_HISTORY_SAMPLE_INTERVAL_US) {
+        return;
+    }
+
+    history->head = (history->head + 1) & (INAV_HISTORY_SAMPLES - 1);
+    history->samples[history->head].pos = posEstimator.est.pos;
+    history->samples[history->head].vel = posEstimator.est.vel;
+    history->count = MIN(history->count + 1, INAV_HISTORY_SAMPLES);
+    history->lastSampleTime = currentTimeUs;
+}
+
+static void estimationHistoryGet(navPositionEstimatorHistorySample_t * sample, timeUs_t delayUs, timeUs_t currentTimeUs)
+{
+    const navPositionEstimatorHistory_t * history = &posEstimator.history;
+    const timeUs_t sinceLastSampleUs = currentTimeUs - history->lastSampleTime;
+
+    // Measurement is newer than the last history sample - use current estimate
+    if (!history->count || delayUs <= sinceLastSampleUs / 2) {
+        sample->pos = posEstimator.est.pos;
+        sample->vel = posEstimator.est.vel;
+        return;
+    }
+
+    const uint32_t age = MIN((delayUs - MIN(delayUs, sinceLastSampleUs) + INAV_HISTORY_SAMPLE_INTERVAL_US / 2) / INAV_HISTORY_SAMPLE_INTERVAL_US, history->count - 1U);
+    *sample = history->samples[(history->head - age) & (INAV_HISTORY_SAMPLES - 1)];
+}
+
+static void estimationHistoryApplyCorrection(uint8_t axis, float posCorr, float velCorr)
+{
+    navPositionEstimatorHistory_t * history = &posEstimator.history;
+
+    // Valid samples are the newest count ones, ending at head
+    for (uint8_t age = 0; age < history->count; age++) {
+        navPositionEstimatorHistorySample_t * sample = &history->samples[(history->head - age) & (INAV_HISTORY_SAMPLES - 1)];
+        sample->pos.v[axis] += posCorr;
+        sample->vel.v[axis] += velCorr;
+    }
+}
+
 static void estimationPredict(estimationContext_t * ctx)
 {
 
@@ -619,19 +700,19 @@ static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
             }
 
             // Altitude
-            float baroAltResidual = wBaro * ((isAirCushionEffectDetected ? baroGroundAlt : posEstimator.baro.alt) - posEstimator.est.pos.z);
+            float baroAltResidual = wBaro * ((isAirCushionEffectDetected ? baroGroundAlt : posEstimator.baro.alt) - ctx->baroRef.pos.z);
 
             // Disable alt pos correction at point of lift off if ground effect active
             if (isAirCushionEffectDetected && isMulticopterThrottleAboveMidHover()) {
                 baroAltResidual = 0.0f;
             }
 
-            const float baroVelZResidual = isAirCushionEffectDetected ? 0.0f : wBaro * (posEstimator.baro.baroAltRate - posEstimator.est.vel.z);
+            const float baroVelZResidual = isAirCushionEffectDetected ? 0.0f : wBaro * (posEstimator.baro.baroAltRate - ctx->baroRef.vel.z);
             const float w_z_baro_p = positionEstimationConfig()->w_z_baro_p;
             const float w_z_baro_v = positionEstimationConfig()->w_z_baro_v;
 
-            ctx->estPosCorr.z = baroAltResidual * w_z_baro_p * dT;
             ctx->estVelCorr.z = baroVelZResidual * w_z_baro_v * dT;
+            ctx->estPosCorr.z = baroAltResidual * w_z_baro_p * dT + ctx->estVelCorr.z * US2S(posEstimator.baro.delayUs);
 
             ctx->newEPV = updateEPE(posEstimator.est.epv, dT, MAX(posEstimator.baro.epv, fabsf(baroAltResidual)), w_z_baro_p);
 
@@ -648,22 +729,24 @@ static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
         if (posEstimator.gps.updateDt) {    // only update corrections once every sensor update
             // Reset current estimate to GPS altitude if estimate not valid (used for GPS and Baro)
             if (!(ctx->newFlags & EST_Z_VALID)) {
-                posEstimator.est.pos.z = posEstimator.gps.pos.z;
+                posEstimator.est.pos.z = posEstimator.gps.pos.z + posEstimator.gps.vel.z * US2S(posEstimator.gps.delayUs);
                 posEstimator.est.vel.z = posEstimator.gps.vel.z;
                 ctx->newEPV = posEstimator.gps.epv;
+                estimationHistoryReset();
             }
             else {
                 ctx->applyCorrectionsZ = true;
                 const float dT = posEstimator.gps.updateDt;
 
                 // Altitude
-                const float gpsAltResidual = wGps * (posEstimator.gps.pos.z - posEstimator.est.pos.z);
-                const float gpsVelZResidual = wGps * (posEstimator.gps.vel.z - posEstimator.est.vel.z);
+                const float gpsAltResidual = wGps * (posEstimator.gps.pos.z - ctx->gpsRef.pos.z);
+                const float gpsVelZResidual = wGps * (posEstimator.gps.vel.z - ctx->gpsRef.vel.z);
                 const float w_z_gps_p = positionEstimationConfig()->w_z_gps_p;
                 const float w_z_gps_v = positionEstimationConfig()->w_z_gps_v;
 
-                ctx->estPosCorr.z += gpsAltResidual * w_z_gps_p * dT;
-                ctx->estVelCorr.z += gpsVelZResidual * w_z_gps_v * dT;
+                const float gpsVelZCorr = gpsVelZResidual * w_z_gps_v * dT;
+                ctx->estPosCorr.z += gpsAltResidual * w_z_gps_p * dT + gpsVelZCorr * US2S(posEstimator.gps.delayUs);
+                ctx->estVelCorr.z += gpsVelZCorr;
 
                 ctx->newEPV = updateEPE(ctx->newEPV, dT, MAX(posEstimator.gps.epv, fabsf(gpsAltResidual)), w_z_gps_p);
 
@@ -691,20 +774,21 @@ static bool estimationCalculateCorrection_XY_GPS(estimationContext_t * ctx)
         }
         /* If GPS is valid and our estimate is NOT valid - reset it to GPS coordinates and velocity */
         if (!(ctx->newFlags & EST_XY_VALID)) {
-            posEstimator.est.pos.x = posEstimator.gps.pos.x;
-            posEstimator.est.pos.y = posEstimator.gps.pos.y;
+            posEstimator.est.pos.x = posEstimator.gps.pos.x + posEstimator.gps.vel.x * US2S(posEstimator.gps.delayUs);
+            posEstimator.est.pos.y = posEstimator.gps.pos.y + posEstimator.gps.vel.y * US2S(posEstimator.gps.delayUs);
             posEstimator.est.vel.x = posEstimator.gps.vel.x;
             posEstimator.est.vel.y = posEstimator.gps.vel.y;
             ctx->newEPH = posEstimator.gps.eph;
+            estimationHistoryReset();
         }
         else {
             ctx->applyCorrectionsXY = true;
             const float dT = posEstimator.gps.updateDt;
 
-            const float gpsPosXResidual = posEstimator.gps.pos.x - posEstimator.est.pos.x;
-            const float gpsPosYResidual = posEstimator.gps.pos.y - posEstimator.est.pos.y;
-            const float gpsVelXResidual = posEstimator.gps.vel.x - posEstimator.est.vel.x;
-            const float gpsVelYResidual = posEstimator.gps.vel.y - posEstimator.est.vel.y;
+            const float gpsPosXResidual = posEstimator.gps.pos.x - ctx->gpsRef.pos.x;
+            const float gpsPosYResidual = posEstimator.gps.pos.y - ctx->gpsRef.pos.y;
+            const float gpsVelXResidual = posEstimator.gps.vel.x - ctx->gpsRef.vel.x;
+            const float gpsVelYResidual = posEstimator.gps.vel.y - ctx->gpsRef.vel.y;
             const float gpsPosResidualMag = calc_length_pythagorean_2D(gpsPosXResidual, gpsPosYResidual);
 
             //const float gpsWeightScaler = scaleRangef(bellCurve(gpsPosResidualMag, INAV_GPS_ACCEPTANCE_EPE), 0.0f, 1.0f, 0.1f, 1.0f);
@@ -713,14 +797,14 @@ static bool estimationCalculateCorrection_XY_GPS(estimationContext_t * ctx)
             const float w_xy_gps_p = positionEstimationConfig()->w_xy_gps_p * gpsWeightScaler;
             const float w_xy_gps_v = positionEstimationConfig()->w_xy_gps_v * sq(gpsWeightScaler);
 
-            // Coordinates
-            ctx->estPosCorr.x = gpsPosXResidual * w_xy_gps_p * dT;
-            ctx->estPosCorr.y = gpsPosYResidual * w_xy_gps_p * dT;
-
             // Velocity from direct measurement
             ctx->estVelCorr.x = gpsVelXResidual * w_xy_gps_v * dT;
             ctx->estVelCorr.y = gpsVelYResidual * w_xy_gps_v * dT;
 
+            // Coordinates. Correction was computed at the time of measurement, propagate it to current time
+            ctx->estPosCorr.x = gpsPosXResidual * w_xy_gps_p * dT + ctx->estVelCorr.x * US2S(posEstimator.gps.delayUs);
+            ctx->estPosCorr.y = gpsPosYResidual * w_xy_gps_p * dT + ctx->estVelCorr.y * US2S(posEstimator.gps.delayUs);
+
             // Accelerometer bias
             ctx->accBiasCorr.x = dT * (gpsPosXResidual * sq(w_xy_gps_p) + gpsVelXResidual * sq(w_xy_gps_v));
             ctx->accBiasCorr.y = dT * (gpsPosYResidual * sq(w_xy_gps_p) + gpsVelYResidual * sq(w_xy_gps_v));
@@ -748,99 +832,68 @@ static void estimationCalculateGroundCourse(timeUs_t currentTimeUs)
     }
 }
 
-/**
- * Calculate next estimate using IMU and apply corrections from reference sensors (GPS, BARO etc)
- *  Function is called at main loop rate
- */
-static void updateEstimatedTopic(timeUs_t currentTimeUs)
+static void estimationUpdateComplementary(estimationContext_t * ctx, timeUs_t currentTimeUs)
 {
-    estimationContext_t ctx;
-    static timeMs_t lastXYSensorUpdateMs = 0;
-    static timeMs_t lastZSensorUpdateMs = 0;
-
     const float max_eph_epv = positionEstimationConfig()->max_eph_epv;
 
-    /* Calculate dT */
-    ctx.dt = US2S(currentTimeUs - posEstimator.est.lastUpdateTime);
-    posEstimator.est.lastUpdateTime = currentTimeUs;
-
-    /* If IMU is not ready we can't estimate anything */
-    if (!isImuReady()) {
-        posEstimator.est.eph = max_eph_epv + 0.001f;
-        posEstimator.est.epv = max_eph_epv + 0.001f;
-        posEstimator.flags = 0;
-        return;
-    }
-
-    /* Calculate new degraded EPH and EPV for the case we didn't update estimation from sensors for > 200ms - linear degradation in max 10s */
-    const bool XYSensorUpdateTimeout = US2MS(currentTimeUs) - lastXYSensorUpdateMs > 200;
-    ctx.newEPH = posEstimator.est.eph + ((posEstimator.est.eph <= max_eph_epv && XYSensorUpdateTimeout) ? 100.0f * ctx.dt : 0.0f);
-    const bool ZSensorUpdateTimeout = US2MS(currentTimeUs) - lastZSensorUpdateMs > 200;
-    ctx.newEPV = posEstimator.est.epv + ((posEstimator.est.epv <= max_eph_epv && ZSensorUpdateTimeout) ? 100.0f * ctx.dt : 0.0f);
-
-    ctx.newFlags = calculateCurrentValidityFlags(currentTimeUs);
-    vectorZero(&ctx.estPosCorr);
-    vectorZero(&ctx.estVelCorr);
-    vectorZero(&ctx.accBiasCorr);
-    ctx.applyCorrectionsXY = false;
-    ctx.applyCorrectionsZ = false;
-
-    /* AGL estimation - separate process, decouples from Z coordinate */
-    estimationCalculateAGL(&ctx);
-
     /* Prediction stage: X,Y,Z */
-    estimationPredict(&ctx);
+    estimationPredict(ctx);
+
+    /* Estimates at the time reference sensor measurements were taken */
+    estimationHistoryGet(&ctx->gpsRef, posEstimator.gps.delayUs, currentTimeUs);
+    estimationHistoryGet(&ctx->baroRef, posEstimator.baro.delayUs, currentTimeUs);
 
     /* Correction stage: Z */
-    const bool estZCorrectOk = estimationCalculateCorrection_Z(&ctx);
+    const bool estZCorrectOk = estimationCalculateCorrection_Z(ctx);
 
     /* Correction stage: XY: GPS, FLOW */
     // FIXME: Handle transition from FLOW to GPS and back - seamlessly fly indoor/outdoor
-    const bool estXYCorrectOk = estimationCalculateCorrection_XY_GPS(&ctx) || estimationCalculateCorrection_XY_FLOW(&ctx);
+    const bool estXYCorrectOk = estimationCalculateCorrection_XY_GPS(ctx) || estimationCalculateCorrection_XY_FLOW(ctx);
 
     // If we can't apply correction or accuracy is off the charts - decay velocity to zero
-    if (!estXYCorrectOk || ctx.newEPH > max_eph_epv) {
+    if (!estXYCorrectOk || ctx->newEPH > max_eph_epv) {
         const float w_xy_res_v = positionEstimationConfig()->w_xy_res_v;
-        posEstimator.est.vel.x -= posEstimator.est.vel.x * w_xy_res_v * ctx.dt;
-        posEstimator.est.vel.y -= posEstimator.est.vel.y * w_xy_res_v * ctx.dt;
+        posEstimator.est.vel.x -= posEstimator.est.vel.x * w_xy_res_v * ctx->dt;
+        posEstimator.est.vel.y -= posEstimator.est.vel.y * w_xy_res_v * ctx->dt;
     }
 
-    if (!estZCorrectOk || ctx.newEPV > max_eph_epv) {
-        posEstimator.est.vel.z -= posEstimator.est.vel.z * positionEstimationConfig()->w_z_res_v * ctx.dt;
+    if (!estZCorrectOk || ctx->newEPV > max_eph_epv) {
+        posEstimator.est.vel.z -= posEstimator.est.vel.z * positionEstimationConfig()->w_z_res_v * ctx->dt;
     }
 
     // Only apply corrections if new sensor update available
-    if (ctx.applyCorrectionsXY || ctx.applyCorrectionsZ) {
+    if (ctx->applyCorrectionsXY || ctx->applyCorrectionsZ) {
         float maxUpdateDt = MAX(posEstimator.gps.updateDt, posEstimator.baro.updateDt);
         maxUpdateDt = MAX(maxUpdateDt, posEstimator.flow.updateDt);
         float correctionLimit = INAV_EST_CORR_LIMIT_VALUE * maxUpdateDt;
 
         uint8_t axisStart = 0;
         uint8_t axisEnd = 2;
-        if (!ctx.applyCorrectionsXY) {
+        if (!ctx->applyCorrectionsXY) {
             axisStart = 2;
-        } else if (!ctx.applyCorrectionsZ) {
+        } else if (!ctx->applyCorrectionsZ) {
             axisEnd = 1;
         }
 
         for (uint8_t axis = axisStart; axis <= axisEnd; axis++) {
             // Boost the corrections based on accWeight
-            ctx.estPosCorr.v[axis] *= 1.0f / posEstimator.imu.accWeightFactor;
-            ctx.estVelCorr.v[axis] *= 1.0f / posEstimator.imu.accWeightFactor;
+            ctx->estPosCorr.v[axis] *= 1.0f / posEstimator.imu.accWeightFactor;
+            ctx->estVelCorr.v[axis] *= 1.0f / posEstimator.imu.accWeightFactor;
 
             // Constrain corrections to prevent instability
-            ctx.estPosCorr.v[axis] = constrainf(ctx.estPosCorr.v[axis], -correctionLimit, correctionLimit);
-            ctx.estVelCorr.v[axis] = constrainf(ctx.estVelCorr.v[axis], -correctionLimit, correctionLimit);
+            ctx->estPosCorr.v[axis] = constrainf(ctx->estPosCorr.v[axis], -correctionLimit, correctionLimit);
+            ctx->estVelCorr.v[axis] = constrainf(ctx->estVelCorr.v[axis], -correctionLimit, correctionLimit);
 
             // Apply corrections
-            posEstimator.est.pos.v[axis] += ctx.estPosCorr.v[axis];
-            posEstimator.est.vel.v[axis] += ctx.estVelCorr.v[axis];
+            posEstimator.est.pos.v[axis] += ctx->estPosCorr.v[axis];
+            posEstimator.est.vel.v[axis] += ctx->estVelCorr.v[axis];
+            estimationHistoryApplyCorrection(axis, ctx->estPosCorr.v[axis], ctx->estVelCorr.v[axis]);
 
             /* Correct accelerometer bias */
             const float w_acc_bias = positionEstimationConfig()->w_acc_bias;
             if (w_acc_bias > 0.0f) {
                 /* Correct accel bias */
-                posEstimator.imu.accelBias.v[axis] += ctx.accBiasCorr.v[axis] * w_acc_bias;
+                posEstimator.imu.accelBias.v[axis] += ctx->accBiasCorr.v[axis] * w_acc_bias;
                 posEstimator.imu.accelBias.v[axis] = constrainf(posEstimator.imu.accelBias.v[axis], -INAV_ACC_BIAS_ACCEPTANCE_VALUE, INAV_ACC_BIAS_ACCEPTANCE_VALUE);
             }
         }
@@ -849,15 +902,224 @@ static void updateEstimatedTopic(timeUs_t currentTimeUs)
         posEstimator.gps.updateDt = 0.0f;
         posEstimator.baro.updateDt = 0.0f;
         posEstimator.flow.updateDt = 0.0f;
+        posEstimator.flow.velocity[X] = 0;
+        posEstimator.flow.velocity[Y] = 0;
 
-        if (ctx.applyCorrectionsXY) {
+        if (ctx->applyCorrectionsXY) {
             lastXYSensorUpdateMs = US2MS(currentTimeUs);
         }
-        if (ctx.applyCorrectionsZ) {
+        if (ctx->applyCorrectionsZ) {
+            lastZSensorUpdateMs = US2MS(currentTimeUs);
+        }
+    }
+}
+
+#ifdef USE_POS_ESTIMATOR_EKF
+static void estimationInitEKF(void)
+{
+    const posEkfParams_t params = {
+        .accNoise = positionEstimationConfig()->ekf_acc_noise,
+        .accBiasNoise = positionEstimationConfig()->ekf_acc_bias_noise,
+        .windNoise = positionEstimationConfig()->ekf_wind_noise,
+        .innovationGate = positionEstimationConfig()->ekf_innovation_gate,
+    };
+
+    posEkfInit(&posEkf, &params);
+}
+
+static void estimationPublishEKF(void)
+{
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        posEstimator.est.pos.v[axis] = posEkf.x[POS_EKF_POS(axis)];
+        posEstimator.est.vel.v[axis] = posEkf.x[POS_EKF_VEL(axis)];
+    }
+}
+
+static void estimationUpdateEKF(estimationContext_t * ctx, timeUs_t currentTimeUs)
+{
+    const float max_eph_epv = positionEstimationConfig()->max_eph_epv;
+    const uint8_t defaultAltitudeSource = positionEstimationConfig()->default_alt_sensor;
+    const float gpsVelVariance = sq(positionEstimationConfig()->ekf_gps_vel_noise);
+    bool estXYCorrectOk = false;
+    bool estZCorrectOk = false;
+
+    /* Prediction stage: X,Y,Z */
+    posEkfPredict(&posEkf, &posEstimator.imu.accelNEU, navIsHeadingUsable() && navIsAccelerationUsable(), posEstimator.imu.accWeightFactor, ctx->dt);
+    estimationPublishEKF();
+
+    /* Estimates at the time reference sensor measurements were taken */
+    estimationHistoryGet(&ctx->gpsRef, posEstimator.gps.delayUs, currentTimeUs);
+    estimationHistoryGet(&ctx->baroRef, posEstimator.baro.delayUs, currentTimeUs);
+
+    /* Correction stage: Z - BARO */
+    const bool useBaro = (ctx->newFlags & EST_BARO_VALID) &&
+                         !(defaultAltitudeSource == ALTITUDE_SOURCE_GPS_ONLY && (ctx->newFlags & EST_GPS_Z_VALID));
+    if (useBaro) {
+        if (posEstimator.baro.updateDt) {
+            const float baroVariance = sq(MAX(posEstimator.baro.epv, 1.0f));
+            if (!(ctx->newFlags & EST_Z_VALID)) {
+                posEkfResetState(&posEkf, POS_EKF_POS_Z, posEstimator.baro.alt, baroVariance);
+                posEkfResetState(&posEkf, POS_EKF_VEL_Z, posEstimator.baro.baroAltRate, gpsVelVariance);
+                estimationHistoryReset();
+            }
+            else {
+                posEkfFuseStateDelayed(&posEkf, POS_EKF_POS_Z, posEstimator.baro.alt, ctx->baroRef.pos.z, baroVariance);
+            }
+            lastZSensorUpdateMs = US2MS(currentTimeUs);
+        }
+        estZCorrectOk = true;
+    }
+
+    /* Correction stage: Z - GPS */
+    const bool useGpsZ = (ctx->newFlags & EST_GPS_Z_VALID) &&
+                         !(defaultAltitudeSource == ALTITUDE_SOURCE_BARO_ONLY && (ctx->newFlags & EST_BARO_VALID));
+    if (useGpsZ) {
+        if (posEstimator.gps.updateDt) {
+            if (!(ctx->newFlags & EST_Z_VALID) && !useBaro) {
+                posEkfResetState(&posEkf, POS_EKF_POS_Z, posEstimator.gps.pos.z + posEstimator.gps.vel.z * US2S(posEstimator.gps.delayUs), sq(posEstimator.gps.epv));
+                posEkfResetState(&posEkf, POS_EKF_VEL_Z, posEstimator.gps.vel.z, gpsVelVariance);
+                estimationHistoryReset();
+            }
+            else {
+                const float velZBeforeUpdate = posEkf.x[POS_EKF_VEL_Z];
+                posEkfFuseStateDelayed(&posEkf, POS_EKF_POS_Z, posEstimator.gps.pos.z, ctx->gpsRef.pos.z, sq(posEstimator.gps.epv));
+                posEkfFuseStateDelayed(&posEkf, POS_EKF_VEL_Z, posEstimator.gps.vel.z, ctx->gpsRef.vel.z, gpsVelVariance);
+                // Propagate velocity correction made at the time of measurement to current time
+                posEkf.x[POS_EKF_POS_Z] += (posEkf.x[POS_EKF_VEL_Z] - velZBeforeUpdate) * US2S(posEstimator.gps.delayUs);
+            }
             lastZSensorUpdateMs = US2MS(currentTimeUs);
         }
+        estZCorrectOk = true;
+    }
+
+    /* Correction stage: XY - GPS */
+    if (ctx->newFlags & EST_GPS_XY_VALID) {
+        if (posEstimator.gps.updateDt) {
+            const float gpsPosVariance = sq(posEstimator.gps.eph);
+            for (uint8_t axis = X; axis <= Y; axis++) {
+                if (!(ctx->newFlags & EST_XY_VALID)) {
+                    posEkfResetState(&posEkf, POS_EKF_POS(axis), posEstimator.gps.pos.v[axis] + posEstimator.gps.vel.v[axis] * US2S(posEstimator.gps.delayUs), gpsPosVariance);
+                    posEkfResetState(&posEkf, POS_EKF_VEL(axis), posEstimator.gps.vel.v[axis], gpsVelVariance);
+                    estimationHistoryReset();
+                }
+                else {
+                    const float velBeforeUpdate = posEkf.x[POS_EKF_VEL(axis)];
+                    posEkfFuseStateDelayed(&posEkf, POS_EKF_POS(axis), posEstimator.gps.pos.v[axis], ctx->gpsRef.pos.v[axis], gpsPosVariance);
+                    posEkfFuseStateDelayed(&posEkf, POS_EKF_VEL(axis), posEstimator.gps.vel.v[axis], ctx->gpsRef.vel.v[axis], gpsVelVariance);
+                    posEkf.x[POS_EKF_POS(axis)] += (posEkf.x[POS_EKF_VEL(axis)] - velBeforeUpdate) * US2S(posEstimator.gps.delayUs);
+                }
+            }
+            lastXYSensorUpdateMs = US2MS(currentTimeUs);
+        }
+        estXYCorrectOk = true;
+    }
+    /* Correction stage: XY - FLOW. As in the complementary filter flow is only used without GPS */
+    else if (estimationFlowIsUsableXY(ctx)) {
+        if (posEstimator.flow.updateDt) {
+            const float flowVelVariance = sq(positionEstimationConfig()->ekf_flow_vel_noise);
+            for (uint8_t axis = X; axis <= Y; axis++) {
+                // Average velocity of the flow samples since the last update
+                posEkfFuseState(&posEkf, POS_EKF_VEL(axis), posEstimator.flow.velocity[axis] / posEstimator.flow.updateDt, flowVelVariance);
+            }
+            lastXYSensorUpdateMs = US2MS(currentTimeUs);
+        }
+        estXYCorrectOk = true;
+    }
+
+#if defined(USE_PITOT)
+    /* Correction stage: airspeed. Virtual airspeed is derived from GPS and can't be fused */
+    static timeUs_t lastPitotFuseTime = 0;
+    if (sensors(SENSOR_PITOT) && detectedSensors[SENSOR_INDEX_PITOT] != PITOT_VIRTUAL && !pitotHasFailed() &&
+            pitotGetValidForAirspeed() && (ctx->newFlags & EST_XY_VALID) && posEstimator.pitot.lastUpdateTime != lastPitotFuseTime) {
+        posEkfFuseAirspeed(&posEkf, posEstimator.pitot.airspeed, sq(positionEstimationConfig()->ekf_airspeed_noise));
+        lastPitotFuseTime = posEstimator.pitot.lastUpdateTime;
+    }
+#endif
+
+    // If we can't apply correction or accuracy is off the charts - decay velocity to zero
+    if (!estXYCorrectOk || ctx->newEPH > max_eph_epv) {
+        const float w_xy_res_v = positionEstimationConfig()->w_xy_res_v;
+        posEkf.x[POS_EKF_VEL_X] -= posEkf.x[POS_EKF_VEL_X] * w_xy_res_v * ctx->dt;
+        posEkf.x[POS_EKF_VEL_Y] -= posEkf.x[POS_EKF_VEL_Y] * w_xy_res_v * ctx->dt;
+    }
+
+    if (!estZCorrectOk || ctx->newEPV > max_eph_epv) {
+        posEkf.x[POS_EKF_VEL_Z] -= posEkf.x[POS_EKF_VEL_Z] * positionEstimationConfig()->w_z_res_v * ctx->dt;
+    }
+
+    posEstimator.gps.updateDt = 0.0f;
+    posEstimator.baro.updateDt = 0.0f;
+    posEstimator.flow.updateDt = 0.0f;
+    posEstimator.flow.velocity[X] = 0;
+    posEstimator.flow.velocity[Y] = 0;
+
+    /* Shift history by the correction applied in this iteration, estimate was published right after prediction */
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        estimationHistoryApplyCorrection(axis, posEkf.x[POS_EKF_POS(axis)] - posEstimator.est.pos.v[axis], posEkf.x[POS_EKF_VEL(axis)] - posEstimator.est.vel.v[axis]);
     }
 
+    estimationPublishEKF();
+
+    /* Uncertainty comes straight from the covariance */
+    ctx->newEPH = MAX(posEkfGetStdDev(&posEkf, POS_EKF_POS_X), posEkfGetStdDev(&posEkf, POS_EKF_POS_Y));
+    ctx->newEPV = posEkfGetStdDev(&posEkf, POS_EKF_POS_Z);
+
+    DEBUG_SET(DEBUG_VIBE, 5, posEkf.x[POS_EKF_ACC_BIAS_X]);
+    DEBUG_SET(DEBUG_VIBE, 6, posEkf.x[POS_EKF_ACC_BIAS_Y]);
+    DEBUG_SET(DEBUG_VIBE, 7, posEkf.x[POS_EKF_ACC_BIAS_Z]);
+}
+#endif
+
+/**
+ * Calculate next estimate using IMU and apply corrections from reference sensors (GPS, BARO etc)
+ *  Function is called at main loop rate
+ */
+static void updateEstimatedTopic(timeUs_t currentTimeUs)
+{
+    estimationContext_t ctx;
+
+    const float max_eph_epv = positionEstimationConfig()->max_eph_epv;
+
+    /* Calculate dT */
+    ctx.dt = US2S(currentTimeUs - posEstimator.est.lastUpdateTime);
+    posEstimator.est.lastUpdateTime = currentTimeUs;
+
+    /* If IMU is not ready we can't estimate anything */
+    if (!isImuReady()) {
+        posEstimator.est.eph = max_eph_epv + 0.001f;
+        posEstimator.est.epv = max_eph_epv + 0.001f;
+        posEstimator.flags = 0;
+        return;
+    }
+
+    /* Calculate new degraded EPH and EPV for the case we didn't update estimation from sensors for > 200ms - linear degradation in max 10s */
+    const bool XYSensorUpdateTimeout = US2MS(currentTimeUs) - lastXYSensorUpdateMs > 200;
+    ctx.newEPH = posEstimator.est.eph + ((posEstimator.est.eph <= max_eph_epv && XYSensorUpdateTimeout) ? 100.0f * ctx.dt : 0.0f);
+    const bool ZSensorUpdateTimeout = US2MS(currentTimeUs) - lastZSensorUpdateMs > 200;
+    ctx.newEPV = posEstimator.est.epv + ((posEstimator.est.epv <= max_eph_epv && ZSensorUpdateTimeout) ? 100.0f * ctx.dt : 0.0f);
+
+    ctx.newFlags = calculateCurrentValidityFlags(currentTimeUs);
+    vectorZero(&ctx.estPosCorr);
+    vectorZero(&ctx.estVelCorr);
+    vectorZero(&ctx.accBiasCorr);
+    ctx.applyCorrectionsXY = false;
+    ctx.applyCorrectionsZ = false;
+
+    /* AGL estimation - separate process, decouples from Z coordinate */
+    estimationCalculateAGL(&ctx);
+
+#ifdef USE_POS_ESTIMATOR_EKF
+    if (positionEstimationConfig()->estimator_type == POS_ESTIMATOR_EKF) {
+        estimationUpdateEKF(&ctx, currentTimeUs);
+    }
+    else
+#endif
+    {
+        estimationUpdateComplementary(&ctx, currentTimeUs);
+    }
+
+    estimationHistoryUpdate(currentTimeUs);
+
     /* Update ground course */
     estimationCalculateGroundCourse(currentTimeUs);
 
@@ -960,11 +1222,17 @@ void initializePositionEstimator(void)
     posEstimator.est.aglAlt = 0;
     posEstimator.est.aglVel = 0;
 
+#ifdef USE_TERRAIN_GRID
+    terrainGridReset();
+#endif
+
     posEstimator.est.flowCoordinates[X] = 0;
     posEstimator.est.flowCoordinates[Y] = 0;
 
     posEstimator.imu.accWeightFactor = 0;
 
+    estimationHistoryReset();
+
     restartGravityCalibration();
 
     for (uint8_t axis = 0; axis < 3; axis++) {
@@ -975,6 +1243,10 @@ void initializePositionEstimator(void)
 
     pt1FilterInit(&posEstimator.baro.avgFilter, INAV_BARO_AVERAGE_HZ, 0.0f);
     pt1FilterInit(&posEstimator.surface.avgFilter, INAV_SURFACE_AVERAGE_HZ, 0.0f);
+
+#ifdef USE_POS_ESTIMATOR_EKF
+    estimationInitEKF();
+#endif
 }
 
 /**
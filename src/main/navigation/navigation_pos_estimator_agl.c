@@ -35,6 +35,7 @@
 #include "navigation/navigation.h"
 #include "navigation/navigation_private.h"
 #include "navigation/navigation_pos_estimator_private.h"
+#include "navigation/navigation_terrain.h"
 
 #include "sensors/rangefinder.h"
 #include "sensors/barometer.h"
@@ -74,6 +75,33 @@ void updatePositionEstimator_SurfaceTopic(timeUs_t currentTimeUs, float newSurfa
             pt1FilterApply3(&posEstimator.surface.avgFilter, newSurfaceAlt, surfaceDt);
         }
     }
+
+#ifdef USE_TERRAIN_GRID
+    // Learn the ground altitude below while both the rangefinder and the position can be trusted
+    const float max_eph_epv = positionEstimationConfig()->max_eph_epv;
+    if (positionEstimationConfig()->use_terrain_grid && surfaceMeasurementWithinRange &&
+            posEstimator.surface.reliability >= RANGEFINDER_RELIABILITY_HIGH_THRESHOLD &&
+            posEstimator.est.eph < max_eph_epv && posEstimator.est.epv < max_eph_epv) {
+        const int32_t groundAltitude = posControl.gpsOrigin.alt + lrintf(posEstimator.est.pos.z - newSurfaceAlt);
+        terrainGridLearn(&posControl.gpsOrigin, posEstimator.est.pos.x, posEstimator.est.pos.y, groundAltitude);
+    }
+#endif
+}
+#endif
+
+#if defined(USE_RANGEFINDER) && defined(USE_BARO) && defined(USE_TERRAIN_GRID)
+// Ground height below from the terrain grid, in the altitude frame of the estimate
+static bool terrainGroundHeight(float *groundHeight)
+{
+    float terrainAltitude;
+
+    if (!positionEstimationConfig()->use_terrain_grid || posEstimator.est.eph >= positionEstimationConfig()->max_eph_epv ||
+            !terrainGridGetAltitude(&posControl.gpsOrigin, posEstimator.est.pos.x, posEstimator.est.pos.y, &terrainAltitude)) {
+        return false;
+    }
+
+    *groundHeight = terrainAltitude - posControl.gpsOrigin.alt;
+    return true;
 }
 #endif
 
@@ -122,6 +150,15 @@ void estimationCalculateAGL(estimationContext_t * ctx)
                 break;
         }
 
+#ifdef USE_TERRAIN_GRID
+        // Out of rangefinder reach the learned terrain still gives the ground height, the MID correction blends over to it
+        float groundHeight;
+        if (newAglQuality != SURFACE_QUAL_HIGH && terrainGroundHeight(&groundHeight)) {
+            posEstimator.est.aglOffset = groundHeight;
+            newAglQuality = SURFACE_QUAL_MID;
+        }
+#endif
+
         posEstimator.est.aglQual = newAglQuality;
 
         if (resetSurfaceEstimate) {
@@ -173,9 +210,17 @@ void estimationCalculateAGL(estimationContext_t * ctx)
         }
     }
     else {
+        navAGLEstimateQuality_e newAglQuality = SURFACE_QUAL_LOW;
+#ifdef USE_TERRAIN_GRID
+        float groundHeight;
+        if (terrainGroundHeight(&groundHeight)) {
+            posEstimator.est.aglOffset = groundHeight;
+            newAglQuality = SURFACE_QUAL_MID;
+        }
+#endif
         posEstimator.est.aglAlt = posEstimator.est.pos.z - posEstimator.est.aglOffset;
         posEstimator.est.aglVel = posEstimator.est.vel.z;
-        posEstimator.est.aglQual = SURFACE_QUAL_LOW;
+        posEstimator.est.aglQual = newAglQuality;
     }
 
     DEBUG_SET(DEBUG_AGL, 0, posEstimator.surface.reliability * 1000);
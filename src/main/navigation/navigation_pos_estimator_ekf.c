@@ -0,0 +1,229 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* --------------------------------------------------------------------------------
+ * == Position EKF ==
+ * Error-state Kalman filter estimating position, velocity, accelerometer bias (NEU)
+ * and horizontal wind. Prediction is driven by the earth-frame accelerometer,
+ * GPS, baro and airspeed are fused as scalar measurements.
+ *
+ * State transition only couples pos/vel/bias of the same axis, so the covariance
+ * prediction is done as in-place row/column operations instead of a full
+ * F * P * F' product. Measurement updates only touch the upper triangle of P
+ * and mirror it, keeping P exactly symmetric.
+ * --------------------------------------------------------------------------------- */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_POS_ESTIMATOR_EKF
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/matrix.h"
+
+#include "navigation/navigation_pos_estimator_ekf.h"
+
+#include "sensors/acceleration.h"
+
+#define POS_EKF_MAX_ACC_BIAS        (GRAVITY_CMSS * 0.25f)  // Same acceptance limit as the complementary estimator
+#define POS_EKF_MIN_VARIANCE        1e-4f                   // Keep diagonal positive despite rounding
+#define POS_EKF_MIN_AIRSPEED        100.0f                  // Airspeed model is not linearizable close to zero (cm/s)
+
+#define POS_EKF_INIT_POS_VARIANCE       sq(1000.0f)
+#define POS_EKF_INIT_VEL_VARIANCE       sq(500.0f)
+#define POS_EKF_INIT_ACC_BIAS_VARIANCE  sq(20.0f)
+#define POS_EKF_INIT_WIND_VARIANCE      sq(500.0f)
+
+void posEkfInit(posEkf_t *ekf, const posEkfParams_t *params)
+{
+    memset(ekf, 0, sizeof(posEkf_t));
+    ekf->params = *params;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        ekf->P[POS_EKF_POS(axis)][POS_EKF_POS(axis)] = POS_EKF_INIT_POS_VARIANCE;
+        ekf->P[POS_EKF_VEL(axis)][POS_EKF_VEL(axis)] = POS_EKF_INIT_VEL_VARIANCE;
+        ekf->P[POS_EKF_ACC_BIAS(axis)][POS_EKF_ACC_BIAS(axis)] = POS_EKF_INIT_ACC_BIAS_VARIANCE;
+    }
+
+    ekf->P[POS_EKF_WIND_X][POS_EKF_WIND_X] = POS_EKF_INIT_WIND_VARIANCE;
+    ekf->P[POS_EKF_WIND_Y][POS_EKF_WIND_Y] = POS_EKF_INIT_WIND_VARIANCE;
+}
+
+/**
+ * Force a state to a known value and decorrelate it from the rest of the filter
+ */
+void posEkfResetState(posEkf_t *ekf, posEkfState_e state, float value, float variance)
+{
+    ekf->x[state] = value;
+
+    for (int i = 0; i < POS_EKF_STATE_COUNT; i++) {
+        ekf->P[state][i] = 0.0f;
+        ekf->P[i][state] = 0.0f;
+    }
+
+    ekf->P[state][state] = MAX(variance, POS_EKF_MIN_VARIANCE);
+}
+
+/**
+ * Propagate state and covariance with earth-frame acceleration (gravity removed)
+ *  accWeight scales down accelerometer trust on vibration or clipping (1.0 = full trust)
+ */
+void posEkfPredict(posEkf_t *ekf, const fpVector3_t *accelNEU, bool useAccelXY, float accWeight, float dt)
+{
+    float (*P)[POS_EKF_STATE_COUNT] = ekf->P;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const int p = POS_EKF_POS(axis);
+        const int v = POS_EKF_VEL(axis);
+        const int b = POS_EKF_ACC_BIAS(axis);
+        const bool useAccel = useAccelXY || axis == Z;
+        const float acc = useAccel ? accelNEU->v[axis] - ekf->x[b] : 0.0f;
+
+        ekf->x[p] += ekf->x[v] * dt + acc * sq(dt) * 0.5f;
+        ekf->x[v] += acc * dt;
+
+        // F differs from identity only in F[p][v] = dt and F[v][b] = -dt. Apply F from the left (rows)...
+        for (int i = 0; i < POS_EKF_STATE_COUNT; i++) {
+            P[p][i] += P[v][i] * dt;
+            if (useAccel) {
+                P[v][i] -= P[b][i] * dt;
+            }
+        }
+
+        // ...and F' from the right (columns)
+        for (int i = 0; i < POS_EKF_STATE_COUNT; i++) {
+            P[i][p] += P[i][v] * dt;
+            if (useAccel) {
+                P[i][v] -= P[i][b] * dt;
+            }
+        }
+    }
+
+    const float accVariance = sq(ekf->params.accNoise / constrainf(accWeight, 0.1f, 1.0f)) * dt;
+    const float accBiasVariance = sq(ekf->params.accBiasNoise) * dt;
+    const float windVariance = sq(ekf->params.windNoise) * dt;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        P[POS_EKF_VEL(axis)][POS_EKF_VEL(axis)] += accVariance;
+        P[POS_EKF_ACC_BIAS(axis)][POS_EKF_ACC_BIAS(axis)] += accBiasVariance;
+    }
+
+    P[POS_EKF_WIND_X][POS_EKF_WIND_X] += windVariance;
+    P[POS_EKF_WIND_Y][POS_EKF_WIND_Y] += windVariance;
+}
+
+/**
+ * Scalar measurement update with a sparse observation row H (count non-zero elements)
+ */
+static bool posEkfFuseSparse(posEkf_t *ekf, const uint8_t *index, const float *h, const uint8_t count, const float innovation, const float variance)
+{
+    float (*P)[POS_EKF_STATE_COUNT] = ekf->P;
+    float PHt[POS_EKF_STATE_COUNT];
+
+    for (int i = 0; i < POS_EKF_STATE_COUNT; i++) {
+        PHt[i] = 0.0f;
+        for (int k = 0; k < count; k++) {
+            PHt[i] += P[i][index[k]] * h[k];
+        }
+    }
+
+    float innovationVariance = variance;
+    for (int k = 0; k < count; k++) {
+        innovationVariance += h[k] * PHt[index[k]];
+    }
+
+    if (innovationVariance <= 0.0f) {
+        return false;
+    }
+
+    if (ekf->params.innovationGate > 0.0f && sq(innovation) > sq(ekf->params.innovationGate) * innovationVariance) {
+        ekf->rejectedCount++;
+        return false;
+    }
+
+    const float invS = 1.0f / innovationVariance;
+
+    for (int i = 0; i < POS_EKF_STATE_COUNT; i++) {
+        ekf->x[i] += PHt[i] * invS * innovation;
+    }
+
+    // P = P - K * H * P, with K = PHt / S
+    matrixSymmetricRankOneUpdate(&P[0][0], POS_EKF_STATE_COUNT, -invS, PHt);
+    for (int i = 0; i < POS_EKF_STATE_COUNT; i++) {
+        P[i][i] = MAX(P[i][i], POS_EKF_MIN_VARIANCE);
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        ekf->x[POS_EKF_ACC_BIAS(axis)] = constrainf(ekf->x[POS_EKF_ACC_BIAS(axis)], -POS_EKF_MAX_ACC_BIAS, POS_EKF_MAX_ACC_BIAS);
+    }
+
+    return true;
+}
+
+/**
+ * Fuse a direct observation of one state (GPS position/velocity, baro altitude)
+ */
+bool posEkfFuseState(posEkf_t *ekf, posEkfState_e state, float measurement, float variance)
+{
+    return posEkfFuseStateDelayed(ekf, state, measurement, ekf->x[state], variance);
+}
+
+/**
+ * Fuse a delayed direct observation. Innovation is taken against the estimate at the
+ * time of measurement (delayedEstimate) and the correction is applied to the current state.
+ */
+bool posEkfFuseStateDelayed(posEkf_t *ekf, posEkfState_e state, float measurement, float delayedEstimate, float variance)
+{
+    const uint8_t index = state;
+    const float h = 1.0f;
+
+    return posEkfFuseSparse(ekf, &index, &h, 1, measurement - delayedEstimate, variance);
+}
+
+/**
+ * Fuse true airspeed. Airspeed is the magnitude of ground velocity minus wind,
+ * which makes horizontal wind observable when the heading changes.
+ */
+bool posEkfFuseAirspeed(posEkf_t *ekf, float airspeed, float variance)
+{
+    const float relX = ekf->x[POS_EKF_VEL_X] - ekf->x[POS_EKF_WIND_X];
+    const float relY = ekf->x[POS_EKF_VEL_Y] - ekf->x[POS_EKF_WIND_Y];
+    const float relZ = ekf->x[POS_EKF_VEL_Z];
+    const float predictedAirspeed = calc_length_pythagorean_3D(relX, relY, relZ);
+
+    if (predictedAirspeed < POS_EKF_MIN_AIRSPEED) {
+        return false;
+    }
+
+    const float invAirspeed = 1.0f / predictedAirspeed;
+    const uint8_t index[5] = { POS_EKF_VEL_X, POS_EKF_VEL_Y, POS_EKF_VEL_Z, POS_EKF_WIND_X, POS_EKF_WIND_Y };
+    const float h[5] = { relX * invAirspeed, relY * invAirspeed, relZ * invAirspeed, -relX * invAirspeed, -relY * invAirspeed };
+
+    return posEkfFuseSparse(ekf, index, h, 5, airspeed - predictedAirspeed, variance);
+}
+
+float posEkfGetStdDev(const posEkf_t *ekf, posEkfState_e state)
+{
+    return fast_fsqrtf(ekf->P[state][state]);
+}
+
+#endif
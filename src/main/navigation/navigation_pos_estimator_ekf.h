@@ -0,0 +1,71 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/vector.h"
+
+/*
+ * Error-state Kalman filter for position estimation (NEU frame, cm, cm/s, cm/s/s).
+ * Dimensions are fixed at compile time, no heap is used. Every measurement is
+ * fused as a sequence of scalar updates with a sparse observation row, so the
+ * cost per update is O(N^2) with N = POS_EKF_STATE_COUNT.
+ */
+
+typedef enum {
+    POS_EKF_POS_X = 0,
+    POS_EKF_POS_Y,
+    POS_EKF_POS_Z,
+    POS_EKF_VEL_X,
+    POS_EKF_VEL_Y,
+    POS_EKF_VEL_Z,
+    POS_EKF_ACC_BIAS_X,
+    POS_EKF_ACC_BIAS_Y,
+    POS_EKF_ACC_BIAS_Z,
+    POS_EKF_WIND_X,
+    POS_EKF_WIND_Y,
+    POS_EKF_STATE_COUNT
+} posEkfState_e;
+
+#define POS_EKF_POS(axis)       (POS_EKF_POS_X + (axis))
+#define POS_EKF_VEL(axis)       (POS_EKF_VEL_X + (axis))
+#define POS_EKF_ACC_BIAS(axis)  (POS_EKF_ACC_BIAS_X + (axis))
+
+typedef struct {
+    float accNoise;         // Accelerometer noise density (cm/s/s/sqrt(Hz))
+    float accBiasNoise;     // Accelerometer bias random walk (cm/s/s/sqrt(s))
+    float windNoise;        // Wind random walk (cm/s/sqrt(s))
+    float innovationGate;   // Innovation gate (standard deviations), 0 to disable
+} posEkfParams_t;
+
+typedef struct {
+    float x[POS_EKF_STATE_COUNT];                       // Nominal state
+    float P[POS_EKF_STATE_COUNT][POS_EKF_STATE_COUNT];  // Error-state covariance, kept symmetric
+    posEkfParams_t params;
+    uint32_t rejectedCount;                             // Number of measurements rejected by the innovation gate
+} posEkf_t;
+
+void posEkfInit(posEkf_t *ekf, const posEkfParams_t *params);
+void posEkfResetState(posEkf_t *ekf, posEkfState_e state, float value, float variance);
+void posEkfPredict(posEkf_t *ekf, const fpVector3_t *accelNEU, bool useAccelXY, float accWeight, float dt);
+bool posEkfFuseState(posEkf_t *ekf, posEkfState_e state, float measurement, float variance);
+bool posEkfFuseStateDelayed(posEkf_t *ekf, posEkfState_e state, float measurement, float delayedEstimate, float variance);
+bool posEkfFuseAirspeed(posEkf_t *ekf, float airspeed, float variance);
+float posEkfGetStdDev(const posEkf_t *ekf, posEkfState_e state);
@@ -43,6 +43,8 @@
 
 extern navigationPosEstimator_t posEstimator;
 
+#define INAV_FLOW_MIN_COS_TILT      0.5f    // Flow is not converted beyond 60 deg of tilt
+
 #ifdef USE_OPFLOW
 /**
  * Read optical flow topic
@@ -56,44 +58,73 @@ void updatePositionEstimator_OpticalFlowTopic(timeUs_t currentTimeUs)
     posEstimator.flow.flowRate[Y] = opflow.flowRate[Y];
     posEstimator.flow.bodyRate[X] = opflow.bodyRate[X];
     posEstimator.flow.bodyRate[Y] = opflow.bodyRate[Y];
+
+    if (!posEstimator.flow.isValid || posEstimator.flow.lastSampleTime == opflow.lastValidUpdate) {
+        return;
+    }
+    posEstimator.flow.lastSampleTime = opflow.lastValidUpdate;
+
+    // Convert every sample at the sensor rate, with the attitude and height at the time it arrived
+    const bool useAglEstimate = (posEstimator.est.aglQual == SURFACE_QUAL_HIGH);
+    const float agl = useAglEstimate ? posEstimator.est.aglAlt : posEstimator.surface.alt;
+    const float aglVel = useAglEstimate ? posEstimator.est.aglVel : posEstimator.est.vel.z;
+
+    fpVector3_t up = { .x = 0, .y = 0, .z = 1 };
+    imuTransformVectorBodyToEarth(&up);
+    if (up.z < INAV_FLOW_MIN_COS_TILT || agl <= 0) {
+        return;
+    }
+
+    // Flow is the angular rate of the ground along the optical axis, the ground is at the slant range
+    const float range = agl / up.z;
+    fpVector3_t flowVel = {
+        .x = - (posEstimator.flow.flowRate[Y] - posEstimator.flow.bodyRate[Y]) * range,
+        .y =   (posEstimator.flow.flowRate[X] - posEstimator.flow.bodyRate[X]) * range,
+        .z =    0
+    };
+    imuTransformVectorBodyToEarth(&flowVel);
+
+    // Flow can't see motion along the optical axis, take it from the known climb rate over the ground
+    const float axisVel = (aglVel - flowVel.z) / up.z;
+    const float dt = opflow.updateDt;
+
+    posEstimator.flow.velocity[X] += (flowVel.x + axisVel * up.x) * dt;
+    posEstimator.flow.velocity[Y] += (flowVel.y + axisVel * up.y) * dt;
+    posEstimator.flow.updateDt += dt;
 }
 #endif
 
-bool estimationCalculateCorrection_XY_FLOW(estimationContext_t * ctx)
+// Flow velocity needs a valid altitude and a reliable surface distance
+bool estimationFlowIsUsableXY(const estimationContext_t * ctx)
 {
 #if defined(USE_RANGEFINDER) && defined(USE_OPFLOW)
-    if (!((ctx->newFlags & EST_FLOW_VALID) && (ctx->newFlags & EST_SURFACE_VALID) && (ctx->newFlags & EST_Z_VALID))) {
-        return false;
-    }
-
-    // FIXME: flow may use AGL estimate if available
-    const bool canUseFlow = (posEstimator.surface.reliability >= RANGEFINDER_RELIABILITY_LOW_THRESHOLD);
+    return (ctx->newFlags & EST_FLOW_VALID) && (ctx->newFlags & EST_SURFACE_VALID) && (ctx->newFlags & EST_Z_VALID) &&
+           (posEstimator.surface.reliability >= RANGEFINDER_RELIABILITY_LOW_THRESHOLD);
+#else
+    UNUSED(ctx);
+    return false;
+#endif
+}
 
-    if (!canUseFlow) {
+bool estimationCalculateCorrection_XY_FLOW(estimationContext_t * ctx)
+{
+#if defined(USE_RANGEFINDER) && defined(USE_OPFLOW)
+    if (!estimationFlowIsUsableXY(ctx)) {
         return false;
     }
 
-    if (!opflow.updateDt) {
+    if (!posEstimator.flow.updateDt) {
         return true;
     }
-    posEstimator.flow.updateDt = opflow.updateDt;
-    opflow.updateDt = 0.0f;
     const float dt = posEstimator.flow.updateDt;
 
-    // Calculate linear velocity based on angular velocity and altitude
-    // Technically we should calculate arc length here, but for fast sampling this is accurate enough
-    fpVector3_t flowVel = {
-        .x = - (posEstimator.flow.flowRate[Y] - posEstimator.flow.bodyRate[Y]) * posEstimator.surface.alt,
-        .y =   (posEstimator.flow.flowRate[X] - posEstimator.flow.bodyRate[X]) * posEstimator.surface.alt,
-        .z =    posEstimator.est.vel.z
-    };
-
-    // At this point flowVel will hold linear velocities in earth frame
-    imuTransformVectorBodyToEarth(&flowVel);
+    // Average velocity of the flow samples since the last correction
+    const float flowVelX = posEstimator.flow.velocity[X] / dt;
+    const float flowVelY = posEstimator.flow.velocity[Y] / dt;
 
     // Calculate velocity correction
-    const float flowVelXInnov = flowVel.x - posEstimator.est.vel.x;
-    const float flowVelYInnov = flowVel.y - posEstimator.est.vel.y;
+    const float flowVelXInnov = flowVelX - posEstimator.est.vel.x;
+    const float flowVelYInnov = flowVelY - posEstimator.est.vel.y;
 
     const float w_xy_flow_v = positionEstimationConfig()->w_xy_flow_v;
     ctx->estVelCorr.x = flowVelXInnov * w_xy_flow_v * dt;
@@ -106,8 +137,8 @@ bool estimationCalculateCorrection_XY_FLOW(estimationContext_t * ctx)
         posEstimator.est.flowCoordinates[Y] = posEstimator.gps.pos.y;
     }
     else if (positionEstimationConfig()->allow_dead_reckoning) {
-        posEstimator.est.flowCoordinates[X] += flowVel.x * dt;
-        posEstimator.est.flowCoordinates[Y] += flowVel.y * dt;
+        posEstimator.est.flowCoordinates[X] += flowVelX * dt;
+        posEstimator.est.flowCoordinates[Y] += flowVelY * dt;
 
         const float flowResidualX = posEstimator.est.flowCoordinates[X] - posEstimator.est.pos.x;
         const float flowResidualY = posEstimator.est.flowCoordinates[Y] - posEstimator.est.pos.y;
@@ -62,6 +62,9 @@
 
 #define INAV_EST_VEL_F_CUT_HZ               3.0f
 
+#define INAV_HISTORY_SAMPLES                32      // Estimate history length, must be a power of 2
+#define INAV_HISTORY_SAMPLE_INTERVAL_US     10000   // 10ms sample spacing, covers up to 310ms of sensor latency
+
 typedef struct {
     timeUs_t    lastTriggeredTime;
     timeUs_t    deltaTime;
@@ -74,6 +77,7 @@ typedef struct {
     float       eph;
     float       epv;
     float       updateDt;
+    timeUs_t    delayUs;        // Age of the solution when it was received
 } navPositionEstimatorGPS_t;
 
 typedef struct {
@@ -83,6 +87,7 @@ typedef struct {
     float       epv;
     float       baroAltRate;    // Baro altitude rate of change (cm/s)
     float       updateDt;
+    timeUs_t    delayUs;        // Age of the measurement when it was received
 } navPositionEstimatorBARO_t;
 
 typedef struct {
@@ -109,6 +114,8 @@ typedef struct {
     float       quality;
     float       flowRate[2];
     float       bodyRate[2];
+    timeUs_t    lastSampleTime; // Last flow sample converted to velocity (us)
+    float       velocity[2];    // Earth frame velocity integrated over updateDt (cm)
     float       updateDt;
 } navPositionEstimatorFLOW_t;
 
@@ -143,6 +150,19 @@ typedef struct {
     zeroCalibrationScalar_t gravityCalibration;
 } navPosisitonEstimatorIMU_t;
 
+typedef struct {
+    fpVector3_t pos;
+    fpVector3_t vel;
+} navPositionEstimatorHistorySample_t;
+
+// Past estimates sampled at a fixed interval, used to fuse delayed measurements at their true timestamp
+typedef struct {
+    navPositionEstimatorHistorySample_t samples[INAV_HISTORY_SAMPLES];
+    timeUs_t    lastSampleTime;
+    uint8_t     head;           // Index of the newest sample
+    uint8_t     count;          // Number of valid samples
+} navPositionEstimatorHistory_t;
+
 typedef enum {
     EST_GPS_XY_VALID            = (1 << 0),
     EST_GPS_Z_VALID             = (1 << 1),
@@ -175,6 +195,7 @@ typedef struct {
 
     // Estimate
     navPositionEstimatorESTIMATE_t  est;
+    navPositionEstimatorHistory_t   history;
 } navigationPosEstimator_t;
 
 typedef struct {
@@ -187,11 +208,14 @@ typedef struct {
     fpVector3_t accBiasCorr;
     bool applyCorrectionsXY;
     bool applyCorrectionsZ;
+    navPositionEstimatorHistorySample_t gpsRef;     // Estimate at the time of the GPS measurement
+    navPositionEstimatorHistorySample_t baroRef;    // Estimate at the time of the baro measurement
 } estimationContext_t;
 
 extern navigationPosEstimator_t posEstimator;
 
 extern float updateEPE(const float oldEPE, const float dt, const float newEPE, const float w);
 extern void estimationCalculateAGL(estimationContext_t * ctx);
+extern bool estimationFlowIsUsableXY(const estimationContext_t * ctx);
 extern bool estimationCalculateCorrection_XY_FLOW(estimationContext_t * ctx);
 
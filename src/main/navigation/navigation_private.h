@@ -37,6 +37,8 @@
 
 #define INAV_SURFACE_MAX_DISTANCE           40
 
+#define NAV_MAX_MULTI_MISSIONS              9       // selectable missions in a multi mission entry, nav_wp_multi_mission_index range
+
 #define MC_POS_CONTROL_JERK_LIMIT_CMSSS     1700.0f // jerk limit on horizontal acceleration (cm/s^3)
 
 #define MC_LAND_CHECK_VEL_XY_MOVING         100.0f  // cm/s
@@ -477,22 +479,23 @@ typedef struct {
     /* Waypoint list */
     navWaypoint_t               waypointList[NAV_MAX_WAYPOINTS];
     bool                        waypointListValid;
-    int8_t                      waypointCount;              // number of WPs in loaded mission
-    int8_t                      startWpIndex;               // index of first waypoint in mission
-    int8_t                      geoWaypointCount;           // total geospatial WPs in mission
+    int16_t                     waypointCount;              // number of WPs in loaded mission
+    int16_t                     startWpIndex;               // index of first waypoint in mission
+    int16_t                     geoWaypointCount;           // total geospatial WPs in mission
     bool                        wpMissionRestart;           // mission restart from first waypoint
 
     /* WP Mission planner */
     int8_t                      wpMissionPlannerStatus;     // WP save status for setting in flight WP mission planner
-    int8_t                      wpPlannerActiveWPIndex;
+    int16_t                     wpPlannerActiveWPIndex;
 #ifdef USE_MULTI_MISSION
     /* Multi Missions */
-    int8_t                      multiMissionCount;          // number of missions in multi mission entry
+    int16_t                     multiMissionCount;          // number of missions in multi mission entry
     int8_t                      loadedMultiMissionIndex;    // index of selected multi mission
-    int8_t                      totalMultiMissionWpCount;   // total number of waypoints in all multi missions
+    int16_t                     totalMultiMissionWpCount;   // total number of waypoints in all multi missions
+    int16_t                     multiMissionStartWpIndex[NAV_MAX_MULTI_MISSIONS + 1];   // first WP index of each mission, then the end of the last one
 #endif
     navWaypointPosition_t       activeWaypoint;             // Local position, current bearing and turn angle to next WP, filled on waypoint activation
-    int8_t                      activeWaypointIndex;
+    int16_t                     activeWaypointIndex;
     float                       wpInitialAltitude;          // Altitude at start of WP
     float                       wpInitialDistance;          // Distance when starting flight to WP
     float                       wpDistance;                 // Distance to active WP
@@ -520,10 +523,6 @@ typedef struct {
     float breakingBoostFactor;
 } multicopterPosXyCoefficients_t;
 
-#if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE)
-PG_DECLARE_ARRAY(navWaypoint_t, NAV_MAX_WAYPOINTS, nonVolatileWaypointList);
-#endif
-
 extern navigationPosControl_t posControl;
 extern multicopterPosXyCoefficients_t multicopterPosXyCoefficients;
 
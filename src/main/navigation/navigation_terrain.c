@@ -0,0 +1,296 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_TERRAIN_GRID)
+
+#include "common/maths.h"
+
+#include "navigation/navigation_terrain.h"
+
+#define TERRAIN_MAX_WEIGHT          16      // Learned posts average over the last hits
+#define TERRAIN_SEEDED              0xFF    // Weight of a seeded post
+#define TERRAIN_MIN_COVERAGE        0.25f   // Known share of the interpolation weights
+
+static terrainTile_t tiles[TERRAIN_TILE_COUNT];
+static uint8_t hashTable[TERRAIN_HASH_SIZE];
+static uint8_t lruHead;
+static uint8_t lruTail;
+static uint8_t tileCount;
+
+// Anchor of the grid, posts are meaningless once the origin moves
+static bool anchored;
+static int32_t anchorLat;
+static int32_t anchorLon;
+
+void terrainGridReset(void)
+{
+    memset(hashTable, TERRAIN_TILE_NONE, sizeof(hashTable));
+    lruHead = TERRAIN_TILE_NONE;
+    lruTail = TERRAIN_TILE_NONE;
+    tileCount = 0;
+    anchored = false;
+}
+
+static bool checkAnchor(const gpsOrigin_t *origin)
+{
+    if (!origin->valid) {
+        return false;
+    }
+
+    if (!anchored || origin->lat != anchorLat || origin->lon != anchorLon) {
+        terrainGridReset();
+        anchored = true;
+        anchorLat = origin->lat;
+        anchorLon = origin->lon;
+    }
+
+    return true;
+}
+
+static uint8_t hashIndex(int16_t x, int16_t y)
+{
+    return ((uint16_t)x * 31u + (uint16_t)y) & (TERRAIN_HASH_SIZE - 1);
+}
+
+static void lruUnlink(uint8_t index)
+{
+    terrainTile_t *tile = &tiles[index];
+
+    if (tile->lruPrev != TERRAIN_TILE_NONE) {
+        tiles[tile->lruPrev].lruNext = tile->lruNext;
+    } else {
+        lruHead = tile->lruNext;
+    }
+
+    if (tile->lruNext != TERRAIN_TILE_NONE) {
+        tiles[tile->lruNext].lruPrev = tile->lruPrev;
+    } else {
+        lruTail = tile->lruPrev;
+    }
+}
+
+static void lruPushFront(uint8_t index)
+{
+    terrainTile_t *tile = &tiles[index];
+
+    tile->lruPrev = TERRAIN_TILE_NONE;
+    tile->lruNext = lruHead;
+    if (lruHead != TERRAIN_TILE_NONE) {
+        tiles[lruHead].lruPrev = index;
+    } else {
+        lruTail = index;
+    }
+    lruHead = index;
+}
+
+static void hashUnlink(uint8_t index)
+{
+    uint8_t *link = &hashTable[hashIndex(tiles[index].x, tiles[index].y)];
+
+    while (*link != index) {
+        link = &tiles[*link].hashNext;
+    }
+    *link = tiles[index].hashNext;
+}
+
+static uint8_t findTile(int16_t x, int16_t y)
+{
+    uint8_t index = hashTable[hashIndex(x, y)];
+
+    while (index != TERRAIN_TILE_NONE && (tiles[index].x != x || tiles[index].y != y)) {
+        index = tiles[index].hashNext;
+    }
+
+    if (index != TERRAIN_TILE_NONE && index != lruHead) {
+        lruUnlink(index);
+        lruPushFront(index);
+    }
+
+    return index;
+}
+
+static uint8_t allocateTile(int16_t x, int16_t y)
+{
+    uint8_t index;
+
+    if (tileCount < TERRAIN_TILE_COUNT) {
+        index = tileCount++;
+    } else {
+        // Recycle the least recently used tile
+        index = lruTail;
+        lruUnlink(index);
+        hashUnlink(index);
+    }
+
+    terrainTile_t *tile = &tiles[index];
+    memset(tile->weight, 0, sizeof(tile->weight));
+    tile->x = x;
+    tile->y = y;
+    tile->baseAlt = 0;
+    tile->knownPosts = 0;
+
+    const uint8_t hash = hashIndex(x, y);
+    tile->hashNext = hashTable[hash];
+    hashTable[hash] = index;
+    lruPushFront(index);
+
+    return index;
+}
+
+// Floor division, posts and tiles extend to negative coordinates
+static int32_t floorDiv(int32_t value, int32_t divisor)
+{
+    return value >= 0 ? value / divisor : -((-value - 1) / divisor) - 1;
+}
+
+static terrainTile_t *postTile(int32_t postX, int32_t postY, bool allocate, int *cellX, int *cellY)
+{
+    const int32_t tileX = floorDiv(postX, TERRAIN_TILE_POSTS);
+    const int32_t tileY = floorDiv(postY, TERRAIN_TILE_POSTS);
+
+    if (tileX < INT16_MIN || tileX > INT16_MAX || tileY < INT16_MIN || tileY > INT16_MAX) {
+        return NULL;
+    }
+
+    uint8_t index = findTile(tileX, tileY);
+    if (index == TERRAIN_TILE_NONE) {
+        if (!allocate) {
+            return NULL;
+        }
+        index = allocateTile(tileX, tileY);
+    }
+
+    *cellX = postX - tileX * TERRAIN_TILE_POSTS;
+    *cellY = postY - tileY * TERRAIN_TILE_POSTS;
+    return &tiles[index];
+}
+
+static float postAltitude(const terrainTile_t *tile, int cellX, int cellY)
+{
+    return tile->baseAlt + tile->height[cellX][cellY] * 10.0f;
+}
+
+static void updatePost(const gpsOrigin_t *origin, float x, float y, int32_t altitude, bool learn)
+{
+    if (!checkAnchor(origin)) {
+        return;
+    }
+
+    int cellX, cellY;
+    terrainTile_t *tile = postTile(lrintf(x / TERRAIN_GRID_SPACING_CM), lrintf(y / TERRAIN_GRID_SPACING_CM), true, &cellX, &cellY);
+    if (!tile) {
+        return;
+    }
+
+    uint8_t *weight = &tile->weight[cellX][cellY];
+    if (!learn && *weight) {
+        return;
+    }
+
+    // The first post of a tile sets its base, heights within a tile fit in 16 bit decimeters
+    if (tile->knownPosts == 0) {
+        tile->baseAlt = altitude;
+    }
+    if (*weight == 0) {
+        tile->knownPosts++;
+    }
+
+    float newAltitude = altitude;
+    if (!learn) {
+        *weight = TERRAIN_SEEDED;
+    } else if (*weight == 0 || *weight == TERRAIN_SEEDED) {
+        // The first rangefinder hit replaces a seed
+        *weight = 1;
+    } else {
+        *weight = MIN(*weight + 1, TERRAIN_MAX_WEIGHT);
+        newAltitude = postAltitude(tile, cellX, cellY);
+        newAltitude += (altitude - newAltitude) / *weight;
+    }
+
+    tile->height[cellX][cellY] = constrain(lrintf((newAltitude - tile->baseAlt) / 10.0f), INT16_MIN, INT16_MAX);
+}
+
+/*
+ * Rangefinder hit, altitude of the ground in cm AMSL below the local
+ * position x, y (cm north and east of the origin)
+ */
+void terrainGridLearn(const gpsOrigin_t *origin, float x, float y, int32_t altitude)
+{
+    updatePost(origin, x, y, altitude, true);
+}
+
+// Uploaded terrain, only fills posts that were not learned yet
+void terrainGridSeed(const gpsOrigin_t *origin, float x, float y, int32_t altitude)
+{
+    updatePost(origin, x, y, altitude, false);
+}
+
+/*
+ * Terrain altitude in cm AMSL at the local position, interpolated between
+ * the surrounding posts that are known. Fails if too few of them are.
+ */
+bool terrainGridGetAltitude(const gpsOrigin_t *origin, float x, float y, float *altitude)
+{
+    if (!checkAnchor(origin)) {
+        return false;
+    }
+
+    const float postX = x / TERRAIN_GRID_SPACING_CM;
+    const float postY = y / TERRAIN_GRID_SPACING_CM;
+    const int32_t x0 = (int32_t)floorf(postX);
+    const int32_t y0 = (int32_t)floorf(postY);
+    const float fx = postX - x0;
+    const float fy = postY - y0;
+
+    float sum = 0.0f;
+    float coverage = 0.0f;
+
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            int cellX, cellY;
+            const terrainTile_t *tile = postTile(x0 + i, y0 + j, false, &cellX, &cellY);
+            if (!tile || !tile->weight[cellX][cellY]) {
+                continue;
+            }
+
+            const float w = (i ? fx : 1.0f - fx) * (j ? fy : 1.0f - fy);
+            sum += w * postAltitude(tile, cellX, cellY);
+            coverage += w;
+        }
+    }
+
+    if (coverage < TERRAIN_MIN_COVERAGE) {
+        return false;
+    }
+
+    *altitude = sum / coverage;
+    return true;
+}
+
+uint8_t terrainGridTileCount(void)
+{
+    return tileCount;
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "navigation/navigation.h"
+
+/*
+ * Local terrain height grid.
+ *
+ * Terrain altitude (cm AMSL) is kept on grid posts every
+ * TERRAIN_GRID_SPACING_CM in the local frame of the GPS origin. Posts are
+ * learned from rangefinder hits while flying or seeded from an uploaded
+ * terrain file. The first rangefinder hit replaces a seed, a learned post is
+ * never overwritten by one. Posts are grouped in square tiles, a fixed number
+ * of tiles is kept and the least recently used one is recycled when a new
+ * area is reached. Tiles are found through a small hash table, so both
+ * lookups and updates take constant time.
+ */
+
+#define TERRAIN_GRID_SPACING_CM     1000
+#define TERRAIN_TILE_POSTS          8       // Posts per tile side
+#define TERRAIN_TILE_COUNT          16      // 16 tiles of 80x80m
+#define TERRAIN_HASH_SIZE           32      // Power of two
+
+#define TERRAIN_TILE_NONE           0xFF
+
+typedef struct terrainTile_s {
+    int16_t x;                      // Tile position in tiles from the origin, north
+    int16_t y;                      // east
+    int32_t baseAlt;                // cm AMSL, posts are relative to it
+    int16_t height[TERRAIN_TILE_POSTS][TERRAIN_TILE_POSTS];    // dm above baseAlt
+    uint8_t weight[TERRAIN_TILE_POSTS][TERRAIN_TILE_POSTS];    // 0 is unknown
+    uint8_t knownPosts;
+    uint8_t hashNext;
+    uint8_t lruPrev;                // Towards the most recently used
+    uint8_t lruNext;                // Towards the least recently used
+} terrainTile_t;
+
+void terrainGridReset(void);
+void terrainGridLearn(const gpsOrigin_t *origin, float x, float y, int32_t altitude);
+void terrainGridSeed(const gpsOrigin_t *origin, float x, float y, int32_t altitude);
+bool terrainGridGetAltitude(const gpsOrigin_t *origin, float x, float y, float *altitude);
+uint8_t terrainGridTileCount(void);
@@ -0,0 +1,371 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Packed non-volatile waypoint mission storage.
+ *
+ * Each waypoint is a header byte followed by only the fields it needs:
+ * - the action is coded in the header for all known actions;
+ * - lat/lon are omitted for non geo waypoints (both zero), otherwise they are
+ *   zigzag varint residuals against one of two predictors: the previous geo
+ *   waypoint, or the previous geo waypoint plus the step taken four geo
+ *   waypoints back. The latter predicts lawnmower survey patterns exactly, so
+ *   a survey waypoint usually packs into 3-5 bytes instead of 20;
+ * - alt is omitted when equal to the previous waypoint altitude;
+ * - p1, p2, p3 are omitted when equal to the previous waypoint parameters,
+ *   the flag when 0 or NAV_WP_FLAG_LAST.
+ *
+ * All arithmetic wraps in uint32_t, so any waypoint round-trips bit exact.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "build/build_config.h"
+
+#include "common/utils.h"
+
+#include "config/parameter_group_ids.h"
+
+#include "navigation/navigation.h"
+#include "navigation/navigation_wp_storage.h"
+
+#if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE)
+STATIC_ASSERT(sizeof(navWaypointStorage_t) <= PGR_SIZE_MASK, navWaypointStorage_too_large);
+
+PG_REGISTER(navWaypointStorage_t, nonVolatileWaypointStorage, PG_WAYPOINT_MISSION_STORAGE, 3);
+#endif
+
+// Header byte
+#define WP_HDR_ACTION_MASK      0x07    // index into packedActions
+#define WP_HDR_ACTION_RAW       0x07    // unknown action, raw action byte follows
+#define WP_HDR_LAST             0x08    // flag is NAV_WP_FLAG_LAST
+#define WP_HDR_POS_MASK         0x30
+#define WP_HDR_POS_NONE         0x00    // lat = lon = 0
+#define WP_HDR_POS_DELTA        0x10    // residual to the previous geo waypoint
+#define WP_HDR_POS_PATTERN      0x20    // residual to the previous geo waypoint plus the step four geo waypoints back
+#define WP_HDR_ALT              0x40    // altitude differs from the previous waypoint
+#define WP_HDR_EXT              0x80    // extension byte follows
+
+// Extension byte
+#define WP_EXT_P1               0x01
+#define WP_EXT_P2               0x02
+#define WP_EXT_P3               0x04
+#define WP_EXT_FLAG             0x08    // raw flag byte follows
+
+static const uint8_t packedActions[WP_HDR_ACTION_RAW] = {
+    NAV_WP_ACTION_WAYPOINT,
+    NAV_WP_ACTION_HOLD_TIME,
+    NAV_WP_ACTION_RTH,
+    NAV_WP_ACTION_SET_POI,
+    NAV_WP_ACTION_JUMP,
+    NAV_WP_ACTION_SET_HEAD,
+    NAV_WP_ACTION_LAND,
+};
+
+static uint32_t zigzagEncode(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t zigzagDecode(uint32_t value)
+{
+    return (int32_t)((value >> 1) ^ -(value & 1));
+}
+
+static uint8_t varintSize(int32_t value)
+{
+    uint32_t zigzag = zigzagEncode(value);
+    uint8_t size = 1;
+
+    while (zigzag >= 0x80) {
+        zigzag >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static uint8_t writeVarint(uint8_t *buf, int32_t value)
+{
+    uint32_t zigzag = zigzagEncode(value);
+    uint8_t size = 0;
+
+    while (zigzag >= 0x80) {
+        buf[size++] = zigzag | 0x80;
+        zigzag >>= 7;
+    }
+    buf[size++] = zigzag;
+    return size;
+}
+
+static bool readVarint(const uint8_t **ptr, const uint8_t *end, int32_t *value)
+{
+    uint32_t zigzag = 0;
+
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (*ptr >= end) {
+            return false;
+        }
+        const uint8_t byte = *(*ptr)++;
+        zigzag |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = zigzagDecode(zigzag);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool readByte(const uint8_t **ptr, const uint8_t *end, uint8_t *value)
+{
+    if (*ptr >= end) {
+        return false;
+    }
+    *value = *(*ptr)++;
+    return true;
+}
+
+static int32_t predictPattern(const int32_t *history)
+{
+    return (int32_t)((uint32_t)history[0] + (uint32_t)history[3] - (uint32_t)history[4]);
+}
+
+static int32_t residual(int32_t value, int32_t prediction)
+{
+    return (int32_t)((uint32_t)value - (uint32_t)prediction);
+}
+
+static int32_t applyResidual(int32_t prediction, int32_t residual)
+{
+    return (int32_t)((uint32_t)prediction + (uint32_t)residual);
+}
+
+static void pushPosition(navWaypointStorageCursor_t *cursor, int32_t lat, int32_t lon)
+{
+    memmove(&cursor->lat[1], &cursor->lat[0], sizeof(cursor->lat) - sizeof(cursor->lat[0]));
+    memmove(&cursor->lon[1], &cursor->lon[0], sizeof(cursor->lon) - sizeof(cursor->lon[0]));
+    cursor->lat[0] = lat;
+    cursor->lon[0] = lon;
+}
+
+void navWpStorageRewind(navWaypointStorageCursor_t *cursor)
+{
+    memset(cursor, 0, sizeof(*cursor));
+}
+
+// Packs the waypoint following the cursor into buf, returns the packed size
+uint8_t navWpStorageEncode(navWaypointStorageCursor_t *cursor, const navWaypoint_t *wp, uint8_t *buf)
+{
+    uint8_t header = WP_HDR_ACTION_RAW;
+    uint8_t ext = 0;
+    uint8_t size = 1;
+
+    for (uint8_t i = 0; i < WP_HDR_ACTION_RAW; i++) {
+        if (packedActions[i] == wp->action) {
+            header = i;
+            break;
+        }
+    }
+    if (header == WP_HDR_ACTION_RAW) {
+        buf[size++] = wp->action;
+    }
+
+    if (wp->flag == NAV_WP_FLAG_LAST) {
+        header |= WP_HDR_LAST;
+    } else if (wp->flag != 0) {
+        ext |= WP_EXT_FLAG;
+    }
+    const int16_t params[3] = { wp->p1, wp->p2, wp->p3 };
+    for (uint8_t i = 0; i < 3; i++) {
+        if (params[i] != cursor->params[i]) {
+            ext |= WP_EXT_P1 << i;
+        }
+    }
+
+    if (ext) {
+        header |= WP_HDR_EXT;
+        buf[size++] = ext;
+    }
+
+    if (wp->lat || wp->lon) {
+        const int32_t deltaLat = residual(wp->lat, cursor->lat[0]);
+        const int32_t deltaLon = residual(wp->lon, cursor->lon[0]);
+        const int32_t patternLat = residual(wp->lat, predictPattern(cursor->lat));
+        const int32_t patternLon = residual(wp->lon, predictPattern(cursor->lon));
+
+        if (varintSize(patternLat) + varintSize(patternLon) < varintSize(deltaLat) + varintSize(deltaLon)) {
+            header |= WP_HDR_POS_PATTERN;
+            size += writeVarint(&buf[size], patternLat);
+            size += writeVarint(&buf[size], patternLon);
+        } else {
+            header |= WP_HDR_POS_DELTA;
+            size += writeVarint(&buf[size], deltaLat);
+            size += writeVarint(&buf[size], deltaLon);
+        }
+        pushPosition(cursor, wp->lat, wp->lon);
+    }
+
+    if (wp->alt != cursor->alt) {
+        header |= WP_HDR_ALT;
+        size += writeVarint(&buf[size], residual(wp->alt, cursor->alt));
+        cursor->alt = wp->alt;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        if (ext & (WP_EXT_P1 << i)) {
+            size += writeVarint(&buf[size], params[i]);
+            cursor->params[i] = params[i];
+        }
+    }
+    if (ext & WP_EXT_FLAG) {
+        buf[size++] = wp->flag;
+    }
+
+    buf[0] = header;
+    cursor->offset += size;
+    cursor->index++;
+
+    return size;
+}
+
+// Unpacks the waypoint following the cursor, false at the end of the mission or on corrupt data
+bool navWpStorageRead(const navWaypointStorage_t *storage, navWaypointStorageCursor_t *cursor, navWaypoint_t *wp)
+{
+    if (cursor->index >= storage->waypointCount || storage->size > NAV_WP_STORAGE_SIZE) {
+        return false;
+    }
+
+    const uint8_t *ptr = &storage->data[cursor->offset];
+    const uint8_t *end = &storage->data[storage->size];
+    uint8_t header;
+    uint8_t ext = 0;
+    int32_t value;
+
+    if (!readByte(&ptr, end, &header)) {
+        return false;
+    }
+
+    if ((header & WP_HDR_ACTION_MASK) == WP_HDR_ACTION_RAW) {
+        if (!readByte(&ptr, end, &wp->action)) {
+            return false;
+        }
+    } else {
+        wp->action = packedActions[header & WP_HDR_ACTION_MASK];
+    }
+
+    if ((header & WP_HDR_EXT) && !readByte(&ptr, end, &ext)) {
+        return false;
+    }
+
+    switch (header & WP_HDR_POS_MASK) {
+        case WP_HDR_POS_NONE:
+            wp->lat = 0;
+            wp->lon = 0;
+            break;
+        case WP_HDR_POS_DELTA:
+        case WP_HDR_POS_PATTERN:
+            {
+                const bool pattern = (header & WP_HDR_POS_MASK) == WP_HDR_POS_PATTERN;
+                int32_t lat, lon;
+
+                if (!readVarint(&ptr, end, &lat) || !readVarint(&ptr, end, &lon)) {
+                    return false;
+                }
+                wp->lat = applyResidual(pattern ? predictPattern(cursor->lat) : cursor->lat[0], lat);
+                wp->lon = applyResidual(pattern ? predictPattern(cursor->lon) : cursor->lon[0], lon);
+                pushPosition(cursor, wp->lat, wp->lon);
+            }
+            break;
+        default:
+            return false;
+    }
+
+    if (header & WP_HDR_ALT) {
+        if (!readVarint(&ptr, end, &value)) {
+            return false;
+        }
+        cursor->alt = applyResidual(cursor->alt, value);
+    }
+    wp->alt = cursor->alt;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        if (ext & (WP_EXT_P1 << i)) {
+            if (!readVarint(&ptr, end, &value)) {
+                return false;
+            }
+            cursor->params[i] = value;
+        }
+    }
+    wp->p1 = cursor->params[0];
+    wp->p2 = cursor->params[1];
+    wp->p3 = cursor->params[2];
+
+    if (ext & WP_EXT_FLAG) {
+        if (!readByte(&ptr, end, &wp->flag)) {
+            return false;
+        }
+    } else {
+        wp->flag = (header & WP_HDR_LAST) ? NAV_WP_FLAG_LAST : 0;
+    }
+
+    cursor->offset = ptr - storage->data;
+    cursor->index++;
+
+    return true;
+}
+
+/*
+ * Packs waypoints #1 to #count as returned by readWaypoint. The stored mission
+ * is only replaced if the new one fits, returns false otherwise.
+ */
+bool navWpStorageStore(navWaypointStorage_t *storage, uint16_t count, void (*readWaypoint)(uint16_t wpNumber, navWaypoint_t *wp))
+{
+    navWaypointStorageCursor_t cursor;
+    uint8_t buf[NAV_WP_STORAGE_MAX_ENCODED_SIZE];
+    navWaypoint_t wp;
+
+    // Dry run to check the size
+    navWpStorageRewind(&cursor);
+    for (uint16_t i = 0; i < count; i++) {
+        readWaypoint(i + 1, &wp);
+        navWpStorageEncode(&cursor, &wp, buf);
+        if (cursor.offset > NAV_WP_STORAGE_SIZE) {
+            return false;
+        }
+    }
+
+    storage->waypointCount = count;
+    storage->size = cursor.offset;
+    storage->missionCount = 0;
+
+    navWpStorageRewind(&cursor);
+    for (uint16_t i = 0; i < count; i++) {
+        readWaypoint(i + 1, &wp);
+        const uint16_t offset = cursor.offset;
+        const uint8_t size = navWpStorageEncode(&cursor, &wp, buf);
+        memcpy(&storage->data[offset], buf, size);
+
+        if (wp.flag == NAV_WP_FLAG_LAST) {
+            storage->missionCount++;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config/parameter_group.h"
+
+#include "navigation/navigation.h"
+
+// Packed mission storage, defaults to the EEPROM footprint of the unpacked waypoint list
+#ifndef NAV_WP_STORAGE_SIZE
+#define NAV_WP_STORAGE_SIZE             (NAV_MAX_WAYPOINTS * sizeof(navWaypoint_t))
+#endif
+
+#define NAV_WP_STORAGE_MAX_ENCODED_SIZE 32  // worst case size of one packed waypoint (bytes)
+#define NAV_WP_STORAGE_HISTORY          5   // positions kept for the pattern predictor
+
+typedef struct navWaypointStorage_s {
+    uint16_t waypointCount;             // waypoints in all missions
+    uint16_t size;                      // bytes used in data
+    uint16_t missionCount;              // number of NAV_WP_FLAG_LAST terminated missions
+    uint8_t data[NAV_WP_STORAGE_SIZE];
+} navWaypointStorage_t;
+
+// Encoder and decoder state, both sides track the same history
+typedef struct navWaypointStorageCursor_s {
+    int32_t lat[NAV_WP_STORAGE_HISTORY];    // positions of the last geo waypoints, newest first
+    int32_t lon[NAV_WP_STORAGE_HISTORY];
+    int32_t alt;
+    int16_t params[3];                      // p1, p2, p3 of the previous waypoint
+    uint16_t offset;
+    uint16_t index;
+} navWaypointStorageCursor_t;
+
+void navWpStorageRewind(navWaypointStorageCursor_t *cursor);
+uint8_t navWpStorageEncode(navWaypointStorageCursor_t *cursor, const navWaypoint_t *wp, uint8_t *buf);
+bool navWpStorageRead(const navWaypointStorage_t *storage, navWaypointStorageCursor_t *cursor, navWaypoint_t *wp);
+bool navWpStorageStore(navWaypointStorage_t *storage, uint16_t count, void (*readWaypoint)(uint16_t wpNumber, navWaypoint_t *wp));
+
+#if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE)
+PG_DECLARE(navWaypointStorage_t, nonVolatileWaypointStorage);
+#endif
@@ -19,13 +19,21 @@
  * == RTH Trackback ==
  * Saves track during flight which is used during RTH to back track
  * along arrival route rather than immediately heading directly toward home.
- * Max desired trackback distance set by user or limited by number of available points.
+ * Max desired trackback distance set by user.
  * Reverts to normal RTH heading direct to home when end of track reached.
- * Trackpoints logged with precedence for course/altitude changes. Distance based changes
- * only logged if no course/altitude changes logged over an extended distance.
+ * The flown path is sampled by trip distance and altitude change and simplified online:
+ * a sample becomes a trackpoint once the path can no longer be represented by a straight
+ * segment within tolerance (opening window), forced saves run Douglas-Peucker over the
+ * pending samples. Trackpoints are quantized to meters and stored as int16 offsets to
+ * the previous point. When the store is full the least significant point is merged into
+ * its neighbours, so the track keeps covering the whole flight with growing coarseness.
  * Tracking suspended during fixed wing loiter (PosHold and WP Mode timed hold).
  * --------------------------------------------------------------------------------- */
 
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
 #include "platform.h"
 
 #include "fc/multifunction.h"
@@ -35,6 +43,10 @@
 #include "navigation/navigation.h"
 #include "navigation/navigation_private.h"
 
+// Path deviation tolerance, Z is scaled so one tolerance applies in 3D [cm]
+#define TRACKBACK_TOLERANCE     METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_XY_TOLERANCE)
+#define TRACKBACK_Z_SCALE       ((float)NAV_RTH_TRACKBACK_XY_TOLERANCE / NAV_RTH_TRACKBACK_Z_TOLERANCE)
+
 rth_trackback_t rth_trackback;
 
 bool rthTrackBackCanBeActivated(void)
@@ -43,6 +55,210 @@ bool rthTrackBackCanBeActivated(void)
            (navConfig()->general.flags.rth_trackback_mode == RTH_TRACKBACK_ON || (navConfig()->general.flags.rth_trackback_mode == RTH_TRACKBACK_FS && posControl.flags.forcedRTHActivated));
 }
 
+static void quantizePosition(fpVector3_t *result, const fpVector3_t *pos)
+{
+    result->x = roundf(CENTIMETERS_TO_METERS(pos->x)) * 100.0f;
+    result->y = roundf(CENTIMETERS_TO_METERS(pos->y)) * 100.0f;
+    result->z = roundf(CENTIMETERS_TO_METERS(pos->z)) * 100.0f;
+}
+
+static void offsetToPosition(fpVector3_t *result, const fpVector3_t *base, const rthTrackBackOffset_t *offset)
+{
+    result->x = base->x + METERS_TO_CENTIMETERS(offset->x);
+    result->y = base->y + METERS_TO_CENTIMETERS(offset->y);
+    result->z = base->z + METERS_TO_CENTIMETERS(offset->z);
+}
+
+// Position of the trackpoint preceding the point at pos stored with offset
+static void previousPosition(fpVector3_t *result, const fpVector3_t *pos, const rthTrackBackOffset_t *offset)
+{
+    result->x = pos->x - METERS_TO_CENTIMETERS(offset->x);
+    result->y = pos->y - METERS_TO_CENTIMETERS(offset->y);
+    result->z = pos->z - METERS_TO_CENTIMETERS(offset->z);
+}
+
+// Both positions quantized, offsets stay within NAV_RTH_TRACKBACK_MAX_SEGMENT
+static void positionToOffset(rthTrackBackOffset_t *result, const fpVector3_t *pos, const fpVector3_t *base)
+{
+    result->x = lrintf(CENTIMETERS_TO_METERS((pos->x - base->x)));
+    result->y = lrintf(CENTIMETERS_TO_METERS((pos->y - base->y)));
+    result->z = lrintf(CENTIMETERS_TO_METERS((pos->z - base->z)));
+}
+
+static bool isSegmentTooLong(const fpVector3_t *a, const fpVector3_t *b)
+{
+    const float maxLength = METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_MAX_SEGMENT);
+    return fabsf(a->x - b->x) > maxLength || fabsf(a->y - b->y) > maxLength || fabsf(a->z - b->z) > maxLength;
+}
+
+// Distance of p to segment a-b with Z scaled to the XY tolerance [cm]
+static float trackBackDeviation(const fpVector3_t *a, const fpVector3_t *b, const fpVector3_t *p)
+{
+    const fpVector3_t ab = { .x = b->x - a->x, .y = b->y - a->y, .z = (b->z - a->z) * TRACKBACK_Z_SCALE };
+    const fpVector3_t ap = { .x = p->x - a->x, .y = p->y - a->y, .z = (p->z - a->z) * TRACKBACK_Z_SCALE };
+    const float lengthSq = vectorNormSquared(&ab);
+    const float t = lengthSq > 0.0f ? constrainf(vectorDotProduct(&ap, &ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+
+    return calc_length_pythagorean_3D(ap.x - t * ab.x, ap.y - t * ab.y, ap.z - t * ab.z);
+}
+
+// Merge the interior trackpoint deviating least from its neighbours' segment into the next point
+static void removeLeastSignificantPoint(void)
+{
+    fpVector3_t newer = rth_trackback.newestPoint;
+    fpVector3_t point;
+    previousPosition(&point, &newer, &rth_trackback.pointsList[rth_trackback.pointCount - 1]);
+
+    float minDeviation = FLT_MAX;
+    int16_t removeIndex = -1;
+
+    for (int16_t i = rth_trackback.pointCount - 2; i > 0; i--) {
+        const rthTrackBackOffset_t *offset = &rth_trackback.pointsList[i];
+        const rthTrackBackOffset_t *nextOffset = &rth_trackback.pointsList[i + 1];
+        fpVector3_t older;
+        previousPosition(&older, &point, offset);
+
+        const bool mergeFits = ABS(offset->x + nextOffset->x) <= NAV_RTH_TRACKBACK_MAX_SEGMENT &&
+                               ABS(offset->y + nextOffset->y) <= NAV_RTH_TRACKBACK_MAX_SEGMENT &&
+                               ABS(offset->z + nextOffset->z) <= NAV_RTH_TRACKBACK_MAX_SEGMENT;
+        if (mergeFits) {
+            const float deviation = trackBackDeviation(&older, &newer, &point);
+            if (deviation < minDeviation) {
+                minDeviation = deviation;
+                removeIndex = i;
+            }
+        }
+
+        newer = point;
+        point = older;
+    }
+
+    if (removeIndex < 0) {
+        // Nothing can be merged, drop the oldest point
+        removeIndex = 0;
+    } else {
+        rthTrackBackOffset_t *nextOffset = &rth_trackback.pointsList[removeIndex + 1];
+        nextOffset->x += rth_trackback.pointsList[removeIndex].x;
+        nextOffset->y += rth_trackback.pointsList[removeIndex].y;
+        nextOffset->z += rth_trackback.pointsList[removeIndex].z;
+    }
+
+    memmove(&rth_trackback.pointsList[removeIndex], &rth_trackback.pointsList[removeIndex + 1], (rth_trackback.pointCount - removeIndex - 1) * sizeof(rthTrackBackOffset_t));
+    rth_trackback.pointCount--;
+}
+
+// pos must be quantized
+static void saveTrackPoint(const fpVector3_t *pos)
+{
+    if (rth_trackback.pointCount > 0) {
+        if (isSegmentTooLong(&rth_trackback.newestPoint, pos)) {
+            fpVector3_t midPoint = {
+                .x = (rth_trackback.newestPoint.x + pos->x) / 2,
+                .y = (rth_trackback.newestPoint.y + pos->y) / 2,
+                .z = (rth_trackback.newestPoint.z + pos->z) / 2,
+            };
+            quantizePosition(&midPoint, &midPoint);
+            saveTrackPoint(&midPoint);
+        }
+
+        if (pos->x == rth_trackback.newestPoint.x && pos->y == rth_trackback.newestPoint.y && pos->z == rth_trackback.newestPoint.z) {
+            return;
+        }
+
+        if (rth_trackback.pointCount == NAV_RTH_TRACKBACK_POINTS) {
+            removeLeastSignificantPoint();
+        }
+        positionToOffset(&rth_trackback.pointsList[rth_trackback.pointCount], pos, &rth_trackback.newestPoint);
+    } else {
+        rth_trackback.pointsList[0] = (rthTrackBackOffset_t){ 0 };
+    }
+
+    rth_trackback.pointCount++;
+    rth_trackback.savedPointCount = rth_trackback.pointCount;
+    rth_trackback.newestPoint = *pos;
+    rth_trackback.startPoint = *pos;
+}
+
+// Douglas-Peucker, marks the path points to keep between first and last
+static void simplifyPath(const fpVector3_t *path, uint8_t first, uint8_t last, bool *keep)
+{
+    float maxDeviation = 0.0f;
+    uint8_t maxIndex = first;
+
+    for (uint8_t i = first + 1; i < last; i++) {
+        const float deviation = trackBackDeviation(&path[first], &path[last], &path[i]);
+        if (deviation > maxDeviation) {
+            maxDeviation = deviation;
+            maxIndex = i;
+        }
+    }
+
+    if (maxDeviation > TRACKBACK_TOLERANCE) {
+        keep[maxIndex] = true;
+        simplifyPath(path, first, maxIndex, keep);
+        simplifyPath(path, maxIndex, last, keep);
+    }
+}
+
+// Save the pending samples that are needed to follow the path up to pos, then pos itself
+static void flushSamples(const fpVector3_t *pos)
+{
+    fpVector3_t path[NAV_RTH_TRACKBACK_SAMPLES + 2];
+    bool keep[NAV_RTH_TRACKBACK_SAMPLES + 2] = { false };
+    const uint8_t last = rth_trackback.sampleCount + 1;
+
+    path[0] = rth_trackback.newestPoint;
+    for (uint8_t i = 0; i < rth_trackback.sampleCount; i++) {
+        offsetToPosition(&path[i + 1], &rth_trackback.newestPoint, &rth_trackback.samples[i]);
+    }
+    quantizePosition(&path[last], pos);
+    keep[last] = true;
+
+    simplifyPath(path, 0, last, keep);
+
+    for (uint8_t i = 1; i <= last; i++) {
+        if (keep[i]) {
+            saveTrackPoint(&path[i]);
+        }
+    }
+    rth_trackback.sampleCount = 0;
+}
+
+static void addSample(const fpVector3_t *pos)
+{
+    fpVector3_t sample;
+    quantizePosition(&sample, pos);
+
+    // The segment from the newest point to the new sample must pass all pending samples within tolerance,
+    // otherwise the previous sample ends the straight part of the path and becomes a trackpoint
+    if (rth_trackback.sampleCount > 0) {
+        bool isStraight = !isSegmentTooLong(&rth_trackback.newestPoint, &sample);
+
+        for (uint8_t i = 0; i < rth_trackback.sampleCount && isStraight; i++) {
+            fpVector3_t previousSample;
+            offsetToPosition(&previousSample, &rth_trackback.newestPoint, &rth_trackback.samples[i]);
+            isStraight = trackBackDeviation(&rth_trackback.newestPoint, &sample, &previousSample) <= TRACKBACK_TOLERANCE;
+        }
+
+        if (!isStraight) {
+            fpVector3_t point;
+            offsetToPosition(&point, &rth_trackback.newestPoint, &rth_trackback.samples[rth_trackback.sampleCount - 1]);
+            saveTrackPoint(&point);
+            rth_trackback.sampleCount = 0;
+        }
+    }
+
+    // Long straight path, keep every other sample to bound memory and CPU
+    if (rth_trackback.sampleCount == NAV_RTH_TRACKBACK_SAMPLES) {
+        for (uint8_t i = 0; i < NAV_RTH_TRACKBACK_SAMPLES / 2; i++) {
+            rth_trackback.samples[i] = rth_trackback.samples[2 * i + 1];
+        }
+        rth_trackback.sampleCount = NAV_RTH_TRACKBACK_SAMPLES / 2;
+    }
+
+    positionToOffset(&rth_trackback.samples[rth_trackback.sampleCount++], &sample, &rth_trackback.newestPoint);
+}
+
 void rthTrackBackUpdate(bool forceSaveTrackPoint)
 {
     static bool suspendTracking = false;
@@ -56,72 +272,38 @@ void rthTrackBackUpdate(bool forceSaveTrackPoint)
         return;
     }
 
-    // Record trackback points based on significant change in course/altitude until points limit reached. Overwrite older points from then on.
+    // Sample the path by trip distance and altitude change, samples are reduced to trackpoints by the online simplification
     if (posControl.flags.estPosStatus >= EST_USABLE && posControl.flags.estAltStatus >= EST_USABLE) {
-        static int32_t previousTBTripDist;      // cm
-        static int16_t previousTBCourse;        // degrees
-        static int16_t previousTBAltitude;      // meters
-        static uint8_t distanceCounter = 0;
-        bool saveTrackpoint = forceSaveTrackPoint;
-        bool GPSCourseIsValid = isGPSHeadingValid();
+        static float previousTBTripDist;    // cm
+        static float previousTBAltitude;    // cm
+        const fpVector3_t *pos = &posControl.actualState.abs.pos;
 
         // Start recording when some distance from home
-        if (rth_trackback.activePointIndex < 0) {
-            saveTrackpoint = posControl.homeDistance > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_MIN_DIST_TO_START);
-            previousTBCourse = CENTIDEGREES_TO_DEGREES(posControl.actualState.cog);
-            previousTBTripDist = posControl.totalTripDistance;
-        } else {
-            // Minimum distance increment between course change track points when GPS course valid
-            const bool distanceIncrement = posControl.totalTripDistance - previousTBTripDist > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_MIN_TRIP_DIST_TO_SAVE);
-
-            // Altitude change
-            if (ABS(previousTBAltitude - CENTIMETERS_TO_METERS(posControl.actualState.abs.pos.z)) > NAV_RTH_TRACKBACK_MIN_Z_DIST_TO_SAVE) {
-                saveTrackpoint = true;
-            } else if (distanceIncrement && GPSCourseIsValid) {
-                // Course change - set to 45 degrees
-                if (ABS(wrap_18000(DEGREES_TO_CENTIDEGREES(DECIDEGREES_TO_DEGREES(gpsSol.groundCourse) - previousTBCourse))) > DEGREES_TO_CENTIDEGREES(45)) {
-                    saveTrackpoint = true;
-                } else if (distanceCounter >= 9) {
-                    // Distance based trackpoint logged if at least 10 distance increments occur without altitude or course change and deviation from projected course path > 20m
-                    float distToPrevPoint = calculateDistanceToDestination(&rth_trackback.pointsList[rth_trackback.activePointIndex]);
-
-                    fpVector3_t virtualCoursePoint;
-                    virtualCoursePoint.x = rth_trackback.pointsList[rth_trackback.activePointIndex].x + distToPrevPoint * cos_approx(DEGREES_TO_RADIANS(previousTBCourse));
-                    virtualCoursePoint.y = rth_trackback.pointsList[rth_trackback.activePointIndex].y + distToPrevPoint * sin_approx(DEGREES_TO_RADIANS(previousTBCourse));
-
-                    saveTrackpoint = calculateDistanceToDestination(&virtualCoursePoint) > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_MIN_XY_DIST_TO_SAVE);
-                }
-                distanceCounter++;
-                previousTBTripDist = posControl.totalTripDistance;
-            } else if (!GPSCourseIsValid) {
-                // If no reliable course revert to basic distance logging based on direct distance from last point
-                saveTrackpoint = calculateDistanceToDestination(&rth_trackback.pointsList[rth_trackback.activePointIndex]) > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_MIN_XY_DIST_TO_SAVE);
+        if (rth_trackback.pointCount == 0) {
+            if (posControl.homeDistance > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_MIN_DIST_TO_START)) {
+                flushSamples(pos);
                 previousTBTripDist = posControl.totalTripDistance;
+                previousTBAltitude = pos->z;
             }
-
-            // Suspend tracking during loiter on fixed wing. Save trackpoint at start of loiter.
-            if (distanceCounter && fwLoiterIsActive) {
-                saveTrackpoint = suspendTracking = true;
-            }
+            return;
         }
 
-        // When trackpoint store full, overwrite from start of store using 'WrapAroundCounter' to track overwrite position
-        if (saveTrackpoint) {
-            if (rth_trackback.activePointIndex == (NAV_RTH_TRACKBACK_POINTS - 1)) {   // Wraparound to start
-                rth_trackback.WrapAroundCounter = rth_trackback.activePointIndex = 0;
-            } else {
-                rth_trackback.activePointIndex++;
-                if (rth_trackback.WrapAroundCounter > -1) {   // Track wraparound overwrite position after store first filled
-                    rth_trackback.WrapAroundCounter = rth_trackback.activePointIndex;
-                }
-            }
+        // Suspend tracking during loiter on fixed wing. Save trackpoint at start of loiter.
+        if (rth_trackback.sampleCount && fwLoiterIsActive) {
+            forceSaveTrackPoint = suspendTracking = true;
+        }
 
-            rth_trackback.pointsList[rth_trackback.activePointIndex] = posControl.actualState.abs.pos;
-            rth_trackback.lastSavedIndex = rth_trackback.activePointIndex;
-            previousTBAltitude = CENTIMETERS_TO_METERS(posControl.actualState.abs.pos.z);
-            previousTBCourse = GPSCourseIsValid ? DECIDEGREES_TO_DEGREES(gpsSol.groundCourse) : previousTBCourse;
-            distanceCounter = 0;
+        if (forceSaveTrackPoint) {
+            flushSamples(pos);
+        } else if (posControl.totalTripDistance - previousTBTripDist > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_SAMPLE_DIST) ||
+                   fabsf(pos->z - previousTBAltitude) > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_Z_TOLERANCE)) {
+            addSample(pos);
+        } else {
+            return;
         }
+
+        previousTBTripDist = posControl.totalTripDistance;
+        previousTBAltitude = pos->z;
     }
 }
 
@@ -131,7 +313,7 @@ bool rthTrackBackSetNewPosition(void)
         return false;   // will fall back to RTH initialize allowing full RTH to handle position loss correctly
     }
 
-    const int32_t distFromStartTrackback = CENTIMETERS_TO_METERS(calculateDistanceToDestination(&rth_trackback.pointsList[rth_trackback.lastSavedIndex]));
+    const int32_t distFromStartTrackback = CENTIMETERS_TO_METERS(calculateDistanceToDestination(&rth_trackback.startPoint));
 
 #ifdef USE_MULTI_FUNCTIONS
     const bool overrideTrackback = rthAltControlStickOverrideCheck(ROLL) || MULTI_FUNC_FLAG(MF_SUSPEND_TRACKBACK);
@@ -140,24 +322,18 @@ bool rthTrackBackSetNewPosition(void)
 #endif
     const bool cancelTrackback = distFromStartTrackback > navConfig()->general.rth_trackback_distance || (overrideTrackback && !posControl.flags.forcedRTHActivated);
 
-    if (rth_trackback.activePointIndex < 0 || cancelTrackback) {
-        rth_trackback.WrapAroundCounter = rth_trackback.activePointIndex = -1;
-        posControl.flags.rthTrackbackActive = false;
+    if (rth_trackback.pointCount == 0 || cancelTrackback) {
+        resetRthTrackBack();
         return false;    // No more trackback points to set, procede to home
     }
 
     if (isWaypointReached(&posControl.activeWaypoint.pos, &posControl.activeWaypoint.bearing)) {
-        rth_trackback.activePointIndex--;
+        // Trackpoints are consumed as they are reached, the previous one becomes the newest
+        rth_trackback.pointCount--;
 
-        if (rth_trackback.WrapAroundCounter > -1 && rth_trackback.activePointIndex < 0) {
-            rth_trackback.activePointIndex = NAV_RTH_TRACKBACK_POINTS - 1;
-        }
-
-        // Last trackback point reached when activePointIndex = WrapAroundCounter so only set position when not equal
-        if (rth_trackback.activePointIndex != rth_trackback.WrapAroundCounter) {
+        if (rth_trackback.pointCount > 0) {
+            previousPosition(&rth_trackback.newestPoint, &rth_trackback.newestPoint, &rth_trackback.pointsList[rth_trackback.pointCount]);
             calculateAndSetActiveWaypointToLocalPosition(getRthTrackBackPosition());
-        } else {
-            rth_trackback.activePointIndex = -1;  // if not already = -1 set to -1 to end trackback next iteration
         }
     } else {
         setDesiredPosition(getRthTrackBackPosition(), 0, NAV_POS_UPDATE_XY | NAV_POS_UPDATE_Z | NAV_POS_UPDATE_BEARING);
@@ -168,17 +344,20 @@ bool rthTrackBackSetNewPosition(void)
 
 fpVector3_t *getRthTrackBackPosition(void)
 {
+    rth_trackback.activePoint = rth_trackback.newestPoint;
+
     // Ensure trackback altitude never lower than altitude of start point
-    if (rth_trackback.pointsList[rth_trackback.activePointIndex].z < rth_trackback.pointsList[rth_trackback.lastSavedIndex].z) {
-        rth_trackback.pointsList[rth_trackback.activePointIndex].z = rth_trackback.pointsList[rth_trackback.lastSavedIndex].z;
+    if (rth_trackback.activePoint.z < rth_trackback.startPoint.z) {
+        rth_trackback.activePoint.z = rth_trackback.startPoint.z;
     }
 
-    return &rth_trackback.pointsList[rth_trackback.activePointIndex];
+    return &rth_trackback.activePoint;
 }
 
 void resetRthTrackBack(void)
 {
-    rth_trackback.activePointIndex = -1;
+    rth_trackback.pointCount = 0;
+    rth_trackback.savedPointCount = 0;
+    rth_trackback.sampleCount = 0;
     posControl.flags.rthTrackbackActive = false;
-    rth_trackback.WrapAroundCounter = -1;
-}
\ No newline at end of file
+}
@@ -19,18 +19,31 @@
 
 #include "common/vector.h"
 
-#define NAV_RTH_TRACKBACK_POINTS                50 // max number RTH trackback points
+#define NAV_RTH_TRACKBACK_POINTS                80 // max number RTH trackback points, stored compressed in about the RAM of 50 raw points
+#define NAV_RTH_TRACKBACK_SAMPLES               16 // max path samples held since the last trackback point
 #define NAV_RTH_TRACKBACK_MIN_DIST_TO_START     50 // start recording when some distance from home (meters)
-#define NAV_RTH_TRACKBACK_MIN_XY_DIST_TO_SAVE   20 // minimum XY distance between two points to store in the buffer (meters)
-#define NAV_RTH_TRACKBACK_MIN_Z_DIST_TO_SAVE    10 // minimum Z distance between two points to store in the buffer (meters)
-#define NAV_RTH_TRACKBACK_MIN_TRIP_DIST_TO_SAVE 10 // minimum trip distance between two points to store in the buffer (meters)
+#define NAV_RTH_TRACKBACK_XY_TOLERANCE          20 // max XY deviation of the flown path from the saved track (meters)
+#define NAV_RTH_TRACKBACK_Z_TOLERANCE           10 // max Z deviation of the flown path from the saved track (meters)
+#define NAV_RTH_TRACKBACK_SAMPLE_DIST           10 // trip distance between two path samples (meters)
+#define NAV_RTH_TRACKBACK_MAX_SEGMENT           20000 // max length of a track segment, keeps the deltas in int16 range (meters)
 
 typedef struct
 {
-    fpVector3_t pointsList[NAV_RTH_TRACKBACK_POINTS]; // buffer of points stored
-    int16_t lastSavedIndex;                           // last trackback point index saved
-    int16_t activePointIndex;                         // trackback points counter
-    int16_t WrapAroundCounter;                        // stores trackpoint array overwrite index position
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} rthTrackBackOffset_t;     // meters
+
+typedef struct
+{
+    rthTrackBackOffset_t pointsList[NAV_RTH_TRACKBACK_POINTS];  // trackback points, oldest first, each stored as offset to the previous point
+    rthTrackBackOffset_t samples[NAV_RTH_TRACKBACK_SAMPLES];    // path samples since the newest point, relative to it
+    fpVector3_t newestPoint;                                    // newest trackback point, quantized to meters [cm]
+    fpVector3_t startPoint;                                     // last saved point, trackback start reference [cm]
+    fpVector3_t activePoint;                                    // trackback position currently flown [cm]
+    uint8_t pointCount;                                         // trackback points stored
+    uint8_t savedPointCount;                                    // trackback points stored after the last save, start point is the newest
+    uint8_t sampleCount;                                        // path samples stored
 } rth_trackback_t;
 
 extern rth_trackback_t rth_trackback;
@@ -39,4 +52,4 @@ bool rthTrackBackCanBeActivated(void);
 bool rthTrackBackSetNewPosition(void);
 void rthTrackBackUpdate(bool forceSaveTrackPoint);
 fpVector3_t *getRthTrackBackPosition(void);
-void resetRthTrackBack(void);
\ No newline at end of file
+void resetRthTrackBack(void);
@@ -586,7 +586,7 @@ static int logicConditionGetWaypointOperandValue(int operand) {
 
         case LOGIC_CONDITION_OPERAND_WAYPOINTS_NEXT_WAYPOINT_ACTION:
             {
-                uint8_t wpIndex = posControl.activeWaypointIndex + 1;
+                int16_t wpIndex = posControl.activeWaypointIndex + 1;
                 if ((wpIndex > 0) && (wpIndex < NAV_MAX_WAYPOINTS)) {
                     return posControl.waypointList[wpIndex].action;
                 }
@@ -89,6 +89,7 @@ static bool rxFlightChannelsValid = false;
 static uint8_t rxChannelCount;
 
 static timeUs_t rxNextUpdateAtUs = 0;
+static timeUs_t rxFrameTimeUs = 0;
 static timeUs_t needRxSignalBefore = 0;
 static bool isRxSuspended = false;
 
@@ -101,7 +102,7 @@ rxLinkStatistics_t rxLinkStatistics;
 rxRuntimeConfig_t rxRuntimeConfig;
 static uint8_t rcSampleIndex = 0;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(rxConfig_t, rxConfig, PG_RX_CONFIG, 13);
+PG_REGISTER_WITH_RESET_TEMPLATE(rxConfig_t, rxConfig, PG_RX_CONFIG, 14);
 
 #ifndef SERIALRX_PROVIDER
 #define SERIALRX_PROVIDER 0
@@ -132,6 +133,7 @@ PG_RESET_TEMPLATE(rxConfig_t, rxConfig,
     .rcFilterFrequency = SETTING_RC_FILTER_LPF_HZ_DEFAULT,
     .autoSmooth = SETTING_RC_FILTER_AUTO_DEFAULT,
     .autoSmoothFactor = SETTING_RC_FILTER_SMOOTHING_FACTOR_DEFAULT,
+    .rcFilterMode = SETTING_RC_FILTER_MODE_DEFAULT,
 #if defined(USE_RX_MSP) && defined(USE_MSP_RC_OVERRIDE)
     .mspOverrideChannels = SETTING_MSP_OVERRIDE_CHANNELS_DEFAULT,
 #endif
@@ -265,6 +267,7 @@ void rxInit(void)
     rxRuntimeConfig.lqTracker = &rxLQTracker;
     rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
     rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+    rxRuntimeConfig.rcFrameTimeUsFn = NULL;
     rxRuntimeConfig.rxSignalTimeout = DELAY_10_HZ;
     rcSampleIndex = 0;
 
@@ -304,6 +307,7 @@ void rxInit(void)
                 rxConfigMutable()->receiverType = RX_TYPE_NONE;
                 rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
                 rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+                rxRuntimeConfig.rcFrameTimeUsFn = NULL;
             }
             break;
 #endif
@@ -416,6 +420,7 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
         rxSignalReceived = (frameStatus & RX_FRAME_FAILSAFE) == 0;
         needRxSignalBefore = currentTimeUs + rxRuntimeConfig.rxSignalTimeout;
         rxDataProcessingRequired = true;
+        rxFrameTimeUs = rxRuntimeConfig.rcFrameTimeUsFn ? rxRuntimeConfig.rcFrameTimeUsFn(&rxRuntimeConfig) : currentTimeUs;
     }
     else if ((frameStatus & RX_FRAME_FAILSAFE) && rxSignalReceived) {
         // All other receiver statuses are allowed to report failsafe, but not allowed to leave it
@@ -442,6 +447,12 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
     return result;
 }
 
+// Time the last complete RC frame was received, from the driver when it timestamps frames
+timeUs_t rxGetFrameTimeUs(void)
+{
+    return rxFrameTimeUs;
+}
+
 bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
 {
     int16_t rcStaging[MAX_SUPPORTED_RC_CHANNEL_COUNT];
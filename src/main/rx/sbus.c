@@ -67,6 +67,8 @@ typedef struct sbusFrameData_s {
     uint8_t buffer[SBUS_FRAME_SIZE];
     uint8_t position;
     timeUs_t lastActivityTimeUs;
+    timeUs_t frameTimeUs;       // Written by the ISR together with frameDone
+    timeUs_t rcFrameTimeUs;     // Last frame handed to the RX layer
 } sbusFrameData_t;
 
 static uint8_t sbus2ActiveTelemetryPage = 0;
@@ -148,6 +150,7 @@ static void sbusDataReceive(uint16_t c, void *data)
                 if (!sbusFrameData->frameDone && frameValid) {
 
                     memcpy((void *)&sbusFrameData->frame, (void *)&sbusFrameData->buffer[0], SBUS_FRAME_SIZE);
+                    sbusFrameData->frameTimeUs = currentTimeUs;
                     sbusFrameData->frameDone = true;
                 }
             }
@@ -181,6 +184,7 @@ static void sbusDataReceive(uint16_t c, void *data)
                 // Frame seems sane, pass data to decoder
                 if (!sbusFrameData->frameDone && frameValid) {
                     memcpy((void *)&sbusFrameData->frameHigh, (void *)&sbusFrameData->buffer[0], SBUS_FRAME_SIZE);
+                    sbusFrameData->frameTimeUs = currentTimeUs;
                     sbusFrameData->frameDone = true;
                     sbusFrameData->is26channels = true;
                 }
@@ -213,6 +217,8 @@ static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
         retValue = sbusChannelsDecode(rxRuntimeConfig, (void *)&sbusFrameData->frame.channels);
     }
 
+    sbusFrameData->rcFrameTimeUs = sbusFrameData->frameTimeUs;
+
     // Reset the frameDone flag - tell ISR that we're ready to receive next frame
     sbusFrameData->frameDone = false;
 
@@ -224,6 +230,13 @@ static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
     return retValue;
 }
 
+static timeUs_t sbusFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    const sbusFrameData_t *sbusFrameData = rxRuntimeConfig->frameData;
+
+    return sbusFrameData->rcFrameTimeUs;
+}
+
 static bool sbusInitEx(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig, uint32_t sbusBaudRate)
 {
     static uint16_t sbusChannelData[SBUS_MAX_CHANNEL];
@@ -237,6 +250,7 @@ static bool sbusInitEx(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeC
     rxRuntimeConfig->channelCount = SBUS_MAX_CHANNEL;
 
     rxRuntimeConfig->rcFrameStatusFn = sbusFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = sbusFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
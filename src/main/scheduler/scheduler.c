@@ -36,6 +36,15 @@
 
 #include "drivers/time.h"
 
+#if defined(SITL_BUILD)
+#include "target/SITL/sim/replay.h"
+#define REPLAY_PROFILE_TASK_BEGIN()         simReplayProfileTaskBegin()
+#define REPLAY_PROFILE_TASK_END(taskId)     simReplayProfileTaskEnd(taskId)
+#else
+#define REPLAY_PROFILE_TASK_BEGIN()
+#define REPLAY_PROFILE_TASK_END(taskId)
+#endif
+
 STATIC_FASTRAM cfTask_t *currentTask = NULL;
 
 STATIC_FASTRAM uint32_t totalWaitingTasks;
@@ -329,7 +338,9 @@ void FAST_CODE NOINLINE scheduler(void)
 
         // Execute task
         const timeUs_t currentTimeBeforeTaskCall = micros();
+        REPLAY_PROFILE_TASK_BEGIN();
         selectedTask->taskFunc(currentTimeBeforeTaskCall);
+        REPLAY_PROFILE_TASK_END(selectedTask - cfTasks);
         const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
         selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / TASK_MOVING_SUM_COUNT;
         selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
@@ -366,7 +377,18 @@ void FAST_CODE NOINLINE scheduler(void)
             }
         }
         const timeUs_t nowUs = micros();
-        if (sitlEarliestNextTaskAt > nowUs + 50) {
+        if (sitlIsFastForward()) {
+            // Log replay runs on simulated time - jump straight past the point the next task becomes due,
+            // but not past the next logged sample, so it is fed in at its own time stamp
+            timeUs_t nextEventAt = sitlEarliestNextTaskAt + 1;
+            timeUs_t sampleAt;
+            if (simReplayNextSampleAt(&sampleAt) && sampleAt < nextEventAt) {
+                nextEventAt = sampleAt;
+            }
+            if (nextEventAt > nowUs) {
+                sitlFastForward(nextEventAt - nowUs);
+            }
+        } else if (sitlEarliestNextTaskAt > nowUs + 50) {
             const timeDelta_t sleepUs = (timeDelta_t)(sitlEarliestNextTaskAt - nowUs) - 50;
             if (sleepUs > 0) {
                 usleep((useconds_t)sleepUs);
@@ -141,6 +141,14 @@ typedef enum {
     TASK_GEOZONE,
 #endif
 
+#ifdef USE_SYSID
+    TASK_SYSID,
+#endif
+
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    TASK_COMPASS_CALIBRATION,
+#endif
+
     /* Count of real tasks */
     TASK_COUNT,
 
@@ -48,6 +48,7 @@
 #include "fc/settings.h"
 
 #include "sensors/barometer.h"
+#include "sensors/barometer_altitude.h"
 #include "sensors/sensors.h"
 
 #ifdef USE_HARDWARE_REVISION_DETECTION
@@ -58,18 +59,34 @@ baro_t baro;                        // barometer access functions
 
 #ifdef USE_BARO
 
-PG_REGISTER_WITH_RESET_TEMPLATE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 5);
+PG_REGISTER_WITH_RESET_TEMPLATE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 6);
 
 PG_RESET_TEMPLATE(barometerConfig_t, barometerConfig,
     .baro_hardware = SETTING_BARO_HARDWARE_DEFAULT,
     .baro_calibration_tolerance = SETTING_BARO_CAL_TOLERANCE_DEFAULT,
     .baro_temp_correction = SETTING_BARO_TEMP_CORRECTION_DEFAULT,
+    .baro_temp_interval = SETTING_BARO_TEMP_INTERVAL_DEFAULT,
+    .baro_rate_hz = SETTING_BARO_RATE_HZ_DEFAULT,
 );
 
+typedef enum {
+    BAROMETER_NEEDS_START = 0,
+    BAROMETER_NEEDS_TEMPERATURE,    // Temperature conversion running
+    BAROMETER_NEEDS_PRESSURE,       // Pressure conversion running
+} barometerState_e;
+
 static zeroCalibrationScalar_t zeroCalibration;
 static float baroGroundAltitude = 0;
 static float baroGroundPressure = 101325.0f; // 101325 pascal, 1 standard atmosphere
 
+static barometerState_e baroState = BAROMETER_NEEDS_START;
+static uint8_t baroPressureConversions;     // Since the last temperature conversion
+static uint8_t baroDecimation;              // Pressure conversions per published sample
+static uint8_t baroSampleCount;
+static int32_t baroPressureSum;
+static float baroPressure;                  // Decimated, keeps the resolution gained by averaging
+static bool baroNewSample;
+
 bool baroDetect(baroDev_t *dev, baroSensor_e baroHardwareToUse)
 {
     // Detect what pressure sensors are available. baro->update() is set to sensor-specific update function
@@ -240,58 +257,107 @@ bool baroDetect(baroDev_t *dev, baroSensor_e baroHardwareToUse)
 
 bool baroInit(void)
 {
+    // Also needed without hardware, a simulator may provide pressure
+    baroAltitudeTableInit();
+
     if (!baroDetect(&baro.dev, barometerConfig()->baro_hardware)) {
         return false;
     }
+
+    // Temperature conversions are spread over the pressure conversions between them
+    const float conversionUs = baro.dev.up_delay + (float)baro.dev.ut_delay / barometerConfig()->baro_temp_interval;
+    baroDecimation = constrain(lrintf(1e6f / (MAX(conversionUs, 1.0f) * barometerConfig()->baro_rate_hz)), 1, UINT8_MAX);
+
     return true;
 }
 
-typedef enum {
-    BAROMETER_NEEDS_SAMPLES = 0,
-    BAROMETER_NEEDS_CALCULATION
-} barometerState_e;
-
+/*
+ * Pressure conversions run back to back. Sensors that convert temperature
+ * separately only do so every baro_temp_interval pressure conversions, the
+ * driver compensates with the last temperature in between. Pressure is
+ * averaged over baroDecimation conversions, a boxcar decimating filter.
+ */
 uint32_t baroUpdate(void)
 {
-    static barometerState_e state = BAROMETER_NEEDS_SAMPLES;
-
 #ifdef USE_SIMULATOR
     if (ARMING_FLAG(SIMULATOR_MODE_HITL)) {
         return 0;
     }
 #endif
 
-    switch (state) {
+    switch (baroState) {
         default:
-        case BAROMETER_NEEDS_SAMPLES:
+        case BAROMETER_NEEDS_START:
+            if (baro.dev.start_ut) {
+                baro.dev.start_ut(&baro.dev);
+            }
+            baroState = BAROMETER_NEEDS_TEMPERATURE;
+            return baro.dev.ut_delay;
+
+        case BAROMETER_NEEDS_TEMPERATURE:
             if (baro.dev.get_ut) {
                 baro.dev.get_ut(&baro.dev);
             }
-            if (baro.dev.start_up) {
-                baro.dev.start_up(&baro.dev);
-            }
-            state = BAROMETER_NEEDS_CALCULATION;
-            return baro.dev.up_delay;
-        break;
+            break;
 
-        case BAROMETER_NEEDS_CALCULATION:
-            if (baro.dev.get_up) {
-                baro.dev.get_up(&baro.dev);
+        case BAROMETER_NEEDS_PRESSURE:
+            {
+                if (baro.dev.get_up) {
+                    baro.dev.get_up(&baro.dev);
+                }
+
+                int32_t pressure;
+                baro.dev.calculate(&baro.dev, &pressure, &baro.baroTemperature);
+                baroPressureSum += pressure;
+
+                if (++baroSampleCount >= baroDecimation) {
+                    baroPressure = (float)baroPressureSum / baroSampleCount;
+                    baro.baroPressure = lrintf(baroPressure);
+                    baroPressureSum = 0;
+                    baroSampleCount = 0;
+                    baroNewSample = true;
+                }
+
+                if (baro.dev.ut_delay == 0) {
+                    // Temperature comes with the pressure conversion
+                    if (baro.dev.start_ut) {
+                        baro.dev.start_ut(&baro.dev);
+                    }
+                    if (baro.dev.get_ut) {
+                        baro.dev.get_ut(&baro.dev);
+                    }
+                } else if (++baroPressureConversions >= barometerConfig()->baro_temp_interval) {
+                    baroPressureConversions = 0;
+                    if (baro.dev.start_ut) {
+                        baro.dev.start_ut(&baro.dev);
+                    }
+                    baroState = BAROMETER_NEEDS_TEMPERATURE;
+                    return baro.dev.ut_delay;
+                }
             }
-            if (baro.dev.start_ut) {
-                baro.dev.start_ut(&baro.dev);
-            }
-            //output: baro.baroPressure, baro.baroTemperature
-            baro.dev.calculate(&baro.dev, &baro.baroPressure, &baro.baroTemperature);
-            state = BAROMETER_NEEDS_SAMPLES;
-            return baro.dev.ut_delay;
-        break;
+            break;
+    }
+
+    if (baro.dev.start_up) {
+        baro.dev.start_up(&baro.dev);
     }
+    baroState = BAROMETER_NEEDS_PRESSURE;
+    return baro.dev.up_delay;
 }
 
-static float pressureToAltitude(const float pressure)
+// True once per decimated sample. The simulator writes every pressure it sends directly
+bool baroProcess(void)
 {
-    return (1.0f - powf(pressure / 101325.0f, 0.190295f)) * 4433000.0f;
+#ifdef USE_SIMULATOR
+    if (ARMING_FLAG(SIMULATOR_MODE_HITL)) {
+        baroPressure = baro.baroPressure;
+        return true;
+    }
+#endif
+
+    const bool newSample = baroNewSample;
+    baroNewSample = false;
+    return newSample;
 }
 
 float altitudeToPressure(const float altCm)
@@ -313,11 +379,11 @@ void baroStartCalibration(void)
 int32_t baroCalculateAltitude(void)
 {
     if (!baroIsCalibrationComplete()) {
-        zeroCalibrationAddValueS(&zeroCalibration, baro.baroPressure);
+        zeroCalibrationAddValueS(&zeroCalibration, baroPressure);
 
         if (zeroCalibrationIsCompleteS(&zeroCalibration)) {
             zeroCalibrationGetZeroS(&zeroCalibration, &baroGroundPressure);
-            baroGroundAltitude = pressureToAltitude(baroGroundPressure);
+            baroGroundAltitude = baroPressureToAltitude(baroGroundPressure);
             LOG_DEBUG(BARO, "Barometer calibration complete (%d)", (int)lrintf(baroGroundAltitude));
         }
 
@@ -325,7 +391,7 @@ int32_t baroCalculateAltitude(void)
     }
     else {
         // calculates height from ground via baro readings
-        baro.BaroAlt = pressureToAltitude(baro.baroPressure) - baroGroundAltitude;
+        baro.BaroAlt = baroPressureToAltitude(baroPressure) - baroGroundAltitude;
         baro.BaroAlt += applySensorTempCompensation(baro.baroTemperature, baro.BaroAlt, SENSOR_INDEX_BARO);
    }
 
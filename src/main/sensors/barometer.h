@@ -53,6 +53,8 @@ typedef struct barometerConfig_s {
     uint8_t baro_hardware;                  // Barometer hardware to use
     uint16_t baro_calibration_tolerance;    // Baro calibration tolerance (cm at sea level)
     float baro_temp_correction;             // Baro temperature correction value (cm/K)
+    uint8_t baro_temp_interval;             // Pressure conversions per temperature conversion
+    uint8_t baro_rate_hz;                   // Decimated sample rate
 } barometerConfig_t;
 
 PG_DECLARE(barometerConfig_t, barometerConfig);
@@ -61,6 +63,7 @@ bool baroInit(void);
 bool baroIsCalibrationComplete(void);
 void baroStartCalibration(void);
 uint32_t baroUpdate(void);
+bool baroProcess(void);
 int32_t baroCalculateAltitude(void);
 int32_t baroGetLatestAltitude(void);
 int16_t baroGetTemperature(void);
@@ -0,0 +1,82 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "platform.h"
+
+#ifdef USE_BARO
+
+#include "sensors/barometer_altitude.h"
+
+#define SEA_LEVEL_PRESSURE_PA   101325.0f
+#define ALTITUDE_EXPONENT       0.190295f
+#define ALTITUDE_SCALE_CM       4433000.0f
+
+#define SEGMENT_PA  ((BARO_ALTITUDE_TABLE_MAX_PA - BARO_ALTITUDE_TABLE_MIN_PA) / BARO_ALTITUDE_TABLE_SEGMENTS)
+
+// Cubic in the position inside the segment, c[0] + t * (c[1] + t * (c[2] + t * c[3]))
+static float altitudeTable[BARO_ALTITUDE_TABLE_SEGMENTS][4];
+
+static float pressureToAltitudeExact(float pressurePa)
+{
+    return (1.0f - powf(pressurePa / SEA_LEVEL_PRESSURE_PA, ALTITUDE_EXPONENT)) * ALTITUDE_SCALE_CM;
+}
+
+/*
+ * Cubic Hermite segments through the exact curve with exact slopes at the
+ * ends. Interpolation error is below 1 cm over the whole table and below
+ * 0.05 cm under 4000 m, on top of the ~0.3 cm that single precision powf()
+ * already rounds to.
+ */
+void baroAltitudeTableInit(void)
+{
+    for (int i = 0; i < BARO_ALTITUDE_TABLE_SEGMENTS; i++) {
+        const float p0 = BARO_ALTITUDE_TABLE_MIN_PA + i * SEGMENT_PA;
+        const float p1 = p0 + SEGMENT_PA;
+        const float y0 = pressureToAltitudeExact(p0);
+        const float y1 = pressureToAltitudeExact(p1);
+        // d/dp of (1 - (p / p0)^a) * K is -a * (K - y) / p, scaled to the segment length
+        const float d0 = -ALTITUDE_EXPONENT * (ALTITUDE_SCALE_CM - y0) / p0 * SEGMENT_PA;
+        const float d1 = -ALTITUDE_EXPONENT * (ALTITUDE_SCALE_CM - y1) / p1 * SEGMENT_PA;
+
+        altitudeTable[i][0] = y0;
+        altitudeTable[i][1] = d0;
+        altitudeTable[i][2] = 3.0f * (y1 - y0) - 2.0f * d0 - d1;
+        altitudeTable[i][3] = 2.0f * (y0 - y1) + d0 + d1;
+    }
+}
+
+// Standard atmosphere altitude in cm, outside the table falls back to powf()
+float baroPressureToAltitude(float pressurePa)
+{
+    const float position = (pressurePa - BARO_ALTITUDE_TABLE_MIN_PA) * (1.0f / SEGMENT_PA);
+
+    if (!(position >= 0.0f && position < BARO_ALTITUDE_TABLE_SEGMENTS)) {
+        return pressureToAltitudeExact(pressurePa);
+    }
+
+    const int segment = (int)position;
+    const float t = position - segment;
+    const float *c = altitudeTable[segment];
+
+    return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+}
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Pressure range covered by the table, about -1200 m to 10300 m in the standard atmosphere
+#define BARO_ALTITUDE_TABLE_MIN_PA      25331.25f   // 0.25 atm
+#define BARO_ALTITUDE_TABLE_MAX_PA      116523.75f  // 1.15 atm
+#define BARO_ALTITUDE_TABLE_SEGMENTS    32
+
+void baroAltitudeTableInit(void);
+float baroPressureToAltitude(float pressurePa);
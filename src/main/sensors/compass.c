@@ -79,10 +79,136 @@ PG_RESET_TEMPLATE(compassConfig_t, compassConfig,
     .pitchDeciDegrees = SETTING_ALIGN_MAG_PITCH_DEFAULT,
     .yawDeciDegrees = SETTING_ALIGN_MAG_YAW_DEFAULT,
     .magGain = {SETTING_MAGGAIN_X_DEFAULT, SETTING_MAGGAIN_Y_DEFAULT, SETTING_MAGGAIN_Z_DEFAULT},
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    .magOnlineCalibration = SETTING_MAG_ONLINE_CALIBRATION_DEFAULT,
+#endif
 );
 
 static bool magUpdatedAtLeastOnce = false;
 
+#ifdef USE_MAG_ONLINE_CALIBRATION
+#define MAG_ONLINE_FORGETTING       0.995f  // About 200 accepted samples of memory
+#define MAG_ONLINE_MIN_SAMPLES      100     // Before the fit replaces the stored calibration
+#define MAG_ONLINE_MAX_FIELD_ERROR  0.05f   // RMS field length error of a usable fit
+#define MAG_ONLINE_SOLVE_INTERVAL   10      // Accepted samples between solutions
+
+/*
+ * The fit runs on raw samples less the stored offset, scaled by the mean
+ * stored gain. The stored calibration is the prior and sits near the unit
+ * sphere in these units.
+ */
+static magEllipsoidFit_t magOnlineFit;
+static float magOnlineScale;
+static float magOnlineSample[XYZ_AXIS_COUNT];
+static float magOnlinePrevious[XYZ_AXIS_COUNT];
+static bool magOnlineSampleReady;
+
+static void compassOnlineCalibrationReset(void)
+{
+    const float offset[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+    float radius[XYZ_AXIS_COUNT];
+
+    magOnlineScale = 0;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        magOnlineScale += ABS(compassConfig()->magGain[axis]) / (float)XYZ_AXIS_COUNT;
+    }
+    magOnlineScale = MAX(magOnlineScale, 1.0f);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        radius[axis] = MAX(ABS(compassConfig()->magGain[axis]), 1) / magOnlineScale;
+        magOnlinePrevious[axis] = 0;
+    }
+
+    magEllipsoidFitInit(&magOnlineFit, offset, radius, MAG_ONLINE_FORGETTING);
+    magOnlineSampleReady = false;
+}
+
+bool compassOnlineCalibrationIsActive(void)
+{
+    return compassConfig()->magOnlineCalibration && magOnlineFit.valid &&
+        magOnlineFit.sampleCount >= MAG_ONLINE_MIN_SAMPLES &&
+        magEllipsoidFitGetQuality(&magOnlineFit) < MAG_ONLINE_MAX_FIELD_ERROR;
+}
+
+const magEllipsoidFit_t *compassGetOnlineCalibration(void)
+{
+    return &magOnlineFit;
+}
+
+/*
+ * Low priority task, feeds the latest sample to the fit while flying. Like
+ * the bench calibration only samples that turned by more than ~8 deg are
+ * used, so a long straight leg does not dominate the fit.
+ */
+void compassOnlineCalibrationUpdate(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    if (!compassConfig()->magOnlineCalibration || !magOnlineSampleReady) {
+        return;
+    }
+    magOnlineSampleReady = false;
+
+    if (!ARMING_FLAG(ARMED) || !STATE(COMPASS_CALIBRATED)) {
+        return;
+    }
+
+    float sample[XYZ_AXIS_COUNT];
+    float diffMag = 0;
+    float avgMag = 0;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        sample[axis] = (magOnlineSample[axis] - compassConfig()->magZero.raw[axis]) / magOnlineScale;
+        diffMag += sq(sample[axis] - magOnlinePrevious[axis]);
+        avgMag += sq(sample[axis] + magOnlinePrevious[axis]) / 4.0f;
+    }
+
+    if (avgMag < 0.01f || diffMag / avgMag < sq(0.14f)) {
+        return;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        magOnlinePrevious[axis] = sample[axis];
+    }
+
+    if (magEllipsoidFitUpdate(&magOnlineFit, sample) && (magOnlineFit.sampleCount % MAG_ONLINE_SOLVE_INTERVAL) == 0) {
+        magEllipsoidFitSolve(&magOnlineFit);
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        DEBUG_SET(DEBUG_MAG_CALIBRATION, axis, lrintf(magOnlineFit.offset[axis] * magOnlineScale) + compassConfig()->magZero.raw[axis]);
+    }
+    DEBUG_SET(DEBUG_MAG_CALIBRATION, 3, lrintf(magEllipsoidFitGetQuality(&magOnlineFit) * 1000));
+    DEBUG_SET(DEBUG_MAG_CALIBRATION, 4, magOnlineFit.sampleCount);
+    DEBUG_SET(DEBUG_MAG_CALIBRATION, 5, magOnlineFit.rejectedCount);
+    DEBUG_SET(DEBUG_MAG_CALIBRATION, 6, compassOnlineCalibrationIsActive());
+}
+
+static bool compassApplyOnlineCalibration(void)
+{
+    if (!compassOnlineCalibrationIsActive()) {
+        return false;
+    }
+
+    float sample[XYZ_AXIS_COUNT];
+    float corrected[XYZ_AXIS_COUNT];
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        sample[axis] = (mag.magADC[axis] - compassConfig()->magZero.raw[axis]) / magOnlineScale;
+    }
+    magEllipsoidFitApply(&magOnlineFit, sample, corrected);
+
+    // Unit field is 1024, as with the stored gains
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        mag.magADC[axis] = corrected[axis] * 1024;
+    }
+    return true;
+}
+#else
+static bool compassApplyOnlineCalibration(void)
+{
+    return false;
+}
+#endif
+
 bool compassDetect(magDev_t *dev, magSensor_e magHardwareToUse)
 {
     magSensor_e magHardware = MAG_NONE;
@@ -323,6 +449,10 @@ bool compassInit(void)
         sensorsClear(SENSOR_MAG);
     }
 
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    compassOnlineCalibrationReset();
+#endif
+
     if (compassConfig()->rollDeciDegrees != 0 ||
         compassConfig()->pitchDeciDegrees != 0 ||
         compassConfig()->yawDeciDegrees != 0) {
@@ -407,6 +537,13 @@ void compassUpdate(timeUs_t currentTimeUs)
         mag.magADC[axis] = mag.dev.magADCRaw[axis];  // int32_t copy to work with
     }
 
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        magOnlineSample[axis] = mag.magADC[axis];
+    }
+    magOnlineSampleReady = true;
+#endif
+
     if (STATE(CALIBRATE_MAG)) {
         calStartedAt = currentTimeUs;
 
@@ -451,26 +588,33 @@ void compassUpdate(timeUs_t currentTimeUs)
             }
         } else {
             float magZerof[3];
-            sensorCalibrationSolveForOffset(&calState, magZerof);
+            calStartedAt = 0;
 
-            for (int axis = 0; axis < 3; axis++) {
-                compassConfigMutable()->magZero.raw[axis] = lrintf(magZerof[axis]);
-            }
+            if (!sensorCalibrationSolveForOffset(&calState, magZerof)) {
+                // Not enough rotation to define the offset - keep the previous calibration
+                beeper(BEEPER_ACTION_FAIL);
+            } else {
+                for (int axis = 0; axis < 3; axis++) {
+                    compassConfigMutable()->magZero.raw[axis] = lrintf(magZerof[axis]);
+                }
 
-            /*
-             * Scale calibration
-             * We use max absolute value of each axis as scale calibration with constant 1024 as base
-             * It is dirty, but worth checking if this will solve the problem of changing mag vector when UAV is tilted
-             */
-            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-                compassConfigMutable()->magGain[axis] = ABS(magAxisDeviation[axis] - compassConfig()->magZero.raw[axis]);
-            }
+                /*
+                 * Scale calibration
+                 * We use max absolute value of each axis as scale calibration with constant 1024 as base
+                 * It is dirty, but worth checking if this will solve the problem of changing mag vector when UAV is tilted
+                 */
+                for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                    compassConfigMutable()->magGain[axis] = ABS(magAxisDeviation[axis] - compassConfig()->magZero.raw[axis]);
+                }
 
-            calStartedAt = 0;
-            saveConfigAndNotify();
+#ifdef USE_MAG_ONLINE_CALIBRATION
+                compassOnlineCalibrationReset();
+#endif
+                saveConfigAndNotify();
+            }
         }
     }
-    else {
+    else if (!compassApplyOnlineCalibration()) {
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             mag.magADC[axis] = (mag.magADC[axis] - compassConfig()->magZero.raw[axis]) * 1024 / compassConfig()->magGain[axis];
         }
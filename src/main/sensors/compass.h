@@ -24,6 +24,7 @@
 
 #include "drivers/compass/compass.h"
 
+#include "sensors/compass_ellipsoid.h"
 #include "sensors/sensors.h"
 
 // Type of magnetometer used/detected
@@ -71,6 +72,9 @@ typedef struct compassConfig_s {
     int16_t rollDeciDegrees;                // Alignment for external mag on the roll (X) axis (0.1deg)
     int16_t pitchDeciDegrees;               // Alignment for external mag on the pitch (Y) axis (0.1deg)
     int16_t yawDeciDegrees;                 // Alignment for external mag on the yaw (Z) axis (0.1deg)
+#ifdef USE_MAG_ONLINE_CALIBRATION
+    uint8_t magOnlineCalibration;           // Refine the calibration with an ellipsoid fit in flight
+#endif
 } compassConfig_t;
 
 PG_DECLARE(compassConfig_t, compassConfig);
@@ -82,4 +86,10 @@ bool compassIsReady(void);
 bool compassIsHealthy(void);
 bool compassIsCalibrationComplete(void);
 
+#ifdef USE_MAG_ONLINE_CALIBRATION
+void compassOnlineCalibrationUpdate(timeUs_t currentTimeUs);
+bool compassOnlineCalibrationIsActive(void);
+const magEllipsoidFit_t *compassGetOnlineCalibration(void);
+#endif
+
 #endif
@@ -0,0 +1,275 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_MAG_ONLINE_CALIBRATION
+
+#include "common/maths.h"
+#include "common/matrix.h"
+
+#include "sensors/compass_ellipsoid.h"
+
+#define INITIAL_VARIANCE        0.1f    // Weak prior, a few dozen samples outweigh it
+#define MAX_TRACE               (MAG_ELLIPSOID_PARAM_COUNT * INITIAL_VARIANCE)
+#define MIN_EXCITATION          1e-9f
+#define WARMUP_SAMPLES          20      // Accepted without gating
+#define OUTLIER_GATE            3.0f    // Standard deviations
+#define MIN_RESIDUAL            0.02f   // Gate floor, about 1% of field length
+#define RESIDUAL_ALPHA          0.02f
+#define FIELD_ERROR_ALPHA       0.02f
+#define MAX_AXIS_RATIO          2.0f    // Soft iron beyond this is treated as a bad fit
+
+static void quadricRegressor(const float sample[XYZ_AXIS_COUNT], float phi[MAG_ELLIPSOID_PARAM_COUNT])
+{
+    const float x = sample[X];
+    const float y = sample[Y];
+    const float z = sample[Z];
+
+    phi[0] = x * x;
+    phi[1] = y * y;
+    phi[2] = z * z;
+    phi[3] = 2.0f * x * y;
+    phi[4] = 2.0f * x * z;
+    phi[5] = 2.0f * y * z;
+    phi[6] = 2.0f * x;
+    phi[7] = 2.0f * y;
+    phi[8] = 2.0f * z;
+}
+
+void magEllipsoidFitInit(magEllipsoidFit_t *fit, const float offset[XYZ_AXIS_COUNT], const float radius[XYZ_AXIS_COUNT], float forgetting)
+{
+    memset(fit, 0, sizeof(*fit));
+    fit->forgetting = forgetting;
+    fit->residualVariance = sq(MIN_RESIDUAL);
+
+    // Axis aligned prior, sum(((x - c) / r)^2) = 1 normalised to the right hand side
+    float k = 1.0f;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        k -= sq(offset[axis] / radius[axis]);
+    }
+    k = MAX(k, 0.1f);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fit->theta[axis] = 1.0f / (sq(radius[axis]) * k);
+        fit->theta[6 + axis] = -offset[axis] / (sq(radius[axis]) * k);
+    }
+
+    for (int i = 0; i < MAG_ELLIPSOID_PARAM_COUNT; i++) {
+        fit->P[i][i] = INITIAL_VARIANCE;
+    }
+
+    magEllipsoidFitSolve(fit);
+}
+
+/*
+ * One RLS step. Residuals beyond the gate are rejected but still widen it a
+ * little, so a lasting change of the field (new payload, moved battery) gets
+ * through after a few samples while single disturbances do not.
+ */
+bool magEllipsoidFitUpdate(magEllipsoidFit_t *fit, const float sample[XYZ_AXIS_COUNT])
+{
+    float phi[MAG_ELLIPSOID_PARAM_COUNT];
+    quadricRegressor(sample, phi);
+
+    float error = 1.0f;
+    for (int i = 0; i < MAG_ELLIPSOID_PARAM_COUNT; i++) {
+        error -= phi[i] * fit->theta[i];
+    }
+
+    const float gateVariance = sq(OUTLIER_GATE) * MAX(fit->residualVariance, sq(MIN_RESIDUAL));
+    if (fit->sampleCount >= WARMUP_SAMPLES && sq(error) > gateVariance) {
+        fit->residualVariance += RESIDUAL_ALPHA * (gateVariance - fit->residualVariance);
+        fit->rejectedCount++;
+        return false;
+    }
+    fit->residualVariance += RESIDUAL_ALPHA * (sq(error) - fit->residualVariance);
+
+    float Pphi[MAG_ELLIPSOID_PARAM_COUNT];
+    matrixMultiplyVector(Pphi, &fit->P[0][0], MAG_ELLIPSOID_PARAM_COUNT, MAG_ELLIPSOID_PARAM_COUNT, phi);
+    const float excitation = matrixVectorDotProduct(phi, Pphi, MAG_ELLIPSOID_PARAM_COUNT);
+    const float trace = matrixTrace(&fit->P[0][0], MAG_ELLIPSOID_PARAM_COUNT);
+
+    const float lambda = fit->forgetting;
+    const float denominator = lambda + excitation;
+
+    for (int i = 0; i < MAG_ELLIPSOID_PARAM_COUNT; i++) {
+        fit->theta[i] += Pphi[i] / denominator * error;
+    }
+
+    /*
+     * Exponential forgetting while the covariance is small, so the prior and
+     * old data fade out in every direction. Above the initial trace only the
+     * information along phi is discounted, inv(P) += (1 - (1 - lambda) /
+     * phi'P phi) * phi * phi', which matches exponential forgetting along phi
+     * and leaves the rest of P alone. Level flight with only yaw changing then
+     * cannot wind up the unexcited directions.
+     */
+    if (trace < MAX_TRACE) {
+        matrixSymmetricRankOneUpdate(&fit->P[0][0], MAG_ELLIPSOID_PARAM_COUNT, -1.0f / denominator, Pphi);
+        matrixScale(&fit->P[0][0], MAG_ELLIPSOID_PARAM_COUNT, MAG_ELLIPSOID_PARAM_COUNT, 1.0f / lambda);
+    } else if (excitation > MIN_EXCITATION) {
+        const float weight = (excitation - (1.0f - lambda)) / (excitation * denominator);
+        matrixSymmetricRankOneUpdate(&fit->P[0][0], MAG_ELLIPSOID_PARAM_COUNT, -weight, Pphi);
+    }
+
+    fit->sampleCount++;
+
+    if (fit->valid) {
+        float corrected[XYZ_AXIS_COUNT];
+        magEllipsoidFitApply(fit, sample, corrected);
+        const float length = sqrtf(sq(corrected[X]) + sq(corrected[Y]) + sq(corrected[Z]));
+        fit->fieldErrorVariance += FIELD_ERROR_ALPHA * (sq(length - 1.0f) - fit->fieldErrorVariance);
+    }
+
+    return true;
+}
+
+// Cyclic Jacobi, A is diagonalised in place and V receives the eigenvectors as columns
+static void symmetricEigen3(float A[3][3], float V[3][3])
+{
+    static const uint8_t pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            V[i][j] = i == j ? 1.0f : 0.0f;
+        }
+    }
+
+    for (int sweep = 0; sweep < 10; sweep++) {
+        const float offDiagonal = sq(A[0][1]) + sq(A[0][2]) + sq(A[1][2]);
+        if (offDiagonal < 1e-12f * (sq(A[0][0]) + sq(A[1][1]) + sq(A[2][2]))) {
+            break;
+        }
+
+        for (int n = 0; n < 3; n++) {
+            const int p = pairs[n][0];
+            const int q = pairs[n][1];
+            if (fabsf(A[p][q]) < 1e-20f) {
+                continue;
+            }
+
+            const float theta = (A[q][q] - A[p][p]) / (2.0f * A[p][q]);
+            const float t = (theta >= 0 ? 1.0f : -1.0f) / (fabsf(theta) + sqrtf(sq(theta) + 1.0f));
+            const float c = 1.0f / sqrtf(sq(t) + 1.0f);
+            const float s = t * c;
+
+            for (int k = 0; k < 3; k++) {
+                const float akp = A[k][p];
+                const float akq = A[k][q];
+                A[k][p] = c * akp - s * akq;
+                A[k][q] = s * akp + c * akq;
+            }
+            for (int k = 0; k < 3; k++) {
+                const float apk = A[p][k];
+                const float aqk = A[q][k];
+                A[p][k] = c * apk - s * aqk;
+                A[q][k] = s * apk + c * aqk;
+            }
+            for (int k = 0; k < 3; k++) {
+                const float vkp = V[k][p];
+                const float vkq = V[k][q];
+                V[k][p] = c * vkp - s * vkq;
+                V[k][q] = s * vkp + c * vkq;
+            }
+        }
+    }
+}
+
+/*
+ * x'Mx + 2v'x = 1 is centred at c = -inv(M) v, where (x - c)' M (x - c) =
+ * 1 - c'v. The soft iron matrix is the symmetric square root of M / (1 - c'v).
+ */
+bool magEllipsoidFitSolve(magEllipsoidFit_t *fit)
+{
+    const float *t = fit->theta;
+    const float M[3][3] = {
+        { t[0], t[3], t[4] },
+        { t[3], t[1], t[5] },
+        { t[4], t[5], t[2] },
+    };
+
+    const float cofactor[3][3] = {
+        { M[1][1] * M[2][2] - M[1][2] * M[2][1], M[0][2] * M[2][1] - M[0][1] * M[2][2], M[0][1] * M[1][2] - M[0][2] * M[1][1] },
+        { M[1][2] * M[2][0] - M[1][0] * M[2][2], M[0][0] * M[2][2] - M[0][2] * M[2][0], M[0][2] * M[1][0] - M[0][0] * M[1][2] },
+        { M[1][0] * M[2][1] - M[1][1] * M[2][0], M[0][1] * M[2][0] - M[0][0] * M[2][1], M[0][0] * M[1][1] - M[0][1] * M[1][0] },
+    };
+    const float det = M[0][0] * cofactor[0][0] + M[0][1] * cofactor[1][0] + M[0][2] * cofactor[2][0];
+
+    fit->valid = false;
+    if (det <= 0) {
+        return false;
+    }
+
+    float offset[3];
+    float radiusSquared = 1.0f;
+    for (int i = 0; i < 3; i++) {
+        offset[i] = -(cofactor[i][0] * t[6] + cofactor[i][1] * t[7] + cofactor[i][2] * t[8]) / det;
+        radiusSquared -= offset[i] * t[6 + i];
+    }
+    if (radiusSquared <= 0) {
+        return false;
+    }
+
+    float A[3][3];
+    float V[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            A[i][j] = M[i][j] / radiusSquared;
+        }
+    }
+    symmetricEigen3(A, V);
+
+    const float minEigen = MIN(A[0][0], MIN(A[1][1], A[2][2]));
+    const float maxEigen = MAX(A[0][0], MAX(A[1][1], A[2][2]));
+    if (minEigen <= 0 || maxEigen > sq(MAX_AXIS_RATIO) * minEigen) {
+        return false;
+    }
+
+    const float scale[3] = { sqrtf(A[0][0]), sqrtf(A[1][1]), sqrtf(A[2][2]) };
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            fit->softIron[i][j] = V[i][0] * scale[0] * V[j][0] + V[i][1] * scale[1] * V[j][1] + V[i][2] * scale[2] * V[j][2];
+        }
+        fit->offset[i] = offset[i];
+    }
+
+    fit->valid = true;
+    return true;
+}
+
+void magEllipsoidFitApply(const magEllipsoidFit_t *fit, const float sample[XYZ_AXIS_COUNT], float corrected[XYZ_AXIS_COUNT])
+{
+    const float centred[3] = { sample[X] - fit->offset[X], sample[Y] - fit->offset[Y], sample[Z] - fit->offset[Z] };
+
+    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+        corrected[i] = fit->softIron[i][0] * centred[0] + fit->softIron[i][1] * centred[1] + fit->softIron[i][2] * centred[2];
+    }
+}
+
+// RMS error of the corrected field length, as a fraction of the field
+float magEllipsoidFitGetQuality(const magEllipsoidFit_t *fit)
+{
+    return sqrtf(fit->fieldErrorVariance);
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/axis.h"
+
+/*
+ * Recursive least squares fit of the quadric
+ *
+ *   A x^2 + B y^2 + C z^2 + 2D xy + 2E xz + 2F yz + 2G x + 2H y + 2I z = 1
+ *
+ * to magnetometer samples, with exponential forgetting. The solution is the
+ * hard iron offset and the symmetric soft iron matrix that map the ellipsoid
+ * onto the unit sphere. Samples are expected around unit length, and the
+ * origin must lie inside the ellipsoid.
+ */
+
+#define MAG_ELLIPSOID_PARAM_COUNT   9
+
+typedef struct magEllipsoidFit_s {
+    float theta[MAG_ELLIPSOID_PARAM_COUNT];
+    float P[MAG_ELLIPSOID_PARAM_COUNT][MAG_ELLIPSOID_PARAM_COUNT];
+    float forgetting;
+    float residualVariance;     // Of accepted samples, sets the outlier gate
+    float fieldErrorVariance;   // Squared field length error after correction
+    uint32_t sampleCount;       // Accepted samples
+    uint32_t rejectedCount;
+    // Latest solution
+    bool valid;
+    float offset[XYZ_AXIS_COUNT];
+    float softIron[XYZ_AXIS_COUNT][XYZ_AXIS_COUNT];
+} magEllipsoidFit_t;
+
+void magEllipsoidFitInit(magEllipsoidFit_t *fit, const float offset[XYZ_AXIS_COUNT], const float radius[XYZ_AXIS_COUNT], float forgetting);
+bool magEllipsoidFitUpdate(magEllipsoidFit_t *fit, const float sample[XYZ_AXIS_COUNT]);
+bool magEllipsoidFitSolve(magEllipsoidFit_t *fit);
+void magEllipsoidFitApply(const magEllipsoidFit_t *fit, const float sample[XYZ_AXIS_COUNT], float corrected[XYZ_AXIS_COUNT]);
+float magEllipsoidFitGetQuality(const magEllipsoidFit_t *fit);
@@ -64,6 +64,8 @@
 
 #include "sensors/boardalignment.h"
 #include "sensors/gyro.h"
+#include "sensors/gyro_calibration.h"
+#include "sensors/gyro_fifo.h"
 #include "sensors/sensors.h"
 
 #include "flight/gyroanalyse.h"
@@ -81,7 +83,9 @@ FASTRAM gyro_t gyro; // gyro sensor object
 
 STATIC_UNIT_TESTED gyroDev_t gyroDev[MAX_GYRO_COUNT];  // Not in FASTRAM since it may hold DMA buffers
 STATIC_FASTRAM int16_t gyroTemperature[MAX_GYRO_COUNT];
-STATIC_FASTRAM_UNIT_TESTED zeroCalibrationVector_t gyroCalibration[MAX_GYRO_COUNT];
+STATIC_FASTRAM bool gyroTemperatureValid;
+STATIC_FASTRAM_UNIT_TESTED gyroZeroEstimator_t gyroCalibration[MAX_GYRO_COUNT];
+STATIC_FASTRAM zeroCalibrationState_e gyroCalibrationState;
 
 STATIC_FASTRAM filterApplyFnPtr gyroLpfApplyFn;
 STATIC_FASTRAM filter_t gyroLpfState[XYZ_AXIS_COUNT];
@@ -100,7 +104,7 @@ EXTENDED_FASTRAM secondaryDynamicGyroNotchState_t secondaryDynamicGyroNotchState
 
 #endif
 
-PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 12);
+PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 13);
 
 PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .gyro_anti_aliasing_lpf_hz = SETTING_GYRO_ANTI_ALIASING_LPF_HZ_DEFAULT,
@@ -125,6 +129,7 @@ PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
 #endif
     .init_gyro_cal_enabled = SETTING_INIT_GYRO_CAL_DEFAULT,
     .gyro_zero_cal = {SETTING_GYRO_ZERO_X_DEFAULT, SETTING_GYRO_ZERO_Y_DEFAULT, SETTING_GYRO_ZERO_Z_DEFAULT},
+    .gyroZeroTracking = SETTING_GYRO_ZERO_TRACKING_DEFAULT,
     .gravity_cmss_cal = SETTING_INS_GRAVITY_CMSS_DEFAULT,
 #ifdef USE_ADAPTIVE_FILTER
     .adaptiveFilterTarget = SETTING_GYRO_ADAPTIVE_FILTER_TARGET_DEFAULT,
@@ -332,6 +337,11 @@ bool gyroInit(void)
 
     // initFn will initialize sampleRateIntervalUs to actual gyro sampling rate (if driver supports it). Calculate target looptime using that value
     gyro.targetLooptime = gyroDev[0].sampleRateIntervalUs;
+
+    // With a FIFO all samples are read, but decimated to at most one per gyro task run
+    if (gyroDev[0].readFifoFn) {
+        gyro.targetLooptime = MAX(gyro.targetLooptime, (uint32_t)TASK_GYRO_LOOPTIME);
+    }
  
     gyroInitFilters();
 
@@ -362,7 +372,9 @@ void gyroStartCalibration(void)
     }
 #endif
 
-    zeroCalibrationStartV(&gyroCalibration[0], CALIBRATING_GYRO_TIME_MS, CALIBRATING_GYRO_MORON_THRESHOLD, false);
+    const uint16_t blockLength = (CALIBRATING_GYRO_BLOCK_MS * 1000) / getLooptime();
+    gyroZeroEstimatorInit(&gyroCalibration[0], blockLength, CALIBRATING_GYRO_TIME_MS / CALIBRATING_GYRO_BLOCK_MS, CALIBRATING_GYRO_MORON_THRESHOLD);
+    gyroCalibrationState = ZERO_CALIBRATION_IN_PROGRESS;
 }
 
 bool gyroIsCalibrationComplete(void)
@@ -377,26 +389,23 @@ bool gyroIsCalibrationComplete(void)
     }
 #endif
 
-    return zeroCalibrationIsCompleteV(&gyroCalibration[0]) && zeroCalibrationIsSuccessfulV(&gyroCalibration[0]);
+    return gyroCalibrationState == ZERO_CALIBRATION_DONE;
 }
 
-STATIC_UNIT_TESTED void performGyroCalibration(gyroDev_t *dev, zeroCalibrationVector_t *gyroCalibration)
+// degC, NAN when the sensor does not report temperature
+static float gyroCalibrationTemperature(void)
 {
-    fpVector3_t v;
-
-    // Consume gyro reading
-    v.v[X] = dev->gyroADCRaw[X];
-    v.v[Y] = dev->gyroADCRaw[Y];
-    v.v[Z] = dev->gyroADCRaw[Z];
+    return gyroTemperatureValid ? gyroTemperature[0] * 0.1f : NAN;
+}
 
-    zeroCalibrationAddValueV(gyroCalibration, &v);
+STATIC_UNIT_TESTED void performGyroCalibration(gyroDev_t *dev, gyroZeroEstimator_t *gyroCalibration)
+{
+    gyroZeroEstimatorPush(gyroCalibration, dev->gyroADCRaw, gyroCalibrationTemperature());
 
     // Check if calibration is complete after this cycle
-    if (zeroCalibrationIsCompleteV(gyroCalibration)) {
-        zeroCalibrationGetZeroV(gyroCalibration, &v);
-        dev->gyroZero[X] = v.v[X];
-        dev->gyroZero[Y] = v.v[Y];
-        dev->gyroZero[Z] = v.v[Z];
+    if (gyroZeroEstimatorIsConverged(gyroCalibration)) {
+        gyroZeroEstimatorGetZero(gyroCalibration, gyroCalibrationTemperature(), dev->gyroZero);
+        gyroCalibrationState = ZERO_CALIBRATION_DONE;
 
 #ifndef USE_IMU_FAKE // fixes Test Unit compilation error
         setGyroCalibration(dev->gyroZero);
@@ -411,6 +420,23 @@ STATIC_UNIT_TESTED void performGyroCalibration(gyroDev_t *dev, zeroCalibrationVe
     }
 }
 
+#ifndef USE_IMU_FAKE
+/*
+ * After the initial calibration the zero keeps being refined while disarmed
+ * and still. Armed, it follows the gyro temperature along the learned slope.
+ */
+static void gyroTrackZero(gyroDev_t *dev, gyroZeroEstimator_t *gyroCalibration)
+{
+    const float temperature = gyroCalibrationTemperature();
+
+    if (!ARMING_FLAG(ARMED)) {
+        gyroZeroEstimatorPush(gyroCalibration, dev->gyroADCRaw, temperature);
+    }
+
+    gyroZeroEstimatorGetZero(gyroCalibration, temperature, dev->gyroZero);
+}
+#endif
+
 /*
  * Calculate rotation rate in rad/s in body frame
  */
@@ -421,16 +447,17 @@ void gyroGetMeasuredRotationRate(fpVector3_t *measuredRotationRate)
     }
 }
 
-static bool FAST_CODE NOINLINE gyroUpdateAndCalibrate(gyroDev_t * gyroDev, zeroCalibrationVector_t * gyroCal, float * gyroADCf)
+static bool FAST_CODE NOINLINE gyroUpdateAndCalibrate(gyroDev_t * gyroDev, gyroZeroEstimator_t * gyroCal, float * gyroADCf)
 {
 
     // range: +/- 8192; +/- 2000 deg/sec
-    if (gyroDev->readFn(gyroDev)) {
+    const bool gyroReadOk = gyroDev->readFifoFn ? gyroFifoRead(gyroDev) : gyroDev->readFn(gyroDev);
+    if (gyroReadOk) {
 
 #ifndef USE_IMU_FAKE // fixes Test Unit compilation error
     if (!gyroConfig()->init_gyro_cal_enabled) {
         // marks that the gyro calibration has ended
-        gyroCalibration[0].params.state = ZERO_CALIBRATION_DONE;
+        gyroCalibrationState = ZERO_CALIBRATION_DONE;
         // pass the calibration values
         gyroDev->gyroZero[X] = gyroConfig()->gyro_zero_cal[X];
         gyroDev->gyroZero[Y] = gyroConfig()->gyro_zero_cal[Y];
@@ -438,9 +465,15 @@ static bool FAST_CODE NOINLINE gyroUpdateAndCalibrate(gyroDev_t * gyroDev, zeroC
     }
 #endif
 
-        if (zeroCalibrationIsCompleteV(gyroCal)) {
+        if (gyroCalibrationState != ZERO_CALIBRATION_IN_PROGRESS) {
             float gyroADCtmp[XYZ_AXIS_COUNT];
 
+#ifndef USE_IMU_FAKE
+            if (gyroConfig()->gyroZeroTracking && gyroConfig()->init_gyro_cal_enabled) {
+                gyroTrackZero(gyroDev, gyroCal);
+            }
+#endif
+
             //Apply zero calibration with CMSIS DSP
             arm_sub_f32(gyroDev->gyroADCRaw, gyroDev->gyroZero, gyroADCtmp, 3);
 
@@ -586,7 +619,8 @@ bool gyroReadTemperature(void)
 
     // Read gyro sensor temperature. temperatureFn returns temperature in [degC * 10]
     if (gyroDev[0].temperatureFn) {
-        return gyroDev[0].temperatureFn(&gyroDev[0], &gyroTemperature[0]);
+        gyroTemperatureValid = gyroDev[0].temperatureFn(&gyroDev[0], &gyroTemperature[0]);
+        return gyroTemperatureValid;
     }
 
     return false;
@@ -92,6 +92,7 @@ typedef struct gyroConfig_s {
 #endif
     bool init_gyro_cal_enabled;
     int16_t gyro_zero_cal[XYZ_AXIS_COUNT];
+    bool gyroZeroTracking;
     float gravity_cmss_cal;
 #ifdef USE_ADAPTIVE_FILTER
     float adaptiveFilterTarget;
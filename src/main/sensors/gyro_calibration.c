@@ -0,0 +1,257 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+
+#include "sensors/gyro_calibration.h"
+
+#define MIN_RECENT_BLOCKS           3       // Before the median means anything
+#define MIN_ACCEPTED_BLOCKS         8
+#define MEDIAN_GATE                 5.0f    // Standard errors of the block mean
+#define MEDIAN_GATE_FLOOR           1.0f    // Raw units, sensor quantisation
+#define STATIONARY_RATIO            2.5f    // Block mean variance over the variance expected from the noise
+#define MIN_BLOCK_MEAN_VARIANCE     0.01f   // Raw units^2, floor for noiseless (simulated) sensors
+#define TARGET_ERROR                0.25f   // Raw units, standard error of the offset
+#define TRACKING_BLOCKS             1200    // Memory of the tracked offset and temperature slope, ~1 min of 50ms blocks
+#define MIN_TEMPERATURE_VARIANCE    0.25f   // degC^2, slope is not used below
+#define MAX_EXTRAPOLATION           15.0f   // degC
+
+static void resetAccumulation(gyroZeroEstimator_t *estimator)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        devClear(&estimator->blockMeans[axis]);
+        estimator->withinVariance[axis] = 0.0f;
+    }
+    estimator->temperatureMean = NAN;
+}
+
+static void resetBlock(gyroZeroEstimator_t *estimator)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        devClear(&estimator->block[axis]);
+    }
+    estimator->blockSamples = 0;
+    estimator->blockTemperatureSum = 0.0f;
+}
+
+void gyroZeroEstimatorInit(gyroZeroEstimator_t *estimator, uint16_t blockLength, uint16_t windowBlocks, float stdDevThreshold)
+{
+    memset(estimator, 0, sizeof(*estimator));
+    estimator->blockLength = MAX(blockLength, 2);
+    estimator->windowBlocks = MAX(windowBlocks, MIN_ACCEPTED_BLOCKS);
+    estimator->stdDevThreshold = stdDevThreshold;
+
+    resetBlock(estimator);
+    resetAccumulation(estimator);
+}
+
+static float medianOfRecent(const gyroZeroEstimator_t *estimator, int axis)
+{
+    float sorted[GYRO_ZERO_MEDIAN_WINDOW];
+    const int count = estimator->recentCount;
+
+    for (int i = 0; i < count; i++) {
+        const float value = estimator->recentMean[axis][i];
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > value; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = value;
+    }
+
+    return count & 1 ? sorted[count / 2] : 0.5f * (sorted[count / 2 - 1] + sorted[count / 2]);
+}
+
+static float temperatureSlope(const gyroZeroEstimator_t *estimator, int axis)
+{
+    if (!(estimator->temperatureVariance >= MIN_TEMPERATURE_VARIANCE)) {
+        return 0.0f;
+    }
+    return estimator->covariance[axis] / estimator->temperatureVariance;
+}
+
+static void predictZero(const gyroZeroEstimator_t *estimator, float temperature, float zero[XYZ_AXIS_COUNT])
+{
+    float dT = 0.0f;
+    if (!isnan(temperature) && !isnan(estimator->temperatureMean)) {
+        dT = constrainf(temperature - estimator->temperatureMean, -MAX_EXTRAPOLATION, MAX_EXTRAPOLATION);
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        zero[axis] = estimator->zero[axis] + temperatureSlope(estimator, axis) * dT;
+    }
+}
+
+static void convergeIfStationary(gyroZeroEstimator_t *estimator, float temperature)
+{
+    const uint16_t blocks = estimator->blockMeans[X].m_n;
+    if (blocks < MIN_ACCEPTED_BLOCKS) {
+        return;
+    }
+
+    bool stationary = true;
+    bool accurate = true;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        // Variance of a block mean if the offset did not move: within block variance / block length
+        const float expectedVariance = MAX(estimator->withinVariance[axis] / estimator->blockLength, MIN_BLOCK_MEAN_VARIANCE);
+        const float variance = devVariance(&estimator->blockMeans[axis]);
+
+        stationary &= variance <= STATIONARY_RATIO * expectedVariance;
+        accurate &= variance <= sq(TARGET_ERROR) * blocks;
+    }
+
+    if (stationary && (accurate || blocks >= estimator->windowBlocks)) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            estimator->zero[axis] = estimator->blockMeans[axis].m_newM;
+            estimator->covariance[axis] = 0.0f;
+        }
+        estimator->temperatureMean = temperature;
+        estimator->temperatureVariance = 0.0f;
+        estimator->trackedBlocks = blocks;
+        estimator->converged = true;
+    } else if (blocks >= estimator->windowBlocks) {
+        // Drifting or slowly moving the whole window, start over
+        resetAccumulation(estimator);
+    }
+}
+
+/*
+ * Exponentially weighted moments of (temperature, offset). The weight is
+ * 1 / n until the memory is full, so the first blocks are a plain average.
+ */
+static void trackZero(gyroZeroEstimator_t *estimator, const float blockMean[XYZ_AXIS_COUNT], float temperature)
+{
+    estimator->trackedBlocks = MIN(estimator->trackedBlocks + 1, TRACKING_BLOCKS);
+    const float alpha = 1.0f / estimator->trackedBlocks;
+
+    float dT = 0.0f;
+    if (!isnan(temperature)) {
+        if (isnan(estimator->temperatureMean)) {
+            estimator->temperatureMean = temperature;
+        }
+        dT = temperature - estimator->temperatureMean;
+        estimator->temperatureMean += alpha * dT;
+        estimator->temperatureVariance = (1.0f - alpha) * (estimator->temperatureVariance + alpha * sq(dT));
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float dZero = blockMean[axis] - estimator->zero[axis];
+        estimator->zero[axis] += alpha * dZero;
+        estimator->covariance[axis] = (1.0f - alpha) * (estimator->covariance[axis] + alpha * dT * dZero);
+    }
+}
+
+static bool processBlock(gyroZeroEstimator_t *estimator)
+{
+    const float temperature = estimator->blockTemperatureSum / estimator->blockSamples;
+    float blockMean[XYZ_AXIS_COUNT];
+    float blockVariance[XYZ_AXIS_COUNT];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        blockMean[axis] = estimator->block[axis].m_newM;
+        blockVariance[axis] = devVariance(&estimator->block[axis]);
+        estimator->recentMean[axis][estimator->recentIndex] = blockMean[axis];
+    }
+    estimator->recentIndex = (estimator->recentIndex + 1) % GYRO_ZERO_MEDIAN_WINDOW;
+    estimator->recentCount = MIN(estimator->recentCount + 1, GYRO_ZERO_MEDIAN_WINDOW);
+
+    if (estimator->recentCount < MIN_RECENT_BLOCKS) {
+        return false;
+    }
+
+    float predicted[XYZ_AXIS_COUNT];
+    predictZero(estimator, temperature, predicted);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float gate = MEDIAN_GATE * sqrtf(blockVariance[axis] / estimator->blockLength) + MEDIAN_GATE_FLOOR;
+
+        if (blockVariance[axis] > sq(estimator->stdDevThreshold) || fabsf(blockMean[axis] - medianOfRecent(estimator, axis)) > gate) {
+            return false;
+        }
+
+        // Slow rotation passes the median, but not the known offset
+        if (estimator->converged && fabsf(blockMean[axis] - predicted[axis]) > gate) {
+            return false;
+        }
+    }
+
+    if (estimator->converged) {
+        trackZero(estimator, blockMean, temperature);
+    } else {
+        const uint16_t blocks = estimator->blockMeans[X].m_n + 1;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            devPush(&estimator->blockMeans[axis], blockMean[axis]);
+            estimator->withinVariance[axis] += (blockVariance[axis] - estimator->withinVariance[axis]) / blocks;
+        }
+        if (!isnan(temperature)) {
+            estimator->temperatureMean = isnan(estimator->temperatureMean) ? temperature : estimator->temperatureMean + (temperature - estimator->temperatureMean) / blocks;
+        }
+        convergeIfStationary(estimator, estimator->temperatureMean);
+    }
+
+    return true;
+}
+
+/*
+ * Feed one raw sample, temperature in degC or NAN when the sensor has none.
+ * Returns true when a block was completed and accepted.
+ */
+bool gyroZeroEstimatorPush(gyroZeroEstimator_t *estimator, const float sample[XYZ_AXIS_COUNT], float temperature)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        devPush(&estimator->block[axis], sample[axis]);
+    }
+    estimator->blockTemperatureSum += temperature;
+
+    if (++estimator->blockSamples < estimator->blockLength) {
+        return false;
+    }
+
+    const bool accepted = processBlock(estimator);
+    if (accepted) {
+        estimator->acceptedCount++;
+    } else {
+        estimator->rejectedCount++;
+    }
+
+    resetBlock(estimator);
+    return accepted;
+}
+
+bool gyroZeroEstimatorIsConverged(const gyroZeroEstimator_t *estimator)
+{
+    return estimator->converged;
+}
+
+// Offset at the given temperature, NAN keeps the last tracked offset
+void gyroZeroEstimatorGetZero(const gyroZeroEstimator_t *estimator, float temperature, float zero[XYZ_AXIS_COUNT])
+{
+    predictZero(estimator, temperature, zero);
+}
+
+// Raw units per degC, zero until the temperature has moved enough to tell
+float gyroZeroEstimatorGetTemperatureSlope(const gyroZeroEstimator_t *estimator, int axis)
+{
+    return temperatureSlope(estimator, axis);
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/axis.h"
+#include "common/maths.h"
+
+/*
+ * Gyro zero offset estimator.
+ *
+ * Samples are collected in short blocks with Welford mean and variance. A
+ * block is rejected when its spread exceeds the motion threshold or its mean
+ * is off the median of the recent block means, so a bump or a knock drops a
+ * few tens of milliseconds instead of restarting the calibration. Accepted
+ * block means are merged, again with Welford. The offset is taken once the
+ * spread of the block means is consistent with the noise inside the blocks
+ * (nothing moved or drifted) and the standard error of the mean is small, or
+ * after the classic calibration window at the latest.
+ *
+ * After that the estimator can keep following the offset while the craft is
+ * known to be still, and learns the offset change with gyro temperature. In
+ * flight the offset is extrapolated along that slope.
+ */
+
+#define GYRO_ZERO_MEDIAN_WINDOW     5
+
+typedef struct gyroZeroEstimator_s {
+    // Parameters, raw sensor units
+    uint16_t blockLength;
+    uint16_t windowBlocks;          // Accepted blocks after which the offset is taken regardless of its error
+    float stdDevThreshold;          // Block spread above is motion
+
+    // Block being collected
+    stdev_t block[XYZ_AXIS_COUNT];
+    uint16_t blockSamples;
+    float blockTemperatureSum;
+
+    // Recent block means, accepted or not
+    float recentMean[XYZ_AXIS_COUNT][GYRO_ZERO_MEDIAN_WINDOW];
+    uint8_t recentIndex;
+    uint8_t recentCount;
+
+    // Accepted blocks until converged
+    stdev_t blockMeans[XYZ_AXIS_COUNT];
+    float withinVariance[XYZ_AXIS_COUNT];   // Mean of the block variances
+
+    // Offset and its temperature slope, exponentially weighted moments of (temperature, offset)
+    bool converged;
+    float zero[XYZ_AXIS_COUNT];
+    float temperatureMean;
+    float temperatureVariance;
+    float covariance[XYZ_AXIS_COUNT];
+    uint16_t trackedBlocks;
+
+    uint32_t acceptedCount;
+    uint32_t rejectedCount;
+} gyroZeroEstimator_t;
+
+void gyroZeroEstimatorInit(gyroZeroEstimator_t *estimator, uint16_t blockLength, uint16_t windowBlocks, float stdDevThreshold);
+bool gyroZeroEstimatorPush(gyroZeroEstimator_t *estimator, const float sample[XYZ_AXIS_COUNT], float temperature);
+bool gyroZeroEstimatorIsConverged(const gyroZeroEstimator_t *estimator);
+void gyroZeroEstimatorGetZero(const gyroZeroEstimator_t *estimator, float temperature, float zero[XYZ_AXIS_COUNT]);
+float gyroZeroEstimatorGetTemperatureSlope(const gyroZeroEstimator_t *estimator, int axis);
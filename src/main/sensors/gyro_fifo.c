@@ -0,0 +1,62 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+
+#include "drivers/accgyro/accgyro.h"
+
+#include "sensors/gyro_fifo.h"
+
+/*
+ * Boxcar average of all samples the sensor produced since the last read.
+ * Its response has nulls at multiples of the output rate, which are the
+ * frequencies that would otherwise fold onto DC when only the newest sample
+ * is used. The gyro anti-aliasing LPF still follows at the output rate.
+ */
+void FAST_CODE gyroFifoDecimate(const float samples[][XYZ_AXIS_COUNT], uint8_t count, float *output)
+{
+    float sum[XYZ_AXIS_COUNT] = { 0.0f, 0.0f, 0.0f };
+
+    for (int i = 0; i < count; i++) {
+        sum[X] += samples[i][X];
+        sum[Y] += samples[i][Y];
+        sum[Z] += samples[i][Z];
+    }
+
+    const float scale = 1.0f / count;
+    output[X] = sum[X] * scale;
+    output[Y] = sum[Y] * scale;
+    output[Z] = sum[Z] * scale;
+}
+
+// Burst reads the sensor FIFO and leaves the decimated sample in gyroADCRaw, false if no new sample was queued
+bool FAST_CODE gyroFifoRead(gyroDev_t *gyroDev)
+{
+    gyroDev->gyroFifoCount = 0;
+
+    if (!gyroDev->readFifoFn(gyroDev) || gyroDev->gyroFifoCount == 0) {
+        return false;
+    }
+
+    gyroFifoDecimate(gyroDev->gyroFifo, gyroDev->gyroFifoCount, gyroDev->gyroADCRaw);
+    return true;
+}
@@ -56,6 +56,7 @@
 #include "sensors/gyro.h"
 #include "sensors/sensors.h"
 #include "sensors/opflow.h"
+#include "sensors/opflow_gyro.h"
 
 #include "scheduler/scheduler.h"
 
@@ -70,6 +71,7 @@ static bool opflowIsCalibrating = false;
 static timeMs_t opflowCalibrationStartedAt;
 static float opflowCalibrationBodyAcc;
 static float opflowCalibrationFlowAcc;
+static opflowGyroHistory_t opflowGyroHistory;
 
 #define OPFLOW_SQUAL_THRESHOLD_HIGH     35      // TBD
 #define OPFLOW_SQUAL_THRESHOLD_LOW      10      // TBD
@@ -129,13 +131,6 @@ static bool opflowDetect(opflowDev_t * dev, uint8_t opflowHardwareToUse)
     return true;
 }
 
-static void opflowZeroBodyGyroAcc(void)
-{
-    opflow.gyroBodyRateTimeUs = 0;
-    opflow.gyroBodyRateAcc[X] = 0;
-    opflow.gyroBodyRateAcc[Y] = 0;
-}
-
 bool opflowInit(void)
 {
     if (!opflowDetect(&opflow.dev, opticalFlowConfig()->opflow_hardware)) {
@@ -147,7 +142,7 @@ bool opflowInit(void)
         return false;
     }
 
-    opflowZeroBodyGyroAcc();
+    opflowGyroHistoryReset(&opflowGyroHistory);
 
     return true;
 }
@@ -171,7 +166,7 @@ void opflowUpdate(timeUs_t currentTimeUs)
     if (opflow.dev.updateFn(&opflow.dev)) {
         // Indicate valid update
         opflow.isHwHealty = true;
-        opflow.updateDt = US2S(currentTimeUs - opflow.lastValidUpdate);
+        opflow.updateDt = US2S(opflow.dev.rawData.deltaTime);
         opflow.lastValidUpdate = currentTimeUs;
         opflow.rawQuality = opflow.dev.rawData.quality;
 
@@ -197,10 +192,13 @@ void opflowUpdate(timeUs_t currentTimeUs)
         opflow.bodyRate[Y] = 0;
 
         // In the following code we operate deg/s and do conversion to rad/s in the last step
-        // Calculate body rates
-        if (opflow.gyroBodyRateTimeUs > 0) {
-            opflow.bodyRate[X] = opflow.gyroBodyRateAcc[X] / opflow.gyroBodyRateTimeUs;
-            opflow.bodyRate[Y] = opflow.gyroBodyRateAcc[Y] / opflow.gyroBodyRateTimeUs;
+        // Calculate body rates over the same window the sensor integrated the flow over
+        const timeUs_t flowEndUs = opflow.dev.rawData.timestamp ? opflow.dev.rawData.timestamp : currentTimeUs;
+        float bodyRotation[2];
+        const timeDelta_t gyroTimeUs = opflowGyroHistoryIntegrate(&opflowGyroHistory, flowEndUs - opflow.dev.rawData.deltaTime, flowEndUs, bodyRotation);
+        if (gyroTimeUs > 0) {
+            opflow.bodyRate[X] = bodyRotation[X] / US2S(gyroTimeUs);
+            opflow.bodyRate[Y] = bodyRotation[Y] / US2S(gyroTimeUs);
         }
 
         // If quality of the flow from the sensor is good - process further
@@ -248,9 +246,6 @@ void opflowUpdate(timeUs_t currentTimeUs)
         opflow.bodyRate[Y] = DEGREES_TO_RADIANS(opflow.bodyRate[Y]);
         opflow.flowRate[X] = DEGREES_TO_RADIANS(opflow.flowRate[X]);
         opflow.flowRate[Y] = DEGREES_TO_RADIANS(opflow.flowRate[Y]);
-
-        // Zero out gyro accumulators to calculate rotation per flow update
-        opflowZeroBodyGyroAcc();
     }
     else {
         // No new data available
@@ -265,22 +260,18 @@ void opflowUpdate(timeUs_t currentTimeUs)
             opflow.bodyRate[X] = 0;
             opflow.bodyRate[Y] = 0;
 
-            opflowZeroBodyGyroAcc();
+            opflowGyroHistoryReset(&opflowGyroHistory);
         }
     }
 }
 
-/* Run a simple gyro update integrator to estimate average body rate between two optical flow updates */
-void opflowGyroUpdateCallback(timeUs_t gyroUpdateDeltaUs)
+/* Keep a timestamped gyro history to match the body rotation to the flow integration window */
+void opflowGyroUpdateCallback(timeUs_t currentTimeUs, timeUs_t gyroUpdateDeltaUs)
 {
     if (!opflow.isHwHealty)
         return;
 
-    for (int axis = 0; axis < 2; axis++) {
-        opflow.gyroBodyRateAcc[axis] += gyro.gyroADCf[axis] * gyroUpdateDeltaUs;
-    }
-
-    opflow.gyroBodyRateTimeUs += gyroUpdateDeltaUs;
+    opflowGyroHistoryPush(&opflowGyroHistory, currentTimeUs, gyroUpdateDeltaUs, gyro.gyroADCf);
 }
 
 bool opflowIsHealthy(void)
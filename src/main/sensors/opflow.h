@@ -53,20 +53,17 @@ typedef struct opflow_s {
 
     opflowQuality_e flowQuality;
     timeUs_t        lastValidUpdate;
-    float           updateDt;
+    float           updateDt;       // Integration timeframe of the last sample (s)
     bool            isHwHealty;
     float           flowRate[2];    // optical flow angular rate in rad/sec measured about the X and Y body axis
     float           bodyRate[2];    // body inertial angular rate in rad/sec measured about the X and Y body axis
 
-    float           gyroBodyRateAcc[2];
-    timeUs_t        gyroBodyRateTimeUs;
-
     uint8_t         rawQuality;
 } opflow_t;
 
 extern opflow_t opflow;
 
-void opflowGyroUpdateCallback(timeUs_t gyroUpdateDeltaUs);
+void opflowGyroUpdateCallback(timeUs_t currentTimeUs, timeUs_t gyroUpdateDeltaUs);
 bool opflowInit(void);
 void opflowUpdate(timeUs_t currentTimeUs);
 bool opflowIsHealthy(void);
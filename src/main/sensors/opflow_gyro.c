@@ -0,0 +1,113 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "sensors/opflow_gyro.h"
+
+void opflowGyroHistoryReset(opflowGyroHistory_t *history)
+{
+    memset(history, 0, sizeof(*history));
+}
+
+/*
+ * Feed one gyro update, rate in deg/s over the deltaUs ending at currentTimeUs
+ */
+void opflowGyroHistoryPush(opflowGyroHistory_t *history, timeUs_t currentTimeUs, timeDelta_t deltaUs, const float rate[2])
+{
+    if (!history->started) {
+        history->started = true;
+        history->startTimeUs = currentTimeUs - deltaUs;
+        history->openStartUs = history->startTimeUs;
+    }
+
+    for (int axis = 0; axis < 2; axis++) {
+        history->openRotation[axis] += rate[axis] * US2S(deltaUs);
+    }
+    history->openEndUs = currentTimeUs;
+
+    if (cmpTimeUs(currentTimeUs, history->openStartUs) < OPFLOW_GYRO_HISTORY_SLOT_US) {
+        return;
+    }
+
+    opflowGyroSlot_t *slot = &history->slot[history->head];
+    if (history->count == OPFLOW_GYRO_HISTORY_SLOTS) {
+        // Overwriting the oldest slot, the next one becomes the oldest
+        history->startTimeUs = slot->endTimeUs;
+    } else {
+        history->count++;
+    }
+
+    slot->endTimeUs = currentTimeUs;
+    slot->rotation[0] = history->openRotation[0];
+    slot->rotation[1] = history->openRotation[1];
+    history->head = (history->head + 1) % OPFLOW_GYRO_HISTORY_SLOTS;
+
+    history->openStartUs = currentTimeUs;
+    history->openRotation[0] = 0;
+    history->openRotation[1] = 0;
+}
+
+// Adds the part of a slot inside the window, assuming a constant rate within the slot
+static timeDelta_t addOverlap(timeUs_t slotStartUs, timeUs_t slotEndUs, const float slotRotation[2], timeUs_t startUs, timeUs_t endUs, float rotation[2])
+{
+    const timeDelta_t slotLength = cmpTimeUs(slotEndUs, slotStartUs);
+    const timeUs_t fromUs = cmpTimeUs(startUs, slotStartUs) > 0 ? startUs : slotStartUs;
+    const timeUs_t toUs = cmpTimeUs(endUs, slotEndUs) < 0 ? endUs : slotEndUs;
+    const timeDelta_t overlap = cmpTimeUs(toUs, fromUs);
+
+    if (slotLength <= 0 || overlap <= 0) {
+        return 0;
+    }
+
+    const float fraction = (float)overlap / slotLength;
+    rotation[0] += slotRotation[0] * fraction;
+    rotation[1] += slotRotation[1] * fraction;
+
+    return overlap;
+}
+
+/*
+ * Rotation in deg between startUs and endUs. Returns the part of the window
+ * covered by the history, the average rate is rotation over that time.
+ */
+timeDelta_t opflowGyroHistoryIntegrate(const opflowGyroHistory_t *history, timeUs_t startUs, timeUs_t endUs, float rotation[2])
+{
+    rotation[0] = 0;
+    rotation[1] = 0;
+
+    if (!history->started) {
+        return 0;
+    }
+
+    timeDelta_t covered = 0;
+    timeUs_t slotStartUs = history->startTimeUs;
+
+    for (int i = 0; i < history->count; i++) {
+        const opflowGyroSlot_t *slot = &history->slot[(history->head + OPFLOW_GYRO_HISTORY_SLOTS - history->count + i) % OPFLOW_GYRO_HISTORY_SLOTS];
+        covered += addOverlap(slotStartUs, slot->endTimeUs, slot->rotation, startUs, endUs, rotation);
+        slotStartUs = slot->endTimeUs;
+    }
+
+    covered += addOverlap(history->openStartUs, history->openEndUs, history->openRotation, startUs, endUs, rotation);
+
+    return covered;
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+/*
+ * Short history of the body rotation about X and Y, kept at gyro rate.
+ *
+ * A flow sample integrates over its own window, reported by the sensor and
+ * usually ending some time before the sample is polled. The gyro rotation
+ * over exactly that window is needed to remove the rotational part of the
+ * flow, so the gyro is accumulated into short slots and the rotation between
+ * any two times within the history is summed from the overlapping slots.
+ */
+
+#define OPFLOW_GYRO_HISTORY_SLOTS       64
+#define OPFLOW_GYRO_HISTORY_SLOT_US     4000    // 256ms of history, longer than any flow window
+
+typedef struct opflowGyroSlot_s {
+    timeUs_t endTimeUs;             // Slot covers (end of the previous slot, endTimeUs]
+    float rotation[2];              // deg
+} opflowGyroSlot_t;
+
+typedef struct opflowGyroHistory_s {
+    opflowGyroSlot_t slot[OPFLOW_GYRO_HISTORY_SLOTS];
+    uint8_t head;                   // Next slot to be written
+    uint8_t count;
+    timeUs_t startTimeUs;           // Start of the oldest slot
+
+    // Slot being collected
+    bool started;
+    timeUs_t openStartUs;
+    timeUs_t openEndUs;
+    float openRotation[2];
+} opflowGyroHistory_t;
+
+void opflowGyroHistoryReset(opflowGyroHistory_t *history);
+void opflowGyroHistoryPush(opflowGyroHistory_t *history, timeUs_t currentTimeUs, timeDelta_t deltaUs, const float rate[2]);
+timeDelta_t opflowGyroHistoryIntegrate(const opflowGyroHistory_t *history, timeUs_t startUs, timeUs_t endUs, float rotation[2]);
@@ -42,6 +42,7 @@ typedef union flightDynamicsTrims_u {
 #define CALIBRATING_BARO_TIME_MS            2000
 #define CALIBRATING_PITOT_TIME_MS           4000
 #define CALIBRATING_GYRO_TIME_MS            2000
+#define CALIBRATING_GYRO_BLOCK_MS           50
 #define CALIBRATING_ACC_TIME_MS             500
 #define CALIBRATING_GYRO_MORON_THRESHOLD    32
 
@@ -0,0 +1,685 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * Blackbox log replay.
+ * Feeds a decoded blackbox log (blackbox_decode CSV) through the fake sensor drivers
+ * and the SIM receiver, so IMU, position estimator and PID controller recompute the flight
+ * with the current firmware and configuration. The clock is fast-forwarded between
+ * scheduler tasks, the log is replayed as fast as the host can run the main loop.
+ * Recomputed state is written as CSV, execution times are reported on exit.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "platform.h"
+
+#include "target.h"
+#include "target/SITL/sim/replay.h"
+#include "target/SITL/sim/simHelper.h"
+#include "fc/runtime_config.h"
+#include "drivers/time.h"
+#include "drivers/accgyro/accgyro_fake.h"
+#include "drivers/barometer/barometer_fake.h"
+#include "drivers/pitotmeter/pitotmeter_fake.h"
+#include "drivers/compass/compass_fake.h"
+#include "sensors/sensors.h"
+#include "sensors/gyro.h"
+#include "sensors/acceleration.h"
+#include "sensors/barometer.h"
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/utils.h"
+#include "build/debug.h"
+#include "flight/imu.h"
+#include "flight/mixer.h"
+#include "flight/pid.h"
+#include "navigation/navigation.h"
+#include "scheduler/scheduler.h"
+#include "io/gps.h"
+#include "rx/rx.h"
+#include "rx/sim.h"
+
+#define REPLAY_MAX_COLUMNS          256
+#define REPLAY_MAX_LINE_LENGTH      4096
+#define REPLAY_COLUMN_NAME_LENGTH   32
+#define REPLAY_WARMUP_TIMEOUT_US    (10 * 1000000)
+#define REPLAY_DEFAULT_ACC_1G       4096.0f
+#define REPLAY_FAKE_ACC_1G          9806.0f    // acc_1G of the fake accelerometer
+#define REPLAY_FAKE_GYRO_SCALE      16.0f      // LSB/dps of the fake gyro
+#define REPLAY_BARO_TEMPERATURE     2100       // centidegrees
+
+typedef struct {
+    char name[REPLAY_COLUMN_NAME_LENGTH];
+    char unit[REPLAY_COLUMN_NAME_LENGTH];
+} replayColumn_t;
+
+typedef struct {
+    FILE *file;
+    int columnCount;
+    replayColumn_t columns[REPLAY_MAX_COLUMNS];
+    double values[REPLAY_MAX_COLUMNS];
+    int timeColumn;
+    bool hasRow;
+    int64_t rowTimeUs;
+} replayCsv_t;
+
+typedef enum {
+    REPLAY_STATE_WARMUP = 0,
+    REPLAY_STATE_RUNNING,
+} replayState_e;
+
+typedef struct {
+    uint32_t count;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t startNs;
+} replayProfile_t;
+
+static const char * const replayProfileNames[REPLAY_PROFILE_COUNT] = {
+    "gyro filter",
+    "imu",
+    "pos estimator",
+    "pid",
+};
+
+static bool isActive = false;
+static replayState_e state;
+static replayCsv_t logCsv;
+static replayCsv_t gpsCsv;
+static FILE *outFile;
+static bool outFileIsStdout;
+
+static int gyroColumn[XYZ_AXIS_COUNT];
+static int accColumn[XYZ_AXIS_COUNT];
+static int magColumn[XYZ_AXIS_COUNT];
+static int rcColumn[4];
+static int baroColumn;
+static int airspeedColumn;
+static float accScale;
+
+static int gpsFixTypeColumn;
+static int gpsNumSatColumn;
+static int gpsCoordColumn[2];
+static int gpsAltitudeColumn;
+static int gpsSpeedColumn;
+static int gpsCourseColumn;
+static int gpsVelNedColumn[XYZ_AXIS_COUNT];
+
+static uint16_t rcChannels[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+static bool armingRequested;
+static timeUs_t warmupStartUs;
+static timeUs_t replayStartUs;
+static int64_t logStartUs;
+static int64_t lastAppliedTimeUs;
+static uint32_t framesReplayed;
+static uint64_t wallStartNs;
+
+static replayProfile_t profile[REPLAY_PROFILE_COUNT];
+static replayProfile_t taskProfile[TASK_COUNT];
+static uint64_t taskStartNs;
+
+static uint64_t nanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void simReplayProfileBegin(replayProfileSection_e section)
+{
+    if (isActive) {
+        profile[section].startNs = nanos();
+    }
+}
+
+static void replayProfileAdd(replayProfile_t *entry, uint64_t startNs)
+{
+    const uint64_t elapsedNs = nanos() - startNs;
+    entry->count++;
+    entry->totalNs += elapsedNs;
+    entry->maxNs = MAX(entry->maxNs, elapsedNs);
+}
+
+void simReplayProfileEnd(replayProfileSection_e section)
+{
+    if (isActive) {
+        replayProfileAdd(&profile[section], profile[section].startNs);
+    }
+}
+
+// Simulated time stands still while a task runs, so the scheduler's own execution times are all zero
+void simReplayProfileTaskBegin(void)
+{
+    if (isActive) {
+        taskStartNs = nanos();
+    }
+}
+
+void simReplayProfileTaskEnd(int taskId)
+{
+    if (isActive) {
+        replayProfileAdd(&taskProfile[taskId], taskStartNs);
+    }
+}
+
+/*
+ * blackbox_decode column names may carry a unit suffix, f.e. "time (us)" or "GPS_speed (m/s)".
+ * The name and the unit are stored separately, so columns can be looked up by field name.
+ */
+static void replayParseHeader(replayCsv_t *csv, char *line)
+{
+    csv->columnCount = 0;
+
+    for (char *saveptr, *token = strtok_r(line, ",\r\n", &saveptr); token && csv->columnCount < REPLAY_MAX_COLUMNS; token = strtok_r(NULL, ",\r\n", &saveptr)) {
+        replayColumn_t *column = &csv->columns[csv->columnCount++];
+
+        while (*token == ' ') {
+            token++;
+        }
+
+        char *unit = strchr(token, '(');
+        if (unit) {
+            *unit++ = '\0';
+            char *unitEnd = strchr(unit, ')');
+            if (unitEnd) {
+                *unitEnd = '\0';
+            }
+            strncpy(column->unit, unit, REPLAY_COLUMN_NAME_LENGTH - 1);
+        }
+
+        char *nameEnd = token + strlen(token);
+        while (nameEnd > token && nameEnd[-1] == ' ') {
+            *--nameEnd = '\0';
+        }
+        strncpy(column->name, token, REPLAY_COLUMN_NAME_LENGTH - 1);
+    }
+}
+
+static int replayFindColumn(const replayCsv_t *csv, const char *name)
+{
+    for (int i = 0; i < csv->columnCount; i++) {
+        if (strcmp(csv->columns[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void replayFindAxisColumns(const replayCsv_t *csv, const char *name, int *columns, int count)
+{
+    char columnName[REPLAY_COLUMN_NAME_LENGTH];
+
+    for (int i = 0; i < count; i++) {
+        snprintf(columnName, sizeof(columnName), "%s[%d]", name, i);
+        columns[i] = replayFindColumn(csv, columnName);
+    }
+}
+
+static bool replayUnitIs(const replayCsv_t *csv, int column, const char *unit)
+{
+    return column >= 0 && strcmp(csv->columns[column].unit, unit) == 0;
+}
+
+static float replayValue(const replayCsv_t *csv, int column, float defaultValue)
+{
+    return column >= 0 ? (float)csv->values[column] : defaultValue;
+}
+
+static bool replayOpen(replayCsv_t *csv, const char *fileName)
+{
+    char line[REPLAY_MAX_LINE_LENGTH];
+
+    memset(csv, 0, sizeof(replayCsv_t));
+
+    csv->file = fopen(fileName, "r");
+    if (!csv->file) {
+        fprintf(stderr, "[REPLAY] Unable to open %s.\n", fileName);
+        return false;
+    }
+
+    if (!fgets(line, sizeof(line), csv->file)) {
+        fprintf(stderr, "[REPLAY] %s is empty.\n", fileName);
+        return false;
+    }
+
+    replayParseHeader(csv, line);
+
+    csv->timeColumn = replayFindColumn(csv, "time");
+    if (csv->timeColumn < 0) {
+        fprintf(stderr, "[REPLAY] %s has no time column.\n", fileName);
+        return false;
+    }
+
+    return true;
+}
+
+static bool replayReadRow(replayCsv_t *csv)
+{
+    char line[REPLAY_MAX_LINE_LENGTH];
+
+    csv->hasRow = false;
+
+    while (fgets(line, sizeof(line), csv->file)) {
+        const char *p = line;
+        int column = 0;
+
+        // Manual split, strtok would swallow empty fields and shift the columns
+        while (column < csv->columnCount) {
+            char *end;
+            csv->values[column] = strtod(p, &end);
+            if (end == p) {
+                csv->values[column] = 0;
+            }
+            column++;
+
+            p = strchr(end, ',');
+            if (!p) {
+                break;
+            }
+            p++;
+        }
+
+        // Skip truncated or corrupt frames
+        if (column > csv->timeColumn && column >= csv->columnCount / 2) {
+            csv->rowTimeUs = (int64_t)csv->values[csv->timeColumn];
+            csv->hasRow = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void replayParseAux(const char *aux)
+{
+    for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+        rcChannels[i] = PWM_RANGE_MIDDLE;
+    }
+
+    if (!aux) {
+        return;
+    }
+
+    char *end;
+    for (int channel = NON_AUX_CHANNEL_COUNT; channel < MAX_SUPPORTED_RC_CHANNEL_COUNT; channel++) {
+        const long value = strtol(aux, &end, 10);
+        if (end == aux) {
+            break;
+        }
+        rcChannels[channel] = constrain(value, PWM_PULSE_MIN, PWM_PULSE_MAX);
+        if (*end != ',') {
+            break;
+        }
+        aux = end + 1;
+    }
+}
+
+static void replayApplyRc(void)
+{
+    for (int i = 0; i < 4; i++) {
+        if (rcColumn[i] >= 0) {
+            rcChannels[rxConfig()->rcmap[i]] = constrain(logCsv.values[rcColumn[i]], PWM_PULSE_MIN, PWM_PULSE_MAX);
+        }
+    }
+
+    rxSimSetChannelValue(rcChannels, MAX_SUPPORTED_RC_CHANNEL_COUNT);
+}
+
+static void replayApplyBaroAndMag(void)
+{
+    if (baroColumn >= 0) {
+        fakeBaroSet(lrintf(altitudeToPressure((float)logCsv.values[baroColumn])), REPLAY_BARO_TEMPERATURE);
+    }
+
+    if (magColumn[X] >= 0) {
+        fakeMagSet(constrainToInt16(replayValue(&logCsv, magColumn[X], 0)),
+                   constrainToInt16(replayValue(&logCsv, magColumn[Y], 0)),
+                   constrainToInt16(replayValue(&logCsv, magColumn[Z], 0)));
+    }
+}
+
+static void replayApplyLogRow(void)
+{
+    fakeGyroSet(constrainToInt16(replayValue(&logCsv, gyroColumn[X], 0) * REPLAY_FAKE_GYRO_SCALE),
+                constrainToInt16(replayValue(&logCsv, gyroColumn[Y], 0) * REPLAY_FAKE_GYRO_SCALE),
+                constrainToInt16(replayValue(&logCsv, gyroColumn[Z], 0) * REPLAY_FAKE_GYRO_SCALE));
+
+    fakeAccSet(constrainToInt16(replayValue(&logCsv, accColumn[X], 0) * accScale),
+               constrainToInt16(replayValue(&logCsv, accColumn[Y], 0) * accScale),
+               constrainToInt16(replayValue(&logCsv, accColumn[Z], 0) * accScale));
+
+    replayApplyBaroAndMag();
+
+    if (airspeedColumn >= 0) {
+        fakePitotSetAirspeed((float)logCsv.values[airspeedColumn]);
+    }
+
+    replayApplyRc();
+}
+
+static void replayApplyGpsRow(void)
+{
+    // Coordinates are decoded to degrees, unless the decoder was asked for raw values. Keep them in double, float can't hold 1e-7 deg.
+    const double lat = gpsCoordColumn[0] >= 0 ? gpsCsv.values[gpsCoordColumn[0]] : 0;
+    const double lon = gpsCoordColumn[1] >= 0 ? gpsCsv.values[gpsCoordColumn[1]] : 0;
+    const double coordScale = (fabs(lat) <= 90 && fabs(lon) <= 180) ? 1e7 : 1;
+    const float speedScale = replayUnitIs(&gpsCsv, gpsSpeedColumn, "m/s") ? 100 : 1;
+    const float courseScale = replayUnitIs(&gpsCsv, gpsCourseColumn, "deg") ? 10 : 1;
+
+    gpsFakeSet(
+        (gpsFixType_e)replayValue(&gpsCsv, gpsFixTypeColumn, GPS_FIX_3D),
+        (uint8_t)replayValue(&gpsCsv, gpsNumSatColumn, 0),
+        (int32_t)lrint(lat * coordScale),
+        (int32_t)lrint(lon * coordScale),
+        (int32_t)lrintf(replayValue(&gpsCsv, gpsAltitudeColumn, 0) * 100),
+        (int16_t)lrintf(replayValue(&gpsCsv, gpsSpeedColumn, 0) * speedScale),
+        (int16_t)lrintf(replayValue(&gpsCsv, gpsCourseColumn, 0) * courseScale),
+        (int16_t)replayValue(&gpsCsv, gpsVelNedColumn[X], 0),
+        (int16_t)replayValue(&gpsCsv, gpsVelNedColumn[Y], 0),
+        (int16_t)replayValue(&gpsCsv, gpsVelNedColumn[Z], 0),
+        0
+    );
+}
+
+static void replayWriteHeader(void)
+{
+    fprintf(outFile, "time (us),attitude[0],attitude[1],attitude[2]");
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fprintf(outFile, ",navPos[%d]", axis);
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fprintf(outFile, ",navVel[%d]", axis);
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fprintf(outFile, ",axisP[%d],axisI[%d],axisD[%d],axisF[%d]", axis, axis, axis, axis);
+    }
+    for (int i = 0; i < getMotorCount(); i++) {
+        fprintf(outFile, ",motor[%d]", i);
+    }
+    for (int i = 0; i < DEBUG32_VALUE_COUNT; i++) {
+        fprintf(outFile, ",debug[%d]", i);
+    }
+    fprintf(outFile, "\n");
+}
+
+static void replayWriteState(int64_t timeUs)
+{
+    fprintf(outFile, "%lld,%d,%d,%d", (long long)timeUs, attitude.values.roll, attitude.values.pitch, attitude.values.yaw);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fprintf(outFile, ",%ld", lrintf(getEstimatedActualPosition(axis)));
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fprintf(outFile, ",%ld", lrintf(getEstimatedActualVelocity(axis)));
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        fprintf(outFile, ",%d,%d,%d,%d", (int)axisPID_P[axis], (int)axisPID_I[axis], (int)axisPID_D[axis], (int)axisPID_F[axis]);
+    }
+    for (int i = 0; i < getMotorCount(); i++) {
+        fprintf(outFile, ",%d", motor[i]);
+    }
+    for (int i = 0; i < DEBUG32_VALUE_COUNT; i++) {
+        fprintf(outFile, ",%d", (int)debug[i]);
+    }
+    fprintf(outFile, "\n");
+}
+
+static void replayPrintProfile(const char *name, const replayProfile_t *entry)
+{
+    fprintf(stderr, "[REPLAY] %-20s %10u %12llu %12llu %12llu\n", name, (unsigned)entry->count,
+        (unsigned long long)(entry->count ? entry->totalNs / entry->count : 0),
+        (unsigned long long)entry->maxNs, (unsigned long long)(entry->totalNs / 1000000));
+}
+
+static void replayPrintSummary(void)
+{
+    const double wallTimeS = (nanos() - wallStartNs) * 1e-9;
+    const double logTimeS = (lastAppliedTimeUs - logStartUs) * 1e-6;
+
+    fprintf(stderr, "[REPLAY] Replayed %u frames, %.1f s of log in %.2f s (%.1fx realtime)\n",
+        (unsigned)framesReplayed, logTimeS, wallTimeS, wallTimeS > 0 ? logTimeS / wallTimeS : 0);
+
+    fprintf(stderr, "[REPLAY] %-20s %10s %12s %12s %12s\n", "Section", "Calls", "Avg (ns)", "Max (ns)", "Total (ms)");
+    for (int i = 0; i < REPLAY_PROFILE_COUNT; i++) {
+        replayPrintProfile(replayProfileNames[i], &profile[i]);
+    }
+
+    fprintf(stderr, "[REPLAY] %-20s %10s %12s %12s %12s\n", "Task", "Calls", "Avg (ns)", "Max (ns)", "Total (ms)");
+    for (cfTaskId_e taskId = 0; taskId < TASK_COUNT; taskId++) {
+        if (taskProfile[taskId].count) {
+            cfTaskInfo_t taskInfo;
+            getTaskInfo(taskId, &taskInfo);
+            replayPrintProfile(taskInfo.taskName, &taskProfile[taskId]);
+        }
+    }
+}
+
+static void replayFinish(void)
+{
+    replayWriteState(lastAppliedTimeUs);
+    replayPrintSummary();
+    simReplayClose();
+    exit(0);
+}
+
+static void replayProcessWarmup(timeUs_t currentTimeUs)
+{
+    // Keep the aircraft level and still, so gyro calibration finds zero offset (logged gyro is already calibrated)
+    fakeGyroSet(0, 0, 0);
+    fakeAccSet(0, 0, (int16_t)REPLAY_FAKE_ACC_1G);
+    replayApplyBaroAndMag();
+    replayApplyRc();
+
+    // Logged accelerometer is already calibrated
+    ENABLE_STATE(ACCELEROMETER_CALIBRATED);
+
+    const bool calibrationComplete = gyroIsCalibrationComplete() && (!sensors(SENSOR_BARO) || baroIsCalibrationComplete()) && isImuReady();
+    if (!warmupStartUs) {
+        warmupStartUs = currentTimeUs;
+    }
+
+    const bool warmupTimeout = currentTimeUs - warmupStartUs > REPLAY_WARMUP_TIMEOUT_US;
+
+    // Log is recorded while armed, give the arming switch from --replayaux a chance before starting
+    if (!warmupTimeout && !(calibrationComplete && (ARMING_FLAG(ARMED) || !armingRequested))) {
+        return;
+    }
+
+    if (armingRequested && !ARMING_FLAG(ARMED)) {
+        fprintf(stderr, "[REPLAY] Not armed (arming flags 0x%08x), replaying disarmed.\n", (unsigned)armingFlags);
+    }
+
+    state = REPLAY_STATE_RUNNING;
+    replayStartUs = currentTimeUs;
+    logStartUs = logCsv.rowTimeUs;
+    lastAppliedTimeUs = logCsv.rowTimeUs;
+    wallStartNs = nanos();
+    memset(profile, 0, sizeof(profile));
+    memset(taskProfile, 0, sizeof(taskProfile));
+
+    replayWriteHeader();
+}
+
+timeUs_t simReplayLogStartUs(void)
+{
+    return logCsv.hasRow ? (timeUs_t)logCsv.rowTimeUs : 0;
+}
+
+bool simReplayNextSampleAt(timeUs_t *timeUs)
+{
+    if (!isActive || state != REPLAY_STATE_RUNNING || !logCsv.hasRow) {
+        return false;
+    }
+
+    *timeUs = replayStartUs + (timeUs_t)(logCsv.rowTimeUs - logStartUs);
+    return true;
+}
+
+void simReplayProcess(void)
+{
+    if (!isActive) {
+        return;
+    }
+
+    // Sensors are sampled at the firmware rate, let the main loop run the IMU on every iteration
+    unlockMainPID();
+
+    const timeUs_t currentTimeUs = micros();
+
+    if (state == REPLAY_STATE_WARMUP) {
+        replayProcessWarmup(currentTimeUs);
+        return;
+    }
+
+    const int64_t logTimeUs = logStartUs + (int64_t)(currentTimeUs - replayStartUs);
+
+    while (logCsv.hasRow && logCsv.rowTimeUs <= logTimeUs) {
+        // State now reflects the previous frame, emit it before it gets overwritten
+        if (framesReplayed) {
+            replayWriteState(lastAppliedTimeUs);
+        }
+
+        while (gpsCsv.hasRow && gpsCsv.rowTimeUs <= logCsv.rowTimeUs) {
+            replayApplyGpsRow();
+            replayReadRow(&gpsCsv);
+        }
+
+        replayApplyLogRow();
+        lastAppliedTimeUs = logCsv.rowTimeUs;
+        framesReplayed++;
+
+        replayReadRow(&logCsv);
+    }
+
+    if (!logCsv.hasRow) {
+        replayFinish();
+    }
+}
+
+bool simReplayInit(const char *logFile, const char *gpsFile, const char *outFileName, const char *aux, float acc1G)
+{
+    if (!logFile) {
+        fprintf(stderr, "[REPLAY] No log file specified, use --replayfile.\n");
+        return false;
+    }
+
+    if (!replayOpen(&logCsv, logFile) || !replayReadRow(&logCsv)) {
+        fprintf(stderr, "[REPLAY] No frames in %s.\n", logFile);
+        return false;
+    }
+
+    // Prefer unfiltered gyro, if logged. Replaying gyroADC runs it through the gyro filters twice.
+    replayFindAxisColumns(&logCsv, "gyroRaw", gyroColumn, XYZ_AXIS_COUNT);
+    if (gyroColumn[X] < 0) {
+        replayFindAxisColumns(&logCsv, "gyroADC", gyroColumn, XYZ_AXIS_COUNT);
+        fprintf(stderr, "[REPLAY] gyroRaw not logged, using filtered gyroADC.\n");
+    }
+    replayFindAxisColumns(&logCsv, "accSmooth", accColumn, XYZ_AXIS_COUNT);
+    replayFindAxisColumns(&logCsv, "magADC", magColumn, XYZ_AXIS_COUNT);
+    replayFindAxisColumns(&logCsv, "rcData", rcColumn, 4);
+    baroColumn = replayFindColumn(&logCsv, "BaroAlt");
+    airspeedColumn = replayFindColumn(&logCsv, "AirSpeed");
+
+    if (gyroColumn[X] < 0 || accColumn[X] < 0) {
+        fprintf(stderr, "[REPLAY] %s has no gyro or accelerometer data.\n", logFile);
+        return false;
+    }
+
+    if (replayUnitIs(&logCsv, accColumn[X], "g")) {
+        accScale = REPLAY_FAKE_ACC_1G;
+    } else if (replayUnitIs(&logCsv, accColumn[X], "m/s/s")) {
+        accScale = REPLAY_FAKE_ACC_1G / GRAVITY_MSS;
+    } else {
+        accScale = REPLAY_FAKE_ACC_1G / (acc1G > 0 ? acc1G : REPLAY_DEFAULT_ACC_1G);
+    }
+
+    if (gpsFile) {
+        if (!replayOpen(&gpsCsv, gpsFile)) {
+            return false;
+        }
+        gpsFixTypeColumn = replayFindColumn(&gpsCsv, "GPS_fixType");
+        gpsNumSatColumn = replayFindColumn(&gpsCsv, "GPS_numSat");
+        replayFindAxisColumns(&gpsCsv, "GPS_coord", gpsCoordColumn, 2);
+        gpsAltitudeColumn = replayFindColumn(&gpsCsv, "GPS_altitude");
+        gpsSpeedColumn = replayFindColumn(&gpsCsv, "GPS_speed");
+        gpsCourseColumn = replayFindColumn(&gpsCsv, "GPS_ground_course");
+        replayFindAxisColumns(&gpsCsv, "GPS_velned", gpsVelNedColumn, XYZ_AXIS_COUNT);
+        replayReadRow(&gpsCsv);
+    }
+
+    if (outFileName) {
+        outFile = fopen(outFileName, "w");
+        if (!outFile) {
+            fprintf(stderr, "[REPLAY] Unable to create %s.\n", outFileName);
+            return false;
+        }
+    } else {
+        outFile = stdout;
+        outFileIsStdout = true;
+    }
+
+    replayParseAux(aux);
+    armingRequested = aux != NULL;
+    rxSimSetRssi(RSSI_MAX_VALUE);
+
+    state = REPLAY_STATE_WARMUP;
+    warmupStartUs = 0;
+    framesReplayed = 0;
+    isActive = true;
+
+    fprintf(stderr, "[REPLAY] Replaying %s.\n", logFile);
+
+    return true;
+}
+
+void simReplayClose(void)
+{
+    isActive = false;
+
+    if (logCsv.file) {
+        fclose(logCsv.file);
+        logCsv.file = NULL;
+    }
+
+    if (gpsCsv.file) {
+        fclose(gpsCsv.file);
+        gpsCsv.file = NULL;
+    }
+
+    if (outFile) {
+        if (!outFileIsStdout) {
+            fclose(outFile);
+        } else {
+            fflush(outFile);
+        }
+        outFile = NULL;
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+typedef enum {
+    REPLAY_PROFILE_GYRO_FILTER = 0,
+    REPLAY_PROFILE_IMU,
+    REPLAY_PROFILE_POS_ESTIMATOR,
+    REPLAY_PROFILE_PID,
+    REPLAY_PROFILE_COUNT
+} replayProfileSection_e;
+
+bool simReplayInit(const char *logFile, const char *gpsFile, const char *outFile, const char *aux, float acc1G);
+void simReplayProcess(void);
+void simReplayClose(void);
+
+timeUs_t simReplayLogStartUs(void);
+bool simReplayNextSampleAt(timeUs_t *timeUs);
+
+void simReplayProfileBegin(replayProfileSection_e section);
+void simReplayProfileEnd(replayProfileSection_e section);
+void simReplayProfileTaskBegin(void);
+void simReplayProfileTaskEnd(int taskId);
@@ -48,6 +48,7 @@
 #include "common/utils.h"
 #include "scheduler/scheduler.h"
 #include "drivers/system.h"
+#include "drivers/time.h"
 #include "drivers/pwm_mapping.h"
 #include "drivers/timer.h"
 #include "drivers/serial.h"
@@ -56,6 +57,7 @@
 #include "build/version.h"
 
 #include "target/SITL/sim/realFlight.h"
+#include "target/SITL/sim/replay.h"
 #include "target/SITL/sim/xplane.h"
 
 #include "target/SITL/serial_proxy.h"
@@ -75,6 +77,15 @@ static uint8_t mappingCount = 0;
 static bool useImu = false;
 static char *simIp = NULL;
 static int simPort = 0;
+static char *replayFile = NULL;
+static char *replayGpsFile = NULL;
+static char *replayOutFile = NULL;
+static char *replayAux = NULL;
+static float replayAcc1G = 0.0f;
+
+// Replay runs on simulated time, the clock only moves when the scheduler or a delay skips ahead
+static bool fastForward = false;
+static timeUs_t simulatedTimeUs = 0;
 
 static char **c_argv;
 
@@ -87,6 +98,8 @@ static void cleanupAndExit(int code, bool shouldExit) {
         simXPlaneClose();
     } else if (sitlSim == SITL_SIM_REALFLIGHT) {
         simRealFlightClose();
+    } else if (sitlSim == SITL_SIM_REPLAY) {
+        simReplayClose();
     }
     pthread_mutex_destroy(&mainLoopLock);
 
@@ -156,6 +169,15 @@ void systemInit(void) {
                 fprintf(stderr, "[SIM] Connection with X-PLane NOT established.\n");
             }
             break;
+        case SITL_SIM_REPLAY:
+            if (!simReplayInit(replayFile, replayGpsFile, replayOutFile, replayAux, replayAcc1G)) {
+                fprintf(stderr, "[SIM] Unable to start replay.\n");
+                cleanupAndExit(1, true);
+            }
+            // From here on time only depends on the log, not on how fast the host runs
+            simulatedTimeUs = MAX(micros(), simReplayLogStartUs());
+            fastForward = true;
+            break;
         default:
           fprintf(stderr, "[SIM] No interface specified. Configurator only.\n");
           break;
@@ -226,10 +248,15 @@ void printCmdLineOptions(void)
     printVersion();
     fprintf(stderr, "Avaiable options:\n");
     fprintf(stderr, "--path=[path]                  Path and filename of eeprom.bin. If not specified 'eeprom.bin' in program directory is used.\n");
-    fprintf(stderr, "--sim=[rf|xp]                  Simulator interface: rf = RealFligt, xp = XPlane. Example: --sim=rf\n");
+    fprintf(stderr, "--sim=[rf|xp|replay]           Simulator interface: rf = RealFligt, xp = XPlane, replay = decoded blackbox log. Example: --sim=rf\n");
     fprintf(stderr, "--simip=[ip]                   IP-Address oft the simulator host. If not specified localhost (127.0.0.1) is used.\n");
     fprintf(stderr, "--simport=[port]               Port oft the simulator host.\n");
     fprintf(stderr, "--useimu                       Use IMU sensor data from the simulator instead of using attitude data from the simulator directly (experimental, not recommended).\n");
+    fprintf(stderr, "--replayfile=[file]            Decoded blackbox log (CSV) to replay with --sim=replay.\n");
+    fprintf(stderr, "--replaygps=[file]             Decoded blackbox GPS log (CSV) to replay along with --replayfile.\n");
+    fprintf(stderr, "--replayout=[file]             Output file for the recomputed state (CSV). If not specified stdout is used.\n");
+    fprintf(stderr, "--replayaux=[values]           Constant values of AUX channels during replay, f.e. 1800,1000,1500 for AUX1-AUX3.\n");
+    fprintf(stderr, "--replayacc1g=[value]          acc_1G of the logged accelerometer, if acceleration is logged in raw units (default: 4096).\n");
     fprintf(stderr, "--serialuart=[uart]            UART number on which serial receiver is configured in SITL, f.e. 3 for UART3\n");
     fprintf(stderr, "--serialport=[serialport]      Host's serial port to which serial receiver/proxy FC is connected, f.e. COM3, /dev/ttyACM3\n");
     fprintf(stderr, "--baudrate=[baudrate]          Serial receiver baudrate (default: 115200).\n");
@@ -268,6 +295,11 @@ void parseArguments(int argc, char *argv[])
             {"parity", required_argument, 0, '4'},
             {"fcproxy", no_argument, 0, '5'},
             {"tcpbaseport", required_argument, 0, '6'},
+            {"replayfile", required_argument, 0, '7'},
+            {"replaygps", required_argument, 0, '8'},
+            {"replayout", required_argument, 0, '9'},
+            {"replayaux", required_argument, 0, 'a'},
+            {"replayacc1g", required_argument, 0, 'g'},
             {NULL, 0, NULL, 0}
         };
 
@@ -281,6 +313,8 @@ void parseArguments(int argc, char *argv[])
                     sitlSim = SITL_SIM_REALFLIGHT;
                 } else if (strcmp(optarg, "xp") == 0){
                     sitlSim = SITL_SIM_XPLANE;
+                } else if (strcmp(optarg, "replay") == 0){
+                    sitlSim = SITL_SIM_REPLAY;
                 } else {
                     fprintf(stderr, "[SIM] Unsupported simulator %s.\n", optarg);
                 }
@@ -363,6 +397,25 @@ void parseArguments(int argc, char *argv[])
                 tcpBasePort = (uint16_t)basePort;
                 break;
             }
+            case '7':
+                replayFile = optarg;
+                break;
+            case '8':
+                replayGpsFile = optarg;
+                break;
+            case '9':
+                replayOutFile = optarg;
+                break;
+            case 'a':
+                replayAux = optarg;
+                break;
+            case 'g':
+                replayAcc1G = atof(optarg);
+                if (replayAcc1G <= 0) {
+                    fprintf(stderr, "[replayacc1g] Invalid argument\n.");
+                    exit(0);
+                }
+                break;
 
             default:
                 printCmdLineOptions();
@@ -386,8 +439,22 @@ void unlockMainPID(void)
     pthread_mutex_unlock(&mainLoopLock);
 }
 
+bool sitlIsFastForward(void)
+{
+    return fastForward;
+}
+
+void sitlFastForward(uint32_t us)
+{
+    simulatedTimeUs += us;
+}
+
 // Replacements for system functions
 timeUs_t micros(void) {
+    if (fastForward) {
+        return simulatedTimeUs;
+    }
+
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
 
@@ -399,13 +466,28 @@ uint64_t microsISR(void)
     return micros();
 }
 
+// Host has no cycle counter, ticks are nanoseconds
+uint32_t usTicks = 1000;
+
+uint32_t ticks(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)(now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
 uint32_t millis(void) {
     return (uint32_t)(micros() / 1000);
 }
 
 void delayMicroseconds(timeUs_t us)
 {
-    usleep(us);
+    if (fastForward) {
+        sitlFastForward(us);
+    } else {
+        usleep(us);
+    }
 }
 
 void delay(timeMs_t ms)
@@ -81,6 +81,11 @@
 #define USE_GEOZONE
 #define MAX_GEOZONES_IN_CONFIG 63
 #define MAX_VERTICES_IN_CONFIG 126
+#define USE_POS_ESTIMATOR_EKF
+#define USE_BENCHMARK
+#define USE_SYSID
+#define USE_MAG_ONLINE_CALIBRATION
+#define USE_TERRAIN_GRID
 
 #undef USE_GYRO_KALMAN // Strange behaviour under x86/x64 ?!?
 #undef USE_VCP
@@ -193,6 +198,7 @@ typedef enum
     SITL_SIM_NONE,
     SITL_SIM_REALFLIGHT,
     SITL_SIM_XPLANE,
+    SITL_SIM_REPLAY,
 } SitlSim_e;
 
 
@@ -200,6 +206,8 @@ typedef enum
 extern bool lockMainPID(void);
 extern void unlockMainPID(void);
 extern void parseArguments(int argc, char *argv[]);
+extern bool sitlIsFastForward(void);
+extern void sitlFastForward(uint32_t us);
 extern char *strnstr(const char *s, const char *find, size_t slen);
 extern int lookupAddress (char *, int, int, struct sockaddr *, socklen_t*);
 
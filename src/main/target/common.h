@@ -159,7 +159,12 @@
 #define USE_MSP_RC_OVERRIDE
 #define USE_SERIALRX_CRSF
 #define USE_SERIAL_PASSTHROUGH
+#if defined(STM32F7) || defined(STM32H7) || defined(AT32F43x) || defined(SITL_BUILD)
+#define NAV_MAX_WAYPOINTS       600
+#define NAV_WP_STORAGE_SIZE     2400    // packed mission storage, survey waypoints take 3-5 bytes
+#else
 #define NAV_MAX_WAYPOINTS       120
+#endif
 #define USE_RCDEVICE
 #define USE_MULTI_MISSION
 #define USE_MULTI_FUNCTIONS  // defines functions only, warnings always defined
@@ -212,6 +217,14 @@
 #define USE_34CHANNELS
 #define MAX_MIXER_PROFILE_COUNT 2
 #define USE_SMARTPORT_MASTER
+#define USE_POS_ESTIMATOR_EKF
+#define USE_BENCHMARK
+#if defined(STM32F7) || defined(STM32H7)
+// capture buffer needs ~21KB of RAM, too much for F4
+#define USE_SYSID
+#endif
+#define USE_MAG_ONLINE_CALIBRATION
+#define USE_TERRAIN_GRID
 #ifdef USE_GPS
 #define USE_GEOZONE
 #define MAX_GEOZONES_IN_CONFIG 63
@@ -135,6 +135,11 @@ extern uint8_t __config_end;
     #define USE_RPM_FILTER
 #endif
 
+// Bidirectional DShot is opt-in per target, the reply capture exists for the F4 per channel timer DMA only
+#if defined(USE_DSHOT_TELEMETRY) && (!defined(USE_DSHOT) || !defined(STM32F4) || defined(USE_DSHOT_DMAR))
+    #undef USE_DSHOT_TELEMETRY
+#endif
+
 #ifndef BEEPER_PWM_FREQUENCY
 #define BEEPER_PWM_FREQUENCY    2500
 #endif
@@ -1092,7 +1092,7 @@ static bool handleIncoming_MISSION_ITEM(void)
                 wp.p1 = 0;
                 wp.p2 = 0;
                 wp.p3 = 0;
-                setWaypoint(255, &wp);
+                setWaypoint(NAV_WP_NUMBER_GCS_POSITION, &wp);
 
                 mavlink_msg_mission_ack_pack(mavSystemId, mavComponentId, &mavSendMsg,
                     mavRecvMsg.sysid, mavRecvMsg.compid,
@@ -1250,7 +1250,7 @@ static bool handleIncoming_COMMAND_INT(void)
                 wp.p3 = 0;
                 wp.flag = 0;
 
-                setWaypoint(255, &wp);
+                setWaypoint(NAV_WP_NUMBER_GCS_POSITION, &wp);
 
                 mavlink_msg_command_ack_pack(mavSystemId, mavComponentId, &mavSendMsg,
                                             msg.command,
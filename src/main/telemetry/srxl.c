@@ -64,7 +64,7 @@
 #include "telemetry/srxl.h"
 
 #include "drivers/vtx_common.h"
-//#include "drivers/dshot.h"
+#include "drivers/dshot_telemetry.h"
 
 #include "io/vtx_tramp.h"
 #include "io/vtx_smartaudio.h"
@@ -196,7 +196,7 @@ uint16_t getMotorAveragePeriod(void)
 #endif
 
 #if defined(USE_DSHOT_TELEMETRY)
-    if (useDshotTelemetry) {
+    if (dshotTelemetryIsActive()) {
         uint16_t motors = getMotorCount();
 
         if (motors > 0) {
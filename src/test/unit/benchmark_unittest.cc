@@ -0,0 +1,102 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <math.h>
+
+extern "C" {
+    #include "common/benchmark.h"
+    #include "common/maths.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_CALLS 100000
+
+// Host clock, ticks are nanoseconds
+static uint32_t hostClock(void)
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float maxErrorFor(const char *name)
+{
+    if (!strncmp(name, "sin", 3) || !strncmp(name, "cos", 3)) {
+        return 1e-5f;
+    } else if (!strncmp(name, "atan2", 5)) {
+        return 2e-5f;
+    } else if (!strncmp(name, "acos", 4)) {
+        return 1e-4f;
+    } else if (!strncmp(name, "quickMedianFilter", 17)) {
+        return 0.0f;
+    } else if (strstr(name, "sqrt")) {
+        return 1e-5f;
+    } else if (!strncmp(name, "matrix", 6)) {
+        return 1e-4f;
+    }
+
+    // Filters run on +-1000 input, single precision rounding only
+    return 1e-3f;
+}
+
+TEST(BenchmarkUnittest, AllKernelsWithinErrorBound)
+{
+    ASSERT_GT(benchmarkCount(), 0);
+
+    printf("%-24s %12s %12s\n", "Kernel", "ns/call", "max error");
+    for (uint8_t i = 0; i < benchmarkCount(); i++) {
+        benchmarkResult_t result;
+        ASSERT_TRUE(benchmarkRun(i, hostClock, BENCHMARK_CALLS, &result));
+        printf("%-24s %12.2f %12.3g\n", result.name, result.ticksPerCall, result.maxError);
+
+        EXPECT_LE(result.maxError, maxErrorFor(result.name)) << result.name;
+        EXPECT_GE(result.ticksPerCall, 0.0f) << result.name;
+    }
+}
+
+TEST(BenchmarkUnittest, OutOfRangeIndex)
+{
+    benchmarkResult_t result;
+    EXPECT_FALSE(benchmarkRun(benchmarkCount(), hostClock, BENCHMARK_CALLS, &result));
+    EXPECT_FALSE(benchmarkRun(0, hostClock, 0, &result));
+}
+
+TEST(BenchmarkUnittest, SinVariantsAgree)
+{
+    for (float x = -2 * M_PIf; x <= 2 * M_PIf; x += 0.001f) {
+        EXPECT_NEAR(sin_approx_lut(x), sin_approx_poly(x), 1e-5f);
+        EXPECT_NEAR(cos_approx(x), cosf(x), 1e-5f);
+    }
+}
+
+TEST(BenchmarkUnittest, Atan2VariantsQuadrants)
+{
+    for (float angle = -M_PIf + 0.001f; angle < M_PIf; angle += 0.01f) {
+        const float y = sinf(angle) * 10.0f;
+        const float x = cosf(angle) * 10.0f;
+        EXPECT_NEAR(atan2_approx_rational(y, x), angle, 2e-5f);
+        EXPECT_NEAR(atan2_approx_minimax(y, x), angle, 2e-5f);
+    }
+
+    EXPECT_FLOAT_EQ(atan2_approx_minimax(0.0f, 0.0f), 0.0f);
+}
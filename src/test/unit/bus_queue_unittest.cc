@@ -0,0 +1,217 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/bus.h"
+    #include "drivers/bus_queue.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Mock backend: records the order jobs reach the bus, completes them on demand or immediately
+static std::vector<busJob_t *> started;
+static bool completeImmediately;
+static bool transferResult;
+static std::vector<busJob_t *> completed;
+
+static void mockStart(busQueue_t * queue, busJob_t * job)
+{
+    started.push_back(job);
+    EXPECT_EQ(BUS_JOB_RUNNING, job->state);
+
+    if (completeImmediately) {
+        busQueueJobComplete(queue, transferResult);
+    }
+}
+
+static void recordCompletion(busJob_t * job)
+{
+    completed.push_back(job);
+}
+
+static busTransferDescriptor_t segment;
+static busQueue_t queue;
+
+static void resetMock(bool immediate)
+{
+    started.clear();
+    completed.clear();
+    completeImmediately = immediate;
+    transferResult = true;
+    busQueueInit(&queue, mockStart);
+}
+
+static void initJob(busJob_t * job, busJobPriority_e priority)
+{
+    memset(job, 0, sizeof(*job));
+    job->segments = &segment;
+    job->segmentCount = 1;
+    job->priority = priority;
+    job->callback = recordCompletion;
+}
+
+TEST(BusQueueTest, IdleBusStartsJobAtOnce)
+{
+    busJob_t job;
+    resetMock(false);
+    initJob(&job, BUS_JOB_PRIORITY_SENSOR);
+
+    EXPECT_TRUE(busQueueIsIdle(&queue));
+    EXPECT_TRUE(busQueueSubmit(&queue, &job));
+    ASSERT_EQ(1u, started.size());
+    EXPECT_TRUE(busJobIsPending(&job));
+    EXPECT_FALSE(busQueueIsIdle(&queue));
+
+    // Same job can not be queued twice
+    EXPECT_FALSE(busQueueSubmit(&queue, &job));
+
+    busQueueJobComplete(&queue, true);
+    EXPECT_EQ(BUS_JOB_DONE, job.state);
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_TRUE(busQueueIsIdle(&queue));
+    EXPECT_EQ(1u, queue.completedCount);
+}
+
+TEST(BusQueueTest, GyroJobGoesBeforeQueuedBulkJobs)
+{
+    busJob_t bulk[3];
+    busJob_t sensor;
+    busJob_t gyro;
+    resetMock(false);
+
+    for (int i = 0; i < 3; i++) {
+        initJob(&bulk[i], BUS_JOB_PRIORITY_BULK);
+        EXPECT_TRUE(busQueueSubmit(&queue, &bulk[i]));
+    }
+    initJob(&sensor, BUS_JOB_PRIORITY_SENSOR);
+    initJob(&gyro, BUS_JOB_PRIORITY_GYRO);
+    EXPECT_TRUE(busQueueSubmit(&queue, &sensor));
+    EXPECT_TRUE(busQueueSubmit(&queue, &gyro));
+
+    // First bulk job was already on the bus and finishes, then gyro, sensor and the remaining bulk jobs in order
+    for (int i = 0; i < 5; i++) {
+        busQueueJobComplete(&queue, true);
+    }
+
+    const std::vector<busJob_t *> expected = { &bulk[0], &gyro, &sensor, &bulk[1], &bulk[2] };
+    EXPECT_EQ(expected, started);
+    EXPECT_EQ(expected, completed);
+    EXPECT_TRUE(busQueueIsIdle(&queue));
+}
+
+static busJob_t chainedJob;
+static int chainedRuns;
+
+static void resubmit(busJob_t * job)
+{
+    completed.push_back(job);
+    if (++chainedRuns < 4) {
+        EXPECT_TRUE(busQueueSubmit(&queue, job));
+    }
+}
+
+TEST(BusQueueTest, SynchronousBackendDoesNotRecurse)
+{
+    busJob_t jobs[4];
+    resetMock(true);
+
+    // Jobs completing inside the start call and resubmitting from the callback are all run in order
+    initJob(&chainedJob, BUS_JOB_PRIORITY_SENSOR);
+    chainedJob.callback = resubmit;
+    chainedRuns = 0;
+    EXPECT_TRUE(busQueueSubmit(&queue, &chainedJob));
+    EXPECT_EQ(4, chainedRuns);
+
+    for (int i = 0; i < 4; i++) {
+        initJob(&jobs[i], BUS_JOB_PRIORITY_BULK);
+        EXPECT_TRUE(busQueueSubmit(&queue, &jobs[i]));
+        EXPECT_EQ(BUS_JOB_DONE, jobs[i].state);
+    }
+
+    EXPECT_EQ(8u, started.size());
+    EXPECT_EQ(8u, queue.completedCount);
+    EXPECT_TRUE(busQueueIsIdle(&queue));
+}
+
+TEST(BusQueueTest, FailedJobDoesNotStallQueue)
+{
+    busJob_t first;
+    busJob_t second;
+    resetMock(false);
+
+    initJob(&first, BUS_JOB_PRIORITY_SENSOR);
+    initJob(&second, BUS_JOB_PRIORITY_SENSOR);
+    EXPECT_TRUE(busQueueSubmit(&queue, &first));
+    EXPECT_TRUE(busQueueSubmit(&queue, &second));
+
+    busQueueJobComplete(&queue, false);
+    EXPECT_EQ(BUS_JOB_FAILED, first.state);
+    EXPECT_EQ(BUS_JOB_RUNNING, second.state);
+
+    busQueueJobComplete(&queue, true);
+    EXPECT_EQ(BUS_JOB_DONE, second.state);
+    EXPECT_EQ(1u, queue.failedCount);
+    EXPECT_EQ(1u, queue.completedCount);
+
+    // Spurious completion with nothing on the bus is ignored
+    busQueueJobComplete(&queue, true);
+    EXPECT_EQ(1u, queue.completedCount);
+}
+
+TEST(BusQueueTest, RejectsInvalidJobs)
+{
+    busJob_t job;
+    resetMock(false);
+
+    initJob(&job, BUS_JOB_PRIORITY_COUNT);
+    EXPECT_FALSE(busQueueSubmit(&queue, &job));
+
+    initJob(&job, BUS_JOB_PRIORITY_GYRO);
+    job.segmentCount = 0;
+    EXPECT_FALSE(busQueueSubmit(&queue, &job));
+    EXPECT_TRUE(started.empty());
+}
+
+// A driver owning a single static job (OSD screen update) waits for it to leave the bus before reusing it
+TEST(BusQueueTest, PendingJobIsNotSubmittedTwice)
+{
+    busJob_t job;
+    resetMock(false);
+    initJob(&job, BUS_JOB_PRIORITY_BULK);
+    job.callback = NULL;
+
+    EXPECT_TRUE(busQueueSubmit(&queue, &job));
+    EXPECT_TRUE(busJobIsPending(&job));
+    EXPECT_FALSE(busQueueSubmit(&queue, &job));
+    EXPECT_EQ(1u, started.size());
+
+    busQueueJobComplete(&queue, true);
+    EXPECT_FALSE(busJobIsPending(&job));
+    EXPECT_TRUE(busQueueIsIdle(&queue));
+
+    EXPECT_TRUE(busQueueSubmit(&queue, &job));
+    EXPECT_EQ(2u, started.size());
+}
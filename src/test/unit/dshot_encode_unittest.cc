@@ -0,0 +1,165 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/dshot_encode.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_FRAMES 100000
+
+// pwm_output.c packet and DMA buffer encoding before the nibble table
+
+static uint16_t prepareDshotPacket(const uint16_t value, bool requestTelemetry)
+{
+    uint16_t packet = (value << 1) | (requestTelemetry ? 1 : 0);
+
+    // compute checksum
+    int csum = 0;
+    int csum_data = packet;
+    for (int i = 0; i < 3; i++) {
+        csum ^=  csum_data;   // xor data by nibbles
+        csum_data >>= 4;
+    }
+    csum &= 0xf;
+
+    // append checksum
+    packet = (packet << 4) | csum;
+
+    return packet;
+}
+
+static void loadDmaBufferDshotStride(timerDMASafeType_t *dmaBuffer, int stride, uint16_t packet)
+{
+    int i;
+    for (i = 0; i < 16; i++) {
+        dmaBuffer[i * stride] = (packet & 0x8000) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0;  // MSB first
+        packet <<= 1;
+    }
+    dmaBuffer[i++ * stride] = 0;
+    dmaBuffer[i++ * stride] = 0;
+}
+
+static void loadDmaBufferDshot(timerDMASafeType_t *dmaBuffer, uint16_t packet)
+{
+    for (int i = 0; i < 16; i++) {
+        dmaBuffer[i] = (packet & 0x8000) ? DSHOT_MOTOR_BIT_1 : DSHOT_MOTOR_BIT_0;  // MSB first
+        packet <<= 1;
+    }
+}
+
+TEST(DshotEncodeTest, PacketMatchesReference)
+{
+    for (uint16_t value = 0; value < 2048; value++) {
+        EXPECT_EQ(prepareDshotPacket(value, false), dshotEncodePacket(value, false, false)) << value;
+        EXPECT_EQ(prepareDshotPacket(value, true), dshotEncodePacket(value, true, false)) << value;
+        // Bidirectional DShot only inverts the checksum
+        EXPECT_EQ(prepareDshotPacket(value, false) ^ 0xf, dshotEncodePacket(value, false, true)) << value;
+    }
+
+    // 1046: data 0x82C, checksum 0x8 ^ 0x2 ^ 0xC
+    EXPECT_EQ(0x82C6, dshotEncodePacket(1046, false, false));
+    EXPECT_EQ(0x82D7, dshotEncodePacket(1046, true, false));
+    EXPECT_EQ(0x82C9, dshotEncodePacket(1046, false, true));
+}
+
+TEST(DshotEncodeTest, DmaBufferMatchesReference)
+{
+    for (uint16_t value = 0; value < 2048; value++) {
+        for (int telemetry = 0; telemetry < 2; telemetry++) {
+            const uint16_t packet = dshotEncodePacket(value, telemetry, false);
+            timerDMASafeType_t expected[DSHOT_DMA_BUFFER_SIZE];
+            timerDMASafeType_t actual[DSHOT_DMA_BUFFER_SIZE];
+
+            memset(expected, 0xA5, sizeof(expected));
+            memset(actual, 0xA5, sizeof(actual));
+            loadDmaBufferDshot(expected, packet);
+            dshotLoadDmaBuffer(actual, packet);
+
+            ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected))) << value;
+        }
+    }
+}
+
+TEST(DshotEncodeTest, BurstDmaBufferMatchesReference)
+{
+    uint16_t value = 0;
+
+    // Every channel combination of a timer, values cycling through the full range
+    for (uint8_t channelMask = 0; channelMask < (1 << DSHOT_BURST_CHANNELS); channelMask++) {
+        for (int frame = 0; frame < 600; frame++) {
+            timerDMASafeType_t expected[DSHOT_DMA_BUFFER_SIZE * DSHOT_BURST_CHANNELS];
+            timerDMASafeType_t actual[DSHOT_DMA_BUFFER_SIZE * DSHOT_BURST_CHANNELS];
+            uint16_t packets[DSHOT_BURST_CHANNELS];
+
+            memset(expected, 0xA5, sizeof(expected));
+            memset(actual, 0xA5, sizeof(actual));
+            for (int channel = 0; channel < DSHOT_BURST_CHANNELS; channel++) {
+                value = (value + 7) % 2048;
+                packets[channel] = dshotEncodePacket(value, (value & 3) == 0, false);
+                if (channelMask & (1 << channel)) {
+                    loadDmaBufferDshotStride(&expected[channel], DSHOT_BURST_CHANNELS, packets[channel]);
+                }
+            }
+            dshotLoadBurstDmaBuffer(actual, packets, channelMask);
+
+            ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected))) << "mask " << (int)channelMask << " frame " << frame;
+        }
+    }
+}
+
+TEST(DshotEncodeTest, Benchmark)
+{
+    static timerDMASafeType_t dmaBurstBuffer[DSHOT_DMA_BUFFER_SIZE * DSHOT_BURST_CHANNELS];
+    uint16_t values[DSHOT_BURST_CHANNELS] = { 48, 700, 1400, 2047 };
+    uint16_t packets[DSHOT_BURST_CHANNELS];
+    uint32_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < BENCHMARK_FRAMES; n++) {
+        for (int channel = 0; channel < DSHOT_BURST_CHANNELS; channel++) {
+            const uint16_t packet = prepareDshotPacket(values[channel] ^ (n & 0x3f), false);
+            loadDmaBufferDshotStride(&dmaBurstBuffer[channel], DSHOT_BURST_CHANNELS, packet);
+        }
+        sum += dmaBurstBuffer[n & 63];
+    }
+    const double reference = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_FRAMES;
+
+    start = std::chrono::steady_clock::now();
+    for (int n = 0; n < BENCHMARK_FRAMES; n++) {
+        for (int channel = 0; channel < DSHOT_BURST_CHANNELS; channel++) {
+            packets[channel] = dshotEncodePacket(values[channel] ^ (n & 0x3f), false, false);
+        }
+        dshotLoadBurstDmaBuffer(dmaBurstBuffer, packets, 0xf);
+        sum -= dmaBurstBuffer[n & 63];
+    }
+    const double table = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_FRAMES;
+
+    printf("4 motor burst frame: bit by bit %.1f ns, nibble table %.1f ns\n", reference, table);
+    EXPECT_EQ(0u, sum);
+}
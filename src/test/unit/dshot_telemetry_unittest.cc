@@ -0,0 +1,217 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/dshot_telemetry.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// DShot600 reply at 5/4 of the command bit rate, timer counting at 12 MHz
+#define BIT_TICKS 16
+
+static const uint8_t gcrEncodeTable[16] = {
+    0x19, 0x1B, 0x12, 0x13, 0x1D, 0x15, 0x16, 0x17,
+    0x1A, 0x09, 0x0A, 0x0B, 0x1E, 0x0D, 0x0E, 0x0F,
+};
+
+// ESC side: 12 bit value + checksum, GCR symbols, one edge per GCR "1"
+static uint8_t encodeReply(uint16_t value, uint32_t startTicks, int jitter, uint32_t *edges)
+{
+    uint16_t packet = value << 4;
+    uint16_t csum = value ^ (value >> 4) ^ (value >> 8);
+    packet |= ~csum & 0xf;
+
+    uint32_t gcr = 1;
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        gcr = (gcr << 5) | gcrEncodeTable[(packet >> shift) & 0xf];
+    }
+
+    uint8_t count = 0;
+    for (int bit = DSHOT_TELEMETRY_GCR_BITS - 1; bit >= 0; bit--) {
+        if (gcr & (1 << bit)) {
+            const int noise = jitter ? (rand() % (2 * jitter + 1)) - jitter : 0;
+            edges[count++] = startTicks + (DSHOT_TELEMETRY_GCR_BITS - 1 - bit) * BIT_TICKS + noise;
+        }
+    }
+
+    return count;
+}
+
+TEST(DshotTelemetryTest, DecodesAllValues)
+{
+    for (uint16_t value = 0; value < 4096; value++) {
+        uint32_t edges[DSHOT_TELEMETRY_MAX_EDGES];
+        const uint8_t count = encodeReply(value, 1000 + value, 0, edges);
+        uint16_t decoded = 0;
+
+        ASSERT_TRUE(dshotTelemetryDecodeEdges(edges, count, BIT_TICKS, &decoded)) << value;
+        ASSERT_EQ(value, decoded);
+    }
+}
+
+/*
+ * Replies as seen on the signal wire, one character per reply bit starting
+ * with the falling start edge. The line idles high before and after, every
+ * valid frame has an even number of transitions so it ends high.
+ */
+static const struct {
+    const char *levels;
+    uint16_t value;
+} wireFrames[] = {
+    { "001010010100101010001", DSHOT_TELEMETRY_MOTOR_STOPPED }, // 0xFFF0: GCR 0F 0F 0F 19
+    { "011011001011011011101", (3 << 9) | 125 },                // 0x67D3: 1000 us period
+    { "010001001001011001001", 100 },                           // 0x064D: 100 us period
+};
+
+static uint8_t levelsToEdges(const char *levels, float ticksPerBit, uint32_t startTicks, uint32_t *edges)
+{
+    char level = '1';
+    uint8_t count = 0;
+
+    for (int bit = 0; levels[bit]; bit++) {
+        if (levels[bit] != level) {
+            level = levels[bit];
+            edges[count++] = (startTicks + lrintf(bit * ticksPerBit)) & 0xFFFF;
+        }
+    }
+
+    return count;
+}
+
+TEST(DshotTelemetryTest, DecodesWireFrames)
+{
+    for (const auto &frame : wireFrames) {
+        // ESC clock up to 5% off, reply starting just before the counter wraps
+        for (float ticksPerBit = BIT_TICKS * 0.95f; ticksPerBit <= BIT_TICKS * 1.05f; ticksPerBit += 0.2f) {
+            uint32_t edges[DSHOT_TELEMETRY_MAX_EDGES];
+            const uint8_t count = levelsToEdges(frame.levels, ticksPerBit, 0xFFF0, edges);
+            uint16_t decoded = 0;
+
+            ASSERT_TRUE(dshotTelemetryDecodeEdges(edges, count, BIT_TICKS, &decoded)) << frame.levels << " " << ticksPerBit;
+            EXPECT_EQ(frame.value, decoded) << frame.levels;
+        }
+    }
+
+    uint32_t edges[DSHOT_TELEMETRY_MAX_EDGES];
+    uint16_t decoded;
+
+    // One bit flipped on the wire
+    char levels[DSHOT_TELEMETRY_GCR_BITS + 1];
+    for (int bit = 1; bit < DSHOT_TELEMETRY_GCR_BITS - 1; bit++) {
+        memcpy(levels, wireFrames[0].levels, sizeof(levels));
+        levels[bit] = levels[bit] == '1' ? '0' : '1';
+        EXPECT_FALSE(dshotTelemetryDecodeEdges(edges, levelsToEdges(levels, BIT_TICKS, 0, edges), BIT_TICKS, &decoded)) << levels;
+    }
+
+    // The per motor result is in eRPM / 100
+    dshotTelemetryInit(1);
+    EXPECT_TRUE(dshotTelemetryProcessCapture(0, edges, levelsToEdges(wireFrames[1].levels, BIT_TICKS, 0, edges), BIT_TICKS));
+    EXPECT_EQ(600u, getDshotTelemetry(0));
+    EXPECT_TRUE(dshotTelemetryProcessCapture(0, edges, levelsToEdges(wireFrames[0].levels, BIT_TICKS, 0, edges), BIT_TICKS));
+    EXPECT_EQ(0u, getDshotTelemetry(0));
+}
+
+TEST(DshotTelemetryTest, ToleratesJitterAndCounterWrap)
+{
+    srand(1);
+    for (int n = 0; n < 20000; n++) {
+        const uint16_t value = rand() % 4096;
+        uint32_t edges[DSHOT_TELEMETRY_MAX_EDGES];
+        // Start just before a 16 bit counter overflow
+        const uint8_t count = encodeReply(value, 0xFFFF - 50 + (n % 100), BIT_TICKS / 4 - 1, edges);
+        for (int i = 0; i < count; i++) {
+            edges[i] &= 0xFFFF;
+        }
+        uint16_t decoded = 0;
+
+        ASSERT_TRUE(dshotTelemetryDecodeEdges(edges, count, BIT_TICKS, &decoded)) << n;
+        ASSERT_EQ(value, decoded);
+    }
+}
+
+TEST(DshotTelemetryTest, RejectsCorruptFrames)
+{
+    uint32_t edges[DSHOT_TELEMETRY_MAX_EDGES + 1];
+    uint16_t decoded;
+    uint8_t count = encodeReply(0x3A5, 0, 0, edges);
+
+    // Missing edge breaks the GCR symbol or the checksum
+    for (int skip = 1; skip < count; skip++) {
+        uint32_t shortEdges[DSHOT_TELEMETRY_MAX_EDGES];
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (i != skip) {
+                shortEdges[n++] = edges[i];
+            }
+        }
+        EXPECT_FALSE(dshotTelemetryDecodeEdges(shortEdges, n, BIT_TICKS, &decoded)) << skip;
+    }
+
+    // Glitch shorter than half a bit
+    edges[count] = edges[count - 1] + 2;
+    EXPECT_FALSE(dshotTelemetryDecodeEdges(edges, count + 1, BIT_TICKS, &decoded));
+
+    // Runs longer than the frame
+    count = encodeReply(0x3A5, 0, 0, edges);
+    edges[count - 1] += 8 * BIT_TICKS;
+    EXPECT_FALSE(dshotTelemetryDecodeEdges(edges, count, BIT_TICKS, &decoded));
+
+    EXPECT_FALSE(dshotTelemetryDecodeEdges(edges, 1, BIT_TICKS, &decoded));
+    EXPECT_FALSE(dshotTelemetryDecodeEdges(edges, count, 0, &decoded));
+}
+
+TEST(DshotTelemetryTest, ValueToErpm)
+{
+    // 9 bit mantissa, 3 bit shift, period in us
+    EXPECT_EQ(0u, dshotTelemetryValueToErpm(DSHOT_TELEMETRY_MOTOR_STOPPED));
+    EXPECT_EQ(0u, dshotTelemetryValueToErpm(0));
+    EXPECT_EQ(6000u, dshotTelemetryValueToErpm(100));                  // 100 us, 600000 eRPM
+    EXPECT_EQ(600u, dshotTelemetryValueToErpm((3 << 9) | 125));        // 1000 us, 60000 eRPM
+    EXPECT_EQ(1176u, dshotTelemetryValueToErpm((1 << 9) | 255));       // 510 us, rounded
+}
+
+TEST(DshotTelemetryTest, PublishesPerMotor)
+{
+    uint32_t edges[DSHOT_TELEMETRY_MAX_EDGES];
+    uint8_t count;
+
+    dshotTelemetryInit(4);
+    EXPECT_TRUE(dshotTelemetryIsActive());
+
+    count = encodeReply((3 << 9) | 125, 0, 0, edges);
+    EXPECT_TRUE(dshotTelemetryProcessCapture(2, edges, count, BIT_TICKS));
+    EXPECT_EQ(600u, getDshotTelemetry(2));
+    EXPECT_EQ(0u, getDshotTelemetry(1));
+
+    // Bad frame keeps the last good value
+    EXPECT_FALSE(dshotTelemetryProcessCapture(2, edges, count - 1, BIT_TICKS));
+    EXPECT_EQ(600u, getDshotTelemetry(2));
+    EXPECT_EQ(1u, getDshotTelemetryErrorCount());
+
+    EXPECT_FALSE(dshotTelemetryProcessCapture(4, edges, count, BIT_TICKS));
+    EXPECT_EQ(0u, getDshotTelemetry(4));
+}
@@ -0,0 +1,234 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "flight/mixer.h"
+    #include "flight/motor_mix.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_LOOPS 200000
+
+static const motorMixer_t quadX[] = {
+    { 1.0f, -1.0f,  1.0f, -1.0f },          // REAR_R
+    { 1.0f, -1.0f, -1.0f,  1.0f },          // FRONT_R
+    { 1.0f,  1.0f,  1.0f,  1.0f },          // REAR_L
+    { 1.0f,  1.0f, -1.0f, -1.0f },          // FRONT_L
+};
+
+// Octo X8 style mixer with a stopped and a transition motor, padded to the full motor count
+static const motorMixer_t mixed[MAX_SUPPORTED_MOTORS] = {
+    { 1.0f, -0.414178f,  1.0f, -1.0f },
+    { 1.0f, -0.414178f, -1.0f,  1.0f },
+    { 1.0f,  0.414178f,  1.0f,  1.0f },
+    { 1.0f,  0.414178f, -1.0f, -1.0f },
+    { 1.0f, -1.0f, -0.414178f, -1.0f },
+    { 1.0f,  1.0f, -0.414178f,  1.0f },
+    { 1.0f, -1.0f,  0.414178f,  1.0f },
+    { 1.0f,  1.0f,  0.414178f, -1.0f },
+    { 0.0f,  0.3f,  0.0f,  0.0f },
+    { -1.2f, 0.0f,  0.0f,  0.0f },
+    { 0.7f,  0.1f,  0.2f,  0.3f },
+    { 0.5f, -0.2f,  0.1f, -0.7f },
+};
+
+typedef struct mixerCase_s {
+    int16_t input[3];
+    int throttleCommand;
+    motorMixLimits_t limits;
+} mixerCase_t;
+
+// The mixTable() motor loops before the struct-of-arrays mix
+static void referenceMix(const motorMixer_t *mixer, int count, float mixerScale, int8_t motorYawMultiplier, const mixerCase_t *c, int16_t *motor, float *mixRange)
+{
+    const int16_t *input = c->input;
+    int16_t rpyMix[MAX_SUPPORTED_MOTORS];
+    int16_t rpyMixMax = 0;
+    int16_t rpyMixMin = 0;
+
+    for (int i = 0; i < count; i++) {
+        rpyMix[i] =
+            (input[FD_PITCH] * mixer[i].pitch +
+            input[FD_ROLL] * mixer[i].roll +
+            -motorYawMultiplier * input[FD_YAW] * mixer[i].yaw) * mixerScale;
+
+        if (rpyMix[i] > rpyMixMax) rpyMixMax = rpyMix[i];
+        if (rpyMix[i] < rpyMixMin) rpyMixMin = rpyMix[i];
+    }
+
+    const int16_t rpyMixRange = rpyMixMax - rpyMixMin;
+    const int16_t throttleRange = c->limits.outputMax - c->limits.outputMin;
+    const float motorMixRange = (float)rpyMixRange / (float)throttleRange;
+    if (motorMixRange > 1.0f) {
+        for (int i = 0; i < count; i++) {
+            rpyMix[i] /= motorMixRange;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        motor[i] = rpyMix[i] + constrain(c->throttleCommand * mixer[i].throttle, c->limits.throttleMin, c->limits.throttleMax);
+        motor[i] = constrain(motor[i], c->limits.outputMin, c->limits.outputMax);
+
+        if (mixer[i].throttle <= 0.0f) {
+            motor[i] = c->limits.stopValue;
+        }
+        if (c->limits.transitionSpin && mixer[i].throttle <= -1.05f && mixer[i].throttle >= -2.0f) {
+            motor[i] = -mixer[i].throttle * 1000;
+            motor[i] = constrain(motor[i], c->limits.transitionMin, c->limits.transitionMax);
+        }
+    }
+
+    *mixRange = motorMixRange;
+}
+
+static void motorMix(const motorMix_t *mix, const mixerCase_t *c, int16_t *motor)
+{
+    int16_t rpyMix[MAX_SUPPORTED_MOTORS];
+    const int16_t rpyMixRange = motorMixRpy(mix, c->input, rpyMix);
+    const float motorMixRange = (float)rpyMixRange / (float)(c->limits.outputMax - c->limits.outputMin);
+
+    motorMixOutput(mix, rpyMix, motorMixRange, c->throttleCommand, &c->limits, motor);
+}
+
+static void randomCase(mixerCase_t *c)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        c->input[axis] = (rand() % 1001) - 500;
+    }
+    c->throttleCommand = 1000 + rand() % 1001;
+    c->limits.outputMin = (rand() & 1) ? 1070 : 1000;
+    c->limits.outputMax = 2000;
+    c->limits.throttleMin = c->limits.outputMin + rand() % 300;
+    c->limits.throttleMax = c->limits.outputMax - rand() % 300;
+    c->limits.transitionMin = 1070;
+    c->limits.transitionMax = 2000;
+    c->limits.stopValue = 1000;
+    c->limits.transitionSpin = rand() & 1;
+}
+
+static void expectSameAsReference(const motorMixer_t *mixer, int count, float scale, int8_t yawMultiplier)
+{
+    motorMix_t mix;
+    motorMixInit(&mix, mixer, count, scale, yawMultiplier);
+
+    srand(count);
+    for (int n = 0; n < 10000; n++) {
+        mixerCase_t c;
+        int16_t expected[MAX_SUPPORTED_MOTORS];
+        int16_t actual[MAX_SUPPORTED_MOTORS];
+        float mixRange;
+
+        randomCase(&c);
+        referenceMix(mixer, count, scale, yawMultiplier, &c, expected, &mixRange);
+        motorMix(&mix, &c, actual);
+
+        for (int i = 0; i < count; i++) {
+            ASSERT_EQ(expected[i], actual[i]) << "case " << n << " motor " << i << " mix range " << mixRange;
+        }
+    }
+}
+
+TEST(MotorMixTest, QuadMatchesScalarMixer)
+{
+    expectSameAsReference(quadX, 4, 1.0f, 1);
+    expectSameAsReference(quadX, 4, 1.0f, -1);
+}
+
+TEST(MotorMixTest, ReversibleMotorsMatchScalarMixer)
+{
+    expectSameAsReference(quadX, 4, 0.5f, 1);
+    expectSameAsReference(mixed, MAX_SUPPORTED_MOTORS, 0.5f, -1);
+}
+
+TEST(MotorMixTest, AllMotorsMatchScalarMixer)
+{
+    expectSameAsReference(mixed, MAX_SUPPORTED_MOTORS, 1.0f, 1);
+    expectSameAsReference(mixed, MAX_SUPPORTED_MOTORS, 1.0f, -1);
+}
+
+TEST(MotorMixTest, StoppedAndTransitionMotors)
+{
+    motorMix_t mix;
+    motorMixInit(&mix, mixed, MAX_SUPPORTED_MOTORS, 1.0f, 1);
+
+    EXPECT_TRUE(mix.stopped[8]);
+    EXPECT_TRUE(mix.stopped[9]);
+    EXPECT_FALSE(mix.stopped[0]);
+    EXPECT_EQ(1200, mix.transitionOutput[9]);
+    EXPECT_EQ(0, mix.transitionOutput[8]);
+
+    mixerCase_t c = { { 0, 0, 0 }, 1500, { 1100, 1900, 1000, 2000, 1100, 1150, 990, false } };
+    int16_t motor[MAX_SUPPORTED_MOTORS];
+
+    motorMix(&mix, &c, motor);
+    EXPECT_EQ(1500, motor[0]);
+    EXPECT_EQ(990, motor[8]);
+    EXPECT_EQ(990, motor[9]);
+
+    c.limits.transitionSpin = true;
+    motorMix(&mix, &c, motor);
+    EXPECT_EQ(990, motor[8]);
+    EXPECT_EQ(1150, motor[9]);
+}
+
+TEST(MotorMixTest, Benchmark)
+{
+    motorMix_t mix;
+    motorMixInit(&mix, mixed, MAX_SUPPORTED_MOTORS, 1.0f, 1);
+
+    mixerCase_t cases[64];
+    srand(1);
+    for (unsigned i = 0; i < ARRAYLEN(cases); i++) {
+        randomCase(&cases[i]);
+    }
+
+    int16_t motor[MAX_SUPPORTED_MOTORS];
+    float mixRange;
+    int32_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < BENCHMARK_LOOPS; n++) {
+        referenceMix(mixed, MAX_SUPPORTED_MOTORS, 1.0f, 1, &cases[n & 63], motor, &mixRange);
+        sum += motor[0];
+    }
+    const double reference = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_LOOPS;
+
+    start = std::chrono::steady_clock::now();
+    for (int n = 0; n < BENCHMARK_LOOPS; n++) {
+        motorMix(&mix, &cases[n & 63], motor);
+        sum -= motor[0];
+    }
+    const double soa = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_LOOPS;
+
+    printf("%d motors: scalar mixer %.1f ns, struct-of-arrays mixer %.1f ns\n", MAX_SUPPORTED_MOTORS, reference, soa);
+    EXPECT_EQ(0, sum);
+}
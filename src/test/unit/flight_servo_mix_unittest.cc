@@ -0,0 +1,214 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "flight/servo_mix.h"
+    #include "flight/servos.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define CONDITION_COUNT 4
+#define LOOP_DT         0.001f
+
+static int16_t input[INPUT_SOURCE_COUNT];
+static bool conditionValue[CONDITION_COUNT];
+
+// The servoMixer() rule loop before the rules were compiled
+static void referenceMix(const servoMixer_t *mixers, int count, rateLimitFilter_t *filters, float dT, int16_t *output)
+{
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        output[i] = 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const uint8_t target = mixers[i].targetChannel;
+        const uint8_t from = mixers[i].inputSource;
+
+        int16_t inputRaw = input[from];
+
+        if (mixers[i].conditionId >= 0 && !conditionValue[mixers[i].conditionId]) {
+            inputRaw = 0;
+        }
+
+        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&filters[i], inputRaw, mixers[i].speed * 10, dT);
+
+        output[target] += ((int32_t)inputLimited * mixers[i].rate) / 100;
+    }
+}
+
+static void compiledMix(const servoMix_t *mix, float dT, int16_t *output)
+{
+    bool conditionActive[MAX_SERVO_RULES];
+    for (int i = 0; i < mix->conditionCount; i++) {
+        conditionActive[i] = conditionValue[mix->conditionIds[i]];
+    }
+
+    servoMixApply(mix, conditionActive, dT, output);
+}
+
+static void randomRules(servoMixer_t *mixers, int count)
+{
+    for (int i = 0; i < count; i++) {
+        mixers[i].targetChannel = rand() % MAX_SUPPORTED_SERVOS;
+        mixers[i].inputSource = rand() % INPUT_SOURCE_COUNT;
+        mixers[i].rate = (rand() % 2001) - 1000;
+        mixers[i].speed = (rand() & 1) ? 0 : 1 + rand() % MAX_SERVO_SPEED;
+        mixers[i].conditionId = (rand() % (CONDITION_COUNT + 1)) - 1;
+    }
+}
+
+static void randomInputs(void)
+{
+    for (int i = 0; i < INPUT_SOURCE_COUNT; i++) {
+        // Mostly small steps, with an occasional full stick jump for the speed limit to work on
+        if (rand() % 50 == 0) {
+            input[i] = (rand() % 1001) - 500;
+        } else {
+            input[i] = constrain(input[i] + (rand() % 21) - 10, -500, 500);
+        }
+    }
+    for (int i = 0; i < CONDITION_COUNT; i++) {
+        if (rand() % 100 == 0) {
+            conditionValue[i] = !conditionValue[i];
+        }
+    }
+}
+
+static void expectSameAsReference(const servoMixer_t *mixers, int count, const rateLimitFilter_t *initialFilters)
+{
+    rateLimitFilter_t referenceFilters[MAX_SERVO_RULES];
+    rateLimitFilter_t compiledFilters[MAX_SERVO_RULES];
+    memcpy(referenceFilters, initialFilters, sizeof(referenceFilters));
+    memcpy(compiledFilters, initialFilters, sizeof(compiledFilters));
+
+    servoMix_t mix;
+    servoMixCompile(&mix, mixers, count, input, compiledFilters);
+
+    for (int n = 0; n < 5000; n++) {
+        int16_t expected[MAX_SUPPORTED_SERVOS];
+        int16_t actual[MAX_SUPPORTED_SERVOS];
+
+        randomInputs();
+        referenceMix(mixers, count, referenceFilters, LOOP_DT, expected);
+        compiledMix(&mix, LOOP_DT, actual);
+
+        for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+            ASSERT_EQ(expected[i], actual[i]) << "loop " << n << " servo " << i;
+        }
+    }
+}
+
+TEST(ServoMixTest, RulesMatchPerRuleLoop)
+{
+    rateLimitFilter_t filters[MAX_SERVO_RULES];
+    memset(filters, 0, sizeof(filters));
+
+    srand(1);
+    for (int count = 1; count <= MAX_SERVO_RULES; count++) {
+        servoMixer_t mixers[MAX_SERVO_RULES];
+        randomRules(mixers, count);
+        expectSameAsReference(mixers, count, filters);
+    }
+}
+
+TEST(ServoMixTest, CarriedOverSpeedLimitsMatchPerRuleLoop)
+{
+    // After a mixer profile switch the speed limited rules of the old profile keep moving from their last position
+    servoMixer_t mixers[MAX_SERVO_RULES];
+    rateLimitFilter_t filters[MAX_SERVO_RULES];
+    memset(filters, 0, sizeof(filters));
+
+    srand(2);
+    randomRules(mixers, MAX_SERVO_RULES - MAX_SERVO_RULES_SWITCH_CARRY);
+    for (int i = MAX_SERVO_RULES - MAX_SERVO_RULES_SWITCH_CARRY; i < MAX_SERVO_RULES; i++) {
+        mixers[i] = (servoMixer_t){
+            .targetChannel = (uint8_t)(i % MAX_SUPPORTED_SERVOS),
+            .inputSource = INPUT_MIXER_SWITCH_HELPER,
+            .rate = 100,
+            .speed = (uint8_t)(1 + i),
+            .conditionId = -1,
+        };
+        filters[i].state = (i & 1) ? 400 : -300;
+    }
+
+    expectSameAsReference(mixers, MAX_SERVO_RULES, filters);
+}
+
+TEST(ServoMixTest, SortsByTargetAndSharesConditions)
+{
+    const servoMixer_t mixers[] = {
+        { 3, INPUT_STABILIZED_ROLL,  100, 0, 2 },
+        { 1, INPUT_STABILIZED_PITCH, 50,  0, -1 },
+        { 3, INPUT_STABILIZED_YAW,  -100, 0, 2 },
+        { 1, INPUT_RC_CH5,          25,  10, 0 },
+    };
+    rateLimitFilter_t filters[ARRAYLEN(mixers)];
+    servoMix_t mix;
+
+    servoMixCompile(&mix, mixers, ARRAYLEN(mixers), input, filters);
+
+    ASSERT_EQ(4, mix.ruleCount);
+    EXPECT_EQ(&input[INPUT_STABILIZED_PITCH], mix.rules[0].input);
+    EXPECT_EQ(&input[INPUT_RC_CH5], mix.rules[1].input);
+    EXPECT_EQ(&input[INPUT_STABILIZED_ROLL], mix.rules[2].input);
+    EXPECT_EQ(&input[INPUT_STABILIZED_YAW], mix.rules[3].input);
+
+    EXPECT_EQ(NULL, mix.rules[0].speedLimitFilter);
+    EXPECT_EQ(&filters[3], mix.rules[1].speedLimitFilter);
+    EXPECT_EQ(100.0f, mix.rules[1].speedLimit);
+
+    ASSERT_EQ(2, mix.conditionCount);
+    EXPECT_EQ(SERVO_MIX_CONDITION_NONE, mix.rules[0].condition);
+    EXPECT_EQ(mix.rules[2].condition, mix.rules[3].condition);
+    EXPECT_EQ(2, mix.conditionIds[mix.rules[2].condition]);
+    EXPECT_EQ(0, mix.conditionIds[mix.rules[1].condition]);
+}
+
+TEST(ServoMixTest, DropsOutOfRangeRules)
+{
+    const servoMixer_t mixers[] = {
+        { MAX_SUPPORTED_SERVOS, INPUT_STABILIZED_ROLL, 100, 0, -1 },
+        { 0, INPUT_SOURCE_COUNT, 100, 0, -1 },
+        { 2, INPUT_STABILIZED_ROLL, 100, 0, -1 },
+    };
+    rateLimitFilter_t filters[ARRAYLEN(mixers)];
+    servoMix_t mix;
+
+    servoMixCompile(&mix, mixers, ARRAYLEN(mixers), input, filters);
+
+    ASSERT_EQ(1, mix.ruleCount);
+    EXPECT_EQ(2, mix.rules[0].target);
+
+    int16_t output[MAX_SUPPORTED_SERVOS];
+    input[INPUT_STABILIZED_ROLL] = 200;
+    compiledMix(&mix, LOOP_DT, output);
+    EXPECT_EQ(200, output[2]);
+    EXPECT_EQ(0, output[0]);
+}
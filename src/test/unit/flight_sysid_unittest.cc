@@ -0,0 +1,351 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <complex>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/filter.h"
+    #include "common/maths.h"
+
+    #include "flight/sysid.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+typedef std::complex<double> complex_t;
+
+#define PID_RATE_HZ         1000
+#define PID_DT              (1.0 / PID_RATE_HZ)
+
+// Integrating rate plant behind a first order motor lag, one loop of delay
+#define PLANT_GAIN          800.0
+#define MOTOR_LAG_HZ        10.0
+
+// Multirotor style gains in configured units
+#define CONFIG_P            40
+#define CONFIG_I            30
+#define DTERM_LPF_HZ        110
+
+static const double kP = CONFIG_P / 31.0;
+static const double kI = CONFIG_I / 4.0;
+static const double kDPerUnit = 1.0 / 1905.0;
+static const double kFFPerUnit = 1.0 / 7270.0;
+
+static double gaussianNoise(double stdDev)
+{
+    double sum = 0;
+    for (int i = 0; i < 12; i++) {
+        sum += rand() / (double)RAND_MAX;
+    }
+    return (sum - 6.0) * stdDev;
+}
+
+static double pt1Gain(double cutoffHz)
+{
+    const double rc = 1.0 / (2.0 * M_PI * cutoffHz);
+    return PID_DT / (rc + PID_DT);
+}
+
+static complex_t zInverse(double frequencyHz)
+{
+    return std::exp(complex_t(0, -2.0 * M_PI * frequencyHz * PID_DT));
+}
+
+static complex_t pt1Response(double cutoffHz, double frequencyHz)
+{
+    const double k = pt1Gain(cutoffHz);
+    return k / (1.0 - (1.0 - k) * zInverse(frequencyHz));
+}
+
+// Exact discrete models of the simulation below
+static complex_t plantResponse(double frequencyHz)
+{
+    const complex_t z1 = zInverse(frequencyHz);
+    return pt1Response(MOTOR_LAG_HZ, frequencyHz) * z1 * PLANT_GAIN * PID_DT / (1.0 - z1);
+}
+
+static complex_t openLoopResponse(double d, double frequencyHz)
+{
+    const complex_t z1 = zInverse(frequencyHz);
+    const complex_t derivative = (1.0 - z1) / PID_DT;
+    return (kP + kI * PID_DT / (1.0 - z1) + d * kDPerUnit * derivative * pt1Response(DTERM_LPF_HZ, frequencyHz)) * plantResponse(frequencyHz);
+}
+
+static bool modelPhaseMargin(double d, double *crossoverHz, double *phaseMargin)
+{
+    for (double f = 1; f < 200; f += 0.01) {
+        const complex_t loop = openLoopResponse(d, f);
+        if (std::abs(loop) < 1) {
+            *crossoverHz = f;
+            *phaseMargin = 180 + std::arg(loop) * 180 / M_PI;
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    double motor;
+    double gyro;
+    double iTerm;
+    double previousGyro;
+    double dtermLpf;
+    double previousSetpoint;
+    double ffLpf[3];
+} loop_t;
+
+// Rate loop as in pidApplyMulticopterRateController(), D on gyro, setpoint derivative feed forward
+static void runLoop(loop_t *loop, int cycles, uint16_t d, uint16_t ff, double noise)
+{
+    for (int n = 0; n < cycles; n++) {
+        const double setpoint = sysidGetExcitation();
+        const double gyro = loop->gyro + gaussianNoise(noise);
+
+        const double error = setpoint - gyro;
+        loop->iTerm += error * kI * PID_DT;
+
+        loop->dtermLpf += pt1Gain(DTERM_LPF_HZ) * ((loop->previousGyro - gyro) - loop->dtermLpf);
+        const double dTerm = loop->dtermLpf * d * kDPerUnit / PID_DT;
+
+        // PT3 with the same per stage cutoff correction as pt3FilterGain()
+        double delta = setpoint - loop->previousSetpoint;
+        for (int i = 0; i < 3; i++) {
+            loop->ffLpf[i] += pt1Gain(100 * 1.961459177) * (delta - loop->ffLpf[i]);
+            delta = loop->ffLpf[i];
+        }
+        const double ffTerm = delta * ff * kFFPerUnit / PID_DT;
+
+        const double output = kP * error + loop->iTerm + dTerm + ffTerm;
+
+        sysidPushSample(setpoint, gyro);
+        if (n % (PID_RATE_HZ / SYSID_TASK_RATE_HZ) == 0) {
+            sysidTask(0);
+        }
+
+        loop->previousGyro = gyro;
+        loop->previousSetpoint = setpoint;
+
+        // Plant, the output of this loop acts on the next gyro sample
+        loop->motor += pt1Gain(MOTOR_LAG_HZ) * (output - loop->motor);
+        loop->gyro += PLANT_GAIN * loop->motor * PID_DT;
+    }
+}
+
+static void finishAnalysis(void)
+{
+    sysidStop();
+    for (int i = 0; i < 100 && sysidGetState() == SYSID_STATE_ANALYSING; i++) {
+        sysidTask(0);
+    }
+}
+
+static sysidController_t testController(uint16_t d, uint16_t ff)
+{
+    sysidController_t controller = {};
+    controller.kP = kP;
+    controller.kI = kI;
+    controller.kDPerUnit = kDPerUnit;
+    controller.kFFPerUnit = kFFPerUnit;
+    controller.d = d;
+    controller.ff = ff;
+    controller.ffIsDerivative = true;
+    controller.dtermLpfType = FILTER_PT1;
+    controller.dtermLpfHz = DTERM_LPF_HZ;
+    controller.ffLpfHz = 100;
+    return controller;
+}
+
+static void configure(sysidSignal_e signal, uint8_t minHz, uint16_t maxHz)
+{
+    sysidConfigMutable()->axis = 0;
+    sysidConfigMutable()->signal = signal;
+    sysidConfigMutable()->amplitude = 100;
+    sysidConfigMutable()->minHz = minHz;
+    sysidConfigMutable()->maxHz = maxHz;
+}
+
+TEST(SysidTest, MeasuresGainAndDelay)
+{
+    // Half gain, two samples of delay, no controller involved
+    configure(SYSID_SIGNAL_CHIRP, 5, 150);
+    sysidController_t controller = {};
+    controller.kP = 1;
+    sysidStart(&controller, 500);
+    EXPECT_TRUE(sysidIsRunning());
+
+    float history[3] = { 0, 0, 0 };
+    for (int n = 0; n < SYSID_SAMPLE_COUNT; n++) {
+        history[2] = history[1];
+        history[1] = history[0];
+        history[0] = sysidGetExcitation();
+        sysidPushSample(history[0], 0.5f * history[2]);
+        if (n % 50 == 0) {
+            sysidTask(0);
+        }
+    }
+
+    // Buffer full, excitation stops by itself
+    EXPECT_FALSE(sysidIsRunning());
+    EXPECT_EQ(0, sysidGetExcitation());
+    finishAnalysis();
+    ASSERT_EQ(SYSID_STATE_DONE, sysidGetState());
+    EXPECT_EQ(31, sysidGetResult()->segments);
+
+    int bins = 0;
+    for (int bin = 0; bin < SYSID_BIN_COUNT; bin++) {
+        sysidResponse_t response;
+        if (!sysidGetResponse(bin, &response)) {
+            continue;
+        }
+        bins++;
+
+        if (response.frequencyHz > 140) {
+            // Little excitation left at the top of the sweep
+            continue;
+        }
+
+        const double expectedPhase = std::arg(std::exp(complex_t(0, -2.0 * M_PI * response.frequencyHz * 2 / 500))) * 180 / M_PI;
+        EXPECT_NEAR(-6.02, response.gainDb, 0.25) << response.frequencyHz;
+        EXPECT_NEAR(expectedPhase, response.phase, 1.0) << response.frequencyHz;
+        EXPECT_GT(response.coherence, 0.99f);
+    }
+    EXPECT_NEAR(150 / (500.0f / SYSID_FFT_SIZE) - 5 / (500.0f / SYSID_FFT_SIZE), bins, 2);
+}
+
+TEST(SysidTest, IdentifiesRateLoop)
+{
+    const sysidSignal_e signals[] = { SYSID_SIGNAL_CHIRP, SYSID_SIGNAL_PRBS };
+
+    for (const sysidSignal_e signal : signals) {
+        // Low D, the loop is underdamped
+        const uint16_t d = 3;
+        loop_t loop = {};
+        srand(1);
+        configure(signal, 5, 150);
+
+        sysidController_t controller = testController(d, 0);
+        sysidStart(&controller, PID_RATE_HZ);
+        runLoop(&loop, SYSID_SAMPLE_COUNT * 2, d, 0, 2.0);
+        finishAnalysis();
+        ASSERT_EQ(SYSID_STATE_DONE, sysidGetState()) << "signal " << signal;
+
+        const sysidResult_t *result = sysidGetResult();
+        double crossoverHz;
+        double phaseMargin;
+        ASSERT_TRUE(modelPhaseMargin(d, &crossoverHz, &phaseMargin));
+
+        EXPECT_NEAR(crossoverHz, result->crossoverHz, 2.0) << "signal " << signal;
+        EXPECT_NEAR(phaseMargin, result->phaseMargin, 5.0) << "signal " << signal << ", crossover " << result->crossoverHz << " Hz";
+        EXPECT_GT(result->bandwidthHz, result->crossoverHz) << "signal " << signal;
+
+        // More D helps this loop, the suggestion must be better on the true model
+        double suggestedCrossoverHz;
+        double suggestedPhaseMargin;
+        EXPECT_GT(result->suggestedD, d) << "signal " << signal;
+        ASSERT_TRUE(modelPhaseMargin(result->suggestedD, &suggestedCrossoverHz, &suggestedPhaseMargin));
+        EXPECT_GT(suggestedPhaseMargin, phaseMargin + 10) << "signal " << signal << ", suggested D " << result->suggestedD;
+        EXPECT_NEAR(suggestedPhaseMargin, result->suggestedPhaseMargin, 5.0) << "signal " << signal << ", suggested D " << result->suggestedD;
+    }
+}
+
+TEST(SysidTest, SuggestsFeedForward)
+{
+    const uint16_t d = 30;
+    loop_t loop = {};
+    srand(2);
+    configure(SYSID_SIGNAL_CHIRP, 5, 150);
+
+    sysidController_t controller = testController(d, 0);
+    sysidStart(&controller, PID_RATE_HZ);
+    runLoop(&loop, SYSID_SAMPLE_COUNT * 2, d, 0, 2.0);
+    finishAnalysis();
+    ASSERT_EQ(SYSID_STATE_DONE, sysidGetState());
+
+    const sysidResult_t *result = sysidGetResult();
+    EXPECT_GT(result->suggestedFF, 0);
+
+    // Tracking error up to crossover with the suggested D, on the true model
+    double crossoverHz;
+    double phaseMargin;
+    ASSERT_TRUE(modelPhaseMargin(result->suggestedD, &crossoverHz, &phaseMargin));
+
+    auto trackingError = [&](double ff) {
+        double error = 0;
+        for (double f = 5; f < crossoverHz; f += 1) {
+            const complex_t z1 = zInverse(f);
+            const complex_t ffLpf = pt1Response(100 * 1.961459177, f);
+            const complex_t feedForward = ff * kFFPerUnit * (1.0 - z1) / PID_DT * ffLpf * ffLpf * ffLpf;
+            const complex_t loopGain = openLoopResponse(result->suggestedD, f);
+            const complex_t tracking = (kP + kI * PID_DT / (1.0 - z1) + feedForward) * plantResponse(f) / (1.0 + loopGain);
+            error += std::norm(1.0 - tracking);
+        }
+        return error;
+    };
+    double bestError = trackingError(0);
+    for (int ff = 1; ff <= 255; ff++) {
+        bestError = MIN(bestError, trackingError(ff));
+    }
+    EXPECT_LT(trackingError(result->suggestedFF), trackingError(0)) << "suggested FF " << result->suggestedFF;
+    EXPECT_LT(trackingError(result->suggestedFF), 1.02 * bestError) << "suggested FF " << result->suggestedFF;
+}
+
+TEST(SysidTest, ShortRunFails)
+{
+    loop_t loop = {};
+    configure(SYSID_SIGNAL_CHIRP, 5, 150);
+
+    sysidController_t controller = testController(20, 0);
+    sysidStart(&controller, PID_RATE_HZ);
+    runLoop(&loop, 500, 20, 0, 0);
+    finishAnalysis();
+
+    EXPECT_EQ(SYSID_STATE_FAILED, sysidGetState());
+    sysidResponse_t response;
+    EXPECT_FALSE(sysidGetResponse(10, &response));
+}
+
+TEST(SysidTest, LimitsBandToSampleRate)
+{
+    // 250 Hz loop records at 250 Hz, nothing above 40% of that is excited
+    configure(SYSID_SIGNAL_CHIRP, 5, 200);
+    sysidController_t controller = {};
+    sysidStart(&controller, 250);
+
+    float previous = 0;
+    int zeroCrossings = 0;
+    for (int n = 0; n < SYSID_SAMPLE_COUNT; n++) {
+        const float excitation = sysidGetExcitation();
+        if (n >= SYSID_SAMPLE_COUNT - 250 && (excitation > 0) != (previous > 0)) {
+            zeroCrossings++;
+        }
+        previous = excitation;
+        sysidPushSample(excitation, excitation);
+    }
+
+    // Last second of the sweep from ~83 Hz up to 100 Hz
+    EXPECT_GE(zeroCrossings / 2, 85);
+    EXPECT_LE(zeroCrossings / 2, 100);
+    EXPECT_EQ(SYSID_STATE_ANALYSING, sysidGetState());
+}
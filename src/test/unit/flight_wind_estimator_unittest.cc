@@ -0,0 +1,209 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "flight/wind_estimator_kf.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define GPS_RATE_HZ     10
+#define GPS_DT          (1.0f / GPS_RATE_HZ)
+
+static const windKfParams_t params = {
+    .windNoise = 5.0f,
+    .windAltitudeNoise = 15.0f,
+    .airspeedNoise = 50.0f,
+    .pitotScaleNoise = 0.002f,
+    .velocityNoise = 150.0f,
+    .innovationGate = 5.0f,
+};
+
+static const float windTruth[XYZ_AXIS_COUNT] = { 500.0f, -300.0f, 0.0f };
+
+static float gaussianNoise(float stdDev)
+{
+    // Sum of uniforms, close enough to normal
+    float sum = 0;
+    for (int i = 0; i < 12; i++) {
+        sum += rand() / (float)RAND_MAX;
+    }
+    return (sum - 6.0f) * stdDev;
+}
+
+typedef struct {
+    windKf_t kf;
+    float heading;
+    float airspeed;
+    float pitotScale;       // True airspeed / pitot airspeed
+} simulation_t;
+
+static void simulationInit(simulation_t *sim, float airspeed)
+{
+    windKfInit(&sim->kf, &params);
+    sim->heading = 0;
+    sim->airspeed = airspeed;
+    sim->pitotScale = 1.0f;
+}
+
+// Fly for some time at a constant turn rate (deg/s), fusing every GPS sample
+static void simulationFly(simulation_t *sim, float seconds, float turnRate, bool usePitot)
+{
+    for (int n = 0; n < seconds * GPS_RATE_HZ; n++) {
+        sim->heading += DEGREES_TO_RADIANS(turnRate) * GPS_DT;
+
+        const fpVector3_t direction = { .v = { cosf(sim->heading), sinf(sim->heading), 0.0f } };
+        fpVector3_t groundVelocity;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            groundVelocity.v[axis] = windTruth[axis] + sim->airspeed * direction.v[axis] + gaussianNoise(50.0f);
+        }
+
+        fpVector3_t reference = direction;
+        if (usePitot) {
+            windKfSetReference(&sim->kf, WIND_KF_REFERENCE_PITOT, 0);
+            const float pitotAirspeed = sim->airspeed / sim->pitotScale + gaussianNoise(30.0f);
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                reference.v[axis] *= pitotAirspeed;
+            }
+        } else {
+            windKfSetReference(&sim->kf, WIND_KF_REFERENCE_HEADING, sim->airspeed);
+        }
+
+        windKfPredict(&sim->kf, GPS_DT, 0);
+        windKfFuseGroundVelocity(&sim->kf, &groundVelocity, &reference);
+    }
+}
+
+static float horizontalWindError(const simulation_t *sim)
+{
+    return calc_length_pythagorean_2D(sim->kf.x[WIND_KF_WIND_X] - windTruth[X], sim->kf.x[WIND_KF_WIND_Y] - windTruth[Y]);
+}
+
+TEST(WindEstimatorTest, ConvergesInTurnWithoutPitot)
+{
+    simulation_t sim;
+    srand(1);
+    simulationInit(&sim, 1800);
+
+    // Nothing known about wind before the first turn
+    simulationFly(&sim, 5, 0, false);
+    EXPECT_GT(windKfGetStdDev(&sim.kf, WIND_KF_WIND_X), 300.0f);
+
+    // One full circle
+    simulationFly(&sim, 60, 6, false);
+    EXPECT_LT(horizontalWindError(&sim), 100.0f);
+    EXPECT_NEAR(1800.0f, sim.kf.x[WIND_KF_AIRSPEED], 100.0f);
+    EXPECT_LT(windKfGetStdDev(&sim.kf, WIND_KF_WIND_X), 150.0f);
+    EXPECT_LT(windKfGetStdDev(&sim.kf, WIND_KF_WIND_Y), 150.0f);
+}
+
+TEST(WindEstimatorTest, HoldsOnStraightLegs)
+{
+    simulation_t sim;
+    srand(2);
+    simulationInit(&sim, 1800);
+    simulationFly(&sim, 60, 6, false);
+
+    // Flying north for 5 minutes, throttle change half way
+    sim.heading = 0;
+    simulationFly(&sim, 150, 0, false);
+    sim.airspeed = 2100;
+    simulationFly(&sim, 150, 0, false);
+
+    // Airspeed change is taken by the airspeed state, wind is kept
+    EXPECT_LT(horizontalWindError(&sim), 150.0f);
+    EXPECT_NEAR(2100.0f, sim.kf.x[WIND_KF_AIRSPEED], 150.0f);
+
+    // Cross track wind is still measured, along track uncertainty grows
+    EXPECT_LT(windKfGetStdDev(&sim.kf, WIND_KF_WIND_Y), 100.0f);
+    EXPECT_GT(windKfGetStdDev(&sim.kf, WIND_KF_WIND_X), windKfGetStdDev(&sim.kf, WIND_KF_WIND_Y));
+    EXPECT_EQ(0u, sim.kf.rejectedCount);
+}
+
+TEST(WindEstimatorTest, EstimatesPitotScale)
+{
+    simulation_t sim;
+    srand(3);
+    simulationInit(&sim, 1800);
+    sim.pitotScale = 1.1f;
+
+    simulationFly(&sim, 60, 6, true);
+    EXPECT_LT(horizontalWindError(&sim), 50.0f);
+    EXPECT_NEAR(1.1f, sim.kf.x[WIND_KF_AIRSPEED], 0.02f);
+
+    // With a pitot a quarter turn is enough
+    simulationInit(&sim, 1800);
+    simulationFly(&sim, 15, 6, true);
+    EXPECT_LT(horizontalWindError(&sim), 100.0f);
+    EXPECT_LT(windKfGetStdDev(&sim.kf, WIND_KF_WIND_X), 150.0f);
+}
+
+TEST(WindEstimatorTest, ReferenceSwitchRestartsAirspeedState)
+{
+    simulation_t sim;
+    srand(4);
+    simulationInit(&sim, 1800);
+    simulationFly(&sim, 60, 6, true);
+
+    // Pitot lost, airspeed state restarts from the given airspeed, wind is kept
+    simulationFly(&sim, 30, 0, false);
+    EXPECT_EQ(WIND_KF_REFERENCE_HEADING, sim.kf.reference);
+    EXPECT_NEAR(1800.0f, sim.kf.x[WIND_KF_AIRSPEED], 100.0f);
+    EXPECT_LT(horizontalWindError(&sim), 100.0f);
+}
+
+TEST(WindEstimatorTest, CovarianceGrowsWithTimeAndAltitude)
+{
+    windKf_t kf;
+    windKfInit(&kf, &params);
+
+    // Converge the wind with direct observations
+    for (int n = 0; n < 200; n++) {
+        const fpVector3_t velocity = { .v = { windTruth[X], windTruth[Y], windTruth[Z] } };
+        const fpVector3_t reference = { .v = { 0, 0, 0 } };
+        windKfFuseGroundVelocity(&kf, &velocity, &reference);
+    }
+    const float converged = windKfGetStdDev(&kf, WIND_KF_WIND_X);
+    const float estimate = kf.x[WIND_KF_WIND_X];
+    EXPECT_LT(converged, 20.0f);
+    EXPECT_NEAR(windTruth[X], estimate, 1.0f);
+
+    // 15 minutes
+    windKfPredict(&kf, 900, 0);
+    const float aged = windKfGetStdDev(&kf, WIND_KF_WIND_X);
+    EXPECT_NEAR(sqrtf(sq(converged) + sq(params.windNoise) * 900), aged, 1.0f);
+
+    // 500 m climb
+    windKfPredict(&kf, 0, 500);
+    EXPECT_NEAR(sqrtf(sq(aged) + sq(params.windAltitudeNoise) * 500), windKfGetStdDev(&kf, WIND_KF_WIND_X), 1.0f);
+
+    // Growth is capped
+    windKfPredict(&kf, 1e6f, 0);
+    EXPECT_NEAR(1500.0f, windKfGetStdDev(&kf, WIND_KF_WIND_X), 1.0f);
+    EXPECT_EQ(estimate, kf.x[WIND_KF_WIND_X]);
+}
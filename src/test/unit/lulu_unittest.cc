@@ -0,0 +1,251 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/lulu.h"
+    #include "common/maths.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_SAMPLES        20000
+#define BENCHMARK_SAMPLES   200000
+
+// lulu.c before the power of two ring, 2N + 1 sample buffer wrapped with modulo
+
+typedef struct {
+    int windowSize;
+    int windowBufIndex;
+    int N;
+    float luluInterim[32];
+    float luluInterimB[32];
+} refLuluFilter_t;
+
+static void refLuluFilterInit(refLuluFilter_t *filter, int N)
+{
+    filter->N = constrain(N, 1, 15);
+    filter->windowSize = filter->N * 2 + 1;
+    filter->windowBufIndex = 0;
+
+    memset(filter->luluInterim, 0, sizeof(float) * (filter->windowSize));
+    memset(filter->luluInterimB, 0, sizeof(float) * (filter->windowSize));
+}
+
+static float refFixRoad(float *series, float *seriesB, int index, int filterN, int windowSize)
+{
+    float curVal = 0;
+    float curValB = 0;
+    for (int N = 1; N <= filterN; N++) {
+        int indexNeg = (index + windowSize - 2 * N) % windowSize;
+        int curIndex = (indexNeg + 1) % windowSize;
+        float prevVal = series[indexNeg];
+        float prevValB = seriesB[indexNeg];
+        int indexPos = (curIndex + N) % windowSize;
+        for (int i = windowSize - 2 * N; i < windowSize - N; i++) {
+            if (indexPos >= windowSize) {
+                indexPos = 0;
+            }
+            if (curIndex >= windowSize) {
+                curIndex = 0;
+            }
+
+            curVal = series[curIndex];
+            curValB = seriesB[curIndex];
+            float nextVal = series[indexPos];
+            float nextValB = seriesB[indexPos];
+
+            if (prevVal < curVal && curVal > nextVal) {
+                series[curIndex] = MAX(prevVal, nextVal);
+            }
+
+            if (prevValB < curValB && curValB > nextValB) {
+                seriesB[curIndex] = MAX(prevValB, nextValB);
+            }
+            prevVal = curVal;
+            prevValB = curValB;
+            curIndex++;
+            indexPos++;
+        }
+
+        curIndex = (indexNeg + 1) % windowSize;
+        prevVal = series[indexNeg];
+        prevValB = seriesB[indexNeg];
+        indexPos = (curIndex + N) % windowSize;
+        for (int i = windowSize - 2 * N; i < windowSize - N; i++) {
+            if (indexPos >= windowSize) {
+                indexPos = 0;
+            }
+            if (curIndex >= windowSize) {
+                curIndex = 0;
+            }
+
+            curVal = series[curIndex];
+            curValB = seriesB[curIndex];
+            float nextVal = series[indexPos];
+            float nextValB = seriesB[indexPos];
+
+            if (prevVal > curVal && curVal < nextVal) {
+                series[curIndex] = MIN(prevVal, nextVal);
+            }
+
+            if (prevValB > curValB && curValB < nextValB) {
+                seriesB[curIndex] = MIN(prevValB, nextValB);
+            }
+            prevVal = curVal;
+            prevValB = curValB;
+            curIndex++;
+            indexPos++;
+        }
+    }
+    int finalIndex = (index + windowSize - filterN) % windowSize;
+    return (series[finalIndex] - seriesB[finalIndex]) / 2;
+}
+
+static float refLuluFilterApply(refLuluFilter_t *filter, float input)
+{
+    int windowIndex = filter->windowBufIndex;
+    filter->windowBufIndex = (windowIndex + 1) % filter->windowSize;
+    filter->luluInterim[windowIndex] = input;
+    filter->luluInterimB[windowIndex] = -input;
+    return refFixRoad(filter->luluInterim, filter->luluInterimB, windowIndex, filter->N, filter->windowSize);
+}
+
+static float noise(void)
+{
+    return (rand() / (float)RAND_MAX - 0.5f) * 100.0f;
+}
+
+// Gyro like signal: slow sine, noise, occasional spikes and steps
+static float testSignal(int n)
+{
+    float value = 200.0f * sin_approx((n % 628) / 100.0f) + noise();
+
+    if (n % 97 == 0) {
+        value += 2000.0f;
+    }
+    if ((n / 500) % 2) {
+        value -= 300.0f;
+    }
+
+    return value;
+}
+
+static void expectMatchesReference(int N, float (*signal)(int))
+{
+    luluFilter_t filter;
+    refLuluFilter_t reference;
+
+    luluFilterInit(&filter, N);
+    refLuluFilterInit(&reference, N);
+
+    for (int n = 0; n < TEST_SAMPLES; n++) {
+        const float input = signal(n);
+        const float expected = refLuluFilterApply(&reference, input);
+        const float actual = luluFilterApply(&filter, input);
+
+        // Bit exact, compare the representation
+        ASSERT_EQ(0, memcmp(&expected, &actual, sizeof(float))) << "N " << N << " sample " << n << ": " << expected << " != " << actual;
+    }
+}
+
+TEST(LuluFilterTest, MatchesReferenceOnGyroSignal)
+{
+    srand(1);
+    // Out of range N is clamped the same way
+    for (int N = -1; N <= LULU_MAX_N + 2; N++) {
+        expectMatchesReference(N, testSignal);
+    }
+}
+
+static float quantizedNoise(int n)
+{
+    // Many equal neighbours exercise the strict comparisons
+    UNUSED(n);
+    return (float)(rand() % 5);
+}
+
+TEST(LuluFilterTest, MatchesReferenceOnQuantizedSignal)
+{
+    srand(2);
+    for (int N = 1; N <= LULU_MAX_N; N++) {
+        expectMatchesReference(N, quantizedNoise);
+    }
+}
+
+TEST(LuluFilterTest, RemovesSpikes)
+{
+    luluFilter_t filter;
+    luluFilterInit(&filter, 3);
+
+    // Pulses up to N samples wide are removed, output is delayed by N samples
+    for (int n = 0; n < 200; n++) {
+        const float input = (n % 20) < 3 ? 100.0f : 0.0f;
+        EXPECT_FLOAT_EQ(0.0f, luluFilterApply(&filter, input)) << n;
+    }
+
+    // Wider pulses pass
+    float peak = 0.0f;
+    for (int n = 0; n < 40; n++) {
+        peak = MAX(peak, luluFilterApply(&filter, (n % 20) < 8 ? 100.0f : 0.0f));
+    }
+    EXPECT_FLOAT_EQ(100.0f, peak);
+}
+
+TEST(LuluFilterTest, Benchmark)
+{
+    static float input[1024];
+    luluFilter_t filter;
+    refLuluFilter_t reference;
+    float referenceSum = 0.0f;
+    float sum = 0.0f;
+
+    srand(3);
+    for (int n = 0; n < 1024; n++) {
+        input[n] = testSignal(n);
+    }
+
+    for (int N = 1; N <= LULU_MAX_N; N += 7) {
+        refLuluFilterInit(&reference, N);
+        auto start = std::chrono::steady_clock::now();
+        for (int n = 0; n < BENCHMARK_SAMPLES; n++) {
+            referenceSum += refLuluFilterApply(&reference, input[n & 1023]);
+        }
+        const double modulo = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_SAMPLES;
+
+        luluFilterInit(&filter, N);
+        start = std::chrono::steady_clock::now();
+        for (int n = 0; n < BENCHMARK_SAMPLES; n++) {
+            sum += luluFilterApply(&filter, input[n & 1023]);
+        }
+        const double masked = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_SAMPLES;
+
+        printf("LULU N=%d: modulo ring %.1f ns, masked ring %.1f ns per sample\n", N, modulo, masked);
+    }
+
+    EXPECT_EQ(referenceSum, sum);
+}
@@ -0,0 +1,215 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+    #include "common/matrix.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define N   6
+
+// Symmetric positive definite, A = B * B' + I with a fixed B
+static void spdMatrix(float A[N][N])
+{
+    float B[N][N];
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            B[i][j] = sinf(1.0f + i * 7 + j * 3);
+        }
+    }
+
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            A[i][j] = i == j ? 1.0f : 0.0f;
+            for (int k = 0; k < N; k++) {
+                A[i][j] += B[i][k] * B[j][k];
+            }
+        }
+    }
+}
+
+static const float expectedX[N] = { 1.0f, -2.0f, 0.5f, 3.0f, -0.25f, 0.0f };
+
+static void rightHandSide(const float A[N][N], float b[N])
+{
+    matrixMultiplyVector(b, &A[0][0], N, N, expectedX);
+}
+
+TEST(MatrixTest, MultiplyVector)
+{
+    const float A[2][3] = { { 1, 2, 3 }, { -1, 0, 2 } };
+    const float x[3] = { 1, 1, 2 };
+    float y[2];
+
+    matrixMultiplyVector(y, &A[0][0], 2, 3, x);
+    EXPECT_FLOAT_EQ(9.0f, y[0]);
+    EXPECT_FLOAT_EQ(3.0f, y[1]);
+    EXPECT_FLOAT_EQ(6.0f, matrixVectorDotProduct(x, x, 3));
+
+    const float S[2][2] = { { 4, 1 }, { 1, -1 } };
+    EXPECT_FLOAT_EQ(3.0f, matrixTrace(&S[0][0], 2));
+}
+
+TEST(MatrixTest, SymmetricRankOneUpdate)
+{
+    float P[N][N];
+    spdMatrix(P);
+
+    float reference[N][N];
+    memcpy(reference, P, sizeof(P));
+
+    const float x[N] = { 0.5f, -1.0f, 2.0f, 0.0f, 1.5f, -0.5f };
+    matrixSymmetricRankOneUpdate(&P[0][0], N, -0.1f, x);
+
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            EXPECT_NEAR(reference[i][j] - 0.1f * x[i] * x[j], P[i][j], 1e-5f);
+            EXPECT_EQ(P[i][j], P[j][i]);
+        }
+    }
+}
+
+TEST(MatrixTest, CholeskySolve)
+{
+    float A[N][N];
+    float b[N];
+    float x[N];
+    spdMatrix(A);
+    rightHandSide(A, b);
+
+    float L[N][N];
+    memcpy(L, A, sizeof(A));
+    ASSERT_TRUE(matrixCholeskyDecompose(&L[0][0], N));
+
+    // L * L' reproduces A
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j <= i; j++) {
+            float sum = 0;
+            for (int k = 0; k <= j; k++) {
+                sum += L[i][k] * L[j][k];
+            }
+            EXPECT_NEAR(A[i][j], sum, 1e-4f);
+        }
+    }
+
+    matrixCholeskySolve(&L[0][0], N, b, x);
+    for (int i = 0; i < N; i++) {
+        EXPECT_NEAR(expectedX[i], x[i], 1e-4f) << i;
+    }
+
+    // In place
+    matrixCholeskySolve(&L[0][0], N, b, b);
+    for (int i = 0; i < N; i++) {
+        EXPECT_FLOAT_EQ(x[i], b[i]);
+    }
+}
+
+TEST(MatrixTest, LdltSolve)
+{
+    float A[N][N];
+    float b[N];
+    float x[N];
+    spdMatrix(A);
+    rightHandSide(A, b);
+
+    ASSERT_TRUE(matrixLdltDecompose(&A[0][0], N));
+    matrixLdltSolve(&A[0][0], N, b, x);
+    for (int i = 0; i < N; i++) {
+        EXPECT_NEAR(expectedX[i], x[i], 1e-4f) << i;
+    }
+}
+
+TEST(MatrixTest, LuSolve)
+{
+    float A[N][N];
+    float b[N];
+    float x[N];
+    spdMatrix(A);
+    // Not symmetric any more
+    A[0][3] += 2.0f;
+    A[4][1] -= 1.0f;
+    rightHandSide(A, b);
+
+    ASSERT_TRUE(matrixLuDecompose(&A[0][0], N));
+    matrixLuSolve(&A[0][0], N, b, x);
+    for (int i = 0; i < N; i++) {
+        EXPECT_NEAR(expectedX[i], x[i], 1e-4f) << i;
+    }
+}
+
+TEST(MatrixTest, RejectsSingular)
+{
+    float A[N][N];
+    spdMatrix(A);
+    // Last row and column repeat the first
+    for (int i = 0; i < N; i++) {
+        A[N - 1][i] = A[0][i];
+        A[i][N - 1] = A[i][0];
+    }
+    A[N - 1][N - 1] = A[0][0];
+
+    float L[N][N];
+    memcpy(L, A, sizeof(A));
+    EXPECT_FALSE(matrixCholeskyDecompose(&L[0][0], N));
+    memcpy(L, A, sizeof(A));
+    EXPECT_FALSE(matrixLdltDecompose(&L[0][0], N));
+
+    // Indefinite
+    float B[2][2] = { { 1, 2 }, { 2, 1 } };
+    EXPECT_FALSE(matrixCholeskyDecompose(&B[0][0], 2));
+}
+
+TEST(MatrixTest, SensorCalibrationOffset)
+{
+    sensorCalibrationState_t calState;
+    const float offset[3] = { 120.0f, -45.0f, 300.0f };
+    const float radius = 450.0f;
+    float result[3];
+
+    sensorCalibrationResetState(&calState);
+    for (int n = 0; n < 200; n++) {
+        const float yaw = n * 0.37f;
+        const float pitch = sinf(n * 0.11f) * 1.4f;
+        float sample[3] = {
+            offset[0] + radius * cosf(pitch) * cosf(yaw),
+            offset[1] + radius * cosf(pitch) * sinf(yaw),
+            offset[2] + radius * sinf(pitch),
+        };
+        sensorCalibrationPushSampleForOffsetCalculation(&calState, sample);
+    }
+
+    ASSERT_TRUE(sensorCalibrationSolveForOffset(&calState, result));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(offset[i], result[i], 0.5f) << i;
+    }
+
+    // Not enough samples to define a sphere
+    sensorCalibrationResetState(&calState);
+    float sample[3] = { 1, 2, 3 };
+    sensorCalibrationPushSampleForOffsetCalculation(&calState, sample);
+    EXPECT_FALSE(sensorCalibrationSolveForOffset(&calState, result));
+}
@@ -0,0 +1,368 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <math.h>
+
+extern "C" {
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "navigation/navigation_pos_estimator_ekf.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LOOP_RATE_HZ    1000
+#define GPS_RATE_HZ     10
+#define PITOT_RATE_HZ   10
+
+static const posEkfParams_t testParams = {
+    .accNoise = 35.0f,
+    .accBiasNoise = 0.5f,
+    .windNoise = 10.0f,
+    .innovationGate = 5.0f,
+};
+
+// Deterministic gaussian noise (Box-Muller over a LCG) so the replay is reproducible
+static uint32_t noiseSeed;
+
+static float noiseUniform(void)
+{
+    noiseSeed = noiseSeed * 1664525u + 1013904223u;
+    return ((noiseSeed >> 8) + 0.5f) / 16777216.0f;
+}
+
+static float noiseGaussian(float sigma)
+{
+    return sigma * sqrtf(-2.0f * logf(noiseUniform())) * cosf(2.0f * M_PIf * noiseUniform());
+}
+
+typedef struct {
+    fpVector3_t pos;
+    fpVector3_t vel;
+    fpVector3_t acc;
+} truthSample_t;
+
+// Fixed-wing circling at constant airspeed in constant wind
+static truthSample_t circleTrajectory(float t, float airspeed, float radius, float windX, float windY)
+{
+    const float omega = airspeed / radius;
+    truthSample_t s;
+
+    s.vel.x = -airspeed * sinf(omega * t) + windX;
+    s.vel.y =  airspeed * cosf(omega * t) + windY;
+    s.vel.z = 0.0f;
+    s.pos.x = radius * cosf(omega * t) + windX * t;
+    s.pos.y = radius * sinf(omega * t) + windY * t;
+    s.pos.z = 10000.0f;
+    s.acc.x = -airspeed * omega * cosf(omega * t);
+    s.acc.y = -airspeed * omega * sinf(omega * t);
+    s.acc.z = 0.0f;
+
+    return s;
+}
+
+static void initAtTruth(posEkf_t *ekf, const truthSample_t *truth)
+{
+    posEkfInit(ekf, &testParams);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        posEkfResetState(ekf, (posEkfState_e)POS_EKF_POS(axis), truth->pos.v[axis], sq(200.0f));
+        posEkfResetState(ekf, (posEkfState_e)POS_EKF_VEL(axis), truth->vel.v[axis], sq(50.0f));
+    }
+}
+
+TEST(PositionEkfTest, CovarianceStaysSymmetric)
+{
+    posEkf_t ekf;
+    posEkfInit(&ekf, &testParams);
+
+    const fpVector3_t acc = { .v = { 10.0f, -20.0f, 5.0f } };
+    for (int i = 0; i < 500; i++) {
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+        if (i % 50 == 0) {
+            posEkfFuseState(&ekf, POS_EKF_POS_X, 0.0f, sq(300.0f));
+            posEkfFuseState(&ekf, POS_EKF_VEL_Y, 0.0f, sq(50.0f));
+            posEkfFuseAirspeed(&ekf, 1500.0f, sq(150.0f));
+        }
+    }
+
+    for (int i = 0; i < POS_EKF_STATE_COUNT; i++) {
+        EXPECT_GT(ekf.P[i][i], 0.0f);
+        for (int j = 0; j < POS_EKF_STATE_COUNT; j++) {
+            EXPECT_FLOAT_EQ(ekf.P[i][j], ekf.P[j][i]);
+        }
+    }
+}
+
+TEST(PositionEkfTest, ResetDecorrelatesState)
+{
+    posEkf_t ekf;
+    posEkfInit(&ekf, &testParams);
+
+    const fpVector3_t acc = { .v = { 0.0f, 0.0f, 0.0f } };
+    for (int i = 0; i < 100; i++) {
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+    }
+    EXPECT_NE(ekf.P[POS_EKF_POS_X][POS_EKF_VEL_X], 0.0f);
+
+    posEkfResetState(&ekf, POS_EKF_POS_X, 123.0f, 400.0f);
+    EXPECT_FLOAT_EQ(ekf.x[POS_EKF_POS_X], 123.0f);
+    EXPECT_FLOAT_EQ(ekf.P[POS_EKF_POS_X][POS_EKF_POS_X], 400.0f);
+    EXPECT_FLOAT_EQ(ekf.P[POS_EKF_POS_X][POS_EKF_VEL_X], 0.0f);
+    EXPECT_FLOAT_EQ(ekf.P[POS_EKF_VEL_X][POS_EKF_POS_X], 0.0f);
+}
+
+TEST(PositionEkfTest, EstimatesAccelerometerBias)
+{
+    posEkf_t ekf;
+    truthSample_t truth = {};
+    initAtTruth(&ekf, &truth);
+
+    const fpVector3_t bias = { .v = { 15.0f, -10.0f, 25.0f } };
+    noiseSeed = 1;
+
+    for (int i = 0; i < 120 * LOOP_RATE_HZ; i++) {
+        fpVector3_t acc;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            acc.v[axis] = bias.v[axis] + noiseGaussian(30.0f);
+        }
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+
+        if (i % (LOOP_RATE_HZ / GPS_RATE_HZ) == 0) {
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_POS(axis), noiseGaussian(150.0f), sq(150.0f));
+                posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_VEL(axis), noiseGaussian(30.0f), sq(50.0f));
+            }
+        }
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(ekf.x[POS_EKF_ACC_BIAS(axis)], bias.v[axis], 3.0f);
+        EXPECT_NEAR(ekf.x[POS_EKF_VEL(axis)], 0.0f, 30.0f);
+    }
+}
+
+TEST(PositionEkfTest, EstimatesWindFromAirspeed)
+{
+    const float airspeed = 1500.0f;
+    const float windX = 400.0f;
+    const float windY = -250.0f;
+
+    posEkf_t ekf;
+    truthSample_t truth = circleTrajectory(0.0f, airspeed, 20000.0f, windX, windY);
+    initAtTruth(&ekf, &truth);
+    noiseSeed = 2;
+
+    for (int i = 0; i < 300 * LOOP_RATE_HZ; i++) {
+        const float t = (float)i / LOOP_RATE_HZ;
+        truth = circleTrajectory(t, airspeed, 20000.0f, windX, windY);
+
+        fpVector3_t acc;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            acc.v[axis] = truth.acc.v[axis] + noiseGaussian(30.0f);
+        }
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+
+        if (i % (LOOP_RATE_HZ / GPS_RATE_HZ) == 0) {
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_POS(axis), truth.pos.v[axis] + noiseGaussian(150.0f), sq(150.0f));
+                posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_VEL(axis), truth.vel.v[axis] + noiseGaussian(30.0f), sq(50.0f));
+            }
+        }
+
+        if (i % (LOOP_RATE_HZ / PITOT_RATE_HZ) == 5) {
+            posEkfFuseAirspeed(&ekf, airspeed + noiseGaussian(100.0f), sq(150.0f));
+        }
+    }
+
+    EXPECT_NEAR(ekf.x[POS_EKF_WIND_X], windX, 60.0f);
+    EXPECT_NEAR(ekf.x[POS_EKF_WIND_Y], windY, 60.0f);
+    EXPECT_LT(posEkfGetStdDev(&ekf, POS_EKF_WIND_X), 100.0f);
+}
+
+TEST(PositionEkfTest, RejectsGpsGlitch)
+{
+    posEkf_t ekf;
+    truthSample_t truth = {};
+    initAtTruth(&ekf, &truth);
+
+    const fpVector3_t acc = { .v = { 0.0f, 0.0f, 0.0f } };
+    for (int i = 0; i < 10 * LOOP_RATE_HZ; i++) {
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+        if (i % (LOOP_RATE_HZ / GPS_RATE_HZ) == 0) {
+            posEkfFuseState(&ekf, POS_EKF_POS_X, 0.0f, sq(150.0f));
+            posEkfFuseState(&ekf, POS_EKF_VEL_X, 0.0f, sq(50.0f));
+        }
+    }
+
+    const uint32_t rejectedBefore = ekf.rejectedCount;
+    EXPECT_FALSE(posEkfFuseState(&ekf, POS_EKF_POS_X, 5000.0f, sq(150.0f)));
+    EXPECT_EQ(ekf.rejectedCount, rejectedBefore + 1);
+    EXPECT_NEAR(ekf.x[POS_EKF_POS_X], 0.0f, 50.0f);
+    EXPECT_TRUE(posEkfFuseState(&ekf, POS_EKF_POS_X, 100.0f, sq(150.0f)));
+}
+
+// GPS reporting position with a latency must not drag the estimate behind truth
+TEST(PositionEkfTest, DelayedFusionHasNoLag)
+{
+    const int delaySamples = LOOP_RATE_HZ / 5;  // 200ms
+    const float velocity = 1500.0f;
+    float posHistory[LOOP_RATE_HZ];
+
+    posEkf_t ekf;
+    truthSample_t truth = {};
+    truth.vel.x = velocity;
+    initAtTruth(&ekf, &truth);
+
+    const fpVector3_t acc = { .v = { 0.0f, 0.0f, 0.0f } };
+    for (int i = 0; i < 30 * LOOP_RATE_HZ; i++) {
+        const float t = (float)i / LOOP_RATE_HZ;
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+        posHistory[i % LOOP_RATE_HZ] = ekf.x[POS_EKF_POS_X];
+
+        if (i >= delaySamples && i % (LOOP_RATE_HZ / GPS_RATE_HZ) == 0) {
+            const float delayedEstimate = posHistory[(i - delaySamples) % LOOP_RATE_HZ];
+            const float posBeforeUpdate = ekf.x[POS_EKF_POS_X];
+            posEkfFuseStateDelayed(&ekf, POS_EKF_POS_X, velocity * (t - 0.2f), delayedEstimate, sq(150.0f));
+            posEkfFuseStateDelayed(&ekf, POS_EKF_VEL_X, velocity, ekf.x[POS_EKF_VEL_X], sq(50.0f));
+
+            // Correction is applied to the whole history window
+            const float correction = ekf.x[POS_EKF_POS_X] - posBeforeUpdate;
+            for (int k = 0; k < LOOP_RATE_HZ; k++) {
+                posHistory[k] += correction;
+            }
+        }
+    }
+
+    EXPECT_NEAR(ekf.x[POS_EKF_POS_X], velocity * (30 * LOOP_RATE_HZ - 1) / LOOP_RATE_HZ, 30.0f);
+}
+
+// After GPS is lost, optical flow velocity keeps a biased accelerometer from running away
+TEST(PositionEkfTest, FlowVelocityHoldsWithoutGps)
+{
+    const int flowRateHz = 20;
+
+    posEkf_t ekf;
+    truthSample_t truth = {};
+    initAtTruth(&ekf, &truth);
+
+    const fpVector3_t bias = { .v = { 20.0f, -15.0f, 0.0f } };
+    float posStdDevAtGpsLoss = 0.0f;
+    noiseSeed = 3;
+
+    for (int i = 0; i < 90 * LOOP_RATE_HZ; i++) {
+        fpVector3_t acc;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            acc.v[axis] = bias.v[axis] + noiseGaussian(30.0f);
+        }
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+
+        if (i == 30 * LOOP_RATE_HZ) {
+            posStdDevAtGpsLoss = posEkfGetStdDev(&ekf, POS_EKF_POS_X);
+        }
+
+        if (i < 30 * LOOP_RATE_HZ) {
+            if (i % (LOOP_RATE_HZ / GPS_RATE_HZ) == 0) {
+                for (int axis = X; axis <= Y; axis++) {
+                    posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_POS(axis), noiseGaussian(150.0f), sq(150.0f));
+                    posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_VEL(axis), noiseGaussian(30.0f), sq(50.0f));
+                }
+            }
+        }
+        else if (i % (LOOP_RATE_HZ / flowRateHz) == 0) {
+            for (int axis = X; axis <= Y; axis++) {
+                posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_VEL(axis), noiseGaussian(20.0f), sq(30.0f));
+            }
+        }
+    }
+
+    // 60s without a position reference: velocity stays bounded, position drifts slowly and the filter knows it
+    for (int axis = X; axis <= Y; axis++) {
+        EXPECT_NEAR(ekf.x[POS_EKF_VEL(axis)], 0.0f, 20.0f) << "axis " << axis;
+        EXPECT_NEAR(ekf.x[POS_EKF_POS(axis)], 0.0f, 500.0f) << "axis " << axis;
+        EXPECT_GT(posEkfGetStdDev(&ekf, (posEkfState_e)POS_EKF_POS(axis)), posStdDevAtGpsLoss) << "axis " << axis;
+    }
+}
+
+// Replay a 10 minute flight and report per-update cost and estimation error
+TEST(PositionEkfTest, ReplayBenchmark)
+{
+    const float airspeed = 1800.0f;
+    const int loopCount = 600 * LOOP_RATE_HZ;
+
+    posEkf_t ekf;
+    truthSample_t truth = circleTrajectory(0.0f, airspeed, 30000.0f, 300.0f, 200.0f);
+    initAtTruth(&ekf, &truth);
+    noiseSeed = 3;
+
+    double predictNs = 0.0;
+    double fuseNs = 0.0;
+    int fuseCount = 0;
+    double posErrorSq = 0.0;
+    double velErrorSq = 0.0;
+
+    for (int i = 0; i < loopCount; i++) {
+        const float t = (float)i / LOOP_RATE_HZ;
+        truth = circleTrajectory(t, airspeed, 30000.0f, 300.0f, 200.0f);
+
+        fpVector3_t acc;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            acc.v[axis] = truth.acc.v[axis] + 8.0f + noiseGaussian(30.0f);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        posEkfPredict(&ekf, &acc, true, 1.0f, 1.0f / LOOP_RATE_HZ);
+        predictNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        if (i % (LOOP_RATE_HZ / GPS_RATE_HZ) == 0) {
+            float posMeas[XYZ_AXIS_COUNT];
+            float velMeas[XYZ_AXIS_COUNT];
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                posMeas[axis] = truth.pos.v[axis] + noiseGaussian(150.0f);
+                velMeas[axis] = truth.vel.v[axis] + noiseGaussian(30.0f);
+            }
+
+            start = std::chrono::steady_clock::now();
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_POS(axis), posMeas[axis], sq(150.0f));
+                posEkfFuseState(&ekf, (posEkfState_e)POS_EKF_VEL(axis), velMeas[axis], sq(50.0f));
+            }
+            posEkfFuseAirspeed(&ekf, airspeed + noiseGaussian(100.0f), sq(150.0f));
+            fuseNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            fuseCount += 7;
+        }
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            posErrorSq += sq(ekf.x[POS_EKF_POS(axis)] - truth.pos.v[axis]);
+            velErrorSq += sq(ekf.x[POS_EKF_VEL(axis)] - truth.vel.v[axis]);
+        }
+    }
+
+    const double posRms = sqrt(posErrorSq / loopCount);
+    const double velRms = sqrt(velErrorSq / loopCount);
+
+    printf("[ EKF      ] predict: %.1f ns/update, scalar fuse: %.1f ns/update\n", predictNs / loopCount, fuseNs / fuseCount);
+    printf("[ EKF      ] RMS error: pos %.1f cm, vel %.1f cm/s, rejected %u\n", posRms, velRms, (unsigned)ekf.rejectedCount);
+
+    EXPECT_LT(posRms, 150.0);
+    EXPECT_LT(velRms, 40.0);
+}
@@ -0,0 +1,155 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "navigation/navigation.h"
+    #include "navigation/navigation_terrain.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static gpsOrigin_t origin;
+
+static void resetGrid(void)
+{
+    origin.valid = true;
+    origin.scale = 0.7f;
+    origin.lat = 470000000;
+    origin.lon = 80000000;
+    origin.alt = 45000;
+    terrainGridReset();
+}
+
+// A hill side at 450m, rising 10cm per m to the north and 5cm per m to the east
+static float slope(float x, float y)
+{
+    return 45000.0f + 0.1f * x + 0.05f * y;
+}
+
+TEST(TerrainGridTest, LearnsAndInterpolates)
+{
+    resetGrid();
+
+    // Lawnmower pattern over 100x100m, a rangefinder hit every 50cm
+    for (float x = -5000; x <= 5000; x += 500) {
+        for (float y = -5000; y <= 5000; y += 50) {
+            terrainGridLearn(&origin, x, y, lrintf(slope(x, y)));
+        }
+    }
+
+    float altitude;
+    for (float x = -4321; x < 4000; x += 777) {
+        for (float y = -3987; y < 4000; y += 913) {
+            ASSERT_TRUE(terrainGridGetAltitude(&origin, x, y, &altitude)) << x << " " << y;
+            // Posts average the hits around them, a plane stays a plane
+            EXPECT_NEAR(slope(x, y), altitude, 30.0f) << x << " " << y;
+        }
+    }
+
+    EXPECT_FALSE(terrainGridGetAltitude(&origin, 20000, 0, &altitude));
+}
+
+TEST(TerrainGridTest, InterpolatesBetweenKnownPostsOnly)
+{
+    resetGrid();
+
+    terrainGridLearn(&origin, 0, 0, 45000);
+    terrainGridLearn(&origin, TERRAIN_GRID_SPACING_CM, 0, 46000);
+
+    float altitude;
+    // Halfway between the two known posts
+    ASSERT_TRUE(terrainGridGetAltitude(&origin, TERRAIN_GRID_SPACING_CM / 2, 100, &altitude));
+    EXPECT_NEAR(45500.0f, altitude, 10.0f);
+
+    // Close to the unknown posts on the east side
+    EXPECT_FALSE(terrainGridGetAltitude(&origin, TERRAIN_GRID_SPACING_CM / 2, TERRAIN_GRID_SPACING_CM * 0.9f, &altitude));
+}
+
+TEST(TerrainGridTest, SeedDoesNotOverrideLearned)
+{
+    resetGrid();
+
+    float altitude;
+    terrainGridSeed(&origin, 0, 0, 50000);
+    ASSERT_TRUE(terrainGridGetAltitude(&origin, 0, 0, &altitude));
+    EXPECT_NEAR(50000.0f, altitude, 10.0f);
+
+    // The first rangefinder hit replaces the seed
+    terrainGridLearn(&origin, 0, 0, 48000);
+    ASSERT_TRUE(terrainGridGetAltitude(&origin, 0, 0, &altitude));
+    EXPECT_NEAR(48000.0f, altitude, 10.0f);
+
+    terrainGridSeed(&origin, 0, 0, 50000);
+    ASSERT_TRUE(terrainGridGetAltitude(&origin, 0, 0, &altitude));
+    EXPECT_NEAR(48000.0f, altitude, 10.0f);
+}
+
+TEST(TerrainGridTest, EvictsLeastRecentlyUsedTile)
+{
+    resetGrid();
+
+    const float tileSize = TERRAIN_TILE_POSTS * TERRAIN_GRID_SPACING_CM;
+    float altitude;
+
+    // Home tile, then a straight line of tiles to the north west, looking back home in between
+    terrainGridLearn(&origin, 0, 0, 45000);
+    for (int i = 1; i <= TERRAIN_TILE_COUNT * 2; i++) {
+        terrainGridLearn(&origin, -i * tileSize, -i * tileSize, 45000 + i * 100);
+        ASSERT_TRUE(terrainGridGetAltitude(&origin, 0, 0, &altitude));
+    }
+
+    EXPECT_EQ(TERRAIN_TILE_COUNT, terrainGridTileCount());
+    EXPECT_NEAR(45000.0f, altitude, 10.0f);
+
+    // The oldest tiles along the line were recycled, the recent ones are kept
+    EXPECT_FALSE(terrainGridGetAltitude(&origin, -tileSize, -tileSize, &altitude));
+    const int last = TERRAIN_TILE_COUNT * 2;
+    ASSERT_TRUE(terrainGridGetAltitude(&origin, -last * tileSize, -last * tileSize, &altitude));
+    EXPECT_NEAR(45000.0f + last * 100, altitude, 10.0f);
+}
+
+TEST(TerrainGridTest, ResetsWhenTheOriginMoves)
+{
+    resetGrid();
+
+    // Posts on both sides of the tile boundary south of the origin
+    for (int x = -1; x <= 0; x++) {
+        for (int y = 0; y <= 1; y++) {
+            terrainGridLearn(&origin, x * TERRAIN_GRID_SPACING_CM, y * TERRAIN_GRID_SPACING_CM, 45000);
+        }
+    }
+    EXPECT_EQ(2, terrainGridTileCount());
+
+    float altitude;
+    ASSERT_TRUE(terrainGridGetAltitude(&origin, -700, 300, &altitude));
+    EXPECT_NEAR(45000.0f, altitude, 10.0f);
+
+    origin.lat += 1000;
+    EXPECT_FALSE(terrainGridGetAltitude(&origin, -700, 300, &altitude));
+    EXPECT_EQ(0, terrainGridTileCount());
+
+    origin.valid = false;
+    terrainGridLearn(&origin, 0, 0, 45000);
+    EXPECT_EQ(0, terrainGridTileCount());
+}
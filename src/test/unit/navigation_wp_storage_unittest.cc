@@ -0,0 +1,217 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "navigation/navigation.h"
+    #include "navigation/navigation_wp_storage.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static std::vector<navWaypoint_t> mission;
+static navWaypointStorage_t storage;
+
+static void missionWaypoint(uint16_t wpNumber, navWaypoint_t *wp)
+{
+    *wp = mission[wpNumber - 1];
+}
+
+static void expectStoredMission(void)
+{
+    navWaypointStorageCursor_t cursor;
+    navWaypoint_t wp;
+
+    navWpStorageRewind(&cursor);
+    for (size_t i = 0; i < mission.size(); i++) {
+        ASSERT_TRUE(navWpStorageRead(&storage, &cursor, &wp)) << i;
+        EXPECT_EQ(mission[i].action, wp.action) << i;
+        EXPECT_EQ(mission[i].lat, wp.lat) << i;
+        EXPECT_EQ(mission[i].lon, wp.lon) << i;
+        EXPECT_EQ(mission[i].alt, wp.alt) << i;
+        EXPECT_EQ(mission[i].p1, wp.p1) << i;
+        EXPECT_EQ(mission[i].p2, wp.p2) << i;
+        EXPECT_EQ(mission[i].p3, wp.p3) << i;
+        EXPECT_EQ(mission[i].flag, wp.flag) << i;
+    }
+    EXPECT_FALSE(navWpStorageRead(&storage, &cursor, &wp));
+}
+
+// Lawnmower survey of a rotated rectangle, 45 degrees north
+static void addSurvey(int legs, float legLength, float spacing, float rotation)
+{
+    const int32_t originLat = 450000000;
+    const int32_t originLon = 90000000;
+    const float cs = cosf(rotation), sn = sinf(rotation);
+
+    for (int leg = 0; leg < legs; leg++) {
+        for (int end = 0; end < 2; end++) {
+            // meters in the survey frame, the second point of each leg flies back
+            const float along = ((leg & 1) ? 1 - end : end) * legLength;
+            const float across = leg * spacing;
+            const float north = along * cs - across * sn;
+            const float east = along * sn + across * cs;
+
+            navWaypoint_t wp = { };
+            wp.action = NAV_WP_ACTION_WAYPOINT;
+            wp.lat = originLat + (int32_t)lrintf(north / 0.0111f);
+            wp.lon = originLon + (int32_t)lrintf(east / 0.0111f / 0.7071f);
+            wp.alt = 8000;
+            wp.p3 = NAV_WP_ALTMODE;
+            mission.push_back(wp);
+        }
+    }
+    mission.back().flag = NAV_WP_FLAG_LAST;
+}
+
+class WaypointStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mission.clear();
+        memset(&storage, 0, sizeof(storage));
+    }
+};
+
+TEST_F(WaypointStorageTest, EmptyStorageHasNoWaypoints)
+{
+    navWaypointStorageCursor_t cursor;
+    navWaypoint_t wp;
+
+    navWpStorageRewind(&cursor);
+    EXPECT_FALSE(navWpStorageRead(&storage, &cursor, &wp));
+}
+
+TEST_F(WaypointStorageTest, AllActionsAndFieldsRoundTrip)
+{
+    const navWaypoint_t waypoints[] = {
+        { 474000000, 85000000, 5000, 0, 0, 0, NAV_WP_ACTION_WAYPOINT, 0 },
+        { 474001000, 85002000, 5000, 30, 0, 1, NAV_WP_ACTION_HOLD_TIME, 0 },
+        { 0, 0, 0, 90, 0, 0, NAV_WP_ACTION_SET_HEAD, 0 },
+        { 474005000, 85000000, 2000, 0, 0, 0, NAV_WP_ACTION_SET_POI, 0 },
+        { 0, 0, 0, 1, 3, 0, NAV_WP_ACTION_JUMP, 0 },
+        { -899999999, -1799999999, -100000, -32768, 32767, -1, NAV_WP_ACTION_LAND, NAV_WP_FLAG_HOME },
+        { 899999999, 1799999999, INT32_MAX, 0, 0, 0, 2, 0x11 },
+        { 0, 0, 0, 0, 0, 0, NAV_WP_ACTION_RTH, NAV_WP_FLAG_LAST },
+    };
+    mission.assign(waypoints, waypoints + sizeof(waypoints) / sizeof(waypoints[0]));
+
+    ASSERT_TRUE(navWpStorageStore(&storage, mission.size(), missionWaypoint));
+    EXPECT_EQ(mission.size(), storage.waypointCount);
+    EXPECT_EQ(1, storage.missionCount);
+    expectStoredMission();
+}
+
+TEST_F(WaypointStorageTest, RandomWaypointsRoundTrip)
+{
+    srand(1234);
+    for (int i = 0; i < 80; i++) {
+        navWaypoint_t wp;
+        wp.action = rand() % 10;
+        wp.lat = (int32_t)((uint32_t)rand() << 16 ^ (uint32_t)rand());
+        wp.lon = (rand() & 3) ? (int32_t)((uint32_t)rand() << 16 ^ (uint32_t)rand()) : 0;
+        wp.alt = (rand() & 1) ? rand() - RAND_MAX / 2 : 0;
+        wp.p1 = rand();
+        wp.p2 = (rand() & 1) ? rand() : 0;
+        wp.p3 = rand();
+        wp.flag = (rand() & 1) ? NAV_WP_FLAG_LAST : rand();
+        mission.push_back(wp);
+    }
+
+    ASSERT_TRUE(navWpStorageStore(&storage, mission.size(), missionWaypoint));
+    expectStoredMission();
+}
+
+TEST_F(WaypointStorageTest, SurveyMissionsPackSmall)
+{
+    // 2 x 300 waypoints of 500m legs at 20m spacing, axis aligned and rotated
+    addSurvey(150, 500, 20, 0);
+    addSurvey(150, 500, 20, 0.6f);
+
+    ASSERT_TRUE(navWpStorageStore(&storage, mission.size(), missionWaypoint));
+    EXPECT_EQ(600, storage.waypointCount);
+    EXPECT_EQ(2, storage.missionCount);
+    expectStoredMission();
+
+    // A 20 byte waypoint packs into a few bytes
+    EXPECT_LE(storage.size, 600 * 4) << storage.waypointCount << " waypoints in " << storage.size << " bytes";
+}
+
+TEST_F(WaypointStorageTest, CountsMoreMissionsThanAByte)
+{
+    // 300 single leg missions
+    for (int i = 0; i < 300; i++) {
+        addSurvey(1, 100, 20, 0);
+    }
+
+    ASSERT_TRUE(navWpStorageStore(&storage, mission.size(), missionWaypoint));
+    EXPECT_EQ(300, storage.missionCount);
+    expectStoredMission();
+}
+
+TEST_F(WaypointStorageTest, TooLargeMissionKeepsStoredOne)
+{
+    addSurvey(2, 500, 20, 0);
+    ASSERT_TRUE(navWpStorageStore(&storage, mission.size(), missionWaypoint));
+    const navWaypointStorage_t stored = storage;
+
+    // Random positions do not pack
+    mission.clear();
+    srand(42);
+    for (int i = 0; i < NAV_WP_STORAGE_SIZE / 8; i++) {
+        navWaypoint_t wp = { };
+        wp.action = NAV_WP_ACTION_WAYPOINT;
+        wp.lat = rand();
+        wp.lon = rand();
+        wp.alt = rand();
+        mission.push_back(wp);
+    }
+
+    EXPECT_FALSE(navWpStorageStore(&storage, mission.size(), missionWaypoint));
+    EXPECT_EQ(0, memcmp(&stored, &storage, sizeof(storage)));
+}
+
+TEST_F(WaypointStorageTest, CorruptDataIsRejected)
+{
+    addSurvey(4, 500, 20, 0);
+    ASSERT_TRUE(navWpStorageStore(&storage, mission.size(), missionWaypoint));
+
+    // Claims more waypoints than the data holds
+    storage.waypointCount += 1;
+
+    navWaypointStorageCursor_t cursor;
+    navWaypoint_t wp;
+    navWpStorageRewind(&cursor);
+    for (size_t i = 0; i < mission.size(); i++) {
+        EXPECT_TRUE(navWpStorageRead(&storage, &cursor, &wp));
+    }
+    EXPECT_FALSE(navWpStorageRead(&storage, &cursor, &wp));
+
+    // Truncated varint
+    navWpStorageRewind(&cursor);
+    storage.size = 2;
+    EXPECT_FALSE(navWpStorageRead(&storage, &cursor, &wp));
+}
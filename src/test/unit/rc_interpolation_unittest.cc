@@ -0,0 +1,217 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "fc/rc_interpolation.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// CRSF 500 Hz with a transmitter clock slightly off and UART/scheduling jitter
+#define FRAME_PERIOD_US 2003.0f
+#define JITTER_US       100
+
+static timeUs_t jitteredFrameTime(int frame, timeUs_t startUs)
+{
+    const int jitter = (rand() % (2 * JITTER_US + 1)) - JITTER_US;
+    return startUs + (timeUs_t)lrintf(frame * FRAME_PERIOD_US) + jitter;
+}
+
+TEST(RcInterpolationTest, PllLocksAndFiltersJitter)
+{
+    rcFramePll_t pll;
+    rcFramePllReset(&pll);
+
+    srand(1);
+    // Start close to the timer wrap
+    const timeUs_t startUs = 0xFFFFFFFF - 100000;
+    float phaseErrorSq = 0;
+    float jitterSq = 0;
+    int count = 0;
+
+    for (int frame = 0; frame < 2000; frame++) {
+        const timeUs_t frameTimeUs = jitteredFrameTime(frame, startUs);
+        rcFramePllUpdate(&pll, frameTimeUs);
+
+        if (frame >= 200) {
+            const timeUs_t idealTimeUs = startUs + (timeUs_t)lrintf(frame * FRAME_PERIOD_US);
+            const float phaseErrorUs = cmpTimeUs(pll.frameTimeUs, idealTimeUs);
+            const float jitterUs = cmpTimeUs(frameTimeUs, idealTimeUs);
+            phaseErrorSq += phaseErrorUs * phaseErrorUs;
+            jitterSq += jitterUs * jitterUs;
+            count++;
+        }
+    }
+
+    EXPECT_TRUE(pll.locked);
+    EXPECT_NEAR(FRAME_PERIOD_US, pll.periodUs, 5.0f);
+
+    // Uniform jitter of +-100 us has 58 us RMS, the estimated frame times are a lot closer
+    const float jitterRmsUs = sqrtf(jitterSq / count);
+    const float phaseRmsUs = sqrtf(phaseErrorSq / count);
+    EXPECT_NEAR(58.0f, jitterRmsUs, 3.0f);
+    EXPECT_LT(phaseRmsUs, 0.5f * jitterRmsUs);
+}
+
+TEST(RcInterpolationTest, PllBridgesLostFrames)
+{
+    rcFramePll_t pll;
+    rcFramePllReset(&pll);
+
+    for (int frame = 0; frame < 100; frame++) {
+        rcFramePllUpdate(&pll, frame * 2000);
+    }
+    EXPECT_TRUE(pll.locked);
+
+    // Three frames lost
+    rcFramePllUpdate(&pll, 103 * 2000);
+    EXPECT_TRUE(pll.locked);
+    EXPECT_EQ(103u * 2000, pll.frameTimeUs);
+    EXPECT_NEAR(2000.0f, pll.periodUs, 0.01f);
+
+    // Link gone for too long, start over
+    rcFramePllUpdate(&pll, 200 * 2000);
+    EXPECT_FALSE(pll.locked);
+    EXPECT_FLOAT_EQ(1.0f, rcFramePllGetFraction(&pll, 200 * 2000 + 500));
+}
+
+TEST(RcInterpolationTest, PllFollowsRateChange)
+{
+    rcFramePll_t pll;
+    rcFramePllReset(&pll);
+    timeUs_t timeUs = 0;
+
+    for (int frame = 0; frame < 100; frame++) {
+        rcFramePllUpdate(&pll, timeUs);
+        timeUs += 2000;
+    }
+
+    // 500 Hz to 250 Hz
+    for (int frame = 0; frame < 100; frame++) {
+        rcFramePllUpdate(&pll, timeUs);
+        timeUs += 4000;
+    }
+    EXPECT_TRUE(pll.locked);
+    EXPECT_NEAR(4000.0f, pll.periodUs, 1.0f);
+
+    // And back up to 1 kHz
+    for (int frame = 0; frame < 100; frame++) {
+        rcFramePllUpdate(&pll, timeUs);
+        timeUs += 1000;
+    }
+    EXPECT_TRUE(pll.locked);
+    EXPECT_NEAR(1000.0f, pll.periodUs, 1.0f);
+}
+
+TEST(RcInterpolationTest, FractionIsBounded)
+{
+    rcFramePll_t pll;
+    rcFramePllReset(&pll);
+
+    EXPECT_FLOAT_EQ(1.0f, rcFramePllGetFraction(&pll, 0));
+
+    for (int frame = 0; frame < 50; frame++) {
+        rcFramePllUpdate(&pll, 10000 + frame * 2000);
+    }
+
+    const timeUs_t lastUs = 10000 + 49 * 2000;
+    EXPECT_FLOAT_EQ(0.0f, rcFramePllGetFraction(&pll, lastUs - 100));
+    EXPECT_NEAR(0.25f, rcFramePllGetFraction(&pll, lastUs + 500), 0.001f);
+    // A late frame holds the newest sample, no extrapolation
+    EXPECT_FLOAT_EQ(1.0f, rcFramePllGetFraction(&pll, lastUs + 5000));
+}
+
+TEST(RcInterpolationTest, LinearInterpolation)
+{
+    rcInterpolator_t interpolator;
+    rcInterpolatorReset(&interpolator, 100);
+
+    rcInterpolatorPush(&interpolator, 200);
+    EXPECT_FLOAT_EQ(100.0f, rcInterpolatorApplyLinear(&interpolator, 0.0f));
+    EXPECT_FLOAT_EQ(150.0f, rcInterpolatorApplyLinear(&interpolator, 0.5f));
+    EXPECT_FLOAT_EQ(200.0f, rcInterpolatorApplyLinear(&interpolator, 1.0f));
+
+    rcInterpolatorReplace(&interpolator, 300);
+    EXPECT_FLOAT_EQ(200.0f, rcInterpolatorApplyLinear(&interpolator, 0.5f));
+}
+
+TEST(RcInterpolationTest, CubicRampIsLinear)
+{
+    rcInterpolator_t interpolator;
+    rcInterpolatorReset(&interpolator, 0);
+
+    rcInterpolatorPush(&interpolator, 10);
+    rcInterpolatorPush(&interpolator, 20);
+    rcInterpolatorPush(&interpolator, 30);
+
+    for (float t = 0; t <= 1.0f; t += 0.125f) {
+        EXPECT_NEAR(20.0f + 10.0f * t, rcInterpolatorApplyCubic(&interpolator, t), 1e-4f);
+    }
+}
+
+TEST(RcInterpolationTest, CubicStepDoesNotOvershoot)
+{
+    rcInterpolator_t interpolator;
+    rcInterpolatorReset(&interpolator, 0);
+
+    // Step, then hold
+    for (int frame = 0; frame < 3; frame++) {
+        rcInterpolatorPush(&interpolator, 500);
+
+        float previous = rcInterpolatorApplyCubic(&interpolator, 0.0f);
+        for (float t = 0.05f; t <= 1.0f; t += 0.05f) {
+            const float value = rcInterpolatorApplyCubic(&interpolator, t);
+            EXPECT_GE(value, previous - 1e-4f);
+            EXPECT_LE(value, 500.0f + 1e-4f);
+            previous = value;
+        }
+        EXPECT_FLOAT_EQ(500.0f, rcInterpolatorApplyCubic(&interpolator, 1.0f));
+    }
+}
+
+TEST(RcInterpolationTest, CubicIsContinuousAcrossFrames)
+{
+    rcInterpolator_t interpolator;
+    const float samples[] = { 0, 40, 120, 180, 200, 190, 150, 100 };
+    rcInterpolatorReset(&interpolator, 0);
+
+    float previousEnd = 0;
+    float previousEndSlope = 0;
+    for (unsigned i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        rcInterpolatorPush(&interpolator, samples[i]);
+
+        EXPECT_NEAR(previousEnd, rcInterpolatorApplyCubic(&interpolator, 0.0f), 1e-3f);
+
+        // Slope is continuous while the overshoot limit is inactive (same sign slopes)
+        const float startSlope = (rcInterpolatorApplyCubic(&interpolator, 0.001f) - rcInterpolatorApplyCubic(&interpolator, 0.0f)) / 0.001f;
+        if (i >= 2 && (samples[i] - samples[i - 1]) * (samples[i - 1] - samples[i - 2]) > 0 &&
+            fabsf(samples[i - 1] - samples[i - 2]) <= 3 * fabsf(samples[i] - samples[i - 1])) {
+            EXPECT_NEAR(previousEndSlope, startSlope, 0.5f) << i;
+        }
+
+        previousEnd = rcInterpolatorApplyCubic(&interpolator, 1.0f);
+        previousEndSlope = (rcInterpolatorApplyCubic(&interpolator, 1.0f) - rcInterpolatorApplyCubic(&interpolator, 0.999f)) / 0.001f;
+    }
+}
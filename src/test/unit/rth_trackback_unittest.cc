@@ -0,0 +1,234 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <math.h>
+#include <vector>
+
+// navigation_private.h uses the C11 keyword
+#define _Static_assert static_assert
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+
+    #include "fc/runtime_config.h"
+
+    #include "navigation/navigation.h"
+    #include "navigation/navigation_private.h"
+    #include "navigation/rth_trackback.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+navigationPosControl_t posControl;
+navSystemStatus_t NAV_Status;
+navConfig_t navConfig_System;
+
+static bool waypointReached;
+static fpVector3_t activeWaypointPos;
+}
+
+// Fly a path given in meters, sampled every meter like the navigation loop would see it
+static void flyTo(float x, float y, float z, std::vector<fpVector3_t> *flown)
+{
+    const fpVector3_t from = posControl.actualState.abs.pos;
+    const fpVector3_t to = { .x = x * 100.0f, .y = y * 100.0f, .z = z * 100.0f };
+    const float length = calc_length_pythagorean_3D(to.x - from.x, to.y - from.y, to.z - from.z);
+    const int steps = MAX(1, (int)(length / 100.0f));
+
+    for (int i = 1; i <= steps; i++) {
+        const float t = (float)i / steps;
+        fpVector3_t *pos = &posControl.actualState.abs.pos;
+        const float dxy = calc_length_pythagorean_2D(from.x + t * (to.x - from.x) - pos->x, from.y + t * (to.y - from.y) - pos->y);
+
+        pos->x = from.x + t * (to.x - from.x);
+        pos->y = from.y + t * (to.y - from.y);
+        pos->z = from.z + t * (to.z - from.z);
+        posControl.totalTripDistance += dxy;
+        posControl.homeDistance = calc_length_pythagorean_2D(pos->x, pos->y);
+
+        rthTrackBackUpdate(false);
+        if (flown) {
+            flown->push_back(*pos);
+        }
+    }
+}
+
+// Decoded trackpoints, oldest first
+static std::vector<fpVector3_t> trackPoints(void)
+{
+    std::vector<fpVector3_t> points(rth_trackback.pointCount);
+    fpVector3_t pos = rth_trackback.newestPoint;
+
+    for (int i = rth_trackback.pointCount - 1; i >= 0; i--) {
+        points[i] = pos;
+        pos.x -= rth_trackback.pointsList[i].x * 100.0f;
+        pos.y -= rth_trackback.pointsList[i].y * 100.0f;
+        pos.z -= rth_trackback.pointsList[i].z * 100.0f;
+    }
+    return points;
+}
+
+// XY distance from the trackback polyline [m]
+static float distanceToTrack(const std::vector<fpVector3_t> &track, const fpVector3_t &p)
+{
+    float minDistance = 1e9f;
+    for (size_t i = 1; i < track.size(); i++) {
+        const float dx = track[i].x - track[i - 1].x;
+        const float dy = track[i].y - track[i - 1].y;
+        const float lengthSq = dx * dx + dy * dy;
+        const float t = lengthSq > 0 ? constrainf(((p.x - track[i - 1].x) * dx + (p.y - track[i - 1].y) * dy) / lengthSq, 0.0f, 1.0f) : 0.0f;
+        minDistance = MIN(minDistance, calc_length_pythagorean_2D(track[i - 1].x + t * dx - p.x, track[i - 1].y + t * dy - p.y));
+    }
+    return minDistance / 100.0f;
+}
+
+class RthTrackBackTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        memset(&posControl, 0, sizeof(posControl));
+        memset(&navConfig_System, 0, sizeof(navConfig_System));
+        posControl.flags.estPosStatus = EST_TRUSTED;
+        posControl.flags.estAltStatus = EST_TRUSTED;
+        navConfig_System.general.flags.rth_trackback_mode = RTH_TRACKBACK_ON;
+        navConfig_System.general.rth_trackback_distance = 2000;
+        ENABLE_ARMING_FLAG(ARMED);
+        DISABLE_FLIGHT_MODE(NAV_RTH_MODE);
+        resetRthTrackBack();
+        waypointReached = false;
+    }
+};
+
+TEST_F(RthTrackBackTest, StraightLegsCompressToCorners)
+{
+    std::vector<fpVector3_t> flown;
+
+    posControl.actualState.abs.pos.z = 5000.0f;
+    flyTo(5000, 0, 50, &flown);
+    flyTo(5000, 5000, 50, &flown);
+    flyTo(0, 5000, 150, &flown);
+    rthTrackBackUpdate(true);
+
+    // Start, three corners/ends and a few climb points
+    const std::vector<fpVector3_t> track = trackPoints();
+    EXPECT_LE(track.size(), 8u);
+    EXPECT_NEAR(track.front().x, 5000.0f, 100.0f);
+    EXPECT_NEAR(track.back().x, 0.0f, 100.0f);
+    EXPECT_NEAR(track.back().y, 500000.0f, 100.0f);
+
+    // Every flown position since recording started is within tolerance of the track
+    for (const fpVector3_t &p : flown) {
+        if (calc_length_pythagorean_2D(p.x, p.y) > METERS_TO_CENTIMETERS(NAV_RTH_TRACKBACK_MIN_DIST_TO_START) + 100.0f) {
+            EXPECT_LE(distanceToTrack(track, p), NAV_RTH_TRACKBACK_XY_TOLERANCE + 1) << p.x << " " << p.y;
+        }
+    }
+}
+
+TEST_F(RthTrackBackTest, LongWindingFlightStaysCovered)
+{
+    std::vector<fpVector3_t> flown;
+
+    // 60km zig-zag, far more corners than trackpoints
+    posControl.actualState.abs.pos.z = 10000.0f;
+    for (int leg = 0; leg < 200; leg++) {
+        flyTo(leg * 300.0f, (leg & 1) ? 150.0f : -150.0f, 100, &flown);
+    }
+    rthTrackBackUpdate(true);
+
+    const std::vector<fpVector3_t> track = trackPoints();
+    EXPECT_EQ(NAV_RTH_TRACKBACK_POINTS, track.size());
+
+    // Whole flight still covered, from the first point out of the home area to the last position
+    EXPECT_LT(track.front().x, 10000.0f);
+    EXPECT_NEAR(track.back().x, 199 * 30000.0f, 100.0f);
+
+    float maxDistance = 0;
+    for (const fpVector3_t &p : flown) {
+        if (calc_length_pythagorean_2D(p.x, p.y) > 10000.0f) {
+            maxDistance = MAX(maxDistance, distanceToTrack(track, p));
+        }
+    }
+    // Thinning drops corners, the track stays within the 300m wide zig-zag band
+    EXPECT_LE(maxDistance, 300.0f);
+}
+
+TEST_F(RthTrackBackTest, TrackIsFlownBackNewestFirst)
+{
+    posControl.actualState.abs.pos.z = 5000.0f;
+    flyTo(1000, 0, 50, NULL);
+    flyTo(1000, 1000, 80, NULL);
+    flyTo(0, 1000, 20, NULL);
+    rthTrackBackUpdate(true);
+
+    const std::vector<fpVector3_t> track = trackPoints();
+    ASSERT_GE(track.size(), 3u);
+
+    ENABLE_FLIGHT_MODE(NAV_RTH_MODE);
+    posControl.flags.rthTrackbackActive = true;
+
+    // Start point is where RTH began
+    EXPECT_EQ(track.back().x, getRthTrackBackPosition()->x);
+    EXPECT_EQ(track.back().y, getRthTrackBackPosition()->y);
+
+    waypointReached = true;
+    for (int i = track.size() - 2; i >= 0; i--) {
+        EXPECT_TRUE(rthTrackBackSetNewPosition());
+        EXPECT_EQ(track[i].x, activeWaypointPos.x);
+        EXPECT_EQ(track[i].y, activeWaypointPos.y);
+        // Never lower than the start point
+        EXPECT_GE(activeWaypointPos.z, track.back().z);
+    }
+
+    EXPECT_TRUE(rthTrackBackSetNewPosition());
+    EXPECT_FALSE(rthTrackBackSetNewPosition());
+    EXPECT_FALSE(posControl.flags.rthTrackbackActive);
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t armingFlags;
+uint32_t flightModeFlags;
+uint32_t stateFlags;
+
+uint32_t calculateDistanceToDestination(const fpVector3_t *destinationPos)
+{
+    const fpVector3_t *pos = &posControl.actualState.abs.pos;
+    return calc_length_pythagorean_2D(destinationPos->x - pos->x, destinationPos->y - pos->y);
+}
+
+bool isWaypointReached(const fpVector3_t *, const int32_t *)
+{
+    return waypointReached;
+}
+
+void calculateAndSetActiveWaypointToLocalPosition(const fpVector3_t *pos)
+{
+    activeWaypointPos = *pos;
+}
+
+void setDesiredPosition(const fpVector3_t *, int32_t, navSetWaypointFlags_t) {}
+bool rthAltControlStickOverrideCheck(uint8_t) { return false; }
+
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "sensors/barometer_altitude.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static double exactAltitude(double pressurePa)
+{
+    return (1.0 - pow(pressurePa / 101325.0, 0.190295)) * 4433000.0;
+}
+
+// Single precision formula the table replaces
+static float powfAltitude(float pressurePa)
+{
+    return (1.0f - powf(pressurePa / 101325.0f, 0.190295f)) * 4433000.0f;
+}
+
+// Float rounding of the result alone is up to half an ulp of ~1e6 cm
+#define FLOAT_ROUNDING_CM   0.07
+
+TEST(BarometerAltitudeTest, MatchesStandardAtmosphere)
+{
+    baroAltitudeTableInit();
+
+    // Interpolation error on top of the rounding powf() already has
+    double maxError = 0;
+    double maxErrorLow = 0;
+    double maxPowfError = 0;
+    for (float p = BARO_ALTITUDE_TABLE_MIN_PA; p < BARO_ALTITUDE_TABLE_MAX_PA; p += 0.5f) {
+        const double error = fabs(baroPressureToAltitude(p) - exactAltitude(p));
+        maxPowfError = fmax(maxPowfError, fabs(powfAltitude(p) - exactAltitude(p)));
+        maxError = fmax(maxError, error);
+        if (p > 61640) {
+            // Below 4000 m
+            maxErrorLow = fmax(maxErrorLow, error);
+        }
+    }
+
+    printf("max error %.3f cm, below 4000 m %.3f cm, powf() %.3f cm\n", maxError, maxErrorLow, maxPowfError);
+    EXPECT_LT(maxError, 1.0 + maxPowfError);
+    EXPECT_LT(maxErrorLow, 0.05 + maxPowfError);
+}
+
+TEST(BarometerAltitudeTest, ContinuousAndMonotonic)
+{
+    baroAltitudeTableInit();
+
+    const float segmentPa = (BARO_ALTITUDE_TABLE_MAX_PA - BARO_ALTITUDE_TABLE_MIN_PA) / BARO_ALTITUDE_TABLE_SEGMENTS;
+    for (int i = 1; i < BARO_ALTITUDE_TABLE_SEGMENTS; i++) {
+        const float p = BARO_ALTITUDE_TABLE_MIN_PA + i * segmentPa;
+        EXPECT_NEAR(baroPressureToAltitude(nextafterf(p, 0)), baroPressureToAltitude(p), 0.5f) << i;
+    }
+
+    // 1 Pa is about 8 cm at sea level
+    float previous = baroPressureToAltitude(BARO_ALTITUDE_TABLE_MIN_PA);
+    for (float p = BARO_ALTITUDE_TABLE_MIN_PA + 1; p < BARO_ALTITUDE_TABLE_MAX_PA; p += 1) {
+        const float altitude = baroPressureToAltitude(p);
+        ASSERT_LT(altitude, previous) << p;
+        previous = altitude;
+    }
+}
+
+TEST(BarometerAltitudeTest, OutsideTable)
+{
+    baroAltitudeTableInit();
+
+    EXPECT_NEAR(exactAltitude(101325), baroPressureToAltitude(101325), FLOAT_ROUNDING_CM);
+    EXPECT_NEAR(exactAltitude(20000), baroPressureToAltitude(20000), 1.0);
+    EXPECT_NEAR(exactAltitude(120000), baroPressureToAltitude(120000), 1.0);
+    EXPECT_NEAR(exactAltitude(BARO_ALTITUDE_TABLE_MAX_PA), baroPressureToAltitude(BARO_ALTITUDE_TABLE_MAX_PA), 1.0);
+    EXPECT_NEAR(4433000.0f, baroPressureToAltitude(0), 1.0);
+}
@@ -0,0 +1,241 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "sensors/compass_ellipsoid.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+typedef struct {
+    float offset[3];
+    float distortion[3][3];     // Inverse of the soft iron matrix, unit sphere to ellipsoid
+} magModel_t;
+
+static float uniform(void)
+{
+    return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static void randomDirection(float v[3])
+{
+    float length;
+    do {
+        v[0] = uniform();
+        v[1] = uniform();
+        v[2] = uniform();
+        length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    } while (length > 1.0f || length < 0.1f);
+
+    for (int i = 0; i < 3; i++) {
+        v[i] /= length;
+    }
+}
+
+static void measure(const magModel_t *model, const float field[3], float noise, float sample[3])
+{
+    for (int i = 0; i < 3; i++) {
+        sample[i] = model->offset[i] + uniform() * noise;
+        for (int j = 0; j < 3; j++) {
+            sample[i] += model->distortion[i][j] * field[j];
+        }
+    }
+}
+
+static void feed(magEllipsoidFit_t *fit, const magModel_t *model, int count, float noise)
+{
+    for (int n = 0; n < count; n++) {
+        float field[3];
+        float sample[3];
+        randomDirection(field);
+        measure(model, field, noise, sample);
+        if (magEllipsoidFitUpdate(fit, sample) && fit->sampleCount % 10 == 0) {
+            magEllipsoidFitSolve(fit);
+        }
+    }
+    magEllipsoidFitSolve(fit);
+}
+
+// Corrected field must be the true field, length and direction
+static float maxCorrectionError(const magEllipsoidFit_t *fit, const magModel_t *model)
+{
+    float maxError = 0;
+    for (int n = 0; n < 200; n++) {
+        float field[3];
+        float sample[3];
+        float corrected[3];
+        randomDirection(field);
+        measure(model, field, 0, sample);
+        magEllipsoidFitApply(fit, sample, corrected);
+        for (int i = 0; i < 3; i++) {
+            maxError = fmaxf(maxError, fabsf(corrected[i] - field[i]));
+        }
+    }
+    return maxError;
+}
+
+// Hard iron of a third of the field, symmetric soft iron with ~25% axis difference
+static const magModel_t distortedModel = {
+    .offset = { 0.3f, -0.2f, 0.1f },
+    .distortion = {
+        { 1.10f, 0.08f, -0.05f },
+        { 0.08f, 0.92f, 0.04f },
+        { -0.05f, 0.04f, 1.00f },
+    },
+};
+
+static void initUnitSphere(magEllipsoidFit_t *fit)
+{
+    const float offset[3] = { 0, 0, 0 };
+    const float radius[3] = { 1, 1, 1 };
+    magEllipsoidFitInit(fit, offset, radius, 0.995f);
+}
+
+TEST(CompassEllipsoidTest, PriorFromStoredCalibration)
+{
+    magEllipsoidFit_t fit;
+    const float offset[3] = { 0.1f, -0.2f, 0.05f };
+    const float radius[3] = { 1.2f, 0.9f, 1.0f };
+    magEllipsoidFitInit(&fit, offset, radius, 0.995f);
+
+    ASSERT_TRUE(fit.valid);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(offset[i], fit.offset[i], 1e-5f);
+        EXPECT_NEAR(1.0f / radius[i], fit.softIron[i][i], 1e-5f);
+    }
+    EXPECT_NEAR(0, fit.softIron[0][1], 1e-6f);
+}
+
+TEST(CompassEllipsoidTest, FitsHardAndSoftIron)
+{
+    magEllipsoidFit_t fit;
+    srand(1);
+    initUnitSphere(&fit);
+
+    EXPECT_GT(maxCorrectionError(&fit, &distortedModel), 0.3f);
+
+    feed(&fit, &distortedModel, 1000, 0.005f);
+
+    ASSERT_TRUE(fit.valid);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(distortedModel.offset[i], fit.offset[i], 0.01f) << i;
+    }
+    EXPECT_LT(maxCorrectionError(&fit, &distortedModel), 0.02f);
+    EXPECT_LT(magEllipsoidFitGetQuality(&fit), 0.01f);
+}
+
+TEST(CompassEllipsoidTest, RejectsOutliers)
+{
+    magEllipsoidFit_t fit;
+    srand(2);
+    initUnitSphere(&fit);
+
+    // Every 10th sample is disturbed by half the field, e.g. by motor current
+    for (int n = 0; n < 1500; n++) {
+        float field[3];
+        float sample[3];
+        randomDirection(field);
+        measure(&distortedModel, field, 0.005f, sample);
+        if (n % 10 == 5) {
+            sample[Z] += 0.5f;
+        }
+        if (magEllipsoidFitUpdate(&fit, sample) && fit.sampleCount % 10 == 0) {
+            magEllipsoidFitSolve(&fit);
+        }
+    }
+    magEllipsoidFitSolve(&fit);
+
+    EXPECT_GT(fit.rejectedCount, 100u);
+    EXPECT_LT(fit.rejectedCount, 200u);
+    EXPECT_LT(maxCorrectionError(&fit, &distortedModel), 0.02f);
+}
+
+TEST(CompassEllipsoidTest, FollowsChangedHardIron)
+{
+    magEllipsoidFit_t fit;
+    srand(3);
+    initUnitSphere(&fit);
+    feed(&fit, &distortedModel, 1000, 0.005f);
+    ASSERT_LT(maxCorrectionError(&fit, &distortedModel), 0.02f);
+
+    // Battery moved, a lasting change well outside the outlier gate
+    magModel_t movedModel = distortedModel;
+    movedModel.offset[X] += 0.15f;
+    movedModel.offset[Y] -= 0.1f;
+
+    feed(&fit, &movedModel, 1000, 0.005f);
+    EXPECT_LT(maxCorrectionError(&fit, &movedModel), 0.02f);
+    EXPECT_LT(magEllipsoidFitGetQuality(&fit), 0.01f);
+}
+
+TEST(CompassEllipsoidTest, NoWindupWithoutExcitation)
+{
+    magEllipsoidFit_t fit;
+    srand(4);
+    initUnitSphere(&fit);
+    feed(&fit, &distortedModel, 1000, 0.005f);
+
+    // Level flight, field only turns around Z
+    for (int n = 0; n < 5000; n++) {
+        const float yaw = n * 0.3f;
+        const float field[3] = { 0.6f * cosf(yaw), 0.6f * sinf(yaw), 0.8f };
+        float sample[3];
+        measure(&distortedModel, field, 0.005f, sample);
+        if (magEllipsoidFitUpdate(&fit, sample) && fit.sampleCount % 10 == 0) {
+            magEllipsoidFitSolve(&fit);
+        }
+    }
+    magEllipsoidFitSolve(&fit);
+
+    float trace = 0;
+    for (int i = 0; i < MAG_ELLIPSOID_PARAM_COUNT; i++) {
+        trace += fit.P[i][i];
+    }
+    // Stays at the initial covariance instead of growing without bound
+    EXPECT_LT(trace, 1.0f);
+    ASSERT_TRUE(fit.valid);
+    EXPECT_LT(maxCorrectionError(&fit, &distortedModel), 0.05f);
+}
+
+TEST(CompassEllipsoidTest, RejectsDegenerateSolution)
+{
+    magEllipsoidFit_t fit;
+    initUnitSphere(&fit);
+
+    // Hyperboloid
+    fit.theta[2] = -1.0f;
+    EXPECT_FALSE(magEllipsoidFitSolve(&fit));
+    EXPECT_FALSE(fit.valid);
+
+    // Ellipsoid, but an axis ratio no magnetometer mounting produces
+    initUnitSphere(&fit);
+    fit.theta[0] = 9.0f;
+    EXPECT_FALSE(magEllipsoidFitSolve(&fit));
+
+    initUnitSphere(&fit);
+    fit.theta[0] = 2.0f;
+    EXPECT_TRUE(magEllipsoidFitSolve(&fit));
+    EXPECT_NEAR(sqrtf(2.0f), fit.softIron[0][0], 1e-5f);
+}
@@ -0,0 +1,210 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "sensors/gyro_calibration.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// 1kHz loop, 50ms blocks, 2s window, threshold as in sensors.h
+#define BLOCK_LENGTH    50
+#define WINDOW_BLOCKS   40
+#define THRESHOLD       32.0f
+
+static const float trueZero[XYZ_AXIS_COUNT] = { 12.3f, -7.8f, 3.1f };
+
+static float gaussian(float sigma)
+{
+    // Sum of uniforms, close enough for a noise source
+    float sum = 0;
+    for (int i = 0; i < 12; i++) {
+        sum += rand() / (float)RAND_MAX;
+    }
+    return (sum - 6.0f) * sigma;
+}
+
+// Quantised like a real sensor
+static void sampleAt(const float zero[XYZ_AXIS_COUNT], float noise, float sample[XYZ_AXIS_COUNT])
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        sample[axis] = roundf(zero[axis] + gaussian(noise));
+    }
+}
+
+// Samples until converged, -1 if never
+static int runUntilConverged(gyroZeroEstimator_t *estimator, float noise, int maxSamples, int shockEvery)
+{
+    for (int n = 0; n < maxSamples; n++) {
+        float sample[XYZ_AXIS_COUNT];
+        sampleAt(trueZero, noise, sample);
+        if (shockEvery && n % shockEvery < 10) {
+            // A knock on the bench, 10ms of large rates
+            sample[X] += 400.0f;
+            sample[Z] -= 250.0f;
+        }
+        gyroZeroEstimatorPush(estimator, sample, NAN);
+        if (gyroZeroEstimatorIsConverged(estimator)) {
+            return n + 1;
+        }
+    }
+    return -1;
+}
+
+TEST(GyroCalibrationTest, ConvergesEarlyWhenStill)
+{
+    gyroZeroEstimator_t estimator;
+    srand(1);
+    gyroZeroEstimatorInit(&estimator, BLOCK_LENGTH, WINDOW_BLOCKS, THRESHOLD);
+
+    const int samples = runUntilConverged(&estimator, 3.0f, 10000, 0);
+    ASSERT_GT(samples, 0);
+    // Well under the 2s fixed window
+    EXPECT_LT(samples, 700);
+
+    float zero[XYZ_AXIS_COUNT];
+    gyroZeroEstimatorGetZero(&estimator, NAN, zero);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(trueZero[axis], zero[axis], 0.5f) << axis;
+    }
+}
+
+TEST(GyroCalibrationTest, NoisySurfaceTakesTheWindow)
+{
+    gyroZeroEstimator_t estimator;
+    srand(2);
+    gyroZeroEstimatorInit(&estimator, BLOCK_LENGTH, WINDOW_BLOCKS, THRESHOLD);
+
+    // Vibrating desk, still below the motion threshold
+    const int samples = runUntilConverged(&estimator, 15.0f, 20000, 0);
+    ASSERT_GT(samples, 0);
+    EXPECT_LE(samples, (WINDOW_BLOCKS + 3) * BLOCK_LENGTH);
+
+    float zero[XYZ_AXIS_COUNT];
+    gyroZeroEstimatorGetZero(&estimator, NAN, zero);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(trueZero[axis], zero[axis], 1.0f) << axis;
+    }
+}
+
+TEST(GyroCalibrationTest, KnocksAreRejectedNotRestarted)
+{
+    gyroZeroEstimator_t estimator;
+    srand(3);
+    gyroZeroEstimatorInit(&estimator, BLOCK_LENGTH, WINDOW_BLOCKS, THRESHOLD);
+
+    // A knock every 300ms, the fixed window would restart forever
+    const int samples = runUntilConverged(&estimator, 3.0f, 10000, 300);
+    ASSERT_GT(samples, 0);
+    EXPECT_LT(samples, 1500);
+    EXPECT_GT(estimator.rejectedCount, 0u);
+
+    float zero[XYZ_AXIS_COUNT];
+    gyroZeroEstimatorGetZero(&estimator, NAN, zero);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(trueZero[axis], zero[axis], 0.5f) << axis;
+    }
+}
+
+TEST(GyroCalibrationTest, NoConvergenceWhileHandled)
+{
+    gyroZeroEstimator_t estimator;
+    srand(4);
+    gyroZeroEstimatorInit(&estimator, BLOCK_LENGTH, WINDOW_BLOCKS, THRESHOLD);
+
+    // Slowly swaying in the hand, rates of a few LSB changing over seconds
+    for (int n = 0; n < 10000; n++) {
+        float zero[XYZ_AXIS_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            zero[axis] = trueZero[axis] + 20.0f * sinf(n * 0.002f + axis);
+        }
+        float sample[XYZ_AXIS_COUNT];
+        sampleAt(zero, 3.0f, sample);
+        gyroZeroEstimatorPush(&estimator, sample, NAN);
+    }
+
+    EXPECT_FALSE(gyroZeroEstimatorIsConverged(&estimator));
+}
+
+TEST(GyroCalibrationTest, TracksTemperatureDrift)
+{
+    gyroZeroEstimator_t estimator;
+    srand(5);
+    gyroZeroEstimatorInit(&estimator, BLOCK_LENGTH, WINDOW_BLOCKS, THRESHOLD);
+
+    // 0.5 LSB per degC on X, -0.3 on Z
+    const float slope[XYZ_AXIS_COUNT] = { 0.5f, 0.0f, -0.3f };
+    float temperature = 30.0f;
+    bool converged = false;
+
+    // Board warms up by 8 degC over two minutes on the bench
+    for (int n = 0; n < 120000; n++) {
+        temperature = 30.0f + 8.0f * (1.0f - expf(-n / 40000.0f));
+        float zero[XYZ_AXIS_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            zero[axis] = trueZero[axis] + slope[axis] * (temperature - 30.0f);
+        }
+        float sample[XYZ_AXIS_COUNT];
+        sampleAt(zero, 3.0f, sample);
+        gyroZeroEstimatorPush(&estimator, sample, temperature);
+        converged |= gyroZeroEstimatorIsConverged(&estimator);
+        if (n == 1000) {
+            EXPECT_TRUE(converged);
+        }
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(slope[axis], gyroZeroEstimatorGetTemperatureSlope(&estimator, axis), 0.1f) << axis;
+    }
+
+    // Armed and no longer fed, the board heats up further in flight
+    const float flightTemperature = 45.0f;
+    float zero[XYZ_AXIS_COUNT];
+    gyroZeroEstimatorGetZero(&estimator, flightTemperature, zero);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float expected = trueZero[axis] + slope[axis] * (flightTemperature - 30.0f);
+        EXPECT_NEAR(expected, zero[axis], 1.0f) << axis;
+    }
+}
+
+TEST(GyroCalibrationTest, TrackingIgnoresSlowRotation)
+{
+    gyroZeroEstimator_t estimator;
+    srand(6);
+    gyroZeroEstimatorInit(&estimator, BLOCK_LENGTH, WINDOW_BLOCKS, THRESHOLD);
+    ASSERT_GT(runUntilConverged(&estimator, 3.0f, 10000, 0), 0);
+
+    // Turning slowly on a table at 1 deg/s
+    const float turning[XYZ_AXIS_COUNT] = { trueZero[X], trueZero[Y], trueZero[Z] + 16.4f };
+    for (int n = 0; n < 5000; n++) {
+        float sample[XYZ_AXIS_COUNT];
+        sampleAt(turning, 3.0f, sample);
+        gyroZeroEstimatorPush(&estimator, sample, NAN);
+    }
+
+    float zero[XYZ_AXIS_COUNT];
+    gyroZeroEstimatorGetZero(&estimator, NAN, zero);
+    EXPECT_NEAR(trueZero[Z], zero[Z], 0.5f);
+}
@@ -0,0 +1,123 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+
+    #include "drivers/accgyro/accgyro.h"
+    #include "drivers/accgyro/accgyro_fake.h"
+
+    #include "sensors/gyro_fifo.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static gyroDev_t gyroDev;
+
+static void fakeGyroFifoInit(void)
+{
+    memset(&gyroDev, 0, sizeof(gyroDev));
+    fakeGyroDetect(&gyroDev);
+    fakeGyroSet(0, 0, 0);
+}
+
+TEST(SensorGyroFifoTest, SingleSampleWithoutBatch)
+{
+    fakeGyroFifoInit();
+    fakeGyroSet(100, -200, 300);
+
+    EXPECT_TRUE(gyroFifoRead(&gyroDev));
+    EXPECT_EQ(1, gyroDev.gyroFifoCount);
+    EXPECT_FLOAT_EQ(100, gyroDev.gyroADCRaw[X]);
+    EXPECT_FLOAT_EQ(-200, gyroDev.gyroADCRaw[Y]);
+    EXPECT_FLOAT_EQ(300, gyroDev.gyroADCRaw[Z]);
+}
+
+TEST(SensorGyroFifoTest, BatchIsAveraged)
+{
+    fakeGyroFifoInit();
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(fakeGyroQueueSample(10 * i, -10 * i, 1000));
+    }
+
+    EXPECT_TRUE(gyroFifoRead(&gyroDev));
+    EXPECT_EQ(4, gyroDev.gyroFifoCount);
+    EXPECT_FLOAT_EQ(15, gyroDev.gyroADCRaw[X]);
+    EXPECT_FLOAT_EQ(-15, gyroDev.gyroADCRaw[Y]);
+    EXPECT_FLOAT_EQ(1000, gyroDev.gyroADCRaw[Z]);
+
+    // Batch is consumed, next read falls back to the current value
+    EXPECT_TRUE(gyroFifoRead(&gyroDev));
+    EXPECT_EQ(1, gyroDev.gyroFifoCount);
+    EXPECT_FLOAT_EQ(0, gyroDev.gyroADCRaw[X]);
+}
+
+TEST(SensorGyroFifoTest, FullFifoDropsSamples)
+{
+    fakeGyroFifoInit();
+
+    for (int i = 0; i < GYRO_FIFO_MAX_SAMPLES; i++) {
+        EXPECT_TRUE(fakeGyroQueueSample(8, 8, 8));
+    }
+    EXPECT_FALSE(fakeGyroQueueSample(1000, 1000, 1000));
+
+    EXPECT_TRUE(gyroFifoRead(&gyroDev));
+    EXPECT_EQ(GYRO_FIFO_MAX_SAMPLES, gyroDev.gyroFifoCount);
+    EXPECT_FLOAT_EQ(8, gyroDev.gyroADCRaw[X]);
+}
+
+/*
+ * 8 kHz sensor read by the 4 kHz gyro task: a 4 kHz vibration sampled at
+ * its peaks aliases to a constant offset when only the newest sample is
+ * kept, the average of each pair cancels it.
+ */
+TEST(SensorGyroFifoTest, DecimationRejectsAliasing)
+{
+    const float odrHz = 8000.0f;
+    const float toneHz = 4000.0f;
+    const float amplitude = 500.0f;
+    float newestError = 0.0f;
+    float averageError = 0.0f;
+
+    fakeGyroFifoInit();
+
+    int sample = 0;
+    for (int batch = 0; batch < 1000; batch++) {
+        for (int i = 0; i < 2; i++, sample++) {
+            const float value = 50.0f + amplitude * cosf(2.0f * M_PI * toneHz * sample / odrHz);
+            fakeGyroQueueSample(lrintf(value), 0, 0);
+        }
+
+        ASSERT_TRUE(gyroFifoRead(&gyroDev));
+        ASSERT_EQ(2, gyroDev.gyroFifoCount);
+
+        newestError = fmaxf(newestError, fabsf(gyroDev.gyroFifo[1][X] - 50.0f));
+        averageError = fmaxf(averageError, fabsf(gyroDev.gyroADCRaw[X] - 50.0f));
+    }
+
+    EXPECT_GT(newestError, amplitude * 0.9f);
+    EXPECT_LT(averageError, 1.0f);
+}
@@ -0,0 +1,130 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "sensors/opflow_gyro.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define GYRO_DT_US  500
+
+// Rotation in deg about X and Y after t seconds of a 2Hz oscillation with 100 deg/s amplitude
+static float rotationAt(float t, int axis)
+{
+    const float omega = 4.0f * (float)M_PI;
+    return 100.0f / omega * (1.0f - cosf(omega * t + axis));
+}
+
+static float rateAt(float t, int axis)
+{
+    const float omega = 4.0f * (float)M_PI;
+    return 100.0f * sinf(omega * t + axis);
+}
+
+// Gyro task at 2kHz from a start time, returns the time of the last update
+static timeUs_t runGyro(opflowGyroHistory_t *history, timeUs_t startUs, int updates)
+{
+    timeUs_t timeUs = startUs;
+    for (int i = 0; i < updates; i++) {
+        timeUs += GYRO_DT_US;
+        // Rate at the middle of the update, as an integrating gyro would see it
+        const float t = (timeUs - GYRO_DT_US / 2 - startUs) * 1e-6f;
+        const float rate[2] = { rateAt(t, 0), rateAt(t, 1) };
+        opflowGyroHistoryPush(history, timeUs, GYRO_DT_US, rate);
+    }
+    return timeUs;
+}
+
+TEST(OpflowGyroTest, EmptyHistoryCoversNothing)
+{
+    opflowGyroHistory_t history;
+    opflowGyroHistoryReset(&history);
+
+    float rotation[2];
+    EXPECT_EQ(0, opflowGyroHistoryIntegrate(&history, 0, 10000, rotation));
+    EXPECT_FLOAT_EQ(0, rotation[0]);
+    EXPECT_FLOAT_EQ(0, rotation[1]);
+}
+
+TEST(OpflowGyroTest, IntegratesTheFlowWindow)
+{
+    opflowGyroHistory_t history;
+    opflowGyroHistoryReset(&history);
+
+    const timeUs_t startUs = 1000000;
+    const timeUs_t nowUs = runGyro(&history, startUs, 400);
+
+    // A 100Hz flow sample that ended 15ms ago and is not on a slot boundary
+    const timeUs_t endUs = nowUs - 15250;
+    const timeUs_t beginUs = endUs - 10000;
+    float rotation[2];
+    EXPECT_EQ(10000, opflowGyroHistoryIntegrate(&history, beginUs, endUs, rotation));
+
+    for (int axis = 0; axis < 2; axis++) {
+        const float expected = rotationAt((endUs - startUs) * 1e-6f, axis) - rotationAt((beginUs - startUs) * 1e-6f, axis);
+        EXPECT_NEAR(expected, rotation[axis], 0.05f) << axis;
+    }
+}
+
+TEST(OpflowGyroTest, WindowIncludesTheOpenSlot)
+{
+    opflowGyroHistory_t history;
+    opflowGyroHistoryReset(&history);
+
+    const timeUs_t startUs = 0;
+    // Ends one gyro update after a slot was closed
+    const timeUs_t nowUs = runGyro(&history, startUs, 8 * 10 + 1);
+
+    float rotation[2];
+    EXPECT_EQ(20000, opflowGyroHistoryIntegrate(&history, nowUs - 20000, nowUs, rotation));
+    for (int axis = 0; axis < 2; axis++) {
+        const float expected = rotationAt(nowUs * 1e-6f, axis) - rotationAt((nowUs - 20000) * 1e-6f, axis);
+        EXPECT_NEAR(expected, rotation[axis], 0.05f) << axis;
+    }
+}
+
+TEST(OpflowGyroTest, PartialCoverageAfterWrap)
+{
+    opflowGyroHistory_t history;
+    opflowGyroHistoryReset(&history);
+
+    // Start close to the 32bit timer wrap, run well past the history length
+    const timeUs_t startUs = 0xFFFFFFFFu - 100000;
+    const timeUs_t nowUs = runGyro(&history, startUs, 2000);
+    const timeDelta_t historyUs = OPFLOW_GYRO_HISTORY_SLOTS * OPFLOW_GYRO_HISTORY_SLOT_US;
+
+    // Window reaching past both ends is only covered by what is kept
+    float rotation[2];
+    const timeDelta_t covered = opflowGyroHistoryIntegrate(&history, nowUs - historyUs - 50000, nowUs + 5000, rotation);
+    EXPECT_GE(covered, historyUs);
+    EXPECT_LE(covered, historyUs + OPFLOW_GYRO_HISTORY_SLOT_US);
+
+    // Recent window is still exact
+    EXPECT_EQ(10000, opflowGyroHistoryIntegrate(&history, nowUs - 12000, nowUs - 2000, rotation));
+    for (int axis = 0; axis < 2; axis++) {
+        const float expected = rotationAt((timeUs_t)(nowUs - 2000 - startUs) * 1e-6f, axis) - rotationAt((timeUs_t)(nowUs - 12000 - startUs) * 1e-6f, axis);
+        EXPECT_NEAR(expected, rotation[axis], 0.05f) << axis;
+    }
+}
@@ -0,0 +1,256 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <limits.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/build_config.h"
+
+    #include "common/color.h"
+    #include "common/colorconversion.h"
+
+    #include "drivers/io.h"
+    #include "drivers/timer.h"
+    #include "drivers/light_ws2811strip.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BIT_COMPARE_1 ((WS2811_TIMER_HZ / WS2811_CARRIER_HZ * 2) / 3)
+#define BIT_COMPARE_0 ((WS2811_TIMER_HZ / WS2811_CARRIER_HZ) / 3)
+
+extern "C" {
+STATIC_UNIT_TESTED extern uint16_t dmaBufferOffset;
+
+STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color);
+STATIC_UNIT_TESTED uint16_t ws2811UpdateDMABuffer(void);
+
+static timerDMASafeType_t *dmaBuffer;
+static bool dmaStarted;
+}
+
+// Original hsvToRgb24 implementation, the table driven one must match it bit for bit
+static rgbColor24bpp_t hsvToRgb24Reference(const hsvColor_t *c)
+{
+    rgbColor24bpp_t r = { .raw = { 0, 0, 0 } };
+
+    uint16_t val = c->v;
+    uint16_t sat = 255 - c->s;
+    uint16_t hue = c->h;
+
+    if (sat == 0) {
+        r.rgb.r = val;
+        r.rgb.g = val;
+        r.rgb.b = val;
+    } else {
+        uint32_t base = ((255 - sat) * val) >> 8;
+
+        switch (hue / 60) {
+            case 0:
+                r.rgb.r = val;
+                r.rgb.g = (((val - base) * hue) / 60) + base;
+                r.rgb.b = base;
+                break;
+            case 1:
+                r.rgb.r = (((val - base) * (60 - (hue % 60))) / 60) + base;
+                r.rgb.g = val;
+                r.rgb.b = base;
+                break;
+            case 2:
+                r.rgb.r = base;
+                r.rgb.g = val;
+                r.rgb.b = (((val - base) * (hue % 60)) / 60) + base;
+                break;
+            case 3:
+                r.rgb.r = base;
+                r.rgb.g = (((val - base) * (60 - (hue % 60))) / 60) + base;
+                r.rgb.b = val;
+                break;
+            case 4:
+                r.rgb.r = (((val - base) * (hue % 60)) / 60) + base;
+                r.rgb.g = base;
+                r.rgb.b = val;
+                break;
+            case 5:
+                r.rgb.r = val;
+                r.rgb.g = base;
+                r.rgb.b = (((val - base) * (60 - (hue % 60))) / 60) + base;
+                break;
+        }
+    }
+
+    return r;
+}
+
+static void expectLedEncoded(int ledIndex, const hsvColor_t *color)
+{
+    const rgbColor24bpp_t rgb = hsvToRgb24Reference(color);
+    const uint32_t grb = (rgb.rgb.g << 16) | (rgb.rgb.r << 8) | rgb.rgb.b;
+    const timerDMASafeType_t *bits = &dmaBuffer[WS2811_DELAY_BUFFER_LENGTH + ledIndex * WS2811_BITS_PER_LED];
+
+    for (int bit = 0; bit < WS2811_BITS_PER_LED; bit++) {
+        EXPECT_EQ((grb & (1 << (23 - bit))) ? BIT_COMPARE_1 : BIT_COMPARE_0, bits[bit]) << "led " << ledIndex << " bit " << bit;
+    }
+}
+
+TEST(WS2812, updateDMABuffer) {
+    // given
+    rgbColor24bpp_t color1 = { .raw = {0xFF,0xAA,0x55} };
+
+    // and
+    dmaBufferOffset = 0;
+
+    // when
+    fastUpdateLEDDMABuffer(&color1);
+
+    // then
+    EXPECT_EQ(24, dmaBufferOffset);
+
+    // and G, R, B with MSB first
+    const uint8_t expected[3] = { 0xAA, 0xFF, 0x55 };
+    for (int byteIndex = 0; byteIndex < 3; byteIndex++) {
+        for (int bit = 0; bit < 8; bit++) {
+            EXPECT_EQ((expected[byteIndex] & (0x80 >> bit)) ? BIT_COMPARE_1 : BIT_COMPARE_0,
+                    dmaBuffer[WS2811_DELAY_BUFFER_LENGTH + (byteIndex * 8) + bit]);
+        }
+    }
+}
+
+TEST(WS2812, hsvToRgb24MatchesReference) {
+    for (int h = 0; h <= HSV_HUE_MAX; h++) {
+        for (int s = 0; s <= HSV_SATURATION_MAX; s++) {
+            for (int v = 0; v <= HSV_VALUE_MAX; v += 3) {
+                const hsvColor_t hsv = { .h = (uint16_t)h, .s = (uint8_t)s, .v = (uint8_t)v };
+                const rgbColor24bpp_t expected = hsvToRgb24Reference(&hsv);
+                const rgbColor24bpp_t *rgb = hsvToRgb24(&hsv);
+
+                ASSERT_EQ(expected.rgb.r, rgb->rgb.r) << h << " " << s << " " << v;
+                ASSERT_EQ(expected.rgb.g, rgb->rgb.g) << h << " " << s << " " << v;
+                ASSERT_EQ(expected.rgb.b, rgb->rgb.b) << h << " " << s << " " << v;
+            }
+        }
+    }
+}
+
+TEST(WS2812, onlyChangedLedsAreEncoded) {
+    const hsvColor_t red = { .h = 0, .s = 255, .v = 255 };
+    const hsvColor_t orange = { .h = 30, .s = 200, .v = 100 };
+
+    // First update encodes the whole strip
+    setStripColor(&red);
+    ws2811UpdateDMABuffer();
+
+    for (int i = 0; i < WS2811_LED_STRIP_LENGTH; i++) {
+        expectLedEncoded(i, &red);
+    }
+
+    // Nothing changed
+    EXPECT_EQ(0, ws2811UpdateDMABuffer());
+
+    // Rewriting the same color is not a change
+    setLedHsv(5, &red);
+    EXPECT_EQ(0, ws2811UpdateDMABuffer());
+
+    // Only the changed LEDs are encoded, the neighbours keep their bits
+    setLedHsv(5, &orange);
+    setLedHsv(WS2811_LED_STRIP_LENGTH - 1, &orange);
+    EXPECT_EQ(2, ws2811UpdateDMABuffer());
+
+    expectLedEncoded(4, &red);
+    expectLedEncoded(5, &orange);
+    expectLedEncoded(6, &red);
+    expectLedEncoded(WS2811_LED_STRIP_LENGTH - 1, &orange);
+
+    // A layer that changes a LED and then restores it within one update is not a change
+    scaleLedValue(5, 50);
+    setLedHsv(5, &orange);
+    EXPECT_EQ(0, ws2811UpdateDMABuffer());
+
+    setLedValue(6, 10);
+    EXPECT_EQ(1, ws2811UpdateDMABuffer());
+}
+
+TEST(WS2812, updateStripStartsTransfer) {
+    const hsvColor_t blue = { .h = 240, .s = 255, .v = 255 };
+
+    ws2811LedStripInit();
+    dmaStarted = false;
+
+    // The strip is sent even if nothing changed, LEDs may have been powered up since the last update
+    ws2811UpdateStrip();
+    EXPECT_TRUE(dmaStarted);
+
+    dmaStarted = false;
+    setLedHsv(0, &blue);
+    ws2811UpdateStrip();
+    EXPECT_TRUE(dmaStarted);
+    expectLedEncoded(0, &blue);
+}
+
+// STUBS
+
+extern "C" {
+
+static timerHardware_t ledTimerHardware;
+static TCH_t ledTimerChannel;
+static uint32_t ledTimerCCR;
+
+static const timerHardware_t * ledTimer(void)
+{
+    ledTimerHardware.usageFlags = TIM_USE_LED;
+    return &ledTimerHardware;
+}
+
+const timerHardware_t * timerGetByTag(ioTag_t, timerUsageFlag_e) { return ledTimer(); }
+const timerHardware_t * timerGetByUsageFlag(timerUsageFlag_e) { return ledTimer(); }
+TCH_t * timerGetTCH(const timerHardware_t *) { return &ledTimerChannel; }
+IO_t IOGetByTag(ioTag_t) { return (IO_t)1; }
+void IOInit(IO_t, resourceOwner_e, resourceType_e, uint8_t) {}
+void IOConfigGPIOAF(IO_t, ioConfig_t, uint8_t) {}
+void timerConfigBase(TCH_t *, uint16_t, uint32_t) {}
+void timerPWMConfigChannel(TCH_t *, uint16_t) {}
+void timerPWMStart(TCH_t *) {}
+void timerEnable(TCH_t *) {}
+volatile timCCR_t * timerCCR(TCH_t *) { return &ledTimerCCR; }
+void timerPWMStopDMA(TCH_t *) {}
+bool timerPWMDMAInProgress(TCH_t *) { return false; }
+void timerPWMPrepareDMA(TCH_t *, uint32_t) {}
+void timerPWMStartDMA(TCH_t *) { dmaStarted = true; }
+
+bool timerPWMConfigChannelDMA(TCH_t *, void *dmaBufferPtr, uint8_t, uint32_t)
+{
+    dmaBuffer = (timerDMASafeType_t *)dmaBufferPtr;
+    return true;
+}
+
+}
+
+// The DMA buffer is static in the driver, grab it through the DMA configuration
+class WS2812Environment : public ::testing::Environment {
+public:
+    void SetUp() override {
+        ws2811LedStripInit();
+    }
+};
+
+static ::testing::Environment * const ws2812Environment = ::testing::AddGlobalTestEnvironment(new WS2812Environment);